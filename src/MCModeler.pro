@@ -58,7 +58,54 @@ HEADERS = \
     block_property_keys.h \
     tree_tool.h \
     circle_tool.h \
-    sphere_tool.h
+    sphere_tool.h \
+    chunk_position.h \
+    block_region.h \
+    diagram_subscription.h \
+    chunk.h \
+    diagram_slice.h \
+    block_orientation_table.h \
+    chunk_cursor.h \
+    span_mask.h \
+    shape_tool.h \
+    brush_tool.h \
+    solid_tool.h \
+    dome_tool.h \
+    cylinder_tool.h \
+    cone_tool.h \
+    torus_tool.h \
+    cuboid_tool.h \
+    block_clipboard.h \
+    selection_tool.h \
+    paste_tool.h \
+    block_transform.h \
+    array_dialog.h \
+    block_replacement.h \
+    find_replace_dialog.h \
+    schematic_file.h \
+    nbt.h \
+    region_file.h \
+    region_import_dialog.h \
+    texture_atlas.h \
+    mesh_builder.h \
+    mesh_exporter.h \
+    triangle_mesh.h \
+    voxelizer.h \
+    mesh_import_dialog.h \
+    image_converter.h \
+    image_convert_dialog.h \
+    terrain_generator.h \
+    terrain_dialog.h \
+    vox_color_table.h \
+    vox_file.h \
+    vox_palette_dialog.h \
+    gradient_noise.h \
+    landscape_generator.h \
+    landscape_dialog.h \
+    tree_generator.h \
+    forest_tool.h \
+    prefab_file.h \
+    prefab_library.h
 
 SOURCES = \
     about_box.cc \
@@ -110,7 +157,53 @@ SOURCES = \
     flow_block_renderable.cc \
     tree_tool.cc \
     circle_tool.cc \
-    sphere_tool.cc
+    sphere_tool.cc \
+    chunk_position.cc \
+    block_region.cc \
+    diagram_subscription.cc \
+    chunk.cc \
+    diagram_slice.cc \
+    chunk_cursor.cc \
+    span_mask.cc \
+    shape_tool.cc \
+    brush_tool.cc \
+    solid_tool.cc \
+    dome_tool.cc \
+    cylinder_tool.cc \
+    cone_tool.cc \
+    torus_tool.cc \
+    cuboid_tool.cc \
+    block_clipboard.cc \
+    selection_tool.cc \
+    paste_tool.cc \
+    block_transform.cc \
+    array_dialog.cc \
+    block_replacement.cc \
+    find_replace_dialog.cc \
+    schematic_file.cc \
+    nbt.cc \
+    region_file.cc \
+    region_import_dialog.cc \
+    texture_atlas.cc \
+    mesh_builder.cc \
+    mesh_exporter.cc \
+    triangle_mesh.cc \
+    voxelizer.cc \
+    mesh_import_dialog.cc \
+    image_converter.cc \
+    image_convert_dialog.cc \
+    terrain_generator.cc \
+    terrain_dialog.cc \
+    vox_color_table.cc \
+    vox_file.cc \
+    vox_palette_dialog.cc \
+    gradient_noise.cc \
+    landscape_generator.cc \
+    landscape_dialog.cc \
+    tree_generator.cc \
+    forest_tool.cc \
+    prefab_file.cc \
+    prefab_library.cc
 
 QT += opengl
 
@@ -124,13 +217,40 @@ FORMS += \
     gl_preview_window.ui \
     main_window.ui \
     block_picker.ui \
-    tool_picker.ui
+    tool_picker.ui \
+    array_dialog.ui \
+    find_replace_dialog.ui \
+    region_import_dialog.ui \
+    mesh_import_dialog.ui \
+    image_convert_dialog.ui \
+    terrain_dialog.ui \
+    vox_palette_dialog.ui \
+    landscape_dialog.ui
 
 INCLUDEPATH += ../third_party \
                ../third_party/qjson/include
 
 win32:INCLUDEPATH += ../third_party/zlib-1.2.5
 win32:QMAKE_LFLAGS += -static-libgcc
+!win32:LIBS += -lz
+
+# Schematics and region files are compressed, and Windows has no system zlib to link against, so build the bundled one.
+win32:SOURCES += \
+    ../third_party/zlib-1.2.5/adler32.c \
+    ../third_party/zlib-1.2.5/compress.c \
+    ../third_party/zlib-1.2.5/crc32.c \
+    ../third_party/zlib-1.2.5/deflate.c \
+    ../third_party/zlib-1.2.5/gzclose.c \
+    ../third_party/zlib-1.2.5/gzlib.c \
+    ../third_party/zlib-1.2.5/gzread.c \
+    ../third_party/zlib-1.2.5/gzwrite.c \
+    ../third_party/zlib-1.2.5/infback.c \
+    ../third_party/zlib-1.2.5/inffast.c \
+    ../third_party/zlib-1.2.5/inflate.c \
+    ../third_party/zlib-1.2.5/inftrees.c \
+    ../third_party/zlib-1.2.5/trees.c \
+    ../third_party/zlib-1.2.5/uncompr.c \
+    ../third_party/zlib-1.2.5/zutil.c
 
 macx {
     QMAKE_LFLAGS += -F ../third_party/qjson/lib -L ../third_party/quazip/lib
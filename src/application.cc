@@ -18,17 +18,23 @@
 #include "gl_preview_window.h"
 #include "main_window.h"
 
+#include "block_orientation.h"
 #include "block_prototype.h"
 
 #include <QDebug>
 
+#include <time.h>
+
 Application::Application(int& argc, char** argv)
     : QApplication(argc, argv), block_mgr_(NULL) {
   setApplicationName("MCModeler");
   setApplicationVersion("0.3 dev 2");
   setOrganizationName("Caffeinix");
   setOrganizationDomain("com.github.caffeinix");
+  // qrand() is only used to pick fresh seeds for things like trees and landscapes, which are then reproducible.
+  qsrand(time(NULL));
 
+  BlockOrientation::setupOrientations();
   BlockPrototype::setupBlockProperties();
 
   MainWindow* main_window = new MainWindow(NULL);
@@ -39,6 +45,7 @@ Application::Application(int& argc, char** argv)
   diagram_->setBlockManager(block_mgr_.data());
 
   settings_.reset(new QSettings());
+  block_mgr_->loadAllPrototypes();
 
   gl_preview_window->setDiagram(diagram_.data());
   gl_preview_window->setBlockManager(block_mgr_.data());
@@ -0,0 +1,47 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "array_dialog.h"
+
+ArrayDialog::ArrayDialog(QWidget* parent) : QDialog(parent) {
+  ui.setupUi(this);
+  connect(ui.arrangement_combo_box_, SIGNAL(currentIndexChanged(int)), SLOT(updateFields(int)));
+  updateFields(ui.arrangement_combo_box_->currentIndex());
+}
+
+ArrayDialog::Arrangement ArrayDialog::arrangement() const {
+  return static_cast<Arrangement>(ui.arrangement_combo_box_->currentIndex());
+}
+
+int ArrayDialog::copies() const {
+  return ui.copies_spin_box_->value();
+}
+
+BlockPosition ArrayDialog::step() const {
+  return BlockPosition(ui.step_x_spin_box_->value(), ui.step_y_spin_box_->value(), ui.step_z_spin_box_->value());
+}
+
+BlockPosition ArrayDialog::center() const {
+  return BlockPosition(ui.center_x_spin_box_->value(), 0, ui.center_z_spin_box_->value());
+}
+
+void ArrayDialog::updateFields(int index) {
+  bool linear = (index == kArrangementLinear);
+  ui.step_x_spin_box_->setEnabled(linear);
+  ui.step_y_spin_box_->setEnabled(linear);
+  ui.step_z_spin_box_->setEnabled(linear);
+  ui.center_x_spin_box_->setEnabled(!linear);
+  ui.center_z_spin_box_->setEnabled(!linear);
+}
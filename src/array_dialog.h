@@ -0,0 +1,70 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ARRAY_DIALOG_H
+#define ARRAY_DIALOG_H
+
+#include "block_position.h"
+#include "ui_array_dialog.h"
+
+/**
+  * The dialog that asks how to repeat the selection when making an array (see LevelWidget::arraySelection()).
+  *
+  * Copies are either laid out in a line, each one step() away from the last, or spaced evenly around a circle whose
+  * center is center() blocks away from the center of the selection.
+  */
+class ArrayDialog : public QDialog {
+  Q_OBJECT
+
+ public:
+  enum Arrangement {
+    kArrangementLinear,
+    kArrangementRadial
+  };
+
+  explicit ArrayDialog(QWidget* parent = NULL);
+
+  /**
+    * Returns how the copies should be laid out.
+    */
+  Arrangement arrangement() const;
+
+  /**
+    * Returns the total number of copies, including the selection itself.
+    */
+  int copies() const;
+
+  /**
+    * Returns the offset from each copy to the next, for linear arrays.
+    */
+  BlockPosition step() const;
+
+  /**
+    * Returns the offset from the center of the selection to the center of the circle, for radial arrays.  Only the
+    * _x_ and _z_ coordinates are used, since copies are always placed on the levels the selection spans.
+    */
+  BlockPosition center() const;
+
+ private slots:
+  /**
+    * Enables the fields that make sense for the arrangement at \p index in the arrangement combo box.
+    */
+  void updateFields(int index);
+
+ private:
+  Ui::ArrayDialog ui;
+};
+
+#endif // ARRAY_DIALOG_H
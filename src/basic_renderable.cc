@@ -16,6 +16,7 @@
 #include "basic_renderable.h"
 
 #include "enums.h"
+#include "mesh_builder.h"
 #include "render_delegate.h"
 
 BasicRenderable::BasicRenderable(const QVector3D& size)
@@ -50,7 +51,9 @@ void BasicRenderable::addQuad(const QVector3D& a, const QVector3D& b,
   appendVertex(d, norm, tex[kTopLeftCorner]);
 }
 
-void BasicRenderable::applyOrientationTransform(const BlockOrientation* orientation) const {}
+QMatrix4x4 BasicRenderable::orientationTransform(const BlockOrientation* orientation) const {
+  return QMatrix4x4();
+}
 
 bool BasicRenderable::shouldRenderQuad(int index,
                                        const QVector3D& location,
@@ -58,6 +61,12 @@ bool BasicRenderable::shouldRenderQuad(int index,
   return true;
 }
 
+bool BasicRenderable::shouldExportQuad(int index,
+                                       const QVector3D& location,
+                                       const BlockOrientation* orientation) const {
+  return shouldRenderQuad(index, location, orientation);
+}
+
 Texture BasicRenderable::textureForQuad(int index, const BlockOrientation* orientation) const {
   return texture(index);
 }
@@ -74,7 +83,15 @@ void BasicRenderable::renderAt(const QVector3D& location, const BlockOrientation
   glPushMatrix();
   glTranslatef(location.x(), location.y(), location.z());
 
-  applyOrientationTransform(orientation);
+  QMatrix4x4 transform = orientationTransform(orientation);
+  if (!transform.isIdentity()) {
+    GLfloat matrix[16];
+    const qreal* data = transform.constData();
+    for (int i = 0; i < 16; ++i) {
+      matrix[i] = data[i];
+    }
+    glMultMatrixf(matrix);
+  }
 
   glEnableClientState(GL_VERTEX_ARRAY);
   glEnableClientState(GL_NORMAL_ARRAY);
@@ -97,3 +114,24 @@ void BasicRenderable::renderAt(const QVector3D& location, const BlockOrientation
   }
   glPopMatrix();
 }
+
+void BasicRenderable::addToMesh(const QVector3D& location, const BlockOrientation* orientation,
+                                MeshBuilder* mesh) const {
+  if (!isInitialized()) {
+    qWarning() << "Tried to export a BasicRenderable without first calling initialize().";
+    return;
+  }
+  QMatrix4x4 transform;
+  transform.translate(location);
+  transform *= orientationTransform(orientation);
+  QVector3D corners[4];
+  for (int start = 0; start < vertices().size(); start += 4) {
+    if (!shouldExportQuad(start / 4, location, orientation)) {
+      continue;
+    }
+    for (int corner = 0; corner < 4; ++corner) {
+      corners[corner] = transform.map(vertices().at(start + corner));
+    }
+    mesh->addQuad(corners, textureCoords().constData() + start, textureForQuad(start / 4, orientation));
+  }
+}
@@ -16,6 +16,7 @@
 #ifndef BASIC_RENDERABLE_H
 #define BASIC_RENDERABLE_H
 
+#include <QMatrix4x4>
 #include <QVector>
 #include <QVector2D>
 #include <QVector3D>
@@ -34,9 +35,11 @@
   * 4. The geometry is converted into a set of quads using addQuad.
   *
   * Once this setup has finished, the geometry can be drawn by BasicRenderable's generic renderAt() implementation.
-  * To customize the rendering, you can reimplement applyOrientationTransform() (to apply OpenGL matrix transformations
-  * for orientation support), shouldRenderQuad() (to perform face culling, for example) and/or textureForQuad().  All
-  * three of these methods have default implementations, so you do not need to override them unless you want to.
+  * To customize the rendering, you can reimplement orientationTransform() (to rotate the geometry for orientation
+  * support), shouldRenderQuad() (to perform face culling, for example) and/or textureForQuad().  All three of these
+  * methods have default implementations, so you do not need to override them unless you want to.  addToMesh() uses
+  * the same methods, except that it asks shouldExportQuad() which quads to keep, so that face culling can look at the
+  * world rather than at the 3D view.
   *
   * You can also reimplement renderAt yourself and use the vertices(), normals(), and textureCoords() accessors to get
   * direct access to the raw geometry.
@@ -69,6 +72,11 @@ class BasicRenderable : public Renderable {
     */
   virtual void renderAt(const QVector3D& location, const BlockOrientation* orientation) const;
 
+  /**
+    * @copydoc Renderable::addToMesh(const QVector3D&, const BlockOrientation*, MeshBuilder*) const
+    * BasicRenderable adds the same quads renderAt() draws, transformed the same way.
+    */
+  virtual void addToMesh(const QVector3D& location, const BlockOrientation* orientation, MeshBuilder* mesh) const;
 
  protected:
   /**
@@ -114,11 +122,11 @@ class BasicRenderable : public Renderable {
   virtual void addGeometry(const Geometry& geometry, const TextureCoords& texture_coords) = 0;
 
   /**
-    * Applies any desired OpenGL coordinate transformations (glRotate(), glTranslate(), etc.) to account for the given
-    * orientation.  You do not need to push a matrix before applying these transforms; they will be applied at the
-    * correct time and in the correct context automatically.  The default implementation does nothing.
+    * Returns the transformation (rotations, translations, etc.) that accounts for the given orientation.  It is
+    * applied to the geometry after it has been moved to the origin, and before it is moved to where the block is.
+    * The default implementation returns the identity.
     */
-  virtual void applyOrientationTransform(const BlockOrientation* orientation) const;
+  virtual QMatrix4x4 orientationTransform(const BlockOrientation* orientation) const;
 
   /**
     * Returns true if the quad at \p index should be rendered at \p location with \p orientation.  Subclasses can check
@@ -127,6 +135,13 @@ class BasicRenderable : public Renderable {
     */
   virtual bool shouldRenderQuad(int index, const QVector3D& location, const BlockOrientation* orientation) const;
 
+  /**
+    * Returns true if the quad at \p index should be exported at \p location with \p orientation by addToMesh().
+    * Subclasses that cull faces against their neighbors should override this to ask the render delegate's
+    * shouldExportFace().  The default implementation calls shouldRenderQuad().
+    */
+  virtual bool shouldExportQuad(int index, const QVector3D& location, const BlockOrientation* orientation) const;
+
   /**
     * Returns the texture that should be used to draw the quad at \p index for a block in \p orientation.  By default,
     * this just calls Renderable::texture() with index, but you may wish to override it if you wish to use the same
@@ -22,12 +22,14 @@
 #include "block_prototype.h"
 #include "block_type.h"
 #include "diagram.h"
+#include "diagram_subscription.h"
 
 BillOfMaterialsWindow::BillOfMaterialsWindow(Diagram* diagram, QWidget* parent)
     : QWidget(parent), diagram_(diagram) {
   ui.setupUi(this);
   ui.bill_of_materials_text_->setAttribute(Qt::WA_MacSmallSize);
-  this->connect(diagram, SIGNAL(diagramChanged(BlockTransaction)), SLOT(updateBillOfMaterials()));
+  DiagramSubscription* subscription = diagram->subscribe(BlockRegion::everything(), this);
+  this->connect(subscription, SIGNAL(diagramChanged(BlockTransaction)), SLOT(updateBillOfMaterials()));
 }
 
 BillOfMaterialsWindow::~BillOfMaterialsWindow() {}
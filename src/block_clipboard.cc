@@ -0,0 +1,113 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "block_clipboard.h"
+
+#include "block_position.h"
+#include "block_prototype.h"
+
+BlockClipboard::BlockClipboard() : width_(0), height_(0), depth_(0), block_count_(0) {
+}
+
+BlockClipboard::BlockClipboard(int width, int height, int depth)
+    : width_(width),
+      height_(height),
+      depth_(depth),
+      block_count_(0) {
+  Q_ASSERT(width > 0 && height > 0 && depth > 0);
+}
+
+void BlockClipboard::setBlock(const BlockPosition& position,
+                              BlockPrototype* prototype,
+                              const BlockOrientation* orientation) {
+  Q_ASSERT(position.x() >= 0 && position.x() < width_);
+  Q_ASSERT(position.y() >= 0 && position.y() < height_);
+  Q_ASSERT(position.z() >= 0 && position.z() < depth_);
+  ChunkPosition chunk_position = ChunkPosition::containing(position);
+  if (!prototype && !chunks_.contains(chunk_position)) {
+    return;
+  }
+  Chunk& chunk = chunks_[chunk_position];
+  block_count_ -= chunk.blockCount();
+  chunk.setBlock(ChunkPosition::localCoordinate(position.x()),
+                 ChunkPosition::localCoordinate(position.y()),
+                 ChunkPosition::localCoordinate(position.z()),
+                 prototype,
+                 orientation);
+  block_count_ += chunk.blockCount();
+  if (chunk.isEmpty()) {
+    chunks_.remove(chunk_position);
+  }
+}
+
+void BlockClipboard::setLayer(const ChunkPosition& chunk_position, int y, const ChunkLayer& layer) {
+  if (layer.isEmpty() && !chunks_.contains(chunk_position)) {
+    return;
+  }
+  Chunk& chunk = chunks_[chunk_position];
+  block_count_ -= chunk.blockCount();
+  chunk.setLayer(y, layer);
+  block_count_ += chunk.blockCount();
+  if (chunk.isEmpty()) {
+    chunks_.remove(chunk_position);
+  }
+}
+
+void BlockClipboard::setLayers(const QList<QList<Layer> >& layers) {
+  foreach (const QList<Layer>& job_layers, layers) {
+    foreach (const Layer& layer, job_layers) {
+      setLayer(layer.chunkPosition(), layer.y(), layer.layer());
+    }
+  }
+}
+
+BlockClipboard BlockClipboard::transformed(BlockTransform::Kind kind) const {
+  if (isEmpty()) {
+    return BlockClipboard();
+  }
+  bool swaps_axes = BlockTransform::swapsAxes(kind);
+  BlockClipboard result(swaps_axes ? depth_ : width_, height_, swaps_axes ? width_ : depth_);
+  QVector<const BlockOrientation*> orientations;
+  for (QHash<ChunkPosition, Chunk>::const_iterator it = chunks_.constBegin(); it != chunks_.constEnd(); ++it) {
+    int base_x = it.key().x() * kChunkSize;
+    int base_y = it.key().y() * kChunkSize;
+    int base_z = it.key().z() * kChunkSize;
+    for (int local_y = 0; local_y < kChunkSize; ++local_y) {
+      const ChunkLayer& layer = it.value().layer(local_y);
+      if (layer.isEmpty()) {
+        continue;
+      }
+      const QVector<ChunkLayer::PaletteEntry>& palette = layer.palette();
+      orientations.resize(palette.size());
+      for (int i = 1; i < palette.size(); ++i) {
+        const ChunkLayer::PaletteEntry& entry = palette.at(i);
+        orientations[i] = entry.count() ? entry.prototype()->transformedOrientation(entry.orientation(), kind) : NULL;
+      }
+      for (int local_z = 0; local_z < kChunkSize; ++local_z) {
+        for (int local_x = 0; local_x < kChunkSize; ++local_x) {
+          int index = layer.paletteIndexAt(ChunkLayer::cellIndex(local_x, local_z));
+          if (!index) {
+            continue;
+          }
+          int x = base_x + local_x;
+          int z = base_z + local_z;
+          BlockTransform::transformCell(kind, width_, depth_, &x, &z);
+          result.setBlock(BlockPosition(x, base_y + local_y, z), palette.at(index).prototype(), orientations.at(index));
+        }
+      }
+    }
+  }
+  return result;
+}
@@ -0,0 +1,162 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BLOCK_CLIPBOARD_H
+#define BLOCK_CLIPBOARD_H
+
+#include <QHash>
+#include <QList>
+
+#include "block_transform.h"
+#include "chunk.h"
+#include "chunk_position.h"
+
+class BlockOrientation;
+class BlockPosition;
+class BlockPrototype;
+
+/**
+  * A box of blocks copied out of a Diagram, to be pasted somewhere else later.
+  *
+  * The blocks are stored the same way the Diagram stores them, as Chunks keyed by ChunkPosition, with positions
+  * relative to the corner of the box with the smallest coordinates.  So a clipboard costs nothing for the air in it
+  * and little more than a palette index for each block, and like Chunk it is implicitly shared and cheap to copy.
+  *
+  * Use Diagram::copyRegion() to fill a clipboard and Diagram::paste() to put it back.
+  */
+class BlockClipboard {
+ public:
+  /**
+    * A layer of blocks bound for the clipboard, along with where it goes.  Jobs that build a clipboard in parallel
+    * return these, so that the clipboard itself is only touched on one thread.
+    */
+  class Layer {
+   public:
+    Layer(const ChunkPosition& chunk_position, int y, const ChunkLayer& layer)
+        : chunk_position_(chunk_position), y_(y), layer_(layer) {}
+
+    /**
+      * Returns the position of the clipboard chunk the layer belongs in.
+      */
+    const ChunkPosition& chunkPosition() const {
+      return chunk_position_;
+    }
+
+    /**
+      * Returns the local height of the layer within its chunk.
+      */
+    int y() const {
+      return y_;
+    }
+
+    const ChunkLayer& layer() const {
+      return layer_;
+    }
+
+   private:
+    ChunkPosition chunk_position_;
+    int y_;
+    ChunkLayer layer_;
+  };
+
+  /**
+    * Constructs an empty clipboard that holds no box at all.
+    */
+  BlockClipboard();
+
+  /**
+    * Constructs a clipboard holding a box of \p width x \p height x \p depth blocks of air.
+    */
+  BlockClipboard(int width, int height, int depth);
+
+  /**
+    * Returns whether the clipboard holds no box at all.  A clipboard holding a box of air is not empty.
+    */
+  bool isEmpty() const {
+    return width_ == 0;
+  }
+
+  /**
+    * Returns the size of the box along x.
+    */
+  int width() const {
+    return width_;
+  }
+
+  /**
+    * Returns the size of the box along y, which is the number of levels it spans.
+    */
+  int height() const {
+    return height_;
+  }
+
+  /**
+    * Returns the size of the box along z.
+    */
+  int depth() const {
+    return depth_;
+  }
+
+  /**
+    * Returns the number of cells in the box which are not air.
+    */
+  int blockCount() const {
+    return block_count_;
+  }
+
+  /**
+    * Sets the block at \p position, relative to the corner of the box, to be described by \p prototype and
+    * \p orientation.  If \p prototype is NULL, the cell is cleared instead.  \p position must lie inside the box.
+    */
+  void setBlock(const BlockPosition& position, BlockPrototype* prototype, const BlockOrientation* orientation);
+
+  /**
+    * Replaces the layer at local height \p y of the chunk at \p chunk_position, relative to the corner of the box, with
+    * \p layer.  This is how whole levels are filled in at once, without looking up the chunk for every block.  The
+    * cells of \p layer that lie outside the box must be air.
+    */
+  void setLayer(const ChunkPosition& chunk_position, int y, const ChunkLayer& layer);
+
+  /**
+    * Calls setLayer() for each of \p layers, as returned by jobs mapped over the box with QtConcurrent.  No two of
+    * them may go in the same place.
+    */
+  void setLayers(const QList<QList<Layer> >& layers);
+
+  /**
+    * Returns the chunks holding the blocks, keyed by their position relative to the corner of the box.  Chunks
+    * holding only air may be missing.
+    */
+  const QHash<ChunkPosition, Chunk>& chunks() const {
+    return chunks_;
+  }
+
+  /**
+    * Returns a copy of this clipboard rotated or mirrored by \p kind, with the orientations of its blocks turned to
+    * match (see BlockPrototype::transformedOrientation()).  Rotating a quarter turn swaps the width and the depth.
+    * The orientations in each layer's palette are looked up once per layer, not once per block, and layers of air
+    * are skipped.
+    */
+  BlockClipboard transformed(BlockTransform::Kind kind) const;
+
+ private:
+  QHash<ChunkPosition, Chunk> chunks_;
+  int width_;
+  int height_;
+  int depth_;
+  int block_count_;
+};
+
+#endif // BLOCK_CLIPBOARD_H
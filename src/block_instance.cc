@@ -17,6 +17,7 @@
 #include "block_manager.h"
 
 #include <QDataStream>
+#include <QDebug>
 
 BlockInstance::BlockInstance() : is_valid_(false), prototype_(NULL), orientation_(NULL) {}
 
@@ -26,7 +27,7 @@ BlockInstance::BlockInstance(BlockPrototype* prototype,
     : is_valid_(true), prototype_(prototype), position_(position), orientation_(orientation) {}
 
 
-BlockInstance::BlockInstance(QDataStream* stream, BlockManager* block_manager)
+BlockInstance::BlockInstance(QDataStream* stream, BlockManager* block_manager, OrientationFormat orientation_format)
     : is_valid_(false), prototype_(NULL), orientation_(NULL) {
   Q_ASSERT(block_manager != NULL);
   int position_x;
@@ -37,15 +38,23 @@ BlockInstance::BlockInstance(QDataStream* stream, BlockManager* block_manager)
   *stream >> position_z;
   qint32 type_word;
   *stream >> type_word;
-  char* orientation_chars;
-  *stream >> orientation_chars;
+  const BlockOrientation* orientation = NULL;
+  if (orientation_format == kOrientationFormatName) {
+    char* orientation_chars;
+    *stream >> orientation_chars;
+    orientation = BlockOrientation::get(orientation_chars);
+    delete[] orientation_chars;
+  } else {
+    orientation = BlockOrientation::deserialize(stream);
+    if (!orientation) {
+      qWarning() << "Unknown orientation id; using no orientation instead.";
+      orientation = BlockOrientation::noOrientation();
+    }
+  }
 
   BlockPosition position(position_x, position_y, position_z);
   blocktype_t type = static_cast<blocktype_t>(type_word);
   BlockPrototype* prototype = block_manager->getPrototype(type);
-  const BlockOrientation* orientation = BlockOrientation::get(orientation_chars);
-
-  delete[] orientation_chars;
 
   is_valid_ = true;
   prototype_ = prototype;
@@ -79,6 +88,6 @@ bool BlockInstance::serialize(QDataStream* stream) const {
   *stream << position_y;
   *stream << position_z;
   *stream << static_cast<qint32>(prototype()->type());
-  *stream << orientation()->name().toAscii().constData();
+  orientation()->serialize(stream);
   return true;
 }
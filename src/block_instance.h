@@ -31,6 +31,16 @@ class QDataStream;
   */
 class BlockInstance {
  public:
+  /**
+    * The ways in which the orientation of a serialized BlockInstance may be stored.
+    */
+  enum OrientationFormat {
+    /// The orientation is stored as its name.  Used by diagram files before version 0x140.
+    kOrientationFormatName,
+    /// The orientation is stored by BlockOrientation::serialize(), as its 16-bit id if that is stable.
+    kOrientationFormatId
+  };
+
   /**
     * Constructs a BlockInstance.
     *
@@ -45,9 +55,10 @@ class BlockInstance {
     * Constructs a BlockInstance by deserializing it from \p stream using \p block_manager.  If a block can be read
     * from the stream without skipping any bytes, the created BlockInstance will be valid.  Otherwise, the created
     * BlockInstance will be invalid.  Either way, due to the sequential nature of streams, the stream will be advanced
-    * past the data that was read.
+    * past the data that was read.  \p orientation_format says how the block's orientation was stored.
     */
-  BlockInstance(QDataStream* stream, BlockManager* block_manager);
+  BlockInstance(QDataStream* stream, BlockManager* block_manager,
+                OrientationFormat orientation_format = kOrientationFormatId);
 
   /**
     * Constructs an invalid BlockInstance.  This is only useful when using BlockInstance in a context where a default
@@ -68,6 +79,9 @@ class BlockInstance {
     */
   BlockInstance& operator=(const BlockInstance& other);
 
+  /**
+    * Writes this BlockInstance to \p stream, storing its orientation in kOrientationFormatId format.
+    */
   bool serialize(QDataStream* stream) const;
 
   /**
@@ -22,6 +22,7 @@ BlockManager::BlockManager(BlockOracle* oracle, QGLWidget* widget)
     : oracle_(oracle), widget_(widget) {
   // Load textures.
   default_texture_pack_.reset(TexturePack::createDefaultTexturePack());
+  sprite_engine_.reset(new SpriteEngine());
 }
 
 BlockManager::~BlockManager() {
@@ -33,8 +34,27 @@ BlockPrototype* BlockManager::getPrototype(blocktype_t type) const {
   if (block) {
     return block;
   } else {
-    block = new BlockPrototype(type, default_texture_pack_.data(), oracle_, widget_);
+    block = new BlockPrototype(type, default_texture_pack_.data(), oracle_, widget_, sprite_engine_.data());
     blocks_.insert(type, block);
     return block;
   }
 }
+
+BlockPrototype* BlockManager::getPrototypeForMinecraftBlock(int id, int data) const {
+  blocktype_t type = id | (data << 16);
+  if (BlockPrototype::isKnownType(type)) {
+    return getPrototype(type);
+  }
+  if (BlockPrototype::isKnownType(id)) {
+    return getPrototype(id);
+  }
+  return NULL;
+}
+
+void BlockManager::loadAllPrototypes() {
+  BlockTypeIterator iter = BlockPrototype::blockIterator();
+  while (iter.hasNext()) {
+    getPrototype(iter.next());
+  }
+  sprite_engine_->generateSprites();
+}
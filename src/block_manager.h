@@ -20,6 +20,7 @@
 #include <QScopedPointer>
 
 #include "block_type.h"
+#include "sprite_engine.h"
 #include "texture_pack.h"
 
 class BlockOracle;
@@ -50,11 +51,32 @@ class BlockManager {
     */
   BlockPrototype* getPrototype(blocktype_t type) const;
 
+  /**
+    * Gets the BlockPrototype for the block Minecraft saves with block ID \p id and data value \p data: the type with
+    * the ID in its bottom 16 bits and the data value in the next four if that type is known, or else the type with just
+    * the ID.  Returns NULL if neither type is known.
+    */
+  BlockPrototype* getPrototypeForMinecraftBlock(int id, int data) const;
+
+  /**
+    * Creates the prototypes for every known block type, then generates all of their sprites at once.  Call this once
+    * at startup so that sprites don't have to be painted one at a time as blocks are first shown.
+    */
+  void loadAllPrototypes();
+
+  /**
+    * Returns the SpriteEngine shared by all the prototypes.
+    */
+  SpriteEngine* spriteEngine() const {
+    return sprite_engine_.data();
+  }
+
  private:
   mutable QHash<blocktype_t, BlockPrototype*> blocks_;
   BlockOracle* oracle_;
   QGLWidget* widget_;
   QScopedPointer<TexturePack> default_texture_pack_;
+  QScopedPointer<SpriteEngine> sprite_engine_;
 };
 
 #endif // BLOCK_MANAGER_H
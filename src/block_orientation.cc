@@ -15,29 +15,85 @@
 
 #include "block_orientation.h"
 
+#include <QDataStream>
 #include <QString>
 
 QHash<QString, BlockOrientation*> BlockOrientation::s_known_orientations_;
+QVector<BlockOrientation*> BlockOrientation::s_orientations_by_id_;
+
+/**
+  * The id serialize() writes in place of the id of an orientation that is not in the orientation table, before its
+  * name.
+  */
+static const quint16 kNamedOrientationId = 0xFFFF;
+
+/**
+  * The names of the orientations in the orientation table, indexed by BlockOrientation::Id.
+  */
+static const char* const kOrientationNames[] = {
+#define DECLARE_ORIENTATION_NAME(identifier, name) name,
+  BLOCK_ORIENTATION_TABLE(DECLARE_ORIENTATION_NAME)
+#undef DECLARE_ORIENTATION_NAME
+};
+
+// Static.
+void BlockOrientation::setupOrientations() {
+  if (!s_orientations_by_id_.isEmpty()) {
+    return;
+  }
+  for (int i = 0; i < kOrientationCount; ++i) {
+    create(QString(kOrientationNames[i]));
+  }
+}
 
 // Static.
-BlockOrientation* BlockOrientation::noOrientation() {
-  return BlockOrientation::get("");
+BlockOrientation* BlockOrientation::fromId(int id) {
+  setupOrientations();
+  if (id < 0 || id >= s_orientations_by_id_.size()) {
+    return NULL;
+  }
+  return s_orientations_by_id_.at(id);
 }
 
 // Static.
-BlockOrientation* BlockOrientation::paletteOrientation() {
-  return BlockOrientation::get("In palette");
+BlockOrientation* BlockOrientation::deserialize(QDataStream* stream) {
+  quint16 id;
+  *stream >> id;
+  if (id == kNamedOrientationId) {
+    char* name = NULL;
+    *stream >> name;
+    BlockOrientation* orientation = name ? get(name) : NULL;
+    delete[] name;
+    return orientation;
+  }
+  return id < kOrientationCount ? get(static_cast<Id>(id)) : NULL;
 }
 
 // Static.
 BlockOrientation* BlockOrientation::get(const char* name) {
+  setupOrientations();
   QString q_name(name);
   BlockOrientation* instance = s_known_orientations_.value(q_name);
   if (!instance) {
-    instance = new BlockOrientation(q_name);
-    s_known_orientations_.insert(name, instance);
+    instance = create(q_name);
   }
   return instance;
 }
 
-BlockOrientation::BlockOrientation(const QString& name) : name_(name) {}
+// Static.
+BlockOrientation* BlockOrientation::create(const QString& name) {
+  BlockOrientation* instance = new BlockOrientation(name, s_orientations_by_id_.size());
+  s_known_orientations_.insert(name, instance);
+  s_orientations_by_id_.append(instance);
+  return instance;
+}
+
+BlockOrientation::BlockOrientation(const QString& name, int id) : name_(name), id_(id) {}
+
+void BlockOrientation::serialize(QDataStream* stream) const {
+  if (id_ < kOrientationCount) {
+    *stream << static_cast<quint16>(id_);
+  } else {
+    *stream << kNamedOrientationId << name_.toUtf8().constData();
+  }
+}
@@ -17,22 +17,47 @@
 #define BLOCK_ORIENTATION_H
 
 #include <QtCore/QHash>
+#include <QtCore/QVector>
 
+#include "block_orientation_table.h"
+
+class QDataStream;
 class QString;
 
 /**
   * Represents a possible valid orientation of a block.
   *
   * BlockOrientations cannot be constructed directly.  Instead, they are initialized by means of the get() method,
-  * which takes a uniquely identifying string, or the noOrientation() method which returns a default instance.  This
-  * ensures that there will be exactly one BlockOrientation object per distinct string.
+  * which takes either an Id or a uniquely identifying string, or the noOrientation() method which returns a default
+  * instance.  This ensures that there will be exactly one BlockOrientation object per distinct string.
   *
   * BlockOrientations are similar to enum constants in that they are useful purely for comparison to other
   * BlockOrientations, but they are true objects instead of integers under the covers.  This allows a descriptive name
-  * to be associated with each instance that can be retrieved by calling the name() method.
+  * to be associated with each instance that can be retrieved by calling the name() method.  Each one also has a small
+  * integer id() which is cheap to compare and switch on, and which is what gets saved in diagram files.  Looking up an
+  * orientation by Id is an array access; looking it up by name involves a hash lookup, and should be kept out of hot
+  * paths.
   */
 class BlockOrientation {
  public:
+  /**
+    * The ids of the orientations in the orientation table (see block_orientation_table.h).  Orientations that are
+    * requested by a name not in the table are given ids starting at kOrientationCount.
+    */
+  enum Id {
+#define DECLARE_ORIENTATION_ID(identifier, name) kOrientation##identifier,
+    BLOCK_ORIENTATION_TABLE(DECLARE_ORIENTATION_ID)
+#undef DECLARE_ORIENTATION_ID
+    kOrientationCount
+  };
+
+  /**
+    * Creates the BlockOrientation objects for every orientation in the orientation table.  This is done automatically
+    * the first time an orientation is requested, but because it populates a static data structure, it is not
+    * thread-safe; call it at startup before any other threads might ask for orientations.
+    */
+  static void setupOrientations();
+
   /**
     * Returns a BlockOrientation object representing no orientation.  This is the default orientation for blocks like
     * dirt, stone, and gravel that look the same from every direction, and for blocks like grass and snow that cannot
@@ -40,7 +65,9 @@ class BlockOrientation {
     *
     * @note This function does \e not transfer ownership of the pointer to the caller, so you should \e not delete it!
     */
-  static BlockOrientation* noOrientation();
+  static inline BlockOrientation* noOrientation() {
+    return get(kOrientationNone);
+  }
 
   /**
     * Returns a BlockOrientation object representing the orientation a block should be in when it is viewed in the
@@ -49,7 +76,35 @@ class BlockOrientation {
     *
     * @note This function does \e not transfer ownership of the pointer to the caller, so you should \e not delete it!
     */
-  static BlockOrientation* paletteOrientation();
+  static inline BlockOrientation* paletteOrientation() {
+    return get(kOrientationInPalette);
+  }
+
+  /**
+    * Returns the BlockOrientation object for \p id.
+    *
+    * @note This function does \e not transfer ownership of the pointer to the caller, so you should \e not delete it!
+    */
+  static inline BlockOrientation* get(Id id) {
+    if (Q_UNLIKELY(s_orientations_by_id_.isEmpty())) {
+      setupOrientations();
+    }
+    return s_orientations_by_id_.at(id);
+  }
+
+  /**
+    * Returns the BlockOrientation object whose id() is \p id, or NULL if there is no such orientation.  Unlike
+    * get(Id), this accepts ids of orientations that are not in the orientation table, and out of range values.
+    * @note Only the ids in the orientation table are the same from one run to the next, so use serialize() and
+    * deserialize() rather than ids to save orientations.
+    */
+  static BlockOrientation* fromId(int id);
+
+  /**
+    * Reads an orientation written by serialize() from \p stream.  Returns NULL if the stream holds the id of an
+    * orientation that is not in the orientation table, since only those ids mean the same orientation in every run.
+    */
+  static BlockOrientation* deserialize(QDataStream* stream);
 
   /**
     * Returns a BlockOrientation object for the given string.  This is guaranteed to return the same pointer every time
@@ -67,6 +122,14 @@ class BlockOrientation {
     return (this == &other);
   }
 
+  /**
+    * Returns the id of this orientation.  For orientations in the orientation table, this is the corresponding value
+    * of Id.  Ids are dense, so they are suitable for use as array indices.
+    */
+  inline int id() const {
+    return id_;
+  }
+
   /**
     * Returns the name of this orientation, which is the same as the string used to obtain it.
     */
@@ -74,10 +137,24 @@ class BlockOrientation {
     return name_;
   }
 
+  /**
+    * Writes this orientation to \p stream as a 16-bit id if it is in the orientation table.  Other orientations are
+    * given ids in the order they are first asked for, so those are written by name instead.
+    */
+  void serialize(QDataStream* stream) const;
+
  private:
-  BlockOrientation(const QString& name);
+  BlockOrientation(const QString& name, int id);
+
+  /**
+    * Creates a new orientation called \p name with the next available id, and records it in the static tables.
+    */
+  static BlockOrientation* create(const QString& name);
+
   static QHash<QString, BlockOrientation*> s_known_orientations_;
+  static QVector<BlockOrientation*> s_orientations_by_id_;
   QString name_;
+  int id_;
   Q_DISABLE_COPY(BlockOrientation)
 };
 
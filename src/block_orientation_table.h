@@ -0,0 +1,78 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BLOCK_ORIENTATION_TABLE_H
+#define BLOCK_ORIENTATION_TABLE_H
+
+/**
+  * The table of every orientation known at compile time.  This header is shared between MCModeler and the
+  * MCModelerIniWriter tool, so that blocks.json and the application always agree on the names of orientations.
+  *
+  * To use the table, define a macro taking two arguments, an identifier and the orientation's name, and pass it to
+  * BLOCK_ORIENTATION_TABLE.  The macro will be expanded once for each orientation, in order.  For example:
+  *
+  * @code
+  * #define DECLARE_ORIENTATION_NAME(identifier, name) const char kOrientation##identifier[] = name;
+  * BLOCK_ORIENTATION_TABLE(DECLARE_ORIENTATION_NAME)
+  * #undef DECLARE_ORIENTATION_NAME
+  * @endcode
+  *
+  * The position of each entry in the table is the orientation's id (see BlockOrientation::id()), which is saved in
+  * diagram files.  New orientations must therefore only ever be added to the end of the table.
+  */
+#define BLOCK_ORIENTATION_TABLE(ENTRY) \
+  ENTRY(None, "") \
+  ENTRY(FacingSouth, "Facing south") \
+  ENTRY(FacingWest, "Facing west") \
+  ENTRY(FacingNorth, "Facing north") \
+  ENTRY(FacingEast, "Facing east") \
+  ENTRY(FacingSouthInverted, "Facing south, inverted") \
+  ENTRY(FacingWestInverted, "Facing west, inverted") \
+  ENTRY(FacingNorthInverted, "Facing north, inverted") \
+  ENTRY(FacingEastInverted, "Facing east, inverted") \
+  ENTRY(RunningNorthSouth, "Running north/south") \
+  ENTRY(RunningEastWest, "Running east/west") \
+  ENTRY(NorthwestCorner, "Northwest corner") \
+  ENTRY(SouthwestCorner, "Southwest corner") \
+  ENTRY(NortheastCorner, "Northeast corner") \
+  ENTRY(SoutheastCorner, "Southeast corner") \
+  ENTRY(AscendingSouth, "Ascending south") \
+  ENTRY(AscendingWest, "Ascending west") \
+  ENTRY(AscendingNorth, "Ascending north") \
+  ENTRY(AscendingEast, "Ascending east") \
+  ENTRY(NorthHalf, "North half") \
+  ENTRY(SouthHalf, "South half") \
+  ENTRY(EastHalf, "East half") \
+  ENTRY(WestHalf, "West half") \
+  ENTRY(TFacingSouth, "T facing south") \
+  ENTRY(TFacingWest, "T facing west") \
+  ENTRY(TFacingNorth, "T facing north") \
+  ENTRY(TFacingEast, "T facing east") \
+  ENTRY(Cross, "Cross") \
+  ENTRY(OnFloor, "On floor") \
+  ENTRY(OnNorthWall, "On north wall") \
+  ENTRY(OnEastWall, "On east wall") \
+  ENTRY(OnSouthWall, "On south wall") \
+  ENTRY(OnWestWall, "On west wall") \
+  ENTRY(OneBlockFromSource, "One block from source") \
+  ENTRY(TwoBlocksFromSource, "Two blocks from source") \
+  ENTRY(ThreeBlocksFromSource, "Three blocks from source") \
+  ENTRY(FourBlocksFromSource, "Four blocks from source") \
+  ENTRY(FiveBlocksFromSource, "Five blocks from source") \
+  ENTRY(SixBlocksFromSource, "Six blocks from source") \
+  ENTRY(SevenBlocksFromSource, "Seven blocks from source") \
+  ENTRY(InPalette, "In palette")
+
+#endif // BLOCK_ORIENTATION_TABLE_H
@@ -17,6 +17,7 @@
 
 #include "block_picker_item_delegate.h"
 #include "block_prototype.h"
+#include "sprite_engine.h"
 
 BlockPicker::BlockPicker(QWidget* parent)
     : QWidget(parent) {
@@ -85,6 +86,11 @@ void BlockPicker::selectBlockForItem(QListWidgetItem* item) {
 }
 
 void BlockPicker::addBlock(BlockPrototype* block) {
+  // Blocks whose sprite is in the atlas are drawn straight from it by the item delegate, rather than from an icon.
+  SpriteEngine* sprite_engine = block->spriteEngine();
+  QRect sprite_rect = sprite_engine->spriteRect(sprite_engine->blockId(block->type()),
+                                                BlockOrientation::paletteOrientation()->id());
+  item_delegate_->setSpriteEngine(sprite_engine);
   foreach (const QString& raw_category, QStringList() << "All blocks" << block->categories()) {
     QString category = raw_category;
     category[0] = category[0].toUpper();
@@ -101,8 +107,12 @@ void BlockPicker::addBlock(BlockPrototype* block) {
                  << "-- this tab wasn't a QListWidget, it was a" << tab->metaObject()->className();
       continue;
     }
-    QListWidgetItem* item = new QListWidgetItem(
-          iconForSprite(block->sprite(BlockOrientation::paletteOrientation())), QString());
+    QListWidgetItem* item = new QListWidgetItem();
+    if (sprite_rect.isNull()) {
+      item->setIcon(iconForSprite(block->sprite(BlockOrientation::paletteOrientation())));
+    } else {
+      item->setData(BlockPickerItemDelegate::kSpriteRectRole, sprite_rect);
+    }
     item->setSizeHint(QSize(24, 24));
     item->setData(Qt::UserRole, block->type());
     item->setToolTip(block->name());
@@ -19,13 +19,39 @@
 
 #include <QPainter>
 
-BlockPickerItemDelegate::BlockPickerItemDelegate(QObject* parent) : QItemDelegate(parent) {
+#include "sprite_engine.h"
+
+BlockPickerItemDelegate::BlockPickerItemDelegate(QObject* parent) : QItemDelegate(parent), sprite_engine_(NULL) {
+}
+
+void BlockPickerItemDelegate::paint(QPainter* painter,
+                                    const QStyleOptionViewItem& option,
+                                    const QModelIndex& index) const {
+  QRect source_rect = index.data(kSpriteRectRole).toRect();
+  if (!sprite_engine_ || source_rect.isNull()) {
+    QItemDelegate::paint(painter, option, index);
+    return;
+  }
+  painter->save();
+  QRect rect = QStyle::alignedRect(option.direction, Qt::AlignCenter, source_rect.size(), option.rect);
+  drawSelectionHighlight(painter, option, rect);
+  painter->drawPixmap(rect.translated(0, 2), sprite_engine_->atlas(), source_rect);
+  drawFocus(painter, option, option.rect);
+  painter->restore();
 }
 
 void BlockPickerItemDelegate::drawDecoration(QPainter* painter,
                                              const QStyleOptionViewItem& option,
                                              const QRect& rect,
                                              const QPixmap& pixmap) const {
+  drawSelectionHighlight(painter, option, rect);
+  QRect offset_rect = rect.translated(0, 2);
+  QItemDelegate::drawDecoration(painter, option, offset_rect, pixmap);
+}
+
+void BlockPickerItemDelegate::drawSelectionHighlight(QPainter* painter,
+                                                     const QStyleOptionViewItem& option,
+                                                     const QRect& rect) const {
   if (option.state & QStyle::State_Selected) {
     painter->setRenderHint(QPainter::Antialiasing, true);
     QLinearGradient gradient(rect.topLeft(), rect.bottomLeft());
@@ -38,6 +64,4 @@ void BlockPickerItemDelegate::drawDecoration(QPainter* painter,
     rect.adjust(0.5, 0.5, -0.5, -0.5);
     painter->drawRoundedRect(rect, 1, 1);
   }
-  QRect offset_rect = rect.translated(0, 2);
-  QItemDelegate::drawDecoration(painter, option, offset_rect, pixmap);
 }
@@ -18,14 +18,35 @@
 
 #include <QItemDelegate>
 
+class SpriteEngine;
+
 /**
   * QItemDelegate subclass used to customize the display of items in the BlockPicker.
   */
 class BlockPickerItemDelegate : public QItemDelegate {
   Q_OBJECT
  public:
+  /**
+    * The item data role holding the QRect of an item's sprite within the sprite atlas.  Items with this role are drawn
+    * straight from the atlas; items without it are drawn from their icon as usual.
+    */
+  static const int kSpriteRectRole = Qt::UserRole + 1;
+
   explicit BlockPickerItemDelegate(QObject* parent = NULL);
 
+  /**
+    * Sets the SpriteEngine whose atlas the sprites given by kSpriteRectRole are drawn from.
+    */
+  void setSpriteEngine(SpriteEngine* sprite_engine) {
+    sprite_engine_ = sprite_engine;
+  }
+
+  /**
+    * @copydoc
+    * This is overridden here to draw items with a kSpriteRectRole from the sprite atlas.
+    */
+  void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const;
+
  protected:
   /**
     * @copydoc
@@ -33,6 +54,15 @@ class BlockPickerItemDelegate : public QItemDelegate {
     */
   void drawDecoration(QPainter* painter, const QStyleOptionViewItem& option,
                       const QRect& rect, const QPixmap& pixmap) const;
+
+ private:
+  /**
+    * Draws the custom selection highlight behind the item described by \p option, if it is selected, shaded to
+    * match its sprite at \p rect.
+    */
+  void drawSelectionHighlight(QPainter* painter, const QStyleOptionViewItem& option, const QRect& rect) const;
+
+  SpriteEngine* sprite_engine_;
 };
 
 #endif // BLOCK_PICKER_ITEM_DELEGATE_H
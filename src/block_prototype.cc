@@ -39,6 +39,7 @@
 #include "rectangular_prism_renderable.h"
 #include "renderable.h"
 #include "stairs_renderable.h"
+#include "sprite_engine.h"
 #include "texture.h"
 #include "texture_pack.h"
 #include "torch_renderable.h"
@@ -110,6 +111,11 @@ QString BlockPrototype::nameOfType(blocktype_t type) {
   }
 }
 
+// static
+bool BlockPrototype::isKnownType(blocktype_t type) {
+  return s_type_mapping && s_type_mapping->contains(type);
+}
+
 // static
 BlockTypeIterator BlockPrototype::blockIterator() {
   return BlockTypeIterator(s_type_mapping->keys());
@@ -119,14 +125,16 @@ const BlockProperties& BlockPrototype::properties() const {
   return properties_;
 }
 
-BlockPrototype::BlockPrototype(blocktype_t type, TexturePack* texture_pack, BlockOracle* oracle, QGLWidget* widget)
-    : type_(type), oracle_(oracle) {
+BlockPrototype::BlockPrototype(blocktype_t type, TexturePack* texture_pack, BlockOracle* oracle, QGLWidget* widget,
+                               SpriteEngine* sprite_engine)
+    : type_(type), oracle_(oracle), sprite_engine_(sprite_engine) {
   if (!s_type_mapping) {
     qWarning() << "You forgot to call setupBlockProperties!";
     s_type_mapping = new QMap<blocktype_t, BlockProperties>();
   }
 
   properties_ = s_type_mapping->value(type_);
+  setupTransformedOrientations();
   switch (properties_.geometry()) {
     case BlockGeometry::kGeometryCube:
       renderable_.reset(new RectangularPrismRenderable(QVector3D(1.0f, 1.0f, 1.0f)));
@@ -215,11 +223,11 @@ BlockPrototype::BlockPrototype(blocktype_t type, TexturePack* texture_pack, Bloc
   } else {
     sprite_texture_ = Texture(widget, terrain_png, sprite_offset.x(), sprite_offset.y(), 16, 16);
   }
-  sprite_engine_.reset(new SpriteEngine());
+  sprite_engine_->addBlock(type_, sprite_texture_, properties_);
 }
 
 QPixmap BlockPrototype::sprite(const BlockOrientation* orientation) const {
-  return sprite_engine_->createSprite(sprite_texture_, properties_, orientation);
+  return sprite_engine_->createSprite(type_, orientation);
 }
 
 const BlockOrientation* BlockPrototype::defaultOrientation() const {
@@ -238,6 +246,38 @@ QVector<const BlockOrientation*> BlockPrototype::orientations() const {
   return orientations;
 }
 
+const BlockOrientation* BlockPrototype::transformedOrientation(const BlockOrientation* orientation,
+                                                               BlockTransform::Kind kind) const {
+  const QVector<const BlockOrientation*>& table = transformed_orientations_[kind];
+  if (!orientation || orientation->id() < 0 || orientation->id() >= table.size()) {
+    return orientation;
+  }
+  return table.at(orientation->id());
+}
+
+void BlockPrototype::setupTransformedOrientations() {
+  QVector<const BlockOrientation*> valid_orientations = properties_.validOrientations();
+  int table_size = 0;
+  foreach (const BlockOrientation* orientation, valid_orientations) {
+    table_size = qMax(table_size, orientation->id() + 1);
+  }
+  for (int kind = 0; kind < BlockTransform::kKindCount; ++kind) {
+    QVector<const BlockOrientation*>& table = transformed_orientations_[kind];
+    table.resize(table_size);
+    for (int id = 0; id < table_size; ++id) {
+      table[id] = BlockOrientation::fromId(id);
+    }
+    foreach (const BlockOrientation* orientation, valid_orientations) {
+      const BlockOrientation* image =
+          BlockOrientation::fromId(BlockTransform::transformedOrientationId(orientation->id(),
+                                                                          static_cast<BlockTransform::Kind>(kind)));
+      if (image && valid_orientations.contains(image)) {
+        table[orientation->id()] = image;
+      }
+    }
+  }
+}
+
 void BlockPrototype::renderInstance(const BlockInstance& instance) const {
   if (oracle_ && oracle_->levelsAreVertical()) {
     BlockPosition pos(instance.position().x(), -instance.position().z(), -instance.position().y());
@@ -247,28 +287,45 @@ void BlockPrototype::renderInstance(const BlockInstance& instance) const {
   }
 }
 
+void BlockPrototype::addToMesh(const BlockPosition& position, const BlockOrientation* orientation,
+                               MeshBuilder* mesh) const {
+  renderable_->addToMesh(position.centerVector(), orientation, mesh);
+}
+
 // TODO(phoenix): This doesn't look like it belongs here.  Shouldn't the Renderable be responsible for this?
 bool BlockPrototype::shouldRenderFace(const Renderable* renderable, Face face, const QVector3D& location) const {
   Q_UNUSED(renderable);
 
-  BlockGeometry::Geometry geometry = properties().geometry();
-  if (geometry != BlockGeometry::kGeometryCube && geometry != BlockGeometry::kGeometrySlab) {
-    return true;
-  }
-
   if (oracle_ && oracle_->levelsAreVertical()) {
     // We don't yet support face culling for vertical orientation.
     // TODO(phoenix): Figure out what changes are necessary to get this working.
     return true;
   }
+  return isFaceExposed(face, location, true);
+}
+
+bool BlockPrototype::shouldExportFace(const Renderable* renderable, Face face, const QVector3D& location) const {
+  Q_UNUSED(renderable);
+
+  // Exported blocks are always at their world positions, so the orientation of the levels doesn't matter here.
+  return isFaceExposed(face, location, false);
+}
+
+bool BlockPrototype::isFaceExposed(Face face, const QVector3D& location, bool include_ephemeral) const {
+  BlockGeometry::Geometry geometry = properties().geometry();
+  if (geometry != BlockGeometry::kGeometryCube && geometry != BlockGeometry::kGeometrySlab) {
+    return true;
+  }
 
-  BlockPrototype* other = neighboringBlockForFace(face, location);
-  return (other->type() == kBlockTypeAir ||
+  BlockPrototype* other = neighboringBlockForFace(face, location, include_ephemeral);
+  return (!other ||
+          other->type() == kBlockTypeAir ||
           other->properties().geometry() != BlockGeometry::kGeometryCube ||
           (other->properties().isTransparent() && other->type() != type()));
 }
 
-BlockPrototype* BlockPrototype::neighboringBlockForFace(Face face, const QVector3D& location) const {
+BlockPrototype* BlockPrototype::neighboringBlockForFace(Face face, const QVector3D& location,
+                                                        bool include_ephemeral) const {
   static QVector3D front = QVector3D(0, 0, 1);
   static QVector3D back = QVector3D(0, 0, -1);
   static QVector3D left = QVector3D(-1, 0, 0);
@@ -280,23 +337,23 @@ BlockPrototype* BlockPrototype::neighboringBlockForFace(Face face, const QVector
     return NULL;
   }
 
+  QVector3D offset;
   if (face == kFrontFace) {
-    return oracle_->blockAt(BlockPosition(location + front), BlockOracle::kPhysicalOrEphemeralBlocks).prototype();
-  }
-  if (face == kBackFace) {
-    return oracle_->blockAt(BlockPosition(location + back), BlockOracle::kPhysicalOrEphemeralBlocks).prototype();
-  }
-  if (face == kLeftFace) {
-    return oracle_->blockAt(BlockPosition(location + left), BlockOracle::kPhysicalOrEphemeralBlocks).prototype();
-  }
-  if (face == kRightFace) {
-    return oracle_->blockAt(BlockPosition(location + right), BlockOracle::kPhysicalOrEphemeralBlocks).prototype();
-  }
-  if (face == kTopFace) {
-    return oracle_->blockAt(BlockPosition(location + top), BlockOracle::kPhysicalOrEphemeralBlocks).prototype();
-  }
-  if (face == kBottomFace) {
-    return oracle_->blockAt(BlockPosition(location + bottom), BlockOracle::kPhysicalOrEphemeralBlocks).prototype();
+    offset = front;
+  } else if (face == kBackFace) {
+    offset = back;
+  } else if (face == kLeftFace) {
+    offset = left;
+  } else if (face == kRightFace) {
+    offset = right;
+  } else if (face == kTopFace) {
+    offset = top;
+  } else if (face == kBottomFace) {
+    offset = bottom;
+  } else {
+    return NULL;
   }
-  return NULL;
+  BlockOracle::Mode mode =
+      include_ephemeral ? BlockOracle::kPhysicalOrEphemeralBlocks : BlockOracle::kPhysicalBlocksOnly;
+  return oracle_->blockAt(BlockPosition(location + offset), mode).prototype();
 }
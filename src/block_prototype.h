@@ -17,15 +17,17 @@
 #define BLOCK_PROTOTYPE_H
 
 #include "block_properties.h"
+#include "block_transform.h"
 #include "block_type.h"
 #include "renderable.h"
 #include "render_delegate.h"
-#include "sprite_engine.h"
 #include "texture.h"
 
 class BlockInstance;
 class BlockOracle;
 class BlockPosition;
+class MeshBuilder;
+class SpriteEngine;
 class TexturePack;
 class QGLWidget;
 
@@ -51,6 +53,11 @@ class BlockPrototype : public RenderDelegate {
     */
   static QString nameOfType(blocktype_t type);
 
+  /**
+    * Returns whether \p type is one of the block types loaded by setupBlockProperties().
+    */
+  static bool isKnownType(blocktype_t type);
+
   /**
     * Returns a non-mutable iterator over all known block types.
     * @todo This should move to BlockManager and stop being static.
@@ -67,16 +74,27 @@ class BlockPrototype : public RenderDelegate {
     * @param texture_pack The TexturePack that will be used to create textures for the block.
     * @param oracle The BlockOracle the prototype will use to determine neighboring face information.
     * @param widget The QGLWidget into which blocks of this type will be rendered.
+    * @param sprite_engine The SpriteEngine that will create sprites for the block.
     */
-  explicit BlockPrototype(blocktype_t type, TexturePack* texture_pack, BlockOracle* oracle, QGLWidget* widget);
+  explicit BlockPrototype(blocktype_t type, TexturePack* texture_pack, BlockOracle* oracle, QGLWidget* widget,
+                          SpriteEngine* sprite_engine);
 
   virtual bool shouldRenderFace(const Renderable* renderable, Face face, const QVector3D& location) const;
+  virtual bool shouldExportFace(const Renderable* renderable, Face face, const QVector3D& location) const;
 
   /**
     * Returns the sprite pixmap that should be used to represent this kind of block in a 2D context.
     */
   QPixmap sprite(const BlockOrientation* orientation = BlockOrientation::noOrientation()) const;
 
+  /**
+    * Returns the SpriteEngine that creates the sprites for this block, for widgets that draw many sprites straight
+    * from its atlas.
+    */
+  SpriteEngine* spriteEngine() const {
+    return sprite_engine_;
+  }
+
   /**
     * Returns the name of this block.  For example, "Netherrack" or "Diamond ore".
     */
@@ -111,6 +129,16 @@ class BlockPrototype : public RenderDelegate {
     */
   virtual QVector<const BlockOrientation*> orientations() const;
 
+  /**
+    * Returns the orientation a block of this type with orientation \p orientation should have after being transformed
+    * by \p kind.  If the transformed orientation is not one this block can have (a block with only two orientations
+    * can't face every direction, for instance), \p orientation is returned unchanged.  This is a table lookup; the
+    * tables are built once when the prototype is constructed.
+    * @sa BlockTransform::transformedOrientationId()
+    */
+  const BlockOrientation* transformedOrientation(const BlockOrientation* orientation,
+                                                 BlockTransform::Kind kind) const;
+
   /**
     * Returns whether this block is "transparent" in the Minecraft sense.  Transparent blocks may or may not be
     * visibly translucent, but they permit the passage of light, do not hide blocks behind them, and will not suffocate
@@ -121,6 +149,14 @@ class BlockPrototype : public RenderDelegate {
     return properties().isTransparent();
   }
 
+  /**
+    * Returns whether blocks of this type fill their whole cell and are not transparent, like stone or wool, so that
+    * they look like their sprite from every side.
+    */
+  bool isOpaqueCube() const {
+    return properties().geometry() == BlockGeometry::kGeometryCube && !properties().isTransparent();
+  }
+
   /**
     * Renders an instance of this block into the render destination with which the prototype was constructed.  The
     * position and orientation for the block are read from the instance. This should only be called from within a
@@ -130,6 +166,13 @@ class BlockPrototype : public RenderDelegate {
     */
   void renderInstance(const BlockInstance& instance) const;
 
+  /**
+    * Adds the geometry of a block of this type at \p position with \p orientation to \p mesh, culled the same way
+    * renderInstance() culls it.  Unlike renderInstance(), this needs no OpenGL context, and the block is always placed
+    * at its true position, even if levels are vertical.
+    */
+  void addToMesh(const BlockPosition& position, const BlockOrientation* orientation, MeshBuilder* mesh) const;
+
  private:
   /**
     * The mapping from blocktype_t enum constants to BlockProperties objects.  This must be a pointer to avoid creating
@@ -137,12 +180,19 @@ class BlockPrototype : public RenderDelegate {
     */
   static QMap<blocktype_t, BlockProperties>* s_type_mapping;
 
+  /**
+    * Returns whether the \p face Face of a block of this type located at \p location can be seen past the block next
+    * to it.  If \p include_ephemeral is true, ephemeral blocks count as neighbors; otherwise only physical blocks do.
+    */
+  bool isFaceExposed(Face face, const QVector3D& location, bool include_ephemeral) const;
+
   /**
     * Returns the prototype of the block that would be adjacent to the \p face Face of a block of this type that is
-    * located at \p location.
+    * located at \p location.  If \p include_ephemeral is true, an ephemeral block there is returned in place of the
+    * physical one.
     * @return The prototype of the adjacent block, or \c NULL if no block is adjacent to that face.
     */
-  BlockPrototype* neighboringBlockForFace(Face face, const QVector3D& location) const;
+  BlockPrototype* neighboringBlockForFace(Face face, const QVector3D& location, bool include_ephemeral) const;
 
   /**
     * Returns the BlockProperties object for this prototype.  This is private because much of the information is only
@@ -150,12 +200,23 @@ class BlockPrototype : public RenderDelegate {
     */
   const BlockProperties& properties() const;
 
+  /**
+    * Fills in transformed_orientations_ from the valid orientations in properties_.
+    */
+  void setupTransformedOrientations();
+
+  /**
+    * For each kind of BlockTransform, what each orientation turns into, indexed by orientation id.  Only ids up to
+    * the largest valid orientation of this block are present; anything beyond that is left alone by transforms.
+    */
+  QVector<const BlockOrientation*> transformed_orientations_[BlockTransform::kKindCount];
+
   Texture sprite_texture_;
   BlockProperties properties_;
   blocktype_t type_;
   BlockOracle* oracle_;
   QScopedPointer<Renderable> renderable_;
-  QScopedPointer<SpriteEngine> sprite_engine_;
+  SpriteEngine* sprite_engine_;
 };
 
 #endif // BLOCK_PROTOTYPE_H
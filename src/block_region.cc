@@ -0,0 +1,106 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "block_region.h"
+
+BlockRegion::BlockRegion() : kind_(kEverything) {
+}
+
+BlockRegion BlockRegion::everything() {
+  return BlockRegion();
+}
+
+BlockRegion BlockRegion::levels(int min_level, int max_level) {
+  BlockRegion region;
+  region.kind_ = kLevelRange;
+  region.min_ = BlockPosition(0, qMin(min_level, max_level), 0);
+  region.max_ = BlockPosition(0, qMax(min_level, max_level), 0);
+  return region;
+}
+
+BlockRegion BlockRegion::box(const BlockPosition& corner, const BlockPosition& opposite_corner) {
+  BlockRegion region;
+  region.kind_ = kBox;
+  region.min_ = BlockPosition(qMin(corner.x(), opposite_corner.x()),
+                              qMin(corner.y(), opposite_corner.y()),
+                              qMin(corner.z(), opposite_corner.z()));
+  region.max_ = BlockPosition(qMax(corner.x(), opposite_corner.x()),
+                              qMax(corner.y(), opposite_corner.y()),
+                              qMax(corner.z(), opposite_corner.z()));
+  return region;
+}
+
+BlockRegion BlockRegion::chunks(const QSet<ChunkPosition>& chunks) {
+  BlockRegion region;
+  region.kind_ = kChunkSet;
+  region.chunks_ = chunks;
+  return region;
+}
+
+bool BlockRegion::contains(const BlockPosition& position) const {
+  switch (kind_) {
+    case kEverything:
+      return true;
+    case kLevelRange:
+      return position.y() >= min_.y() && position.y() <= max_.y();
+    case kBox:
+      return position.x() >= min_.x() && position.x() <= max_.x() &&
+             position.y() >= min_.y() && position.y() <= max_.y() &&
+             position.z() >= min_.z() && position.z() <= max_.z();
+    case kChunkSet:
+      return chunks_.contains(ChunkPosition::containing(position));
+  }
+  return false;
+}
+
+bool BlockRegion::intersectsChunk(const ChunkPosition& chunk) const {
+  BlockPosition chunk_min = chunk.minimumBlock();
+  BlockPosition chunk_max = chunk.maximumBlock();
+  switch (kind_) {
+    case kEverything:
+      return true;
+    case kLevelRange:
+      return chunk_max.y() >= min_.y() && chunk_min.y() <= max_.y();
+    case kBox:
+      return chunk_max.x() >= min_.x() && chunk_min.x() <= max_.x() &&
+             chunk_max.y() >= min_.y() && chunk_min.y() <= max_.y() &&
+             chunk_max.z() >= min_.z() && chunk_min.z() <= max_.z();
+    case kChunkSet:
+      return chunks_.contains(chunk);
+  }
+  return false;
+}
+
+bool BlockRegion::containsChunk(const ChunkPosition& chunk) const {
+  BlockPosition chunk_min = chunk.minimumBlock();
+  BlockPosition chunk_max = chunk.maximumBlock();
+  switch (kind_) {
+    case kEverything:
+      return true;
+    case kLevelRange:
+      return chunk_min.y() >= min_.y() && chunk_max.y() <= max_.y();
+    case kBox:
+      return chunk_min.x() >= min_.x() && chunk_max.x() <= max_.x() &&
+             chunk_min.y() >= min_.y() && chunk_max.y() <= max_.y() &&
+             chunk_min.z() >= min_.z() && chunk_max.z() <= max_.z();
+    case kChunkSet:
+      return chunks_.contains(chunk);
+  }
+  return false;
+}
+
+bool BlockRegion::operator==(const BlockRegion& other) const {
+  return kind_ == other.kind_ && min_ == other.min_ && max_ == other.max_ && chunks_ == other.chunks_;
+}
@@ -0,0 +1,114 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BLOCK_REGION_H
+#define BLOCK_REGION_H
+
+#include <QSet>
+
+#include "block_position.h"
+#include "chunk_position.h"
+
+/**
+  * Describes a region of the world that a view is interested in.
+  *
+  * A region may be the whole world, a range of levels, an axis-aligned box of blocks, or an arbitrary set of chunks.
+  * Regions are cheap to copy and are typically passed to Diagram::subscribe() to receive only the part of each
+  * BlockTransaction that falls inside them.
+  *
+  * Every query can be answered at chunk granularity first (intersectsChunk() and containsChunk()), so callers can
+  * skip or accept whole chunks of blocks without ever looking at the blocks themselves, and only fall back to
+  * contains() for chunks that straddle the region's boundary.
+  *
+  * @note A "level" is currently defined to be the set of blocks sharing a particular _y_ coordinate, to match
+  *       Diagram::level().
+  */
+class BlockRegion {
+ public:
+  enum Kind {
+    kEverything,
+    kLevelRange,
+    kBox,
+    kChunkSet
+  };
+
+  /**
+    * Constructs a region containing the whole world.
+    */
+  BlockRegion();
+
+  /**
+    * Returns a region containing the whole world.
+    */
+  static BlockRegion everything();
+
+  /**
+    * Returns a region containing every block whose level is between \p min_level and \p max_level, inclusive.
+    */
+  static BlockRegion levels(int min_level, int max_level);
+
+  /**
+    * Returns a region containing every block inside the box with opposite corners \p corner and \p opposite_corner,
+    * inclusive.  The corners may be given in any order.
+    */
+  static BlockRegion box(const BlockPosition& corner, const BlockPosition& opposite_corner);
+
+  /**
+    * Returns a region containing every block in each of the chunks in \p chunks.
+    */
+  static BlockRegion chunks(const QSet<ChunkPosition>& chunks);
+
+  /**
+    * Returns the kind of region this is.
+    */
+  Kind kind() const {
+    return kind_;
+  }
+
+  /**
+    * Returns whether this region contains the whole world.  Callers can use this to avoid filtering altogether.
+    */
+  bool isEverything() const {
+    return kind_ == kEverything;
+  }
+
+  /**
+    * Returns whether the block at \p position lies inside this region.
+    */
+  bool contains(const BlockPosition& position) const;
+
+  /**
+    * Returns whether any block in the chunk at \p chunk lies inside this region.  If this returns false, none of the
+    * blocks in the chunk need to be considered.
+    */
+  bool intersectsChunk(const ChunkPosition& chunk) const;
+
+  /**
+    * Returns whether every block in the chunk at \p chunk lies inside this region.  If this returns true, all of the
+    * blocks in the chunk can be accepted without calling contains() on each of them.
+    */
+  bool containsChunk(const ChunkPosition& chunk) const;
+
+  /** Equality operator. */
+  bool operator==(const BlockRegion& other) const;
+
+ private:
+  Kind kind_;
+  BlockPosition min_;
+  BlockPosition max_;
+  QSet<ChunkPosition> chunks_;
+};
+
+#endif // BLOCK_REGION_H
@@ -0,0 +1,44 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "block_replacement.h"
+
+#include "block_prototype.h"
+
+BlockReplacement::BlockReplacement(BlockPrototype* find_prototype, BlockPrototype* replacement_prototype)
+    : find_prototype_(find_prototype),
+      replacement_prototype_(replacement_prototype),
+      find_orientation_(NULL) {
+  Q_ASSERT(find_prototype && find_prototype->type() != kBlockTypeAir);
+  if (replacement_prototype_ && replacement_prototype_->type() == kBlockTypeAir) {
+    replacement_prototype_ = NULL;
+  }
+  if (replacement_prototype_) {
+    replacement_orientations_ = replacement_prototype_->orientations();
+  }
+}
+
+const BlockOrientation* BlockReplacement::replacementOrientation(const BlockOrientation* orientation) const {
+  if (!replacement_prototype_) {
+    return NULL;
+  }
+  if (orientation_map_.contains(orientation)) {
+    return orientation_map_.value(orientation);
+  }
+  if (replacement_orientations_.contains(orientation)) {
+    return orientation;
+  }
+  return replacement_orientations_.first();
+}
@@ -0,0 +1,122 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BLOCK_REPLACEMENT_H
+#define BLOCK_REPLACEMENT_H
+
+#include <QHash>
+#include <QVector>
+
+#include "block_region.h"
+
+class BlockOrientation;
+class BlockPrototype;
+
+/**
+  * Describes a find-and-replace operation on the blocks of a Diagram: which blocks to look for, and what to put in
+  * their place.  Pass one to Diagram::findAndReplace() to carry it out.
+  *
+  * Blocks match if they have the prototype findPrototype() and, if a find orientation has been set, that orientation
+  * too.  Only blocks inside region() are considered, which is the whole world unless setRegion() is called.  Each
+  * matching block is replaced by a block of type replacementPrototype(), whose orientation is given by
+  * replacementOrientation().
+  */
+class BlockReplacement {
+ public:
+  /**
+    * Constructs a replacement of every block with prototype \p find_prototype, in any orientation and anywhere in the
+    * world, with a block with prototype \p replacement_prototype.  If \p replacement_prototype is NULL or air, the
+    * blocks are removed instead.
+    */
+  BlockReplacement(BlockPrototype* find_prototype, BlockPrototype* replacement_prototype);
+
+  /**
+    * Returns the prototype of the blocks to look for.
+    */
+  BlockPrototype* findPrototype() const {
+    return find_prototype_;
+  }
+
+  /**
+    * Returns the prototype of the blocks to put in their place, or NULL if they are to be removed.
+    */
+  BlockPrototype* replacementPrototype() const {
+    return replacement_prototype_;
+  }
+
+  /**
+    * Restricts the blocks to look for to those with orientation \p orientation, or lifts the restriction if
+    * \p orientation is NULL.
+    */
+  void setFindOrientation(const BlockOrientation* orientation) {
+    find_orientation_ = orientation;
+  }
+
+  /**
+    * Returns the orientation of the blocks to look for, or NULL if any orientation will do.
+    */
+  const BlockOrientation* findOrientation() const {
+    return find_orientation_;
+  }
+
+  /**
+    * Makes matching blocks with orientation \p from be replaced by blocks with orientation \p to.
+    */
+  void mapOrientation(const BlockOrientation* from, const BlockOrientation* to) {
+    orientation_map_.insert(from, to);
+  }
+
+  /**
+    * Restricts the blocks to look for to those inside \p region.
+    */
+  void setRegion(const BlockRegion& region) {
+    region_ = region;
+  }
+
+  /**
+    * Returns the region in which to look for blocks.
+    */
+  const BlockRegion& region() const {
+    return region_;
+  }
+
+  /**
+    * Returns whether a block with prototype \p prototype and orientation \p orientation is one to be replaced,
+    * regardless of where it is.
+    */
+  bool matches(BlockPrototype* prototype, const BlockOrientation* orientation) const {
+    return prototype == find_prototype_ && (!find_orientation_ || orientation == find_orientation_);
+  }
+
+  /**
+    * Returns the orientation the replacement for a matching block with orientation \p orientation should have.  This
+    * is the orientation \p orientation was mapped to by mapOrientation(), if any.  Otherwise it is \p orientation
+    * itself if the replacement prototype can have it, or the replacement prototype's default orientation if not.
+    */
+  const BlockOrientation* replacementOrientation(const BlockOrientation* orientation) const;
+
+ private:
+  BlockPrototype* find_prototype_;
+  BlockPrototype* replacement_prototype_;
+  const BlockOrientation* find_orientation_;
+  QHash<const BlockOrientation*, const BlockOrientation*> orientation_map_;
+
+  /// The orientations replacement_prototype_ can have, the default one first.
+  QVector<const BlockOrientation*> replacement_orientations_;
+
+  BlockRegion region_;
+};
+
+#endif // BLOCK_REPLACEMENT_H
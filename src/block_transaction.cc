@@ -15,17 +15,87 @@
 
 #include "block_transaction.h"
 
+#include <QHash>
+
 #include "block_instance.h"
 #include "block_position.h"
 
-BlockTransaction::BlockTransaction() {
+/**
+  * A map from position to block, used to compare transactions.
+  */
+typedef QHash<BlockPosition, const BlockInstance*> BlockMap;
+
+/**
+  * Returns whether \p a and \p b, either of which may be NULL to stand for no block, are the same block.
+  */
+static bool isSameBlock(const BlockInstance* a, const BlockInstance* b) {
+  if (!a || !b) {
+    return a == b;
+  }
+  return a->prototype() == b->prototype() && a->orientation() == b->orientation();
+}
+
+/**
+  * Returns a map from position to block for \p blocks.  The map points into \p blocks, so it must not outlive it.
+  */
+static BlockMap blocksByPosition(const QList<BlockInstance>& blocks) {
+  BlockMap map;
+  map.reserve(blocks.size());
+  foreach (const BlockInstance& block, blocks) {
+    map.insert(block.position(), &block);
+  }
+  return map;
+}
+
+/**
+  * Folds one side of a later ephemeral patch, the blocks \p later_retracted_blocks it takes back and the blocks
+  * \p later_added_blocks it then puts in their place, into the same side of an earlier patch.  \p retracted and
+  * \p added hold the blocks the earlier patch takes back and puts in place, by position, and are updated to hold those
+  * of the merged patch.
+  */
+static void mergePatchBlocks(const QList<BlockInstance>& later_retracted_blocks,
+                             const QList<BlockInstance>& later_added_blocks,
+                             QHash<BlockPosition, BlockInstance>* retracted,
+                             QHash<BlockPosition, BlockInstance>* added) {
+  foreach (const BlockInstance& block, later_retracted_blocks) {
+    // Taking back a block the earlier patch put in place leaves whatever the earlier patch took back, if anything.
+    if (!added->remove(block.position()) && !retracted->contains(block.position())) {
+      retracted->insert(block.position(), block);
+    }
+  }
+  foreach (const BlockInstance& block, later_added_blocks) {
+    QHash<BlockPosition, BlockInstance>::iterator earlier = retracted->find(block.position());
+    if (earlier != retracted->end() && isSameBlock(&earlier.value(), &block)) {
+      // Taken back and then put back as it was, so the merged patch needn't touch it at all.
+      retracted->erase(earlier);
+    } else {
+      added->insert(block.position(), block);
+    }
+  }
+}
+
+/**
+  * Returns a map from position to a copy of the block there for \p blocks.
+  */
+static QHash<BlockPosition, BlockInstance> copiesByPosition(const QList<BlockInstance>& blocks) {
+  QHash<BlockPosition, BlockInstance> map;
+  map.reserve(blocks.size());
+  foreach (const BlockInstance& block, blocks) {
+    map.insert(block.position(), block);
+  }
+  return map;
+}
+
+BlockTransaction::BlockTransaction() : is_indexed_(true) {
 }
 
 BlockTransaction::BlockTransaction(const BlockTransaction& other)
     : old_positions_(other.old_positions_),
       new_positions_(other.new_positions_),
+      is_indexed_(other.is_indexed_),
       old_blocks_(other.old_blocks_),
-      new_blocks_(other.new_blocks_) {
+      new_blocks_(other.new_blocks_),
+      shared_layers_(other.shared_layers_) {
 }
 
 BlockTransaction& BlockTransaction::operator=(const BlockTransaction& other) {
@@ -33,6 +103,8 @@ BlockTransaction& BlockTransaction::operator=(const BlockTransaction& other) {
   old_blocks_ = other.old_blocks_;
   new_positions_ = other.new_positions_;
   new_blocks_ = other.new_blocks_;
+  is_indexed_ = other.is_indexed_;
+  shared_layers_ = other.shared_layers_;
   return *this;
 }
 
@@ -42,10 +114,28 @@ BlockTransaction BlockTransaction::reversed() const {
   reversed.old_positions_ = new_positions_;
   reversed.new_blocks_ = old_blocks_;
   reversed.new_positions_ = old_positions_;
+  reversed.is_indexed_ = is_indexed_;
   return reversed;
 }
 
+void BlockTransaction::index() const {
+  if (is_indexed_) {
+    return;
+  }
+  old_positions_.reserve(old_blocks_.size());
+  foreach (const BlockInstance& old_block, old_blocks_) {
+    old_positions_.insert(old_block.position());
+  }
+  new_positions_.reserve(new_blocks_.size());
+  foreach (const BlockInstance& new_block, new_blocks_) {
+    new_positions_.insert(new_block.position());
+  }
+  is_indexed_ = true;
+}
+
 void BlockTransaction::setBlock(const BlockInstance& new_block) {
+  index();
+  shared_layers_.clear();
   if (new_block.prototype()->type() != kBlockTypeAir &&
       !new_positions_.contains(new_block.position())) {
     new_blocks_.append(new_block);
@@ -60,9 +150,156 @@ void BlockTransaction::replaceBlock(const BlockInstance& old_block, const BlockI
 }
 
 void BlockTransaction::clearBlock(const BlockInstance& old_block) {
+  index();
+  shared_layers_.clear();
   if (old_block.prototype()->type() != kBlockTypeAir &&
       !old_positions_.contains(old_block.position())) {
     old_blocks_.append(old_block);
     old_positions_.insert(old_block.position());
   }
 }
+
+void BlockTransaction::replaceBlocks(const QList<BlockInstance>& old_blocks, const QList<BlockInstance>& new_blocks) {
+  if (!isEmpty()) {
+    foreach (const BlockInstance& old_block, old_blocks) {
+      clearBlock(old_block);
+    }
+    foreach (const BlockInstance& new_block, new_blocks) {
+      setBlock(new_block);
+    }
+    return;
+  }
+  old_blocks_ = old_blocks;
+  new_blocks_ = new_blocks;
+  shared_layers_.clear();
+  old_positions_.clear();
+  new_positions_.clear();
+  is_indexed_ = false;
+}
+
+void BlockTransaction::shareLayer(const ChunkPosition& chunk_position, int y, const ChunkLayer& layer) {
+  shared_layers_.append(SharedLayer(chunk_position, y, layer));
+}
+
+void BlockTransaction::merge(const BlockTransaction& later) {
+  if (isEmpty()) {
+    *this = later;
+    return;
+  }
+  index();
+  later.index();
+  shared_layers_.clear();
+  // The state of the world before the merged transaction is the state before this one, except at positions this one
+  // never touched, where it is whatever later found there.
+  foreach (const BlockInstance& old_block, later.old_blocks_) {
+    const BlockPosition& position = old_block.position();
+    if (!old_positions_.contains(position) && !new_positions_.contains(position)) {
+      old_blocks_.append(old_block);
+      old_positions_.insert(position);
+    }
+  }
+
+  // The state after the merged transaction is whatever later left behind, except at positions later never touched,
+  // where it is whatever this one left behind.  Only pay for filtering our own additions if later overlaps them.
+  bool overlaps = false;
+  foreach (const BlockPosition& position, later.old_positions_) {
+    if (new_positions_.contains(position)) {
+      overlaps = true;
+      break;
+    }
+  }
+  if (!overlaps) {
+    foreach (const BlockPosition& position, later.new_positions_) {
+      if (new_positions_.contains(position)) {
+        overlaps = true;
+        break;
+      }
+    }
+  }
+  if (overlaps) {
+    QList<BlockInstance> surviving_blocks;
+    foreach (const BlockInstance& new_block, new_blocks_) {
+      const BlockPosition& position = new_block.position();
+      if (later.old_positions_.contains(position) || later.new_positions_.contains(position)) {
+        new_positions_.remove(position);
+      } else {
+        surviving_blocks.append(new_block);
+      }
+    }
+    new_blocks_ = surviving_blocks;
+  }
+  foreach (const BlockInstance& new_block, later.new_blocks_) {
+    new_blocks_.append(new_block);
+    new_positions_.insert(new_block.position());
+  }
+}
+
+void BlockTransaction::difference(const BlockTransaction& later,
+                                  BlockTransaction* retracted,
+                                  BlockTransaction* added) const {
+  BlockMap old_blocks = blocksByPosition(old_blocks_);
+  BlockMap new_blocks = blocksByPosition(new_blocks_);
+  BlockMap later_old_blocks = blocksByPosition(later.old_blocks_);
+  BlockMap later_new_blocks = blocksByPosition(later.new_blocks_);
+
+  QList<BlockInstance> retracted_old_blocks;
+  QList<BlockInstance> retracted_new_blocks;
+  QList<BlockInstance> added_old_blocks;
+  QList<BlockInstance> added_new_blocks;
+  QSet<BlockPosition> compared_positions;
+  QList<const BlockMap*> maps;
+  maps << &old_blocks << &new_blocks << &later_old_blocks << &later_new_blocks;
+  foreach (const BlockMap* map, maps) {
+    BlockMap::const_iterator iter;
+    for (iter = map->constBegin(); iter != map->constEnd(); ++iter) {
+      const BlockPosition& position = iter.key();
+      if (compared_positions.contains(position)) {
+        continue;
+      }
+      compared_positions.insert(position);
+
+      const BlockInstance* old_block = old_blocks.value(position, NULL);
+      const BlockInstance* new_block = new_blocks.value(position, NULL);
+      const BlockInstance* later_old_block = later_old_blocks.value(position, NULL);
+      const BlockInstance* later_new_block = later_new_blocks.value(position, NULL);
+      if (isSameBlock(old_block, later_old_block) && isSameBlock(new_block, later_new_block)) {
+        continue;
+      }
+      if (old_block) {
+        retracted_old_blocks.append(*old_block);
+      }
+      if (new_block) {
+        retracted_new_blocks.append(*new_block);
+      }
+      if (later_old_block) {
+        added_old_blocks.append(*later_old_block);
+      }
+      if (later_new_block) {
+        added_new_blocks.append(*later_new_block);
+      }
+    }
+  }
+  retracted->replaceBlocks(retracted_old_blocks, retracted_new_blocks);
+  added->replaceBlocks(added_old_blocks, added_new_blocks);
+}
+
+// Static.
+void BlockTransaction::mergePatches(BlockTransaction* retracted, BlockTransaction* added,
+                                    const BlockTransaction& later_retracted, const BlockTransaction& later_added) {
+  if (retracted->isEmpty() && added->isEmpty()) {
+    *retracted = later_retracted;
+    *added = later_added;
+    return;
+  }
+  // Each side of the patch is merged on its own: the blocks it ephemerally removes, and those it ephemerally adds.
+  QHash<BlockPosition, BlockInstance> retracted_old_blocks = copiesByPosition(retracted->old_blocks_);
+  QHash<BlockPosition, BlockInstance> retracted_new_blocks = copiesByPosition(retracted->new_blocks_);
+  QHash<BlockPosition, BlockInstance> added_old_blocks = copiesByPosition(added->old_blocks_);
+  QHash<BlockPosition, BlockInstance> added_new_blocks = copiesByPosition(added->new_blocks_);
+  mergePatchBlocks(later_retracted.old_blocks_, later_added.old_blocks_, &retracted_old_blocks, &added_old_blocks);
+  mergePatchBlocks(later_retracted.new_blocks_, later_added.new_blocks_, &retracted_new_blocks, &added_new_blocks);
+  *retracted = BlockTransaction();
+  retracted->replaceBlocks(retracted_old_blocks.values(), retracted_new_blocks.values());
+  *added = BlockTransaction();
+  added->replaceBlocks(added_old_blocks.values(), added_new_blocks.values());
+}
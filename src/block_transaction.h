@@ -20,6 +20,8 @@
 #include <QSet>
 
 #include "block_type.h"
+#include "chunk.h"
+#include "chunk_position.h"
 
 class BlockInstance;
 class BlockPosition;
@@ -50,9 +52,44 @@ class BlockPosition;
   *
   * BlockTransactions record both the old and new states of the world, so they can be used to undo operations as well,
   * by simply removing the new blocks and adding back the old ones.
+  *
+  * Operations that copy whole chunk layers, such as Diagram::copyLevel() and chunk-aligned pastes, can also record
+  * which layers they copied by calling shareLayer().  The blocks are still recorded one by one for the views' sake,
+  * but the Diagram stores the copied layers themselves, so the copies share storage with the original until one of
+  * them is changed.
   */
 class BlockTransaction {
  public:
+  /**
+    * A layer of a chunk which is known to hold exactly the blocks of layer() once the transaction has been applied.
+    * @sa shareLayer()
+    */
+  class SharedLayer {
+   public:
+    SharedLayer(const ChunkPosition& chunk_position, int y, const ChunkLayer& layer)
+        : chunk_position_(chunk_position), y_(y), layer_(layer) {}
+
+    /** Returns the position of the chunk the layer belongs to. */
+    const ChunkPosition& chunkPosition() const {
+      return chunk_position_;
+    }
+
+    /** Returns the local height of the layer within its chunk. */
+    int y() const {
+      return y_;
+    }
+
+    /** Returns the blocks the layer holds once the transaction has been applied. */
+    const ChunkLayer& layer() const {
+      return layer_;
+    }
+
+   private:
+    ChunkPosition chunk_position_;
+    int y_;
+    ChunkLayer layer_;
+  };
+
   /**
     * Default constructor.
     */
@@ -74,6 +111,36 @@ class BlockTransaction {
     */
   BlockTransaction reversed() const;
 
+  /**
+    * Folds \p later into this transaction, so that applying the result has the same effect as applying this
+    * transaction followed by \p later.  For each position, the block recorded as removed is the one that was there
+    * before this transaction, and the block recorded as added is the one that is there after \p later.
+    *
+    * This is used to coalesce bursts of commits into a single change set, for instance by DiagramSubscription.
+    */
+  void merge(const BlockTransaction& later);
+
+  /**
+    * Compares this transaction with \p later position by position.  Wherever the two don't make exactly the same
+    * change, the change this transaction makes is recorded in \p retracted and the one \p later makes is recorded in
+    * \p added.  Taking back the changes in \p retracted and then making those in \p added therefore turns the
+    * effect of this transaction into that of \p later, touching only the positions where they differ.
+    *
+    * This is how successive previews of a tool are turned into patches (see Tool::drawPreview()).
+    */
+  void difference(const BlockTransaction& later, BlockTransaction* retracted, BlockTransaction* added) const;
+
+  /**
+    * Folds the ephemeral patch made up of \p later_retracted and \p later_added (see Diagram::patchEphemeral()) into
+    * the one made up of \p retracted and \p added, so that applying the result has the same effect as applying the two
+    * patches in turn.  Where the later patch takes back a change the earlier one made, or makes again a change the
+    * earlier one took back, the two cancel out.
+    *
+    * This is used to coalesce bursts of ephemeral patches, for instance by DiagramSubscription.
+    */
+  static void mergePatches(BlockTransaction* retracted, BlockTransaction* added,
+                           const BlockTransaction& later_retracted, const BlockTransaction& later_added);
+
   /**
     * Records the replacement of \p old_block with \p new_block.  The blocks must have the same position.  If
     * \p old_block has a type of kBlockTypeAir, this is equivalent to setBlock().  If \p new_block has a type of
@@ -135,6 +202,32 @@ class BlockTransaction {
     */
   void clearBlock(const BlockInstance& old_block);
 
+  /**
+    * Records the removal of every block in \p old_blocks and the addition of every block in \p new_blocks.  Neither
+    * list may contain air, or two blocks at the same position.
+    *
+    * The result is the same as calling clearBlock() and setBlock() for each block, but when the transaction is empty,
+    * as it is when a tool draws a whole shape at once (see Diagram::fillSpans()), the lists are adopted as they are and
+    * the bookkeeping needed to honor only the first change per position is put off until something actually needs it.
+    */
+  void replaceBlocks(const QList<BlockInstance>& old_blocks, const QList<BlockInstance>& new_blocks);
+
+  /**
+    * Records that once this transaction has been applied, the layer at local height \p y of the chunk at
+    * \p chunk_position will hold exactly the blocks of \p layer, no more and no fewer.  The changes to those blocks
+    * must already have been recorded as usual; this only lets the Diagram keep \p layer itself rather than building a
+    * copy of it block by block.  Recording any other change afterwards forgets all shared layers, since the promise may
+    * no longer hold, and so does reversing or merging the transaction.
+    */
+  void shareLayer(const ChunkPosition& chunk_position, int y, const ChunkLayer& layer);
+
+  /**
+    * Returns the layers recorded by shareLayer().
+    */
+  const QList<SharedLayer>& sharedLayers() const {
+    return shared_layers_;
+  }
+
   /**
     * Returns a list of blocks that are removed from the world by this transaction.  When applying the transaction in
     * the normal (forward) manner, these blocks should be removed \e before adding the blocks returned by new_blocks().
@@ -155,11 +248,25 @@ class BlockTransaction {
     return new_blocks_;
   }
 
+  /**
+    * Returns whether this transaction neither adds nor removes any blocks.
+    */
+  bool isEmpty() const {
+    return old_blocks_.isEmpty() && new_blocks_.isEmpty();
+  }
+
  private:
-  QSet<BlockPosition> old_positions_;
-  QSet<BlockPosition> new_positions_;
+  /**
+    * Fills in old_positions_ and new_positions_ if replaceBlocks() left them empty.
+    */
+  void index() const;
+
+  mutable QSet<BlockPosition> old_positions_;
+  mutable QSet<BlockPosition> new_positions_;
+  mutable bool is_indexed_;
   QList<BlockInstance> old_blocks_;
   QList<BlockInstance> new_blocks_;
+  QList<SharedLayer> shared_layers_;
 };
 
 #endif // BLOCK_TRANSACTION_H
@@ -0,0 +1,148 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "block_transform.h"
+
+#include "macros.h"
+
+/**
+  * Every orientation that turns into another when rotated or mirrored, along with what it turns into when rotated a
+  * quarter turn clockwise and when mirrored along the x axis.  The other transforms are combinations of these two.
+  */
+static const BlockOrientation::Id kOrientationImages[][3] = {
+  // Orientation, rotated clockwise, mirrored along x.
+  {BlockOrientation::kOrientationFacingSouth, BlockOrientation::kOrientationFacingWest,
+   BlockOrientation::kOrientationFacingSouth},
+  {BlockOrientation::kOrientationFacingWest, BlockOrientation::kOrientationFacingNorth,
+   BlockOrientation::kOrientationFacingEast},
+  {BlockOrientation::kOrientationFacingNorth, BlockOrientation::kOrientationFacingEast,
+   BlockOrientation::kOrientationFacingNorth},
+  {BlockOrientation::kOrientationFacingEast, BlockOrientation::kOrientationFacingSouth,
+   BlockOrientation::kOrientationFacingWest},
+  {BlockOrientation::kOrientationFacingSouthInverted, BlockOrientation::kOrientationFacingWestInverted,
+   BlockOrientation::kOrientationFacingSouthInverted},
+  {BlockOrientation::kOrientationFacingWestInverted, BlockOrientation::kOrientationFacingNorthInverted,
+   BlockOrientation::kOrientationFacingEastInverted},
+  {BlockOrientation::kOrientationFacingNorthInverted, BlockOrientation::kOrientationFacingEastInverted,
+   BlockOrientation::kOrientationFacingNorthInverted},
+  {BlockOrientation::kOrientationFacingEastInverted, BlockOrientation::kOrientationFacingSouthInverted,
+   BlockOrientation::kOrientationFacingWestInverted},
+  {BlockOrientation::kOrientationRunningNorthSouth, BlockOrientation::kOrientationRunningEastWest,
+   BlockOrientation::kOrientationRunningNorthSouth},
+  {BlockOrientation::kOrientationRunningEastWest, BlockOrientation::kOrientationRunningNorthSouth,
+   BlockOrientation::kOrientationRunningEastWest},
+  {BlockOrientation::kOrientationNorthwestCorner, BlockOrientation::kOrientationNortheastCorner,
+   BlockOrientation::kOrientationNortheastCorner},
+  {BlockOrientation::kOrientationSouthwestCorner, BlockOrientation::kOrientationNorthwestCorner,
+   BlockOrientation::kOrientationSoutheastCorner},
+  {BlockOrientation::kOrientationNortheastCorner, BlockOrientation::kOrientationSoutheastCorner,
+   BlockOrientation::kOrientationNorthwestCorner},
+  {BlockOrientation::kOrientationSoutheastCorner, BlockOrientation::kOrientationSouthwestCorner,
+   BlockOrientation::kOrientationSouthwestCorner},
+  {BlockOrientation::kOrientationAscendingSouth, BlockOrientation::kOrientationAscendingWest,
+   BlockOrientation::kOrientationAscendingSouth},
+  {BlockOrientation::kOrientationAscendingWest, BlockOrientation::kOrientationAscendingNorth,
+   BlockOrientation::kOrientationAscendingEast},
+  {BlockOrientation::kOrientationAscendingNorth, BlockOrientation::kOrientationAscendingEast,
+   BlockOrientation::kOrientationAscendingNorth},
+  {BlockOrientation::kOrientationAscendingEast, BlockOrientation::kOrientationAscendingSouth,
+   BlockOrientation::kOrientationAscendingWest},
+  {BlockOrientation::kOrientationNorthHalf, BlockOrientation::kOrientationEastHalf,
+   BlockOrientation::kOrientationNorthHalf},
+  {BlockOrientation::kOrientationSouthHalf, BlockOrientation::kOrientationWestHalf,
+   BlockOrientation::kOrientationSouthHalf},
+  {BlockOrientation::kOrientationEastHalf, BlockOrientation::kOrientationSouthHalf,
+   BlockOrientation::kOrientationWestHalf},
+  {BlockOrientation::kOrientationWestHalf, BlockOrientation::kOrientationNorthHalf,
+   BlockOrientation::kOrientationEastHalf},
+  {BlockOrientation::kOrientationTFacingSouth, BlockOrientation::kOrientationTFacingWest,
+   BlockOrientation::kOrientationTFacingSouth},
+  {BlockOrientation::kOrientationTFacingWest, BlockOrientation::kOrientationTFacingNorth,
+   BlockOrientation::kOrientationTFacingEast},
+  {BlockOrientation::kOrientationTFacingNorth, BlockOrientation::kOrientationTFacingEast,
+   BlockOrientation::kOrientationTFacingNorth},
+  {BlockOrientation::kOrientationTFacingEast, BlockOrientation::kOrientationTFacingSouth,
+   BlockOrientation::kOrientationTFacingWest},
+  {BlockOrientation::kOrientationOnNorthWall, BlockOrientation::kOrientationOnEastWall,
+   BlockOrientation::kOrientationOnNorthWall},
+  {BlockOrientation::kOrientationOnEastWall, BlockOrientation::kOrientationOnSouthWall,
+   BlockOrientation::kOrientationOnWestWall},
+  {BlockOrientation::kOrientationOnSouthWall, BlockOrientation::kOrientationOnWestWall,
+   BlockOrientation::kOrientationOnSouthWall},
+  {BlockOrientation::kOrientationOnWestWall, BlockOrientation::kOrientationOnNorthWall,
+   BlockOrientation::kOrientationOnEastWall}
+};
+
+/**
+  * Returns the id of the orientation that the orientation whose id is \p id turns into according to \p column of
+  * kOrientationImages: 1 for a clockwise quarter turn, or 2 for a mirror image along x.
+  */
+static int orientationImage(int id, int column) {
+  for (int i = 0; i < arraysize(kOrientationImages); ++i) {
+    if (kOrientationImages[i][0] == id) {
+      return kOrientationImages[i][column];
+    }
+  }
+  return id;
+}
+
+// Static.
+int BlockTransform::transformedOrientationId(int id, Kind kind) {
+  switch (kind) {
+    case kRotateClockwise:
+      return orientationImage(id, 1);
+    case kRotateHalfTurn:
+      return orientationImage(orientationImage(id, 1), 1);
+    case kRotateCounterclockwise:
+      return orientationImage(orientationImage(orientationImage(id, 1), 1), 1);
+    case kMirrorX:
+      return orientationImage(id, 2);
+    case kMirrorZ:
+      // A mirror image along z is a half turn followed by a mirror image along x.
+      return orientationImage(orientationImage(orientationImage(id, 1), 1), 2);
+    default:
+      Q_ASSERT(false);
+      return id;
+  }
+}
+
+// Static.
+void BlockTransform::transformCell(Kind kind, int width, int depth, int* x, int* z) {
+  int old_x = *x;
+  int old_z = *z;
+  switch (kind) {
+    case kRotateClockwise:
+      *x = depth - 1 - old_z;
+      *z = old_x;
+      break;
+    case kRotateHalfTurn:
+      *x = width - 1 - old_x;
+      *z = depth - 1 - old_z;
+      break;
+    case kRotateCounterclockwise:
+      *x = old_z;
+      *z = width - 1 - old_x;
+      break;
+    case kMirrorX:
+      *x = width - 1 - old_x;
+      break;
+    case kMirrorZ:
+      *z = depth - 1 - old_z;
+      break;
+    default:
+      Q_ASSERT(false);
+      break;
+  }
+}
@@ -0,0 +1,71 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BLOCK_TRANSFORM_H
+#define BLOCK_TRANSFORM_H
+
+#include "block_orientation.h"
+
+/**
+  * The rotations about the vertical axis and mirror images that can be applied to a box of blocks, such as a selection
+  * or the contents of a BlockClipboard.
+  *
+  * Transforming blocks means moving them and also turning their orientations, so that a staircase facing north still
+  * climbs towards the same wall once the room around it has been rotated.  transformedOrientationId() says where each
+  * orientation in the orientation table ends up, going by the compass directions in its name.  Not every block can
+  * take on every orientation, so BlockPrototype::transformedOrientation() narrows this down to the orientations the
+  * prototype supports, using tables it builds once rather than looking at names every time a block is transformed.
+  *
+  * As seen from above in the LevelWidget, north is towards negative z at the top and east is towards positive x on
+  * the right.
+  */
+class BlockTransform {
+ public:
+  enum Kind {
+    /// Rotates a quarter turn clockwise, seen from above, so that north becomes east.
+    kRotateClockwise,
+    /// Rotates a half turn, so that north becomes south.
+    kRotateHalfTurn,
+    /// Rotates a quarter turn counterclockwise, seen from above, so that north becomes west.
+    kRotateCounterclockwise,
+    /// Mirrors along the x axis, so that east and west trade places.
+    kMirrorX,
+    /// Mirrors along the z axis, so that north and south trade places.
+    kMirrorZ,
+    kKindCount
+  };
+
+  /**
+    * Returns the id of the orientation that a block with the orientation whose id is \p id turns into when transformed
+    * by \p kind.  Orientations that don't mention a compass direction, and orientations that are not in the
+    * orientation table, are left alone.
+    */
+  static int transformedOrientationId(int id, Kind kind);
+
+  /**
+    * Returns whether \p kind swaps the width and the depth of a box.
+    */
+  static bool swapsAxes(Kind kind) {
+    return kind == kRotateClockwise || kind == kRotateCounterclockwise;
+  }
+
+  /**
+    * Moves the cell at \p x and \p z of a box \p width blocks wide and \p depth blocks deep to where \p kind puts it,
+    * in the transformed box with the same corner.  The level of a cell is never affected.
+    */
+  static void transformCell(Kind kind, int width, int depth, int* x, int* z);
+};
+
+#endif // BLOCK_TRANSFORM_H
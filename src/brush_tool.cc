@@ -0,0 +1,117 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "brush_tool.h"
+
+#include "block_instance.h"
+#include "span_mask.h"
+
+BrushTool::BrushTool(Diagram* diagram)
+    : diagram_(diagram),
+      stroked_position_count_(0),
+      last_stroked_position_(0, 0, 0),
+      stroke_prototype_(NULL),
+      stroke_orientation_(NULL) {
+}
+
+BrushTool::~BrushTool() {}
+
+bool BrushTool::wantsMorePositions() {
+  return countPositions() == 0;
+}
+
+bool BrushTool::isBrush() const {
+  return true;
+}
+
+void BrushTool::setStateFrom(Tool* other) {
+  Tool::setStateFrom(other);
+  resetStroke();
+}
+
+void BrushTool::clear() {
+  Tool::clear();
+  resetStroke();
+}
+
+void BrushTool::draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
+  BlockTransaction segment;
+  updateStroke(prototype, orientation, &segment);
+  transaction->replaceBlocks(stroke_.old_blocks(), stroke_.new_blocks());
+}
+
+bool BrushTool::drawPreview(BlockPrototype* prototype,
+                            const BlockOrientation* orientation,
+                            BlockTransaction* retracted,
+                            BlockTransaction* transaction) {
+  BlockTransaction segment;
+  bool is_extended = updateStroke(prototype, orientation, &segment);
+  bool is_incremental = continuePreview(prototype, orientation) && is_extended;
+  *transaction = is_incremental ? segment : stroke_;
+  return is_incremental;
+}
+
+bool BrushTool::updateStroke(BlockPrototype* prototype,
+                             const BlockOrientation* orientation,
+                             BlockTransaction* segment) {
+  bool is_extended = stroked_position_count_ > 0 &&
+                     stroked_position_count_ <= countPositions() &&
+                     positionAtIndex(stroked_position_count_ - 1) == last_stroked_position_ &&
+                     prototype == stroke_prototype_ &&
+                     orientation == stroke_orientation_;
+  if (!is_extended) {
+    resetStroke();
+    stroke_prototype_ = prototype;
+    stroke_orientation_ = orientation;
+  }
+  if (stroked_position_count_ == countPositions()) {
+    return is_extended;
+  }
+
+  SpanMask mask;
+  SpanMask painted_end;
+  if (stroked_position_count_ == 0) {
+    const BlockPosition& first_position = positionAtIndex(0);
+    mask.addCell(first_position.x(), first_position.y(), first_position.z());
+    stroked_position_count_ = 1;
+  } else {
+    painted_end.addCell(last_stroked_position_.x(), last_stroked_position_.y(), last_stroked_position_.z());
+  }
+  for (int i = stroked_position_count_; i < countPositions(); ++i) {
+    const BlockPosition& from = positionAtIndex(i - 1);
+    const BlockPosition& to = positionAtIndex(i);
+    if (from.y() == to.y()) {
+      mask.addLine(from, to);
+    } else {
+      // Lines only run along a level, so a stroke that changes level just jumps.
+      mask.addCell(to.x(), to.y(), to.z());
+    }
+  }
+  stroked_position_count_ = countPositions();
+  last_stroked_position_ = positionAtIndex(stroked_position_count_ - 1);
+
+  // The segment starts where the stroke left off, and that cell is already painted.  Leaving it out keeps the segment
+  // from overlapping the stroke in the usual case, where merging it in then costs nothing for the rest of the stroke.
+  paint(mask.subtracted(painted_end), prototype, orientation, segment);
+  stroke_.merge(*segment);
+  return is_extended;
+}
+
+void BrushTool::resetStroke() {
+  stroke_ = BlockTransaction();
+  stroked_position_count_ = 0;
+  stroke_prototype_ = NULL;
+  stroke_orientation_ = NULL;
+}
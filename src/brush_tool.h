@@ -0,0 +1,98 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BRUSH_TOOL_H
+#define BRUSH_TOOL_H
+
+#include "block_position.h"
+#include "block_transaction.h"
+#include "tool.h"
+
+class Diagram;
+class SpanMask;
+
+/**
+  * A Tool that paints along the path of the mouse, such as the pencil or the eraser.
+  *
+  * A brush stroke can collect hundreds of positions, so rather than replaying all of them every time the mouse moves,
+  * BrushTool keeps the stroke painted so far and only extends it by the segment from the last position it painted to
+  * the newest one.  Segments are rasterized as lines (see SpanMask::addLine()), so the stroke has no gaps no matter
+  * how quickly the mouse moves.  drawPreview() reports just the new segment, so each mouse movement costs time in
+  * proportion to the distance moved rather than the length of the stroke.  Wherever a segment paints over the stroke
+  * so far, the segment wins, in the stroke just as in the preview.
+  *
+  * Subclasses implement paint() to decide what the brush does to the cells it passes over.
+  */
+class BrushTool : public Tool {
+ public:
+  explicit BrushTool(Diagram* diagram);
+  virtual ~BrushTool();
+
+  virtual bool wantsMorePositions();
+  virtual bool isBrush() const;
+  virtual void setStateFrom(Tool* other);
+  virtual void clear();
+  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
+  virtual bool drawPreview(BlockPrototype* prototype,
+                           const BlockOrientation* orientation,
+                           BlockTransaction* retracted,
+                           BlockTransaction* transaction);
+
+ protected:
+  /**
+    * Records in \p segment what the brush does to the cells in \p mask when painting with \p prototype and
+    * \p orientation.
+    */
+  virtual void paint(const SpanMask& mask,
+                     BlockPrototype* prototype,
+                     const BlockOrientation* orientation,
+                     BlockTransaction* segment) = 0;
+
+  Diagram* diagram() const {
+    return diagram_;
+  }
+
+  /**
+    * Throws away the stroke, so that the next call to updateStroke() starts again.  Subclasses that remember anything
+    * about the stroke should override this to forget it too.
+    */
+  virtual void resetStroke();
+
+ private:
+  /**
+    * Brings stroke_ up to date with the tool's positions, painting with \p prototype and \p orientation, and records
+    * in \p segment whatever was added to it.  If the stroke can't simply be extended, because the positions it was
+    * painted from have changed (as they do while the brush is only hovering) or it was painted with something else, it
+    * is started again from scratch.
+    * @returns \c true if the existing stroke was extended, or \c false if it was started again.
+    */
+  bool updateStroke(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* segment);
+
+  Diagram* diagram_;
+
+  /// Everything the brush has painted so far.
+  BlockTransaction stroke_;
+
+  /// The number of the tool's positions that have been painted into stroke_.
+  int stroked_position_count_;
+
+  /// The last position painted into stroke_, used to notice when the tool's positions change under it.
+  BlockPosition last_stroked_position_;
+
+  BlockPrototype* stroke_prototype_;
+  const BlockOrientation* stroke_orientation_;
+};
+
+#endif // BRUSH_TOOL_H
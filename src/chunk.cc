@@ -0,0 +1,106 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chunk.h"
+
+ChunkLayer::ChunkLayer() : block_count_(0) {
+}
+
+int ChunkLayer::paletteIndexFor(BlockPrototype* prototype, const BlockOrientation* orientation) {
+  if (palette_.isEmpty()) {
+    // Entry 0 is air.
+    palette_.append(PaletteEntry());
+  }
+  int free_index = -1;
+  for (int i = 1; i < palette_.size(); ++i) {
+    const PaletteEntry& entry = palette_.at(i);
+    if (entry.prototype_ == prototype && entry.orientation_ == orientation) {
+      return i;
+    }
+    if (free_index < 0 && entry.count_ == 0) {
+      free_index = i;
+    }
+  }
+  if (free_index >= 0) {
+    palette_[free_index] = PaletteEntry(prototype, orientation);
+    return free_index;
+  }
+  palette_.append(PaletteEntry(prototype, orientation));
+  return palette_.size() - 1;
+}
+
+bool ChunkLayer::setBlock(int cell, BlockPrototype* prototype, const BlockOrientation* orientation) {
+  if (!prototype) {
+    clearBlock(cell);
+    return false;
+  }
+  int new_index = paletteIndexFor(prototype, orientation);
+  if (cells_.isEmpty()) {
+    cells_.fill(0, kChunkLayerArea);
+  }
+  int old_index = cells_.at(cell);
+  if (old_index == new_index) {
+    return false;
+  }
+  if (old_index) {
+    --palette_[old_index].count_;
+  } else {
+    ++block_count_;
+  }
+  ++palette_[new_index].count_;
+  cells_[cell] = static_cast<quint16>(new_index);
+  return old_index == 0;
+}
+
+bool ChunkLayer::clearBlock(int cell) {
+  int old_index = paletteIndexAt(cell);
+  if (!old_index) {
+    return false;
+  }
+  --block_count_;
+  if (block_count_ == 0) {
+    // Release the storage entirely rather than keeping around a layer full of air.
+    palette_.clear();
+    cells_.clear();
+    return true;
+  }
+  --palette_[old_index].count_;
+  cells_[cell] = 0;
+  return true;
+}
+
+Chunk::Chunk() : layers_(kChunkSize), block_count_(0) {
+}
+
+void Chunk::setBlock(int x, int y, int z, BlockPrototype* prototype, const BlockOrientation* orientation) {
+  if (!prototype) {
+    clearBlock(x, y, z);
+    return;
+  }
+  if (layers_[y].setBlock(ChunkLayer::cellIndex(x, z), prototype, orientation)) {
+    ++block_count_;
+  }
+}
+
+void Chunk::clearBlock(int x, int y, int z) {
+  if (layers_[y].clearBlock(ChunkLayer::cellIndex(x, z))) {
+    --block_count_;
+  }
+}
+
+void Chunk::setLayer(int y, const ChunkLayer& layer) {
+  block_count_ += layer.blockCount() - layers_.at(y).blockCount();
+  layers_[y] = layer;
+}
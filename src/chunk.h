@@ -0,0 +1,226 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include <QVector>
+
+#include "chunk_position.h"
+
+class BlockOrientation;
+class BlockPrototype;
+
+/**
+  * The number of cells in one layer of a chunk.
+  */
+const int kChunkLayerArea = kChunkSize * kChunkSize;
+
+/**
+  * One horizontal kChunkSize x kChunkSize layer of a Chunk.
+  *
+  * Rather than storing a prototype and orientation for every cell, each layer keeps a small palette of the distinct
+  * (prototype, orientation) pairs it contains, and each cell stores an index into that palette.  Index 0 is reserved
+  * for air.  Cells are stored row by row, so the cells with consecutive _x_ coordinates are adjacent in memory.
+  *
+  * Both the palette and the cells are implicitly shared, so copying a layer (or a whole Chunk) costs a couple of
+  * reference count increments, and the data is only duplicated once one of the copies is modified.  A layer
+  * containing only air holds no cell data at all.
+  */
+class ChunkLayer {
+ public:
+  /**
+    * One entry in a layer's palette: a distinct combination of prototype and orientation, along with the number of
+    * cells in the layer that use it.
+    */
+  class PaletteEntry {
+   public:
+    PaletteEntry() : prototype_(NULL), orientation_(NULL), count_(0) {}
+    PaletteEntry(BlockPrototype* prototype, const BlockOrientation* orientation)
+        : prototype_(prototype), orientation_(orientation), count_(0) {}
+
+    /** Returns the prototype of the blocks using this entry, or NULL if the entry is unused. */
+    BlockPrototype* prototype() const {
+      return prototype_;
+    }
+
+    /** Returns the orientation of the blocks using this entry. */
+    const BlockOrientation* orientation() const {
+      return orientation_;
+    }
+
+    /** Returns the number of cells in the layer using this entry. */
+    int count() const {
+      return count_;
+    }
+
+   private:
+    friend class ChunkLayer;
+    BlockPrototype* prototype_;
+    const BlockOrientation* orientation_;
+    int count_;
+  };
+
+  ChunkLayer();
+
+  /**
+    * Returns the index of the cell at local coordinates \p x and \p z within the layer.
+    */
+  static inline int cellIndex(int x, int z) {
+    return (z << kChunkShift) | x;
+  }
+
+  /**
+    * Returns whether every cell in this layer is air.
+    */
+  inline bool isEmpty() const {
+    return block_count_ == 0;
+  }
+
+  /**
+    * Returns the number of cells in this layer which are not air.
+    */
+  inline int blockCount() const {
+    return block_count_;
+  }
+
+  /**
+    * Returns the palette index of the cell with index \p cell, or 0 if the cell is air.
+    */
+  inline int paletteIndexAt(int cell) const {
+    return cells_.isEmpty() ? 0 : cells_.at(cell);
+  }
+
+  /**
+    * Returns the palette entry at \p index.
+    */
+  inline const PaletteEntry& paletteEntry(int index) const {
+    return palette_.at(index);
+  }
+
+  /**
+    * Returns this layer's palette.  Entry 0 is always air.  Entries with a count of zero are unused.
+    */
+  const QVector<PaletteEntry>& palette() const {
+    return palette_;
+  }
+
+  /**
+    * Returns the prototype of the block in the cell with index \p cell, or NULL if the cell is air.
+    */
+  inline BlockPrototype* prototypeAt(int cell) const {
+    int index = paletteIndexAt(cell);
+    return index ? palette_.at(index).prototype_ : NULL;
+  }
+
+  /**
+    * Returns the orientation of the block in the cell with index \p cell, or NULL if the cell is air.
+    */
+  inline const BlockOrientation* orientationAt(int cell) const {
+    int index = paletteIndexAt(cell);
+    return index ? palette_.at(index).orientation_ : NULL;
+  }
+
+  /**
+    * Sets the cell with index \p cell to contain a block described by \p prototype and \p orientation.  If
+    * \p prototype is NULL, the cell is cleared instead.
+    * @return Whether the cell was air before the call.
+    */
+  bool setBlock(int cell, BlockPrototype* prototype, const BlockOrientation* orientation);
+
+  /**
+    * Clears the cell with index \p cell.
+    * @return Whether the cell contained a block before the call.
+    */
+  bool clearBlock(int cell);
+
+ private:
+  /**
+    * Returns the index of the palette entry for \p prototype and \p orientation, adding one if necessary.
+    */
+  int paletteIndexFor(BlockPrototype* prototype, const BlockOrientation* orientation);
+
+  QVector<PaletteEntry> palette_;
+  QVector<quint16> cells_;
+  int block_count_;
+};
+
+/**
+  * A kChunkSize x kChunkSize x kChunkSize cube of blocks, stored as a stack of ChunkLayers.
+  *
+  * Chunk is the unit of storage for the Diagram.  All coordinates taken by its methods are local to the chunk, and
+  * range from 0 to kChunkMask inclusive.  Like ChunkLayer, Chunk is implicitly shared and cheap to copy.
+  */
+class Chunk {
+ public:
+  Chunk();
+
+  /**
+    * Returns whether every cell in this chunk is air.
+    */
+  bool isEmpty() const {
+    return block_count_ == 0;
+  }
+
+  /**
+    * Returns the number of cells in this chunk which are not air.
+    */
+  int blockCount() const {
+    return block_count_;
+  }
+
+  /**
+    * Returns the layer at local height \p y.
+    */
+  inline const ChunkLayer& layer(int y) const {
+    return layers_.at(y);
+  }
+
+  /**
+    * Returns the prototype of the block at local coordinates \p x, \p y, \p z, or NULL if the cell is air.
+    */
+  inline BlockPrototype* prototypeAt(int x, int y, int z) const {
+    return layers_.at(y).prototypeAt(ChunkLayer::cellIndex(x, z));
+  }
+
+  /**
+    * Returns the orientation of the block at local coordinates \p x, \p y, \p z, or NULL if the cell is air.
+    */
+  inline const BlockOrientation* orientationAt(int x, int y, int z) const {
+    return layers_.at(y).orientationAt(ChunkLayer::cellIndex(x, z));
+  }
+
+  /**
+    * Sets the block at local coordinates \p x, \p y, \p z.  If \p prototype is NULL, the cell is cleared instead.
+    */
+  void setBlock(int x, int y, int z, BlockPrototype* prototype, const BlockOrientation* orientation);
+
+  /**
+    * Clears the block at local coordinates \p x, \p y, \p z.
+    */
+  void clearBlock(int x, int y, int z);
+
+  /**
+    * Replaces the layer at local height \p y with \p layer.  Since layers are implicitly shared, this does not copy
+    * any cells; the two layers share storage until one of them is modified.
+    */
+  void setLayer(int y, const ChunkLayer& layer);
+
+ private:
+  QVector<ChunkLayer> layers_;
+  int block_count_;
+};
+
+#endif // CHUNK_H
@@ -0,0 +1,29 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chunk_cursor.h"
+
+ChunkCursor::ChunkCursor(const QHash<ChunkPosition, Chunk>& chunks)
+    : chunks_(chunks),
+      position_(0, 0, 0),
+      chunk_(NULL) {
+  moveTo(position_);
+}
+
+void ChunkCursor::moveTo(const ChunkPosition& position) {
+  position_ = position;
+  QHash<ChunkPosition, Chunk>::const_iterator iter = chunks_.constFind(position);
+  chunk_ = (iter == chunks_.constEnd()) ? NULL : &iter.value();
+}
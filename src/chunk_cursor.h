@@ -0,0 +1,90 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHUNK_CURSOR_H
+#define CHUNK_CURSOR_H
+
+#include <QHash>
+
+#include "chunk.h"
+#include "chunk_position.h"
+
+class BlockOrientation;
+class BlockPrototype;
+
+/**
+  * Provides fast read-only access to the blocks of a Diagram at arbitrary positions.
+  *
+  * Looking up a block with Diagram::blockAt() involves a virtual call, a hash lookup to find the right chunk, and the
+  * construction of a BlockInstance.  A ChunkCursor instead remembers the last chunk it looked at, so a run of lookups
+  * that stay within one chunk (as scanning along a row does) costs little more than an array access each.
+  *
+  * Like DiagramSlice, a ChunkCursor holds an implicitly shared snapshot of the diagram's storage, so it is cheap to
+  * create but does not see changes made to the diagram after it was created.
+  */
+class ChunkCursor {
+ public:
+  explicit ChunkCursor(const QHash<ChunkPosition, Chunk>& chunks);
+
+  /**
+    * Returns the prototype of the block at \p x, \p y, \p z, or NULL if there is no block there.
+    */
+  inline BlockPrototype* prototypeAt(int x, int y, int z) {
+    if (!seek(x, y, z)) {
+      return NULL;
+    }
+    return chunk_->prototypeAt(ChunkPosition::localCoordinate(x),
+                               ChunkPosition::localCoordinate(y),
+                               ChunkPosition::localCoordinate(z));
+  }
+
+  /**
+    * Returns the orientation of the block at \p x, \p y, \p z, or NULL if there is no block there.
+    */
+  inline const BlockOrientation* orientationAt(int x, int y, int z) {
+    if (!seek(x, y, z)) {
+      return NULL;
+    }
+    return chunk_->orientationAt(ChunkPosition::localCoordinate(x),
+                                 ChunkPosition::localCoordinate(y),
+                                 ChunkPosition::localCoordinate(z));
+  }
+
+ private:
+  /**
+    * Makes chunk_ point to the chunk containing \p x, \p y, \p z.
+    * @return Whether that chunk exists.
+    */
+  inline bool seek(int x, int y, int z) {
+    ChunkPosition position(ChunkPosition::chunkCoordinate(x),
+                           ChunkPosition::chunkCoordinate(y),
+                           ChunkPosition::chunkCoordinate(z));
+    if (position != position_) {
+      moveTo(position);
+    }
+    return chunk_ != NULL;
+  }
+
+  /**
+    * Looks up the chunk at \p position and makes it the current chunk.
+    */
+  void moveTo(const ChunkPosition& position);
+
+  QHash<ChunkPosition, Chunk> chunks_;
+  ChunkPosition position_;
+  const Chunk* chunk_;
+};
+
+#endif // CHUNK_CURSOR_H
@@ -0,0 +1,28 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chunk_position.h"
+
+QDebug operator<<(QDebug dbg, const ChunkPosition& position) {
+  dbg.nospace() << "Chunk(" << position.x() << ", " << position.y() << ", " << position.z() << ")";
+  return dbg.space();
+}
+
+uint qHash(const ChunkPosition& position) {
+  quint64 hash_seed = static_cast<quint64>(position.x()) +
+                      (static_cast<quint64>(position.y()) << 16) +
+                      (static_cast<quint64>(position.z()) << 32);
+  return qHash(hash_seed);
+}
@@ -0,0 +1,137 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHUNK_POSITION_H
+#define CHUNK_POSITION_H
+
+#include <QDebug>
+
+#include "block_position.h"
+
+/**
+  * The base-2 logarithm of the edge length of a chunk.  Chunks are cubes of (1 << kChunkShift) blocks on a side.
+  */
+const int kChunkShift = 4;
+
+/**
+  * The edge length of a chunk, in blocks.
+  */
+const int kChunkSize = 1 << kChunkShift;
+
+/**
+  * A mask which, when applied to a block coordinate, yields the coordinate of the block relative to its chunk.
+  */
+const int kChunkMask = kChunkSize - 1;
+
+/**
+  * The integer position of a chunk, which is a kChunkSize x kChunkSize x kChunkSize cube of blocks.
+  *
+  * Chunks are the unit of granularity the Diagram uses when it needs to reason about large groups of blocks at once,
+  * for instance when deciding which views are interested in a given BlockTransaction.  Chunk (0, 0, 0) contains the
+  * blocks from (0, 0, 0) through (15, 15, 15); chunk (-1, 0, 0) contains the blocks from (-16, 0, 0) through
+  * (-1, 15, 15), and so on.
+  */
+class ChunkPosition {
+ public:
+  ChunkPosition() : x_(0), y_(0), z_(0) {}
+
+  /** Constructs a ChunkPosition with the given x, y, and z chunk coordinates. */
+  ChunkPosition(int x, int y, int z) : x_(x), y_(y), z_(z) {}
+
+  /**
+    * Returns the position of the chunk containing the block at \p position.
+    */
+  static ChunkPosition containing(const BlockPosition& position) {
+    return ChunkPosition(chunkCoordinate(position.x()),
+                         chunkCoordinate(position.y()),
+                         chunkCoordinate(position.z()));
+  }
+
+  /**
+    * Returns the chunk coordinate containing the block coordinate \p block_coordinate.  Rounds towards negative
+    * infinity, so negative block coordinates are handled correctly.
+    */
+  static inline int chunkCoordinate(int block_coordinate) {
+    // Right-shifting a negative integer is technically implementation-defined, but every compiler we care about
+    // performs an arithmetic shift, which is exactly the floor division we want.
+    return block_coordinate >> kChunkShift;
+  }
+
+  /**
+    * Returns the coordinate of the block at \p block_coordinate relative to the chunk containing it, which is always
+    * between 0 and kChunkMask inclusive.
+    */
+  static inline int localCoordinate(int block_coordinate) {
+    return block_coordinate & kChunkMask;
+  }
+
+  /** Equality operator. */
+  bool operator==(const ChunkPosition& other) const {
+    return x_ == other.x_ && y_ == other.y_ && z_ == other.z_;
+  }
+
+  /** Inequality operator. */
+  bool operator!=(const ChunkPosition& other) const {
+    return !(*this == other);
+  }
+
+  /** Returns the x component of this ChunkPosition. */
+  inline int x() const {
+    return x_;
+  }
+
+  /** Returns the y component of this ChunkPosition. */
+  inline int y() const {
+    return y_;
+  }
+
+  /** Returns the z component of this ChunkPosition. */
+  inline int z() const {
+    return z_;
+  }
+
+  /**
+    * Returns the position of the block with the smallest coordinates in this chunk.
+    */
+  BlockPosition minimumBlock() const {
+    return BlockPosition(x_ << kChunkShift, y_ << kChunkShift, z_ << kChunkShift);
+  }
+
+  /**
+    * Returns the position of the block with the largest coordinates in this chunk.
+    */
+  BlockPosition maximumBlock() const {
+    return BlockPosition((x_ << kChunkShift) + kChunkMask,
+                         (y_ << kChunkShift) + kChunkMask,
+                         (z_ << kChunkShift) + kChunkMask);
+  }
+
+ private:
+  int x_;
+  int y_;
+  int z_;
+};
+
+/**
+  * Allows ChunkPositions to be streamed using qDebug().
+  */
+QDebug operator<<(QDebug dbg, const ChunkPosition& position);
+
+/**
+  * Allows ChunkPositions to be stored in a hash table such as QHash.
+  */
+uint qHash(const ChunkPosition& position);
+
+#endif // CHUNK_POSITION_H
@@ -17,12 +17,9 @@
 
 #include "circle_tool.h"
 
-#include "block_instance.h"
-#include "block_oracle.h"
-#include "block_prototype.h"
-#include "block_transaction.h"
+#include "span_mask.h"
 
-CircleTool::CircleTool(BlockOracle* oracle) : oracle_(oracle) {}
+CircleTool::CircleTool(Diagram* diagram) : ShapeTool(diagram) {}
 
 QString CircleTool::actionName() const {
   return "Draw Circle";
@@ -36,13 +33,7 @@ bool CircleTool::isBrush() const {
   return false;
 }
 
-void CircleTool::setPixel(int x, int y, int z, BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
-  BlockPosition pos(x, y, z);
-  BlockInstance new_block(prototype, pos, orientation);
-  transaction->replaceBlock(oracle_->blockAt(pos), new_block);
-}
-
-void CircleTool::draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
+void CircleTool::rasterize(SpanMask* mask) {
   if (wantsMorePositions()) {
     return;
   }
@@ -71,19 +62,19 @@ void CircleTool::draw(BlockPrototype* prototype, const BlockOrientation* orienta
   a *= 8*a; b1 = 8*b*b;
 
   do {
-    setPixel(x1, start.y(), y0, prototype, orientation, transaction); /*   I. Quadrant */
-    setPixel(x0, start.y(), y0, prototype, orientation, transaction); /*  II. Quadrant */
-    setPixel(x0, start.y(), y1, prototype, orientation, transaction); /* III. Quadrant */
-    setPixel(x1, start.y(), y1, prototype, orientation, transaction); /*  IV. Quadrant */
+    mask->addCell(x1, start.y(), y0); /*   I. Quadrant */
+    mask->addCell(x0, start.y(), y0); /*  II. Quadrant */
+    mask->addCell(x0, start.y(), y1); /* III. Quadrant */
+    mask->addCell(x1, start.y(), y1); /*  IV. Quadrant */
     e2 = 2*err;
     if (e2 <= dy) { y0++; y1--; err += dy += a; }  /* y step */
     if (e2 >= dx || 2*err > dy) { x0++; x1--; err += dx += b1; } /* x step */
   } while (x0 <= x1);
 
   while (y0-y1 < b) {  /* too early stop of flat ellipses a=1 */
-    setPixel(x0-1, start.y(), y0, prototype, orientation, transaction); /* -> finish tip of ellipse */
-    setPixel(x1+1, start.y(), y0++, prototype, orientation, transaction);
-    setPixel(x0-1, start.y(), y1, prototype, orientation, transaction);
-    setPixel(x1+1, start.y(), y1--, prototype, orientation, transaction);
+    mask->addCell(x0-1, start.y(), y0); /* -> finish tip of ellipse */
+    mask->addCell(x1+1, start.y(), y0++);
+    mask->addCell(x0-1, start.y(), y1);
+    mask->addCell(x1+1, start.y(), y1--);
   }
 }
@@ -17,24 +17,22 @@
 #define CIRCLE_TOOL_H
 
 #include "block_position.h"
-#include "tool.h"
+#include "shape_tool.h"
 
-class BlockOracle;
+class Diagram;
 
 /**
   * A Tool that draws hollow ellipses between two corners.
   */
-class CircleTool : public Tool {
+class CircleTool : public ShapeTool {
  public:
-  explicit CircleTool(BlockOracle* oracle);
+  explicit CircleTool(Diagram* diagram);
   virtual QString actionName() const;
   virtual bool wantsMorePositions();
   virtual bool isBrush() const;
-  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
 
- private:
-  void setPixel(int x, int y, int z, BlockPrototype *prototype, const BlockOrientation *orientation, BlockTransaction *transaction);
-  BlockOracle* oracle_;
+ protected:
+  virtual void rasterize(SpanMask* mask);
 };
 
 #endif // CIRCLE_TOOL_H
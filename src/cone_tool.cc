@@ -0,0 +1,30 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cone_tool.h"
+
+#include "span_mask.h"
+
+ConeTool::ConeTool(Diagram* diagram) : SolidTool(diagram) {}
+
+QString ConeTool::actionName() const {
+  return "Draw Cone";
+}
+
+void ConeTool::rasterizeLevel(SpanMask* mask, int level, int height) {
+  // At w half blocks above the base, the slice is the footprint ellipse scaled by 1 - w / (2 * height).
+  qint64 remaining = 2 * qint64(height) - (2 * level + 1);
+  addEllipticRing(mask, level, remaining * remaining, -1, 4 * qint64(height) * height);
+}
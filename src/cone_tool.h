@@ -0,0 +1,35 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONE_TOOL_H
+#define CONE_TOOL_H
+
+#include "solid_tool.h"
+
+class Diagram;
+
+/**
+  * A Tool that draws upright cones whose base is the circle or ellipse filling the footprint between two corners.
+  */
+class ConeTool : public SolidTool {
+ public:
+  explicit ConeTool(Diagram* diagram);
+  virtual QString actionName() const;
+
+ protected:
+  virtual void rasterizeLevel(SpanMask* mask, int level, int height);
+};
+
+#endif // CONE_TOOL_H
@@ -0,0 +1,28 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cylinder_tool.h"
+
+#include "span_mask.h"
+
+CylinderTool::CylinderTool(Diagram* diagram) : SolidTool(diagram) {}
+
+QString CylinderTool::actionName() const {
+  return "Draw Cylinder";
+}
+
+void CylinderTool::rasterizeLevel(SpanMask* mask, int level, int /* height */) {
+  addEllipticRing(mask, level, 1, -1, 1);
+}
@@ -15,19 +15,33 @@
 
 #include "diagram.h"
 
+#include <QBitArray>
 #include <QDataStream>
 #include <QPair>
+#include <QtConcurrentMap>
 
+#include "block_clipboard.h"
 #include "block_manager.h"
 #include "block_orientation.h"
+#include "block_region.h"
+#include "block_replacement.h"
 #include "block_transaction.h"
+#include "chunk_position.h"
+#include "diagram_subscription.h"
 #include "line_tool.h"
+#include "span_mask.h"
 
 /**
   * The current version of the MCModeler file format.  This must be increased whenever a backwards-incompatible change
   * is made.  The nybbles roughly correspond to major, minor, and maintenance version numbers.
   */
-static const quint32 kCurrentFileFormatVersion = 0x130;
+static const quint32 kCurrentFileFormatVersion = 0x140;
+
+/**
+  * The oldest version of the file format that can still be read correctly.  Version 0x130 stored block orientations
+  * as strings rather than as ids.
+  */
+static const quint32 kOldestReadableFileFormatVersion = 0x130;
 
 /**
   * The number of bytes we are holding reserved for future expansion.  These will all be set to zero when writing out
@@ -58,7 +72,212 @@ class ScopedTransactionCommitter {
   const BlockTransaction& transaction_;
 };
 
-Diagram::Diagram(QObject* parent) : QObject(parent), block_mgr_(NULL) {
+/**
+  * Buckets the blocks of a BlockTransaction by the chunk they lie in, so that the transaction can be sliced for any
+  * number of BlockRegions without each of them having to look at every block.  The bucketing is only done once some
+  * region actually needs it.
+  */
+class ChunkedTransaction {
+ public:
+  explicit ChunkedTransaction(const BlockTransaction& transaction)
+      : transaction_(transaction),
+        is_bucketed_(false) {
+  }
+
+  /**
+    * Returns the part of the transaction that lies inside \p region.  Chunks that lie entirely outside the region are
+    * skipped without examining their blocks, and chunks that lie entirely inside it are copied without testing each
+    * block.
+    */
+  BlockTransaction slice(const BlockRegion& region) {
+    if (region.isEverything()) {
+      return transaction_;
+    }
+    if (!is_bucketed_) {
+      foreach (const BlockInstance& old_block, transaction_.old_blocks()) {
+        old_blocks_[ChunkPosition::containing(old_block.position())].append(old_block);
+      }
+      foreach (const BlockInstance& new_block, transaction_.new_blocks()) {
+        new_blocks_[ChunkPosition::containing(new_block.position())].append(new_block);
+      }
+      is_bucketed_ = true;
+    }
+
+    // The slice is part of a transaction that already has at most one change per position, so it can be handed over
+    // in bulk.
+    QList<BlockInstance> old_blocks;
+    QList<BlockInstance> new_blocks;
+    appendSlice(region, old_blocks_, &old_blocks);
+    appendSlice(region, new_blocks_, &new_blocks);
+    BlockTransaction slice;
+    slice.replaceBlocks(old_blocks, new_blocks);
+    return slice;
+  }
+
+ private:
+  /**
+    * Appends the blocks in \p blocks that lie inside \p region to \p slice.
+    */
+  static void appendSlice(const BlockRegion& region,
+                          const QHash<ChunkPosition, QList<BlockInstance> >& blocks,
+                          QList<BlockInstance>* slice) {
+    QHash<ChunkPosition, QList<BlockInstance> >::const_iterator iter;
+    for (iter = blocks.constBegin(); iter != blocks.constEnd(); ++iter) {
+      if (!region.intersectsChunk(iter.key())) {
+        continue;
+      }
+      if (region.containsChunk(iter.key())) {
+        *slice += iter.value();
+        continue;
+      }
+      foreach (const BlockInstance& block, iter.value()) {
+        if (region.contains(block.position())) {
+          slice->append(block);
+        }
+      }
+    }
+  }
+
+  BlockTransaction transaction_;
+  bool is_bucketed_;
+  QHash<ChunkPosition, QList<BlockInstance> > old_blocks_;
+  QHash<ChunkPosition, QList<BlockInstance> > new_blocks_;
+};
+
+/**
+  * Returns the block in the cell with index \p cell of \p layer, which is the layer at local height \p y of the chunk
+  * at \p chunk_position.
+  */
+static BlockInstance blockInLayer(const ChunkPosition& chunk_position, int y, const ChunkLayer& layer, int cell) {
+  const ChunkLayer::PaletteEntry& entry = layer.paletteEntry(layer.paletteIndexAt(cell));
+  BlockPosition offset(cell & kChunkMask, y, cell >> kChunkShift);
+  return BlockInstance(entry.prototype(), chunk_position.minimumBlock() + offset, entry.orientation());
+}
+
+/**
+  * Returns the layer at local height \p y of the chunk at \p chunk_position in \p chunks, or NULL if there is no such
+  * chunk or the layer holds nothing but air.
+  */
+static const ChunkLayer* nonEmptyLayer(const QHash<ChunkPosition, Chunk>& chunks,
+                                       const ChunkPosition& chunk_position,
+                                       int y) {
+  QHash<ChunkPosition, Chunk>::const_iterator chunk = chunks.constFind(chunk_position);
+  if (chunk == chunks.constEnd() || chunk.value().layer(y).isEmpty()) {
+    return NULL;
+  }
+  return &chunk.value().layer(y);
+}
+
+/**
+  * One chunk's share of the work of Diagram::findAndReplace(), which hands a list of these to QtConcurrent.
+  */
+class ChunkReplacementJob {
+ public:
+  ChunkReplacementJob(const ChunkPosition& chunk_position, const Chunk& chunk, const BlockReplacement* replacement)
+      : chunk_position_(chunk_position), chunk_(chunk), replacement_(replacement) {}
+
+  const ChunkPosition& chunkPosition() const {
+    return chunk_position_;
+  }
+
+  const Chunk& chunk() const {
+    return chunk_;
+  }
+
+  const BlockReplacement& replacement() const {
+    return *replacement_;
+  }
+
+ private:
+  ChunkPosition chunk_position_;
+  // A shallow copy, so the job stays valid without holding on to the Diagram.
+  Chunk chunk_;
+  const BlockReplacement* replacement_;
+};
+
+/**
+  * The blocks a ChunkReplacementJob removes and adds, in that order.
+  */
+typedef QPair<QList<BlockInstance>, QList<BlockInstance> > ChunkReplacementResult;
+
+/**
+  * Finds the blocks in the chunk of \p job that match its replacement and records their replacements.  Each layer's
+  * palette is checked first, and layers with no matching entry are skipped without looking at any of their cells, so
+  * chunks that don't contain the blocks being looked for cost next to nothing.  Used as the map function by
+  * Diagram::findAndReplace(), so it only reads from its arguments.
+  */
+static ChunkReplacementResult replaceInChunk(const ChunkReplacementJob& job) {
+  ChunkReplacementResult result;
+  const BlockReplacement& replacement = job.replacement();
+  bool whole_chunk = replacement.region().containsChunk(job.chunkPosition());
+  // For each palette index of the current layer, whether it matches, and what replaces it.
+  QBitArray matches;
+  QVector<const BlockOrientation*> orientations;
+  for (int y = 0; y < kChunkSize; ++y) {
+    const ChunkLayer& layer = job.chunk().layer(y);
+    if (layer.isEmpty()) {
+      continue;
+    }
+    const QVector<ChunkLayer::PaletteEntry>& palette = layer.palette();
+    matches.fill(false, palette.size());
+    orientations.resize(palette.size());
+    bool any_matches = false;
+    for (int i = 1; i < palette.size(); ++i) {
+      const ChunkLayer::PaletteEntry& entry = palette.at(i);
+      if (entry.count() && replacement.matches(entry.prototype(), entry.orientation())) {
+        matches.setBit(i);
+        orientations[i] = replacement.replacementOrientation(entry.orientation());
+        any_matches = true;
+      }
+    }
+    if (!any_matches) {
+      continue;
+    }
+    for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+      int index = layer.paletteIndexAt(cell);
+      if (!matches.testBit(index)) {
+        continue;
+      }
+      BlockInstance old_block = blockInLayer(job.chunkPosition(), y, layer, cell);
+      if (!whole_chunk && !replacement.region().contains(old_block.position())) {
+        continue;
+      }
+      result.first.append(old_block);
+      if (replacement.replacementPrototype()) {
+        result.second.append(BlockInstance(replacement.replacementPrototype(),
+                                           old_block.position(),
+                                           orientations.at(index)));
+      }
+    }
+  }
+  return result;
+}
+
+/**
+  * Returns whether the box \p first would cover if pasted at \p first_origin overlaps the one \p second would cover
+  * if pasted at \p second_origin.
+  */
+static bool boxesOverlap(const BlockPosition& first_origin,
+                         const BlockClipboard& first,
+                         const BlockPosition& second_origin,
+                         const BlockClipboard& second) {
+  return first_origin.x() < second_origin.x() + second.width() &&
+         second_origin.x() < first_origin.x() + first.width() &&
+         first_origin.y() < second_origin.y() + second.height() &&
+         second_origin.y() < first_origin.y() + first.height() &&
+         first_origin.z() < second_origin.z() + second.depth() &&
+         second_origin.z() < first_origin.z() + first.depth();
+}
+
+Diagram::Diagram(QObject* parent) : QObject(parent), block_count_(0), block_mgr_(NULL) {
+}
+
+Diagram::~Diagram() {
+  // The subscriptions are owned by the views, which may well outlive us.  Make sure they don't call back into a
+  // deleted diagram when they are destroyed.
+  foreach (DiagramSubscription* subscription, subscriptions_) {
+    subscription->diagram_ = NULL;
+  }
 }
 
 BlockManager* Diagram::blockManager() const {
@@ -84,11 +303,11 @@ void Diagram::load(QDataStream* stream) {
     error_dialog->exec();
     return;
   }
-  if (version != kCurrentFileFormatVersion) {
+  if (version < kOldestReadableFileFormatVersion || version > kCurrentFileFormatVersion) {
     QMessageBox* error_dialog = new QMessageBox();
     error_dialog->setAttribute(Qt::WA_DeleteOnClose, true);
     error_dialog->setWindowTitle(qAppName());
-    if (version < kCurrentFileFormatVersion) {
+    if (version < kOldestReadableFileFormatVersion) {
       error_dialog->setText("The diagram you have selected was created using an older version of MCModeler.");
       error_dialog->setInformativeText("The save file format has changed in an incompatible way since then. "
                                        "You can try to open it anyway, but it will almost certainly display "
@@ -121,12 +340,22 @@ void Diagram::load(QDataStream* stream) {
   ScopedTransactionCommitter committer(this, transaction);
 
   // Completely nuke the document.
-  foreach (const BlockInstance& block, block_map_.values()) {
-    transaction.clearBlock(block);
+  QHash<ChunkPosition, Chunk>::const_iterator iter;
+  for (iter = chunks_.constBegin(); iter != chunks_.constEnd(); ++iter) {
+    for (int y = 0; y < kChunkSize; ++y) {
+      const ChunkLayer& layer = iter.value().layer(y);
+      for (int cell = 0; !layer.isEmpty() && cell < kChunkLayerArea; ++cell) {
+        if (layer.paletteIndexAt(cell)) {
+          transaction.clearBlock(blockInLayer(iter.key(), y, layer, cell));
+        }
+      }
+    }
   }
 
+  BlockInstance::OrientationFormat orientation_format =
+      version < 0x140 ? BlockInstance::kOrientationFormatName : BlockInstance::kOrientationFormatId;
   while (!stream->atEnd()) {
-    BlockInstance new_block(stream, blockManager());
+    BlockInstance new_block(stream, blockManager(), orientation_format);
     transaction.setBlock(new_block);
   }
 }
@@ -142,23 +371,19 @@ void Diagram::save(QDataStream* stream) {
   stream->writeRawData(reserved, kNumReservedBytes);
   delete[] reserved;
   *stream << static_cast<qint32>(blockCount());
-  QHash<BlockPosition, BlockInstance>::const_iterator iter;
-  for (iter = block_map_.constBegin(); iter != block_map_.constEnd(); ++iter) {
-    const BlockInstance& instance = iter.value();
-    instance.serialize(stream);
+  QHash<ChunkPosition, Chunk>::const_iterator iter;
+  for (iter = chunks_.constBegin(); iter != chunks_.constEnd(); ++iter) {
+    for (int y = 0; y < kChunkSize; ++y) {
+      const ChunkLayer& layer = iter.value().layer(y);
+      for (int cell = 0; !layer.isEmpty() && cell < kChunkLayerArea; ++cell) {
+        if (layer.paletteIndexAt(cell)) {
+          blockInLayer(iter.key(), y, layer, cell).serialize(stream);
+        }
+      }
+    }
   }
 }
 
-void Diagram::addBlockInternal(const BlockInstance& block) {
-  Q_ASSERT(block.prototype()->type() != kBlockTypeAir);
-  const BlockPosition& position = block.position();
-  block_map_.insert(position, block);
-  // TODO(phoenix): This assumes top-down.  Will need to customize.
-  int level = position.y();
-  QHash<BlockPosition, BlockInstance>& level_map = block_list_[level];
-  level_map.insert(position, block);
-}
-
 void Diagram::ephemerallyAddBlockInternal(const BlockInstance& block) {
   Q_ASSERT(block.prototype()->type() != kBlockTypeAir);
   const BlockPosition& position = block.position();
@@ -171,64 +396,185 @@ void Diagram::ephemerallyRemoveBlockInternal(const BlockInstance& block) {
   ephemeral_block_removals_.insert(position, block);
 }
 
-void Diagram::removeBlockInternal(const BlockPosition& position) {
-  block_map_.remove(position);
-  // TODO(phoenix): This assumes top-down.  Will need to customize.
-  int level = position.y();
-  QHash<BlockPosition, BlockInstance>& level_map = block_list_[level];
-  level_map.remove(position);
-}
-
 void Diagram::commit(const BlockTransaction& transaction) {
+  // Committing throws away the ephemeral blocks, so subscribers showing any need to retract them.
+  BlockTransaction retracted = ephemeralTransaction();
   ephemeral_blocks_.clear();
   ephemeral_block_removals_.clear();
+  // Layers the transaction shares with us are adopted whole once the other changes are made, so the blocks in them
+  // are skipped below.  This records which local heights of each chunk are shared, one bit per height.
+  QHash<ChunkPosition, quint32> shared_heights;
+  foreach (const BlockTransaction::SharedLayer& shared_layer, transaction.sharedLayers()) {
+    shared_heights[shared_layer.chunkPosition()] |= 1u << shared_layer.y();
+  }
+  // Transactions are usually built a row at a time, so consecutive blocks tend to share a chunk.  Hang on to the last
+  // chunk touched rather than hashing every position again.
+  Chunk* chunk = NULL;
+  ChunkPosition chunk_position;
+  quint32 chunk_shared_heights = 0;
   foreach (const BlockInstance& old_block, transaction.old_blocks()) {
-    removeBlockInternal(old_block.position());
+    const BlockPosition& position = old_block.position();
+    ChunkPosition block_chunk_position = ChunkPosition::containing(position);
+    if (!chunk || block_chunk_position != chunk_position) {
+      QHash<ChunkPosition, Chunk>::iterator iter = chunks_.find(block_chunk_position);
+      if (iter == chunks_.end()) {
+        chunk = NULL;
+        continue;
+      }
+      chunk = &iter.value();
+      chunk_position = block_chunk_position;
+      chunk_shared_heights = shared_heights.value(chunk_position);
+    }
+    int y = ChunkPosition::localCoordinate(position.y());
+    if (chunk_shared_heights & (1u << y)) {
+      continue;
+    }
+    int old_count = chunk->blockCount();
+    chunk->clearBlock(ChunkPosition::localCoordinate(position.x()), y, ChunkPosition::localCoordinate(position.z()));
+    block_count_ += chunk->blockCount() - old_count;
+    if (chunk->isEmpty()) {
+      chunks_.remove(chunk_position);
+      chunk = NULL;
+    }
   }
+  chunk = NULL;
   foreach (const BlockInstance& new_block, transaction.new_blocks()) {
-    addBlockInternal(new_block);
+    Q_ASSERT(new_block.prototype()->type() != kBlockTypeAir);
+    const BlockPosition& position = new_block.position();
+    ChunkPosition block_chunk_position = ChunkPosition::containing(position);
+    if (!chunk || block_chunk_position != chunk_position) {
+      chunk_position = block_chunk_position;
+      chunk_shared_heights = shared_heights.value(chunk_position);
+      chunk = &chunks_[chunk_position];
+    }
+    int y = ChunkPosition::localCoordinate(position.y());
+    if (chunk_shared_heights & (1u << y)) {
+      continue;
+    }
+    int old_count = chunk->blockCount();
+    chunk->setBlock(ChunkPosition::localCoordinate(position.x()),
+                    y,
+                    ChunkPosition::localCoordinate(position.z()),
+                    new_block.prototype(),
+                    new_block.orientation());
+    block_count_ += chunk->blockCount() - old_count;
+  }
+  foreach (const BlockTransaction::SharedLayer& shared_layer, transaction.sharedLayers()) {
+    QHash<ChunkPosition, Chunk>::iterator iter = chunks_.find(shared_layer.chunkPosition());
+    if (iter == chunks_.end()) {
+      if (shared_layer.layer().isEmpty()) {
+        continue;
+      }
+      iter = chunks_.insert(shared_layer.chunkPosition(), Chunk());
+    }
+    int old_count = iter.value().blockCount();
+    iter.value().setLayer(shared_layer.y(), shared_layer.layer());
+    block_count_ += iter.value().blockCount() - old_count;
+    if (iter.value().isEmpty()) {
+      chunks_.erase(iter);
+    }
+  }
+  // The new blocks may have created chunks in shared layers without putting anything in them.
+  for (QHash<ChunkPosition, quint32>::const_iterator iter = shared_heights.constBegin();
+       iter != shared_heights.constEnd(); ++iter) {
+    QHash<ChunkPosition, Chunk>::iterator chunk_iter = chunks_.find(iter.key());
+    if (chunk_iter != chunks_.end() && chunk_iter.value().isEmpty()) {
+      chunks_.erase(chunk_iter);
+    }
   }
-  emit ephemeralBlocksChanged(transaction);
   emit diagramChanged(transaction);
+  publish(transaction);
+  if (!retracted.isEmpty()) {
+    emit ephemeralBlocksChanged(retracted, BlockTransaction());
+    publishEphemeral(retracted, BlockTransaction());
+  }
 }
 
 void Diagram::commitEphemeral(const BlockTransaction& transaction) {
-  ephemeral_blocks_.clear();
-  ephemeral_block_removals_.clear();
+  patchEphemeral(ephemeralTransaction(), transaction);
+}
+
+void Diagram::patchEphemeral(const BlockTransaction& retracted, const BlockTransaction& transaction) {
+  foreach (const BlockInstance& old_block, retracted.old_blocks()) {
+    ephemeral_block_removals_.remove(old_block.position());
+  }
+  foreach (const BlockInstance& new_block, retracted.new_blocks()) {
+    ephemeral_blocks_.remove(new_block.position());
+  }
   foreach (const BlockInstance& old_block, transaction.old_blocks()) {
     ephemerallyRemoveBlockInternal(old_block);
   }
   foreach (const BlockInstance& new_block, transaction.new_blocks()) {
     ephemerallyAddBlockInternal(new_block);
   }
-  emit ephemeralBlocksChanged(transaction);
+  emit ephemeralBlocksChanged(retracted, transaction);
+  publishEphemeral(retracted, transaction);
 }
 
-void Diagram::copyLevel(int source_level, int dest_level) {
-  QHash<BlockPosition, BlockInstance>& source_level_map = block_list_[source_level];
-  QHash<BlockPosition, BlockInstance>& dest_level_map = block_list_[dest_level];
+BlockTransaction Diagram::ephemeralTransaction() const {
+  BlockTransaction transaction;
+  transaction.replaceBlocks(ephemeral_block_removals_.values(), ephemeral_blocks_.values());
+  return transaction;
+}
+
+DiagramSubscription* Diagram::subscribe(const BlockRegion& region, QObject* parent) {
+  DiagramSubscription* subscription = new DiagramSubscription(this, region, parent);
+  subscriptions_.append(subscription);
+  return subscription;
+}
+
+void Diagram::unsubscribe(DiagramSubscription* subscription) {
+  subscriptions_.removeAll(subscription);
+}
+
+void Diagram::publish(const BlockTransaction& transaction) {
+  ChunkedTransaction chunked_transaction(transaction);
+  foreach (DiagramSubscription* subscription, subscriptions_) {
+    subscription->deliverChanges(chunked_transaction.slice(subscription->region()));
+  }
+}
 
+void Diagram::publishEphemeral(const BlockTransaction& retracted, const BlockTransaction& transaction) {
+  ChunkedTransaction chunked_retracted(retracted);
+  ChunkedTransaction chunked_transaction(transaction);
+  foreach (DiagramSubscription* subscription, subscriptions_) {
+    subscription->deliverEphemeralChanges(chunked_retracted.slice(subscription->region()),
+                                          chunked_transaction.slice(subscription->region()));
+  }
+}
+
+void Diagram::copyLevel(int source_level, int dest_level) {
   BlockTransaction transaction;
   ScopedTransactionCommitter committer(this, transaction);
 
   // Remove all blocks in the dest level.
-  foreach (const BlockPosition& key, dest_level_map.keys()) {
-    transaction.clearBlock(dest_level_map.value(key));
+  foreach (const BlockInstance& dest_instance, level(dest_level)) {
+    transaction.clearBlock(dest_instance);
   }
 
   // Add all blocks in the source level to the dest level, adjusting their altitudes.
-  foreach (const BlockPosition& source_position, source_level_map.keys()) {
-    BlockPosition dest_position = source_position + BlockPosition(0, dest_level - source_level, 0);
-    BlockInstance invalid_instance(NULL, BlockPosition(0, 0, 0), NULL);
-    BlockInstance source_instance = source_level_map.value(source_position, invalid_instance);
-    // The value() call should never return invalid_instance, since we got the key from the map
-    // just before we called value() with it.
-    Q_ASSERT(source_instance.prototype());
-    BlockInstance dest_instance(source_instance.prototype(), dest_position, source_instance.orientation());
+  BlockPosition offset(0, dest_level - source_level, 0);
+  foreach (const BlockInstance& source_instance, level(source_level)) {
+    BlockInstance dest_instance(source_instance.prototype(),
+                                source_instance.position() + offset,
+                                source_instance.orientation());
     // Since we already cleared the dest level, we can safely call setBlock instead of replaceBlock
     // since we know there's nothing to replace.
     transaction.setBlock(dest_instance);
   }
+
+  // Levels are made of whole chunk layers, so the copy can share the source level's layers rather than building its
+  // own.  Layers of the dest level with no counterpart in the source level were emptied by the changes above.
+  int source_chunk_y = ChunkPosition::chunkCoordinate(source_level);
+  int dest_chunk_y = ChunkPosition::chunkCoordinate(dest_level);
+  for (QHash<ChunkPosition, Chunk>::const_iterator iter = chunks_.constBegin(); iter != chunks_.constEnd(); ++iter) {
+    const ChunkLayer& layer = iter.value().layer(ChunkPosition::localCoordinate(source_level));
+    if (iter.key().y() == source_chunk_y && !layer.isEmpty()) {
+      transaction.shareLayer(ChunkPosition(iter.key().x(), dest_chunk_y, iter.key().z()),
+                             ChunkPosition::localCoordinate(dest_level),
+                             layer);
+    }
+  }
 }
 
 BlockInstance Diagram::blockAt(const BlockPosition& position, BlockOracle::Mode mode) {
@@ -240,7 +586,18 @@ BlockInstance Diagram::blockAt(const BlockPosition& position, BlockOracle::Mode
       return ephemeral_blocks_.value(position, default_value);
     }
   }
-  return block_map_.value(position, default_value);
+  QHash<ChunkPosition, Chunk>::const_iterator iter = chunks_.constFind(ChunkPosition::containing(position));
+  if (iter == chunks_.constEnd()) {
+    return default_value;
+  }
+  int x = ChunkPosition::localCoordinate(position.x());
+  int y = ChunkPosition::localCoordinate(position.y());
+  int z = ChunkPosition::localCoordinate(position.z());
+  BlockPrototype* prototype = iter.value().prototypeAt(x, y, z);
+  if (!prototype) {
+    return default_value;
+  }
+  return BlockInstance(prototype, position, iter.value().orientationAt(x, y, z));
 }
 
 bool Diagram::levelsAreVertical() const {
@@ -250,69 +607,351 @@ bool Diagram::levelsAreVertical() const {
   return false;
 }
 
-QHash<BlockPosition, BlockInstance> Diagram::level(int level_index) {
-  return block_list_.value(level_index);
+DiagramSlice Diagram::level(int level_index) const {
+  // TODO(phoenix): This assumes top-down.  Will need to customize.
+  return slice(DiagramSlice::kYAxis, level_index);
 }
 
-// TODO(phoenix): This probably shouldn't be in the model.  Move it somewhere else?
-void Diagram::render() {
-  QVector<const BlockInstance*> transparent_blocks;
-  QHash<BlockPosition, BlockInstance>::const_iterator iter;
+DiagramSlice Diagram::slice(DiagramSlice::Axis axis, int coordinate) const {
+  return DiagramSlice(chunks_, axis, coordinate);
+}
 
-  // Try to give the compiler as much opportunity to optimize this branch out as possible.
-  bool need_to_consider_ephemeral_removals = (ephemeral_block_removals_.size() > 0);
-  if (Q_UNLIKELY(need_to_consider_ephemeral_removals)) {
-    // Slow path: ephemeral removals to consider.
-    for (iter = block_map_.constBegin(); iter != block_map_.constEnd(); ++iter) {
-      if (ephemeral_block_removals_.contains(iter.key())) {
+ChunkCursor Diagram::cursor() const {
+  return ChunkCursor(chunks_);
+}
+
+QHash<ChunkPosition, Chunk> Diagram::chunks() const {
+  return chunks_;
+}
+
+void Diagram::fillSpans(const SpanMask& mask,
+                        BlockPrototype* prototype,
+                        const BlockOrientation* orientation,
+                        BlockTransaction* transaction) const {
+  bool is_clearing = !prototype || prototype->type() == kBlockTypeAir;
+  QList<BlockInstance> old_blocks;
+  QList<BlockInstance> new_blocks;
+  if (!is_clearing) {
+    new_blocks.reserve(mask.cellCount());
+  }
+  foreach (const BlockSpan& span, mask.spans()) {
+    int y = span.y();
+    int z = span.z();
+    int local_y = ChunkPosition::localCoordinate(y);
+    int local_z = ChunkPosition::localCoordinate(z);
+    for (int x = span.firstX(); x <= span.lastX(); ) {
+      // The last cell of the span that lies in the same chunk as x.
+      int piece_end = qMin(span.lastX(), x | kChunkMask);
+      ChunkPosition chunk_position(ChunkPosition::chunkCoordinate(x),
+                                   ChunkPosition::chunkCoordinate(y),
+                                   ChunkPosition::chunkCoordinate(z));
+      QHash<ChunkPosition, Chunk>::const_iterator chunk = chunks_.constFind(chunk_position);
+      if (chunk != chunks_.constEnd() && !chunk.value().layer(local_y).isEmpty()) {
+        const ChunkLayer& layer = chunk.value().layer(local_y);
+        for (int piece_x = x; piece_x <= piece_end; ++piece_x) {
+          int cell = ChunkLayer::cellIndex(ChunkPosition::localCoordinate(piece_x), local_z);
+          if (layer.paletteIndexAt(cell)) {
+            old_blocks.append(blockInLayer(chunk_position, local_y, layer, cell));
+          }
+        }
+      }
+      if (!is_clearing) {
+        for (int piece_x = x; piece_x <= piece_end; ++piece_x) {
+          new_blocks.append(BlockInstance(prototype, BlockPosition(piece_x, y, z), orientation));
+        }
+      }
+      x = piece_end + 1;
+    }
+  }
+  transaction->replaceBlocks(old_blocks, new_blocks);
+}
+
+BlockClipboard Diagram::copyRegion(const BlockPosition& corner, const BlockPosition& opposite_corner) const {
+  BlockPosition min(qMin(corner.x(), opposite_corner.x()),
+                    qMin(corner.y(), opposite_corner.y()),
+                    qMin(corner.z(), opposite_corner.z()));
+  BlockPosition max(qMax(corner.x(), opposite_corner.x()),
+                    qMax(corner.y(), opposite_corner.y()),
+                    qMax(corner.z(), opposite_corner.z()));
+  BlockClipboard clipboard(max.x() - min.x() + 1, max.y() - min.y() + 1, max.z() - min.z() + 1);
+  ChunkPosition min_chunk = ChunkPosition::containing(min);
+  ChunkPosition max_chunk = ChunkPosition::containing(max);
+  for (int chunk_y = min_chunk.y(); chunk_y <= max_chunk.y(); ++chunk_y) {
+    for (int chunk_z = min_chunk.z(); chunk_z <= max_chunk.z(); ++chunk_z) {
+      for (int chunk_x = min_chunk.x(); chunk_x <= max_chunk.x(); ++chunk_x) {
+        ChunkPosition chunk_position(chunk_x, chunk_y, chunk_z);
+        QHash<ChunkPosition, Chunk>::const_iterator chunk = chunks_.constFind(chunk_position);
+        if (chunk == chunks_.constEnd() || chunk.value().isEmpty()) {
+          continue;
+        }
+        // The part of the box inside this chunk, in coordinates local to the chunk.
+        BlockPosition chunk_min = chunk_position.minimumBlock();
+        BlockPosition first(qMax(min.x(), chunk_min.x()) - chunk_min.x(),
+                            qMax(min.y(), chunk_min.y()) - chunk_min.y(),
+                            qMax(min.z(), chunk_min.z()) - chunk_min.z());
+        BlockPosition last(qMin(max.x(), chunk_min.x() + kChunkMask) - chunk_min.x(),
+                           qMin(max.y(), chunk_min.y() + kChunkMask) - chunk_min.y(),
+                           qMin(max.z(), chunk_min.z() + kChunkMask) - chunk_min.z());
+        for (int y = first.y(); y <= last.y(); ++y) {
+          const ChunkLayer& layer = chunk.value().layer(y);
+          if (layer.isEmpty()) {
+            continue;
+          }
+          for (int z = first.z(); z <= last.z(); ++z) {
+            for (int x = first.x(); x <= last.x(); ++x) {
+              int index = layer.paletteIndexAt(ChunkLayer::cellIndex(x, z));
+              if (!index) {
+                continue;
+              }
+              const ChunkLayer::PaletteEntry& entry = layer.paletteEntry(index);
+              BlockPosition offset(chunk_min.x() + x - min.x(),
+                                   chunk_min.y() + y - min.y(),
+                                   chunk_min.z() + z - min.z());
+              clipboard.setBlock(offset, entry.prototype(), entry.orientation());
+            }
+          }
+        }
+      }
+    }
+  }
+  return clipboard;
+}
+
+void Diagram::paste(const BlockClipboard& clipboard, const BlockPosition& origin, BlockTransaction* transaction) const {
+  // Whether this paste is the whole transaction, in which case the layers it copies can be shared.
+  bool can_share_layers = transaction->isEmpty();
+  QList<BlockInstance> old_blocks;
+  QList<BlockInstance> new_blocks;
+  new_blocks.reserve(clipboard.blockCount());
+  pasteBlocks(clipboard, origin, &old_blocks, &new_blocks);
+  transaction->replaceBlocks(old_blocks, new_blocks);
+  if (can_share_layers) {
+    foreach (const BlockTransaction::SharedLayer& shared_layer, shareableLayers(clipboard, origin)) {
+      transaction->shareLayer(shared_layer.chunkPosition(), shared_layer.y(), shared_layer.layer());
+    }
+  }
+}
+
+void Diagram::pasteArray(const QList<BlockClipboard>& clipboards,
+                         const QList<BlockPosition>& origins,
+                         BlockTransaction* transaction) const {
+  Q_ASSERT(clipboards.size() == origins.size());
+  bool overlapping = false;
+  for (int i = 0; i < origins.size() && !overlapping; ++i) {
+    for (int j = i + 1; j < origins.size() && !overlapping; ++j) {
+      overlapping = boxesOverlap(origins.at(i), clipboards.at(i), origins.at(j), clipboards.at(j));
+    }
+  }
+  if (overlapping) {
+    // Later copies have to win wherever they overlap earlier ones, which is exactly what merging does.
+    for (int i = 0; i < clipboards.size(); ++i) {
+      BlockTransaction copy;
+      paste(clipboards.at(i), origins.at(i), &copy);
+      transaction->merge(copy);
+    }
+    return;
+  }
+
+  bool can_share_layers = transaction->isEmpty();
+  QList<BlockInstance> old_blocks;
+  QList<BlockInstance> new_blocks;
+  for (int i = 0; i < clipboards.size(); ++i) {
+    pasteBlocks(clipboards.at(i), origins.at(i), &old_blocks, &new_blocks);
+  }
+  transaction->replaceBlocks(old_blocks, new_blocks);
+  if (!can_share_layers) {
+    return;
+  }
+
+  // A layer one copy could share on its own can only be shared if no other copy lands in it too.  Find out which copy
+  // touches each chunk layer, or -1 for layers touched by more than one.
+  QHash<QPair<ChunkPosition, int>, int> layer_owners;
+  for (int i = 0; i < clipboards.size(); ++i) {
+    const BlockPosition& origin = origins.at(i);
+    const BlockClipboard& clipboard = clipboards.at(i);
+    for (int y = origin.y(); y < origin.y() + clipboard.height(); ++y) {
+      for (int chunk_z = ChunkPosition::chunkCoordinate(origin.z());
+           chunk_z <= ChunkPosition::chunkCoordinate(origin.z() + clipboard.depth() - 1); ++chunk_z) {
+        for (int chunk_x = ChunkPosition::chunkCoordinate(origin.x());
+             chunk_x <= ChunkPosition::chunkCoordinate(origin.x() + clipboard.width() - 1); ++chunk_x) {
+          QPair<ChunkPosition, int> key(ChunkPosition(chunk_x, ChunkPosition::chunkCoordinate(y), chunk_z),
+                                        ChunkPosition::localCoordinate(y));
+          QHash<QPair<ChunkPosition, int>, int>::iterator owner = layer_owners.find(key);
+          if (owner == layer_owners.end()) {
+            layer_owners.insert(key, i);
+          } else if (owner.value() != i) {
+            owner.value() = -1;
+          }
+        }
+      }
+    }
+  }
+  for (int i = 0; i < clipboards.size(); ++i) {
+    foreach (const BlockTransaction::SharedLayer& shared_layer, shareableLayers(clipboards.at(i), origins.at(i))) {
+      if (layer_owners.value(qMakePair(shared_layer.chunkPosition(), shared_layer.y())) == i) {
+        transaction->shareLayer(shared_layer.chunkPosition(), shared_layer.y(), shared_layer.layer());
+      }
+    }
+  }
+}
+
+void Diagram::findAndReplace(const BlockReplacement& replacement, BlockTransaction* transaction) const {
+  QList<ChunkReplacementJob> jobs;
+  for (QHash<ChunkPosition, Chunk>::const_iterator iter = chunks_.constBegin(); iter != chunks_.constEnd(); ++iter) {
+    if (replacement.region().intersectsChunk(iter.key())) {
+      jobs.append(ChunkReplacementJob(iter.key(), iter.value(), &replacement));
+    }
+  }
+  QList<ChunkReplacementResult> results =
+      QtConcurrent::blockingMapped<QList<ChunkReplacementResult> >(jobs, replaceInChunk);
+  QList<BlockInstance> old_blocks;
+  QList<BlockInstance> new_blocks;
+  foreach (const ChunkReplacementResult& result, results) {
+    old_blocks.append(result.first);
+    new_blocks.append(result.second);
+  }
+  transaction->replaceBlocks(old_blocks, new_blocks);
+}
+
+void Diagram::pasteBlocks(const BlockClipboard& clipboard,
+                          const BlockPosition& origin,
+                          QList<BlockInstance>* old_blocks,
+                          QList<BlockInstance>* new_blocks) const {
+  for (int y = 0; y < clipboard.height(); ++y) {
+    int dest_y = origin.y() + y;
+    for (int z = 0; z < clipboard.depth(); ++z) {
+      int dest_z = origin.z() + z;
+      for (int x = 0; x < clipboard.width(); ) {
+        // The last cell of the row that lies in the same chunk as x in both the clipboard and the diagram.
+        int piece_end = qMin(clipboard.width() - 1, qMin(x | kChunkMask, ((origin.x() + x) | kChunkMask) - origin.x()));
+        ChunkPosition dest_chunk(ChunkPosition::chunkCoordinate(origin.x() + x),
+                                 ChunkPosition::chunkCoordinate(dest_y),
+                                 ChunkPosition::chunkCoordinate(dest_z));
+        const ChunkLayer* dest_layer = nonEmptyLayer(chunks_, dest_chunk, ChunkPosition::localCoordinate(dest_y));
+        if (dest_layer) {
+          for (int piece_x = x; piece_x <= piece_end; ++piece_x) {
+            int cell = ChunkLayer::cellIndex(ChunkPosition::localCoordinate(origin.x() + piece_x),
+                                             ChunkPosition::localCoordinate(dest_z));
+            if (dest_layer->paletteIndexAt(cell)) {
+              old_blocks->append(blockInLayer(dest_chunk, ChunkPosition::localCoordinate(dest_y), *dest_layer, cell));
+            }
+          }
+        }
+        ChunkPosition source_chunk(ChunkPosition::chunkCoordinate(x),
+                                   ChunkPosition::chunkCoordinate(y),
+                                   ChunkPosition::chunkCoordinate(z));
+        const ChunkLayer* source_layer =
+            nonEmptyLayer(clipboard.chunks(), source_chunk, ChunkPosition::localCoordinate(y));
+        if (source_layer) {
+          for (int piece_x = x; piece_x <= piece_end; ++piece_x) {
+            int cell = ChunkLayer::cellIndex(ChunkPosition::localCoordinate(piece_x),
+                                             ChunkPosition::localCoordinate(z));
+            int index = source_layer->paletteIndexAt(cell);
+            if (index) {
+              const ChunkLayer::PaletteEntry& entry = source_layer->paletteEntry(index);
+              new_blocks->append(BlockInstance(entry.prototype(),
+                                              BlockPosition(origin.x() + piece_x, dest_y, dest_z),
+                                              entry.orientation()));
+            }
+          }
+        }
+        x = piece_end + 1;
+      }
+    }
+  }
+}
+
+QList<BlockTransaction::SharedLayer> Diagram::shareableLayers(const BlockClipboard& clipboard,
+                                                              const BlockPosition& origin) const {
+  QList<BlockTransaction::SharedLayer> shared_layers;
+  if (ChunkPosition::localCoordinate(origin.x()) != 0 || ChunkPosition::localCoordinate(origin.z()) != 0) {
+    return shared_layers;
+  }
+
+  // The clipboard's chunks line up with ours, so each of its layers lands in exactly one of ours.  Once pasted, our
+  // layer holds exactly what the clipboard's does if the box covers all of it, or if it held nothing but air before.
+  // Either way, we can share the clipboard's layer rather than build our own, so repeated pastes cost next to nothing.
+  for (QHash<ChunkPosition, Chunk>::const_iterator iter = clipboard.chunks().constBegin();
+       iter != clipboard.chunks().constEnd(); ++iter) {
+    BlockPosition source_min = iter.key().minimumBlock();
+    bool covers_layers = source_min.x() + kChunkSize <= clipboard.width() &&
+                         source_min.z() + kChunkSize <= clipboard.depth();
+    for (int y = 0; y < kChunkSize && source_min.y() + y < clipboard.height(); ++y) {
+      const ChunkLayer& layer = iter.value().layer(y);
+      if (layer.isEmpty()) {
         continue;
       }
-      const BlockInstance& b = iter.value();
-      if (b.prototype()->isTransparent()) {
-        transparent_blocks.append(&b);
-      } else {
-        b.render();
+      int dest_y = origin.y() + source_min.y() + y;
+      ChunkPosition dest_chunk(ChunkPosition::chunkCoordinate(origin.x()) + iter.key().x(),
+                               ChunkPosition::chunkCoordinate(dest_y),
+                               ChunkPosition::chunkCoordinate(origin.z()) + iter.key().z());
+      if (covers_layers || !nonEmptyLayer(chunks_, dest_chunk, ChunkPosition::localCoordinate(dest_y))) {
+        shared_layers.append(BlockTransaction::SharedLayer(dest_chunk, ChunkPosition::localCoordinate(dest_y), layer));
       }
     }
-  } else {
-    // Fast path: no ephemeral removals.
-    for (iter = block_map_.constBegin(); iter != block_map_.constEnd(); ++iter) {
-      const BlockInstance& b = iter.value();
-      if (b.prototype()->isTransparent()) {
-        transparent_blocks.append(&b);
-      } else {
-        b.render();
+  }
+  return shared_layers;
+}
+
+// TODO(phoenix): This probably shouldn't be in the model.  Move it somewhere else?
+void Diagram::render() {
+  QVector<BlockInstance> transparent_blocks;
+
+  // Blocks are stored by chunk rather than as BlockInstances, so each one is created just before it is drawn.  Try to
+  // give the compiler as much opportunity to optimize the ephemeral removal check out as possible.
+  bool need_to_consider_ephemeral_removals = (ephemeral_block_removals_.size() > 0);
+  QHash<ChunkPosition, Chunk>::const_iterator iter;
+  for (iter = chunks_.constBegin(); iter != chunks_.constEnd(); ++iter) {
+    for (int y = 0; y < kChunkSize; ++y) {
+      const ChunkLayer& layer = iter.value().layer(y);
+      for (int cell = 0; !layer.isEmpty() && cell < kChunkLayerArea; ++cell) {
+        if (!layer.paletteIndexAt(cell)) {
+          continue;
+        }
+        BlockInstance b = blockInLayer(iter.key(), y, layer, cell);
+        if (Q_UNLIKELY(need_to_consider_ephemeral_removals) && ephemeral_block_removals_.contains(b.position())) {
+          continue;
+        }
+        if (b.prototype()->isTransparent()) {
+          transparent_blocks.append(b);
+        } else {
+          b.render();
+        }
       }
     }
   }
 
-  for (iter = ephemeral_blocks_.constBegin(); iter != ephemeral_blocks_.constEnd(); ++iter) {
-    const BlockInstance& b = iter.value();
+  foreach (const BlockInstance& b, ephemeral_blocks_) {
     b.render();
   }
 
   // Render transparent blocks last.
-  QVector<const BlockInstance*>::const_iterator transparent_iter;
+  QVector<BlockInstance>::const_iterator transparent_iter;
   for (transparent_iter = transparent_blocks.constBegin();
        transparent_iter != transparent_blocks.constEnd();
        ++transparent_iter ) {
-    const BlockInstance* b = *transparent_iter;
-    b->render();
+    transparent_iter->render();
   }
 }
 
 int Diagram::blockCount() const {
-  return block_map_.size();
+  return block_count_;
 }
 
 QMap<blocktype_t, int> Diagram::blockCounts() const {
   QMap<blocktype_t, int> map;
-  foreach(const BlockInstance& instance, block_map_.values()) {
-    int count = 0;
-    if (map.contains(instance.prototype()->type())) {
-      count = map.value(instance.prototype()->type());
+  // Each layer's palette already knows how many of its cells use each prototype, so there's no need to visit the
+  // cells themselves.
+  foreach (const Chunk& chunk, chunks_) {
+    for (int y = 0; y < kChunkSize; ++y) {
+      foreach (const ChunkLayer::PaletteEntry& entry, chunk.layer(y).palette()) {
+        if (entry.count() == 0) {
+          continue;
+        }
+        blocktype_t type = entry.prototype()->type();
+        map.insert(type, map.value(type, 0) + entry.count());
+      }
     }
-    map.insert(instance.prototype()->type(), count + 1);
   }
   return map;
 }
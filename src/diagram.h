@@ -25,11 +25,20 @@
 #include "block_oracle.h"
 #include "block_position.h"
 #include "block_prototype.h"
+#include "block_transaction.h"
 #include "block_type.h"
+#include "chunk.h"
+#include "chunk_cursor.h"
+#include "chunk_position.h"
+#include "diagram_slice.h"
 
+class BlockClipboard;
 class BlockManager;
 class BlockOrientation;
-class BlockTransaction;
+class BlockRegion;
+class BlockReplacement;
+class DiagramSubscription;
+class SpanMask;
 
 /**
   * Represents a diagram containing block data for the world.
@@ -41,16 +50,19 @@ class BlockTransaction;
   * All operations on the Diagram take place within the scope of a BlockTransaction.  To make changes to the diagram,
   * create a BlockTransaction that describes the change you'd like to make and then call commit() on the Diagram
   * yourself.  Whenever a change is made to the diagram, the diagramChanged() signal is emitted with the transaction
-  * that was performed.
+  * that was performed.  Views should generally call subscribe() instead, which delivers just the slice of each
+  * transaction that falls inside a given BlockRegion, and coalesces bursts of commits into one update per frame.
   *
-  * Diagram treats the world as horizontal slices, each corresponding to a level in the LevelWidget.  You can get a
-  * map of a given level by calling the level() method.  You can also look up the block at a particular 3D location by
-  * calling the blockAt() method.
+  * Blocks are stored in Chunks, which are created as blocks are added to them and thrown away once they become empty.
+  * Diagram treats the world as horizontal slices, each corresponding to a level in the LevelWidget.  You can iterate
+  * over the blocks on a given level by calling the level() method, or over any other axis-aligned plane by calling
+  * slice().  You can also look up the block at a particular 3D location by calling the blockAt() method.
   */
 class Diagram : public QObject, public BlockOracle {
   Q_OBJECT
  public:
   Diagram(QObject* parent = NULL);
+  virtual ~Diagram();
 
   /**
     * Sets the block manager for this diagram.  The block manager is used to get the prototypes for blocks in the map.
@@ -90,7 +102,9 @@ class Diagram : public QObject, public BlockOracle {
   void load(QDataStream* stream);
 
   /**
-    * Creates and commits a BlockTransaction which copies all blocks on \p source_level to \p dest_level.
+    * Creates and commits a BlockTransaction which copies all blocks on \p source_level to \p dest_level.  The copy
+    * shares chunk layers with the original (see BlockTransaction::shareLayer()), so it takes up next to no memory
+    * until one of the two levels is changed.
     * @note A "level" is currently defined to be the set of blocks sharing a particular _y_ coordinate.
     */
   void copyLevel(int source_level, int dest_level);
@@ -101,13 +115,21 @@ class Diagram : public QObject, public BlockOracle {
   void commit(const BlockTransaction& transaction);
 
   /**
-    * Applies \p transaction to the diagram ephemerally.  Ephemeral commits will be temporarily reflected in the UI, but
-    * will not actually affect the underlying model until committed for real using commit().
-    * @note For technical reasons, although the parameter to ephemeralBlocksChanged() will be exactly \p transaction,
-    * ephemeral \i removals in particular will not be shown in the 3D preview.
+    * Applies \p transaction to the diagram ephemerally, replacing any ephemeral blocks that were there before.
+    * Ephemeral commits will be temporarily reflected in the UI, but will not actually affect the underlying model until
+    * committed for real using commit().
+    * @note For technical reasons, ephemeral \i removals will not be shown in the 3D preview.
     */
   void commitEphemeral(const BlockTransaction& transaction);
 
+  /**
+    * Changes the diagram's ephemeral blocks incrementally: the ephemeral changes in \p retracted are taken back, and
+    * those in \p transaction are then applied on top of the ones that remain.  Views are sent the same patch, so only
+    * the cells that actually changed have to be redrawn.  This is how tool previews follow the mouse (see
+    * Tool::drawPreview()).
+    */
+  void patchEphemeral(const BlockTransaction& retracted, const BlockTransaction& transaction);
+
   /**
     * Returns the number of blocks in the diagram.
     */
@@ -119,10 +141,87 @@ class Diagram : public QObject, public BlockOracle {
   QMap<blocktype_t, int> blockCounts() const;
 
   /**
-    * Returns all the blocks on the level \p level_index.  Each BlockInstance in the returned dictionary will have a
-    * _y_ coordinate of \p level_index, and will be keyed on its own position for easy lookup.
+    * Returns a view of all the blocks on the level \p level_index.  Each BlockInstance in the view will have a _y_
+    * coordinate of \p level_index.  Taking the view does not copy any blocks; see DiagramSlice for details.
+    */
+  DiagramSlice level(int level_index) const;
+
+  /**
+    * Returns a view of all the blocks in the plane perpendicular to \p axis at \p coordinate.
+    * @sa level()
+    */
+  DiagramSlice slice(DiagramSlice::Axis axis, int coordinate) const;
+
+  /**
+    * Returns a ChunkCursor for fast lookups of physical blocks by position.  Ephemeral blocks are not included.
+    */
+  ChunkCursor cursor() const;
+
+  /**
+    * Returns the chunks holding the physical blocks, keyed by position.  Like cursor(), this is an implicitly shared
+    * snapshot, so taking it copies no blocks.
+    */
+  QHash<ChunkPosition, Chunk> chunks() const;
+
+  /**
+    * Records in \p transaction the replacement of every cell covered by \p mask with a block of type \p prototype and
+    * orientation \p orientation, or the removal of whatever is there if \p prototype is air or NULL.  Each span is
+    * read a chunk-aligned piece at a time straight out of the chunk layer it lies in, so the cost is dominated by the
+    * number of rows rather than by per-cell lookups.  This is what shape tools call once they have rasterized
+    * themselves.
+    */
+  void fillSpans(const SpanMask& mask,
+                 BlockPrototype* prototype,
+                 const BlockOrientation* orientation,
+                 BlockTransaction* transaction) const;
+
+  /**
+    * Returns a clipboard holding every block inside the box with opposite corners \p corner and \p opposite_corner,
+    * inclusive.  The corners may be given in any order, and may lie on different levels.  Only the chunks the box
+    * overlaps are visited, and layers of them that hold nothing but air are skipped entirely.
+    */
+  BlockClipboard copyRegion(const BlockPosition& corner, const BlockPosition& opposite_corner) const;
+
+  /**
+    * Records in \p transaction the replacement of the box of blocks that \p clipboard would cover if its corner with
+    * the smallest coordinates were placed at \p origin with the contents of \p clipboard.  Air in the clipboard
+    * clears the cell it lands on.  Like fillSpans(), this reads both the diagram and the clipboard a chunk-aligned
+    * piece of a row at a time, and records everything in a single call to BlockTransaction::replaceBlocks().  If
+    * \p transaction was empty and \p origin lies on a chunk boundary along _x_ and _z_, the clipboard's layers are
+    * shared with the diagram wherever they replace a whole layer or fill an empty one.
     */
-  QHash<BlockPosition, BlockInstance> level(int level_index);
+  void paste(const BlockClipboard& clipboard, const BlockPosition& origin, BlockTransaction* transaction) const;
+
+  /**
+    * Records in \p transaction the pasting of each clipboard in \p clipboards at the origin with the same index in
+    * \p origins, as paste() would, with later copies winning wherever copies overlap.  This is how arrays of copies
+    * are made.  If no two copies overlap, everything is recorded in a single call to BlockTransaction::replaceBlocks(),
+    * and if \p transaction was empty, every layer a copy lands in by itself is shared just as paste() would share it,
+    * so a long row of chunk-aligned copies costs little more memory than one.
+    */
+  void pasteArray(const QList<BlockClipboard>& clipboards,
+                  const QList<BlockPosition>& origins,
+                  BlockTransaction* transaction) const;
+
+  /**
+    * Records in \p transaction the replacement of every block that \p replacement matches, inside its region, with
+    * the block it specifies.  Chunks are searched in parallel, and the palette of each chunk layer is checked before
+    * any of its cells, so layers and chunks without the blocks being looked for cost no per-block work at all.
+    */
+  void findAndReplace(const BlockReplacement& replacement, BlockTransaction* transaction) const;
+
+  /**
+    * Creates a subscription to the part of the diagram inside \p region.  The returned DiagramSubscription emits the
+    * same signals as the Diagram itself, but each transaction is first cut down to the blocks inside \p region, and
+    * signals for transactions that don't touch the region at all are not emitted.  Filtering is done a chunk at a
+    * time, so large transactions far away from the region cost the subscriber nothing.
+    *
+    * Unlike the Diagram's own signals, the subscription's signals are emitted asynchronously: all the commits made in
+    * one turn of the event loop are merged and delivered together afterwards.  See DiagramSubscription for details.
+    *
+    * The subscription is owned by \p parent; delete it to unsubscribe.
+    */
+  DiagramSubscription* subscribe(const BlockRegion& region, QObject* parent = NULL);
 
  signals:
   /**
@@ -133,54 +232,83 @@ class Diagram : public QObject, public BlockOracle {
 
   /**
     * Emitted when the diagram's ephemeral blocks change.
-    * @param transaction The BlockTransaction that caused the change.
+    * @param retracted The ephemeral changes that were taken back.
+    * @param transaction The ephemeral changes that were then applied.
+    * @sa patchEphemeral()
     */
-  void ephemeralBlocksChanged(const BlockTransaction& transaction);
+  void ephemeralBlocksChanged(const BlockTransaction& retracted, const BlockTransaction& transaction);
 
  private:
+  friend class DiagramSubscription;
+
   /**
-    * Returns the block manager, or NULL if it's not set.  This method exists mainly to fire an assert if it is called
-    * while the BlockManager is NULL.  For that reason, you should always call this instead of accessing block_mgr_
-    * directly.
+    * Forgets about \p subscription.  Called by the DiagramSubscription destructor.
     */
-  BlockManager* blockManager() const;
+  void unsubscribe(DiagramSubscription* subscription);
+
+  /**
+    * Delivers the relevant slice of \p transaction to every subscription, to be emitted as
+    * DiagramSubscription::diagramChanged().
+    */
+  void publish(const BlockTransaction& transaction);
+
+  /**
+    * Delivers the relevant slices of the ephemeral patch made of \p retracted and \p transaction to every
+    * subscription, to be emitted as DiagramSubscription::ephemeralBlocksChanged().
+    */
+  void publishEphemeral(const BlockTransaction& retracted, const BlockTransaction& transaction);
 
   /**
-    * Directly adds a block to the diagram, replacing whatever block was there.  This should only be called from
-    * commit() unless you know what you're doing, since it will neither fire diagramChanged() nor create a
-    * BlockTransaction for the change.
+    * Appends to \p old_blocks and \p new_blocks the blocks pasting \p clipboard at \p origin would remove and add.
+    * @sa paste()
     */
-  void addBlockInternal(const BlockInstance& block);
+  void pasteBlocks(const BlockClipboard& clipboard,
+                   const BlockPosition& origin,
+                   QList<BlockInstance>* old_blocks,
+                   QList<BlockInstance>* new_blocks) const;
 
   /**
-    * Directly removes a block from the diagram.  This should only be called from commit() unless you know what you're
-    * doing, since it will neither fire diagramChanged() nor create a BlockTransaction for the change.
+    * Returns the layers of \p clipboard that the diagram could share if \p clipboard were pasted at \p origin and
+    * nothing else were changed.  Nothing can be shared unless \p origin lies on a chunk boundary along _x_ and _z_.
+    * @sa BlockTransaction::shareLayer()
     */
-  void removeBlockInternal(const BlockPosition& position);
+  QList<BlockTransaction::SharedLayer> shareableLayers(const BlockClipboard& clipboard,
+                                                       const BlockPosition& origin) const;
 
   /**
-    * Ephemerally adds a block to the diagram.  This should only be called from commitEphemeral() unless you know what
+    * Returns a transaction describing all of the diagram's current ephemeral changes.
+    */
+  BlockTransaction ephemeralTransaction() const;
+
+  /**
+    * Returns the block manager, or NULL if it's not set.  This method exists mainly to fire an assert if it is called
+    * while the BlockManager is NULL.  For that reason, you should always call this instead of accessing block_mgr_
+    * directly.
+    */
+  BlockManager* blockManager() const;
+
+  /**
+    * Ephemerally adds a block to the diagram.  This should only be called from patchEphemeral() unless you know what
     * you're doing, since it will neither fire ephemeralBlocksChanged() nor create a BlockTransaction for the change.
     */
   void ephemerallyAddBlockInternal(const BlockInstance& block);
 
   /**
-    * Ephemerally removes a block from the diagram.  This should only be called from commitEphemeral() unless you know
+    * Ephemerally removes a block from the diagram.  This should only be called from patchEphemeral() unless you know
     * what you're doing, since it will neither fire ephemeralBlocksChanged() nor create a BlockTransaction for the
     * change.
     */
   void ephemerallyRemoveBlockInternal(const BlockInstance& block);
 
   /**
-    * A map of all blocks in the diagram, regardless of level.  Used mainly for rendering.
+    * The blocks in the diagram, stored a chunk at a time.  Only chunks containing at least one block are present.
     */
-  QHash<BlockPosition, BlockInstance> block_map_;
+  QHash<ChunkPosition, Chunk> chunks_;
 
   /**
-    * A map from level to the blocks at that level.  This allows us to display a given level without having to perform
-    * an incremental search for blocks with the right y-coordinate.
+    * The total number of blocks in chunks_.
     */
-  QHash< int, QHash<BlockPosition, BlockInstance> > block_list_;
+  int block_count_;
 
   /**
     * A map of the ephemeral blocks in the diagram.
@@ -193,6 +321,11 @@ class Diagram : public QObject, public BlockOracle {
     * methods are called.  Don't access this directly -- use blockManager() instead.
     */
   BlockManager* block_mgr_;
+
+  /**
+    * The subscriptions created by subscribe() that have not yet been deleted.
+    */
+  QList<DiagramSubscription*> subscriptions_;
 };
 
 #endif // DIAGRAM_H
@@ -0,0 +1,125 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diagram_slice.h"
+
+DiagramSlice::DiagramSlice(const QHash<ChunkPosition, Chunk>& chunks, Axis axis, int coordinate)
+    : chunks_(chunks),
+      axis_(axis),
+      coordinate_(coordinate) {
+}
+
+DiagramSlice::const_iterator DiagramSlice::begin() const {
+  const_iterator iter(this, chunks_.constBegin());
+  iter.advance();
+  return iter;
+}
+
+DiagramSlice::const_iterator DiagramSlice::end() const {
+  return const_iterator(this, chunks_.constEnd());
+}
+
+int DiagramSlice::count() const {
+  int count = 0;
+  QHash<ChunkPosition, Chunk>::const_iterator iter;
+  for (iter = chunks_.constBegin(); iter != chunks_.constEnd(); ++iter) {
+    if (!crossesChunk(iter.key())) {
+      continue;
+    }
+    if (axis_ == kYAxis) {
+      // Layers keep their own counts, so horizontal slices needn't look at any cells.
+      count += iter.value().layer(ChunkPosition::localCoordinate(coordinate_)).blockCount();
+      continue;
+    }
+    for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+      int x, y, z;
+      cellCoordinates(cell, &x, &y, &z);
+      if (iter.value().prototypeAt(x, y, z)) {
+        ++count;
+      }
+    }
+  }
+  return count;
+}
+
+bool DiagramSlice::crossesChunk(const ChunkPosition& position) const {
+  int chunk_coordinate = ChunkPosition::chunkCoordinate(coordinate_);
+  switch (axis_) {
+    case kXAxis:
+      return position.x() == chunk_coordinate;
+    case kYAxis:
+      return position.y() == chunk_coordinate;
+    case kZAxis:
+      return position.z() == chunk_coordinate;
+  }
+  return false;
+}
+
+void DiagramSlice::cellCoordinates(int cell, int* x, int* y, int* z) const {
+  int local = ChunkPosition::localCoordinate(coordinate_);
+  int u = cell & kChunkMask;
+  int v = cell >> kChunkShift;
+  switch (axis_) {
+    case kXAxis:
+      *x = local;
+      *y = u;
+      *z = v;
+      break;
+    case kYAxis:
+      *x = u;
+      *y = local;
+      *z = v;
+      break;
+    case kZAxis:
+      *x = u;
+      *y = v;
+      *z = local;
+      break;
+  }
+}
+
+DiagramSlice::const_iterator::const_iterator(const DiagramSlice* slice,
+                                             QHash<ChunkPosition, Chunk>::const_iterator chunk_iter)
+    : slice_(slice),
+      chunk_iter_(chunk_iter),
+      cell_(0) {
+}
+
+void DiagramSlice::const_iterator::advance() {
+  QHash<ChunkPosition, Chunk>::const_iterator end = slice_->chunks_.constEnd();
+  for (; chunk_iter_ != end; ++chunk_iter_, cell_ = 0) {
+    if (!slice_->crossesChunk(chunk_iter_.key())) {
+      continue;
+    }
+    const Chunk& chunk = chunk_iter_.value();
+    if (slice_->axis_ == kYAxis && chunk.layer(ChunkPosition::localCoordinate(slice_->coordinate_)).isEmpty()) {
+      continue;
+    }
+    for (; cell_ < kChunkLayerArea; ++cell_) {
+      int x, y, z;
+      slice_->cellCoordinates(cell_, &x, &y, &z);
+      BlockPrototype* prototype = chunk.prototypeAt(x, y, z);
+      if (prototype) {
+        current_ = BlockInstance(prototype,
+                                 chunk_iter_.key().minimumBlock() + BlockPosition(x, y, z),
+                                 chunk.orientationAt(x, y, z));
+        // Leave cell_ pointing past this block so that the next call picks up where this one left off.
+        ++cell_;
+        return;
+      }
+    }
+  }
+  cell_ = 0;
+}
@@ -0,0 +1,143 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIAGRAM_SLICE_H
+#define DIAGRAM_SLICE_H
+
+#include <QHash>
+
+#include "block_instance.h"
+#include "chunk.h"
+#include "chunk_position.h"
+
+/**
+  * A read-only view of all the blocks in a Diagram lying in one axis-aligned plane, for instance a single level.
+  *
+  * A DiagramSlice does not copy any blocks.  It holds an implicitly shared snapshot of the diagram's chunk storage,
+  * which costs a single reference count increment to take, and iterating it walks the cells of the chunks crossing the
+  * plane directly.  Chunks that don't cross the plane are skipped without looking at their contents.  Because the
+  * snapshot is shared rather than live, later changes to the diagram are not reflected in an existing slice.
+  *
+  * BlockInstances are produced on the fly as the slice is iterated, so iterating it with \c foreach binds each
+  * \c const \c BlockInstance& to a short-lived value:
+  *
+  * @code
+  * foreach (const BlockInstance& block, diagram->level(3)) {
+  *   addBlock(block);
+  * }
+  * @endcode
+  */
+class DiagramSlice {
+ public:
+  /**
+    * The axis perpendicular to the plane of a slice.
+    */
+  enum Axis {
+    kXAxis,
+    kYAxis,
+    kZAxis
+  };
+
+  /**
+    * Iterates over the blocks (but not the air) in a DiagramSlice.  The order of iteration is unspecified.
+    */
+  class const_iterator {
+   public:
+    const_iterator() : slice_(NULL), cell_(0) {}
+
+    inline const BlockInstance& operator*() const {
+      return current_;
+    }
+
+    inline const BlockInstance* operator->() const {
+      return &current_;
+    }
+
+    inline const_iterator& operator++() {
+      advance();
+      return *this;
+    }
+
+    inline bool operator==(const const_iterator& other) const {
+      return chunk_iter_ == other.chunk_iter_ && cell_ == other.cell_;
+    }
+
+    inline bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class DiagramSlice;
+
+    const_iterator(const DiagramSlice* slice, QHash<ChunkPosition, Chunk>::const_iterator chunk_iter);
+
+    /**
+      * Moves to the next block in the slice, or to the end if there isn't one.
+      */
+    void advance();
+
+    const DiagramSlice* slice_;
+    QHash<ChunkPosition, Chunk>::const_iterator chunk_iter_;
+
+    /// The index within the current chunk of the next cell in the plane to examine.
+    int cell_;
+
+    BlockInstance current_;
+  };
+
+  /**
+    * Creates a slice of \p chunks through the plane perpendicular to \p axis at \p coordinate.
+    */
+  DiagramSlice(const QHash<ChunkPosition, Chunk>& chunks, Axis axis, int coordinate);
+
+  /**
+    * Returns the axis perpendicular to the plane of this slice.
+    */
+  Axis axis() const {
+    return axis_;
+  }
+
+  /**
+    * Returns the coordinate along axis() at which this slice lies.
+    */
+  int coordinate() const {
+    return coordinate_;
+  }
+
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  /**
+    * Returns the number of blocks in the slice.
+    */
+  int count() const;
+
+ private:
+  /**
+    * Returns whether the chunk at \p position crosses the plane of this slice.
+    */
+  bool crossesChunk(const ChunkPosition& position) const;
+
+  /**
+    * Converts the index \p cell of a cell in the plane of this slice to local coordinates within a chunk crossing it.
+    */
+  void cellCoordinates(int cell, int* x, int* y, int* z) const;
+
+  QHash<ChunkPosition, Chunk> chunks_;
+  Axis axis_;
+  int coordinate_;
+};
+
+#endif // DIAGRAM_SLICE_H
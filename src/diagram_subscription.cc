@@ -0,0 +1,103 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "diagram_subscription.h"
+
+#include "diagram.h"
+
+/**
+  * The minimum number of milliseconds between two deliveries to the same subscription.  This bounds the number of
+  * view updates to roughly one per frame at 60 frames per second.
+  */
+static const int kMinimumDeliveryInterval = 16;
+
+DiagramSubscription::DiagramSubscription(Diagram* diagram, const BlockRegion& region, QObject* parent)
+    : QObject(parent),
+      diagram_(diagram),
+      region_(region),
+      has_pending_changes_(false) {
+  delivery_timer_.setSingleShot(true);
+  connect(&delivery_timer_, SIGNAL(timeout()), SLOT(flush()));
+}
+
+DiagramSubscription::~DiagramSubscription() {
+  if (diagram_) {
+    diagram_->unsubscribe(this);
+  }
+}
+
+void DiagramSubscription::setRegion(const BlockRegion& region) {
+  region_ = region;
+  // Anything still queued was sliced for the old region, so it is no longer meaningful.
+  pending_changes_ = BlockTransaction();
+  has_pending_changes_ = false;
+  pending_ephemeral_retracted_ = BlockTransaction();
+  pending_ephemeral_changes_ = BlockTransaction();
+  delivery_timer_.stop();
+}
+
+void DiagramSubscription::deliverChanges(const BlockTransaction& slice) {
+  if (slice.isEmpty()) {
+    return;
+  }
+  if (has_pending_changes_) {
+    pending_changes_.merge(slice);
+  } else {
+    pending_changes_ = slice;
+    has_pending_changes_ = true;
+  }
+  scheduleDelivery();
+}
+
+void DiagramSubscription::deliverEphemeralChanges(const BlockTransaction& retracted_slice,
+                                                  const BlockTransaction& slice) {
+  if (retracted_slice.isEmpty() && slice.isEmpty()) {
+    return;
+  }
+  BlockTransaction::mergePatches(&pending_ephemeral_retracted_, &pending_ephemeral_changes_, retracted_slice, slice);
+  scheduleDelivery();
+}
+
+void DiagramSubscription::scheduleDelivery() {
+  if (delivery_timer_.isActive()) {
+    return;
+  }
+  int delay = 0;
+  if (!last_delivery_time_.isNull()) {
+    delay = qMax(0, kMinimumDeliveryInterval - last_delivery_time_.elapsed());
+  }
+  delivery_timer_.start(delay);
+}
+
+void DiagramSubscription::flush() {
+  delivery_timer_.stop();
+  last_delivery_time_.start();
+
+  // Take the pending changes before emitting anything, in case a receiver commits more changes in response.
+  if (has_pending_changes_) {
+    BlockTransaction changes = pending_changes_;
+    pending_changes_ = BlockTransaction();
+    has_pending_changes_ = false;
+    emit diagramChanged(changes);
+  }
+  // The queued patches may have cancelled each other out entirely.
+  if (!pending_ephemeral_retracted_.isEmpty() || !pending_ephemeral_changes_.isEmpty()) {
+    BlockTransaction retracted = pending_ephemeral_retracted_;
+    BlockTransaction changes = pending_ephemeral_changes_;
+    pending_ephemeral_retracted_ = BlockTransaction();
+    pending_ephemeral_changes_ = BlockTransaction();
+    emit ephemeralBlocksChanged(retracted, changes);
+  }
+}
@@ -0,0 +1,139 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DIAGRAM_SUBSCRIPTION_H
+#define DIAGRAM_SUBSCRIPTION_H
+
+#include <QObject>
+#include <QTime>
+#include <QTimer>
+
+#include "block_region.h"
+#include "block_transaction.h"
+
+class Diagram;
+
+/**
+  * A view's standing interest in one region of a Diagram.
+  *
+  * Subscriptions are created by calling Diagram::subscribe().  Whenever the diagram changes, each subscription emits
+  * diagramChanged() (or ephemeralBlocksChanged()) with only the part of the transaction that falls inside its region.
+  * A view that only displays a few levels of the world therefore never has to look at changes it can't show.
+  *
+  * Notifications are coalesced rather than delivered synchronously from Diagram::commit().  All the commits made in
+  * one turn of the event loop are merged (see BlockTransaction::merge()) into a single change set, which is delivered
+  * from the event loop afterwards, and deliveries to any one subscription are spaced at least
+  * kMinimumDeliveryInterval milliseconds apart, so a view never updates more than about once per frame no matter how
+  * quickly the diagram is being changed.  Ephemeral changes are patches that only make sense relative to the ones
+  * before them (see Diagram::patchEphemeral()), so they are composed in order into a single patch instead (see
+  * BlockTransaction::mergePatches()).  When both kinds of change are pending, diagramChanged() is emitted before
+  * ephemeralBlocksChanged().  Call flush() if you need pending changes delivered immediately.
+  *
+  * The region can be changed at any time with setRegion(), for instance when the user switches to another level.
+  * Changing the region does not replay any earlier changes, and discards any that have not been delivered yet;
+  * callers that need to repopulate themselves should do so directly from the Diagram.
+  *
+  * Deleting the subscription (or its parent) unsubscribes it from the diagram.
+  */
+class DiagramSubscription : public QObject {
+  Q_OBJECT
+ public:
+  virtual ~DiagramSubscription();
+
+  /**
+    * Returns the region this subscription is interested in.
+    */
+  const BlockRegion& region() const {
+    return region_;
+  }
+
+  /**
+    * Sets the region this subscription is interested in to \p region.  Only changes committed after this call are
+    * filtered against the new region.
+    */
+  void setRegion(const BlockRegion& region);
+
+  /**
+    * Returns the diagram this subscription is attached to, or NULL if the diagram has been destroyed.
+    */
+  Diagram* diagram() const {
+    return diagram_;
+  }
+
+ signals:
+  /**
+    * Emitted when the diagram changes inside this subscription's region.  Never emitted with an empty transaction.
+    * @param transaction The part of the BlockTransactions committed since the last delivery which lies inside the
+    *     region, merged into one.
+    */
+  void diagramChanged(const BlockTransaction& transaction);
+
+  /**
+    * Emitted when the diagram's ephemeral blocks change inside this subscription's region.  Take back the ephemeral
+    * changes in \p retracted, then apply those in \p transaction.  Never emitted with both transactions empty.
+    * @param retracted The part of the ephemeral changes retracted since the last delivery which lies inside the region.
+    * @param transaction The part of the ephemeral changes applied since the last delivery which lies inside the
+    *     region.
+    */
+  void ephemeralBlocksChanged(const BlockTransaction& retracted, const BlockTransaction& transaction);
+
+ public slots:
+  /**
+    * Immediately emits any changes that are waiting to be delivered.
+    */
+  void flush();
+
+ private:
+  friend class Diagram;
+
+  DiagramSubscription(Diagram* diagram, const BlockRegion& region, QObject* parent);
+
+  /**
+    * Queues \p slice, the part of a committed transaction inside our region, for delivery.
+    */
+  void deliverChanges(const BlockTransaction& slice);
+
+  /**
+    * Queues \p retracted_slice and \p slice, the part of an ephemeral patch inside our region, for delivery, composed
+    * with any ephemeral patches that are already queued.
+    */
+  void deliverEphemeralChanges(const BlockTransaction& retracted_slice, const BlockTransaction& slice);
+
+  /**
+    * Starts the delivery timer if it isn't already running, respecting kMinimumDeliveryInterval.
+    */
+  void scheduleDelivery();
+
+  Diagram* diagram_;
+  BlockRegion region_;
+
+  BlockTransaction pending_changes_;
+  bool has_pending_changes_;
+
+  /**
+    * The ephemeral patches waiting to be delivered, composed into one.
+    */
+  BlockTransaction pending_ephemeral_retracted_;
+  BlockTransaction pending_ephemeral_changes_;
+
+  QTimer delivery_timer_;
+
+  /**
+    * Measures the time since the last delivery.  Null until the first delivery.
+    */
+  QTime last_delivery_time_;
+};
+
+#endif // DIAGRAM_SUBSCRIPTION_H
@@ -0,0 +1,35 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dome_tool.h"
+
+#include "span_mask.h"
+
+DomeTool::DomeTool(Diagram* diagram) : SolidTool(diagram) {}
+
+QString DomeTool::actionName() const {
+  return "Draw Dome";
+}
+
+int DomeTool::heightForFootprint(int width, int depth) const {
+  return (qMin(width, depth) + 1) / 2;
+}
+
+void DomeTool::rasterizeLevel(SpanMask* mask, int level, int height) {
+  // At w half blocks above the base, the slice is the footprint ellipse scaled by sqrt(1 - w^2 / (2 * height)^2).
+  qint64 w = 2 * level + 1;
+  qint64 scale = 4 * qint64(height) * height;
+  addEllipticRing(mask, level, scale - w * w, -1, scale);
+}
@@ -15,33 +15,18 @@
 
 #include "eraser_tool.h"
 
-#include "block_instance.h"
-#include "block_oracle.h"
-#include "block_prototype.h"
-#include "block_transaction.h"
+#include "diagram.h"
 
-EraserTool::EraserTool(BlockOracle* oracle) : oracle_(oracle) {}
+EraserTool::EraserTool(Diagram* diagram) : BrushTool(diagram) {}
 
 QString EraserTool::actionName() const {
   return "Erase Blocks";
 }
 
-bool EraserTool::wantsMorePositions() {
-  return countPositions() == 0;
-}
-
-bool EraserTool::isBrush() const {
-  return true;
-}
-
-void EraserTool::draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
-  if (wantsMorePositions()) {
-    return;
-  }
-
-  for (int i = 0; i < countPositions(); ++i) {
-    // TODO(phoenix): Should eventually draw lines between these points.
-    const BlockPosition& point = positionAtIndex(i);
-    transaction->clearBlock(oracle_->blockAt(point));
-  }
+void EraserTool::paint(const SpanMask& mask,
+                       BlockPrototype* prototype,
+                       const BlockOrientation* orientation,
+                       BlockTransaction* segment) {
+  // Whatever the current block type is, the eraser only ever removes blocks.
+  diagram()->fillSpans(mask, NULL, NULL, segment);
 }
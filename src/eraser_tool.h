@@ -16,24 +16,23 @@
 #ifndef ERASER_TOOL_H
 #define ERASER_TOOL_H
 
-#include "block_position.h"
-#include "tool.h"
+#include "brush_tool.h"
 
-class BlockOracle;
+class Diagram;
 
 /**
   * A Tool that erases individual blocks.
   */
-class EraserTool : public Tool {
+class EraserTool : public BrushTool {
  public:
-  explicit EraserTool(BlockOracle* oracle);
+  explicit EraserTool(Diagram* diagram);
   virtual QString actionName() const;
-  virtual bool wantsMorePositions();
-  virtual bool isBrush() const;
-  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
 
- private:
-  BlockOracle* oracle_;
+ protected:
+  virtual void paint(const SpanMask& mask,
+                     BlockPrototype* prototype,
+                     const BlockOrientation* orientation,
+                     BlockTransaction* segment);
 };
 
 #endif // ERASER_TOOL_H
@@ -15,12 +15,9 @@
 
 #include "filled_rectangle_tool.h"
 
-#include "block_instance.h"
-#include "block_oracle.h"
-#include "block_prototype.h"
-#include "block_transaction.h"
+#include "span_mask.h"
 
-FilledRectangleTool::FilledRectangleTool(BlockOracle* oracle) : oracle_(oracle) {}
+FilledRectangleTool::FilledRectangleTool(Diagram* diagram) : ShapeTool(diagram) {}
 
 QString FilledRectangleTool::actionName() const {
   return "Fill Rectangle";
@@ -34,9 +31,7 @@ bool FilledRectangleTool::isBrush() const {
   return false;
 }
 
-void FilledRectangleTool::draw(BlockPrototype* prototype,
-                               const BlockOrientation* orientation,
-                               BlockTransaction* transaction) {
+void FilledRectangleTool::rasterize(SpanMask* mask) {
   if (wantsMorePositions()) {
     return;
   }
@@ -50,11 +45,7 @@ void FilledRectangleTool::draw(BlockPrototype* prototype,
                     positionAtIndex(0).y(),
                     qMax(positionAtIndex(0).z(), positionAtIndex(1).z()));
 
-  for (int x = start.x(); x <= end.x(); ++x) {
-    for (int z = start.z(); z <= end.z(); ++z) {
-      BlockPosition pos(x, start.y(), z);
-      BlockInstance new_block(prototype, pos, orientation);
-      transaction->replaceBlock(oracle_->blockAt(pos), new_block);
-    }
+  for (int z = start.z(); z <= end.z(); ++z) {
+    mask->addSpan(start.x(), end.x(), start.y(), z);
   }
 }
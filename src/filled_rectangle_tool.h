@@ -17,23 +17,22 @@
 #define FILLED_RECTANGLE_TOOL_H
 
 #include "block_position.h"
-#include "tool.h"
+#include "shape_tool.h"
 
-class BlockOracle;
+class Diagram;
 
 /**
   * A Tool that draws filled rectangles between two corners.
   */
-class FilledRectangleTool : public Tool {
+class FilledRectangleTool : public ShapeTool {
  public:
-  explicit FilledRectangleTool(BlockOracle* oracle);
+  explicit FilledRectangleTool(Diagram* diagram);
   virtual QString actionName() const;
   virtual bool wantsMorePositions();
   virtual bool isBrush() const;
-  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
 
- private:
-  BlockOracle* oracle_;
+ protected:
+  virtual void rasterize(SpanMask* mask);
 };
 
 #endif // FILLED_RECTANGLE_TOOL_H
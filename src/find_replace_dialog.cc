@@ -0,0 +1,122 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "find_replace_dialog.h"
+
+#include "block_manager.h"
+#include "block_orientation.h"
+#include "block_prototype.h"
+
+FindReplaceDialog::FindReplaceDialog(BlockManager* block_mgr, blocktype_t replacement_type, int level, QWidget* parent)
+    : QDialog(parent),
+      block_mgr_(block_mgr) {
+  Q_ASSERT(block_mgr);
+  ui.setupUi(this);
+
+  ui.replace_combo_box_->addItem("Air", kBlockTypeAir);
+  BlockTypeIterator iter = BlockPrototype::blockIterator();
+  while (iter.hasNext()) {
+    BlockPrototype* block = block_mgr_->getPrototype(iter.next());
+    if (block->type() == kBlockTypeAir) {
+      continue;
+    }
+    QIcon icon(block->sprite(BlockOrientation::paletteOrientation()));
+    ui.find_combo_box_->addItem(icon, block->name(), block->type());
+    ui.replace_combo_box_->addItem(icon, block->name(), block->type());
+  }
+  ui.replace_combo_box_->setCurrentIndex(qMax(0, ui.replace_combo_box_->findData(replacement_type)));
+
+  ui.scope_combo_box_->addItem("Whole diagram", kScopeEverything);
+  ui.scope_combo_box_->addItem("Levels", kScopeLevels);
+  ui.first_level_spin_box_->setValue(level);
+  ui.last_level_spin_box_->setValue(level);
+
+  connect(ui.find_combo_box_, SIGNAL(currentIndexChanged(int)), SLOT(updateFindOrientations()));
+  connect(ui.replace_combo_box_, SIGNAL(currentIndexChanged(int)), SLOT(updateReplacementOrientations()));
+  connect(ui.scope_combo_box_, SIGNAL(currentIndexChanged(int)), SLOT(updateLevelFields()));
+  updateFindOrientations();
+  updateReplacementOrientations();
+  updateLevelFields();
+}
+
+void FindReplaceDialog::setSelection(const BlockRegion& selection) {
+  selection_ = selection;
+  if (ui.scope_combo_box_->findData(kScopeSelection) < 0) {
+    ui.scope_combo_box_->addItem("Selection", kScopeSelection);
+  }
+  ui.scope_combo_box_->setCurrentIndex(ui.scope_combo_box_->findData(kScopeSelection));
+}
+
+BlockReplacement FindReplaceDialog::replacement() const {
+  BlockReplacement replacement(prototypeForComboBox(ui.find_combo_box_),
+                               prototypeForComboBox(ui.replace_combo_box_));
+  replacement.setFindOrientation(orientationForComboBox(ui.find_orientation_combo_box_));
+  const BlockOrientation* replacement_orientation = orientationForComboBox(ui.replace_orientation_combo_box_);
+  if (replacement_orientation) {
+    foreach (const BlockOrientation* orientation, replacement.findPrototype()->orientations()) {
+      replacement.mapOrientation(orientation, replacement_orientation);
+    }
+  }
+  switch (ui.scope_combo_box_->itemData(ui.scope_combo_box_->currentIndex()).toInt()) {
+    case kScopeLevels:
+      replacement.setRegion(BlockRegion::levels(ui.first_level_spin_box_->value(), ui.last_level_spin_box_->value()));
+      break;
+    case kScopeSelection:
+      replacement.setRegion(selection_);
+      break;
+    default:
+      break;
+  }
+  return replacement;
+}
+
+void FindReplaceDialog::updateFindOrientations() {
+  fillOrientations(ui.find_orientation_combo_box_, prototypeForComboBox(ui.find_combo_box_), "Any direction");
+}
+
+void FindReplaceDialog::updateReplacementOrientations() {
+  fillOrientations(ui.replace_orientation_combo_box_, prototypeForComboBox(ui.replace_combo_box_), "Keep direction");
+}
+
+void FindReplaceDialog::updateLevelFields() {
+  bool levels = (ui.scope_combo_box_->itemData(ui.scope_combo_box_->currentIndex()).toInt() == kScopeLevels);
+  ui.first_level_spin_box_->setEnabled(levels);
+  ui.last_level_spin_box_->setEnabled(levels);
+}
+
+BlockPrototype* FindReplaceDialog::prototypeForComboBox(const QComboBox* combo_box) const {
+  blocktype_t type = combo_box->itemData(combo_box->currentIndex()).toInt();
+  if (type == kBlockTypeAir) {
+    return NULL;
+  }
+  return block_mgr_->getPrototype(type);
+}
+
+// Static.
+void FindReplaceDialog::fillOrientations(QComboBox* combo_box, BlockPrototype* prototype, const QString& any_name) {
+  combo_box->clear();
+  combo_box->addItem(any_name, -1);
+  if (prototype && prototype->orientations().size() > 1) {
+    foreach (const BlockOrientation* orientation, prototype->orientations()) {
+      combo_box->addItem(orientation->name(), orientation->id());
+    }
+  }
+  combo_box->setEnabled(combo_box->count() > 1);
+}
+
+// Static.
+const BlockOrientation* FindReplaceDialog::orientationForComboBox(const QComboBox* combo_box) {
+  return BlockOrientation::fromId(combo_box->itemData(combo_box->currentIndex()).toInt());
+}
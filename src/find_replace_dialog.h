@@ -0,0 +1,97 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIND_REPLACE_DIALOG_H
+#define FIND_REPLACE_DIALOG_H
+
+#include "block_region.h"
+#include "block_replacement.h"
+#include "block_type.h"
+#include "ui_find_replace_dialog.h"
+
+class BlockManager;
+class BlockPrototype;
+
+/**
+  * The dialog that asks what to find and what to replace it with (see LevelWidget::findAndReplace()).
+  *
+  * Blocks can be looked for in any orientation or in just one, and replaced keeping their orientation or with a
+  * particular one.  The search covers the whole diagram, a range of levels, or the current selection if there is one.
+  */
+class FindReplaceDialog : public QDialog {
+  Q_OBJECT
+
+ public:
+  /**
+    * Constructs a dialog offering every block type known to \p block_mgr, with \p replacement_type picked as the
+    * replacement and the level range starting out as just \p level.
+    */
+  FindReplaceDialog(BlockManager* block_mgr, blocktype_t replacement_type, int level, QWidget* parent = NULL);
+
+  /**
+    * Offers \p selection as a place to search, and picks it.
+    */
+  void setSelection(const BlockRegion& selection);
+
+  /**
+    * Returns the replacement the user asked for.
+    */
+  BlockReplacement replacement() const;
+
+ private slots:
+  /**
+    * Fills in the orientations that can be looked for, to match the block type being looked for.
+    */
+  void updateFindOrientations();
+
+  /**
+    * Fills in the orientations the replacements can have, to match the replacement block type.
+    */
+  void updateReplacementOrientations();
+
+  /**
+    * Enables the level range fields if the search is restricted to a range of levels.
+    */
+  void updateLevelFields();
+
+ private:
+  enum Scope {
+    kScopeEverything,
+    kScopeLevels,
+    kScopeSelection
+  };
+
+  /**
+    * Returns the prototype picked in \p combo_box, or NULL if air is picked.
+    */
+  BlockPrototype* prototypeForComboBox(const QComboBox* combo_box) const;
+
+  /**
+    * Fills \p combo_box with "Any" under the name \p any_name, followed by each orientation of \p prototype.  If
+    * \p prototype is NULL or only has one orientation, only "Any" is offered.
+    */
+  static void fillOrientations(QComboBox* combo_box, BlockPrototype* prototype, const QString& any_name);
+
+  /**
+    * Returns the orientation picked in \p combo_box, or NULL if the first item is picked.
+    */
+  static const BlockOrientation* orientationForComboBox(const QComboBox* combo_box);
+
+  Ui::FindReplaceDialog ui;
+  BlockManager* block_mgr_;
+  BlockRegion selection_;
+};
+
+#endif // FIND_REPLACE_DIALOG_H
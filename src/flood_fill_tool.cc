@@ -15,12 +15,28 @@
 
 #include "flood_fill_tool.h"
 
-#include "block_oracle.h"
-#include "block_transaction.h"
+#include <QBitArray>
+#include <QVector>
 
-static const int kMaxFillDistance = 64;
+#include "chunk_cursor.h"
+#include "diagram.h"
+#include "span_mask.h"
 
-FloodFillTool::FloodFillTool(BlockOracle* oracle) : oracle_(oracle) {
+/**
+  * The default value of FloodFillTool::maximumExtent().
+  */
+static const int kDefaultMaximumExtent = 64;
+
+/**
+  * The largest value FloodFillTool::maximumExtent() may take.  This keeps the bitmap of filled cells for a 3D fill to a
+  * reasonable size (about 17 MB at most).
+  */
+static const int kLargestMaximumExtent = 256;
+
+FloodFillTool::FloodFillTool(Diagram* diagram)
+    : diagram_(diagram),
+      maximum_extent_(kDefaultMaximumExtent),
+      is_three_dimensional_(false) {
 }
 
 FloodFillTool::~FloodFillTool() {}
@@ -37,59 +53,88 @@ bool FloodFillTool::isBrush() const {
   return false;
 }
 
+void FloodFillTool::setMaximumExtent(int extent) {
+  maximum_extent_ = qBound(0, extent, kLargestMaximumExtent);
+}
+
 void FloodFillTool::draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
   if (countPositions() < 1 || state() == kProposed) {
     return;
   }
 
+  // This is a scanline fill: rather than visiting cells one at a time, each seed taken off the stack is grown into
+  // the longest run of matching cells along the x axis, and the rows next to that run are then scanned for runs of
+  // their own, each of which gets a single seed.  This keeps the stack small and reads the diagram in the order it is
+  // stored.
+  // TODO: this hard-codes top-down orientation again.
   BlockPosition start_pos = positionAtIndex(0);
-  BlockInstance start_block = oracle_->blockAt(start_pos);
-  const blocktype_t source_type = start_block.prototype()->type();
-  QSet<BlockPosition> filled_blocks;
-  fillBlocksRecurse(start_pos, source_type, prototype, orientation, start_pos, 1, &filled_blocks, transaction);
-}
+  int extent_y = is_three_dimensional_ ? maximum_extent_ : 0;
+  BlockPosition min_pos = start_pos + BlockPosition(-maximum_extent_, -extent_y, -maximum_extent_);
+  BlockPosition max_pos = start_pos + BlockPosition(maximum_extent_, extent_y, maximum_extent_);
+  int size_x = max_pos.x() - min_pos.x() + 1;
+  int size_y = max_pos.y() - min_pos.y() + 1;
+  int size_z = max_pos.z() - min_pos.z() + 1;
 
-void FloodFillTool::fillBlocksRecurse(const BlockPosition& pos,
-                                      const blocktype_t& source_type,
-                                      BlockPrototype* dest_prototype,
-                                      const BlockOrientation* dest_orientation,
-                                      const BlockPosition& start_pos,
-                                      int depth,
-                                      QSet<BlockPosition>* filled_blocks,
-                                      BlockTransaction* transaction) {
-  if (filled_blocks->contains(pos)) {
-    // We've already filled this block.
-    return;
-  }
-  int fill_distance = kMaxFillDistance;
-  if (qAbs(pos.x() - start_pos.x()) > fill_distance ||
-      qAbs(pos.z() - start_pos.z()) > fill_distance) {
-    // This is unlikely to be a bounded area, so return to prevent stack overflow.
-    return;
-  }
-  if (depth > 8192) {
-    // Generic runaway recursion catcher.
-    return;
-  }
-  BlockInstance old_block = oracle_->blockAt(pos);
-  if (old_block.prototype()->type() != source_type) {
-    return;
-  }
-  if (dest_prototype->type() == kBlockTypeAir) {
-    transaction->clearBlock(old_block);
-  } else {
-    BlockInstance new_block(dest_prototype, pos, dest_orientation);
-    transaction->replaceBlock(old_block, new_block);
+  // One bit per cell in the bounding box, set once the cell has been filled.
+  QBitArray filled(size_x * size_y * size_z);
+
+  ChunkCursor cursor = diagram_->cursor();
+  // Air is NULL as far as the cursor is concerned.
+  BlockPrototype* source_prototype = cursor.prototypeAt(start_pos.x(), start_pos.y(), start_pos.z());
+
+  // Offsets to the rows adjacent to a run, as (y, z) pairs.  Only the first two are used unless the fill is 3D.
+  static const int kNeighborRows[][2] = { { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 } };
+  int neighbor_row_count = is_three_dimensional_ ? 4 : 2;
+
+  SpanMask mask;
+  QVector<BlockPosition> stack;
+  stack.append(start_pos);
+  while (!stack.isEmpty()) {
+    BlockPosition seed = stack.last();
+    stack.pop_back();
+    int y = seed.y();
+    int z = seed.z();
+    int row_index = ((y - min_pos.y()) * size_z + (z - min_pos.z())) * size_x - min_pos.x();
+    if (filled.testBit(row_index + seed.x())) {
+      continue;
+    }
+
+    // Grow the seed into a run.
+    int first_x = seed.x();
+    while (first_x > min_pos.x() && !filled.testBit(row_index + first_x - 1) &&
+           cursor.prototypeAt(first_x - 1, y, z) == source_prototype) {
+      --first_x;
+    }
+    int last_x = seed.x();
+    while (last_x < max_pos.x() && !filled.testBit(row_index + last_x + 1) &&
+           cursor.prototypeAt(last_x + 1, y, z) == source_prototype) {
+      ++last_x;
+    }
+
+    filled.fill(true, row_index + first_x, row_index + last_x + 1);
+    mask.addSpan(first_x, last_x, y, z);
+
+    // Seed each run of matching cells in the neighboring rows.
+    for (int i = 0; i < neighbor_row_count; ++i) {
+      int neighbor_y = y + kNeighborRows[i][0];
+      int neighbor_z = z + kNeighborRows[i][1];
+      if (neighbor_y < min_pos.y() || neighbor_y > max_pos.y() ||
+          neighbor_z < min_pos.z() || neighbor_z > max_pos.z()) {
+        continue;
+      }
+      int neighbor_row_index =
+          ((neighbor_y - min_pos.y()) * size_z + (neighbor_z - min_pos.z())) * size_x - min_pos.x();
+      bool in_run = false;
+      for (int x = first_x; x <= last_x; ++x) {
+        bool matches = !filled.testBit(neighbor_row_index + x) &&
+                       cursor.prototypeAt(x, neighbor_y, neighbor_z) == source_prototype;
+        if (matches && !in_run) {
+          stack.append(BlockPosition(x, neighbor_y, neighbor_z));
+        }
+        in_run = matches;
+      }
+    }
   }
-  filled_blocks->insert(pos);
 
-  // TODO: this hard-codes top-down orientation again.
-  fillBlocksRecurse(pos + BlockPosition(1, 0, 0), source_type, dest_prototype, dest_orientation,
-                    start_pos, depth, filled_blocks, transaction);
-  fillBlocksRecurse(pos + BlockPosition(-1, 0, 0), source_type, dest_prototype, dest_orientation,
-                    start_pos, depth, filled_blocks, transaction);
-  fillBlocksRecurse(pos + BlockPosition(0, 0, 1), source_type, dest_prototype, dest_orientation,
-                    start_pos, depth, filled_blocks, transaction);
-  fillBlocksRecurse(pos + BlockPosition(0, 0, -1), source_type, dest_prototype, dest_orientation,
-                    start_pos, depth, filled_blocks, transaction);
+  diagram_->fillSpans(mask, prototype, orientation, transaction);
 }
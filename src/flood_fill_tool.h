@@ -19,11 +19,19 @@
 #include "block_type.h"
 #include "tool.h"
 
-class BlockOracle;
+class Diagram;
 
+/**
+  * A tool which replaces the block that was clicked, and every block of the same type connected to it, with the
+  * current block type.
+  *
+  * By default, the fill spreads across the current level only.  In three-dimensional mode it also spreads up and down,
+  * which is useful for filling the inside of a hollow shape.  Either way, it never goes further than maximumExtent()
+  * blocks away from the starting point along any axis, so that filling an unbounded area doesn't run forever.
+  */
 class FloodFillTool : public Tool {
  public:
-  FloodFillTool(BlockOracle* oracle);
+  FloodFillTool(Diagram* diagram);
   virtual ~FloodFillTool();
 
   virtual QString actionName() const;
@@ -31,28 +39,37 @@ class FloodFillTool : public Tool {
   virtual bool isBrush() const;
   virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
 
- private:
   /**
-    * Recursion helper function for draw().
-    * @param pos The current position we are filling.
-    * @param source_type The type of the block we should replace.
-    * @param dest_prototype The prototype of the block we should replace it with.
-    * @param dest_orientation The orientation we should set newly created blocks to.
-    * @param start_pos The point at which the initial fillBlocks began.
-    * @param depth Recursive stack depth.  Used for sanity checking to avoid stack overflow.
-    * @param filled_blocks The set of all blocks we have filled so far.  This is shared among all the recursive helpers.
-    * @param transaction The transaction we are building which, when committed, will perform the flood fill.
+    * Returns the furthest distance from the starting point, along any axis, that the fill will reach.
+    */
+  int maximumExtent() const {
+    return maximum_extent_;
+  }
+
+  /**
+    * Sets the furthest distance from the starting point, along any axis, that the fill will reach to \p extent.  The
+    * extent is clamped to between 0 and 256.
+    */
+  void setMaximumExtent(int extent);
+
+  /**
+    * Returns whether the fill spreads between levels as well as within them.
+    */
+  bool isThreeDimensional() const {
+    return is_three_dimensional_;
+  }
+
+  /**
+    * Sets whether the fill spreads between levels as well as within them.
     */
-  void fillBlocksRecurse(const BlockPosition& pos,
-                         const blocktype_t& source_type,
-                         BlockPrototype* dest_prototype,
-                         const BlockOrientation* dest_orientation,
-                         const BlockPosition& start_pos,
-                         int depth,
-                         QSet<BlockPosition>* filled_blocks,
-                         BlockTransaction* transaction);
-
-  BlockOracle* oracle_;
+  void setThreeDimensional(bool three_dimensional) {
+    is_three_dimensional_ = three_dimensional;
+  }
+
+ private:
+  Diagram* diagram_;
+  int maximum_extent_;
+  bool is_three_dimensional_;
 };
 
 #endif // FLOOD_FILL_TOOL_H
@@ -30,8 +30,23 @@ void FlowBlockRenderable::initialize() {
 }
 
 void FlowBlockRenderable::renderAt(const QVector3D& location, const BlockOrientation* orientation) const {
+  Renderable* delegate_renderable = delegateRenderable(orientation);
+  if (delegate_renderable) {
+    delegate_renderable->renderAt(location, orientation);
+  }
+}
+
+void FlowBlockRenderable::addToMesh(const QVector3D& location, const BlockOrientation* orientation,
+                                    MeshBuilder* mesh) const {
+  Renderable* delegate_renderable = delegateRenderable(orientation);
+  if (delegate_renderable) {
+    delegate_renderable->addToMesh(location, orientation, mesh);
+  }
+}
+
+Renderable* FlowBlockRenderable::delegateRenderable(const BlockOrientation* orientation) const {
   if (renderables_.isEmpty()) {
-    // First time we have been rendered, so set up our delegate renderables.
+    // First time we have been used, so set up our delegate renderables.
     Q_ASSERT(renderDelegate() != NULL);
     QVector<const BlockOrientation*> orientations = renderDelegate()->orientations();
     int len = orientations.size();
@@ -52,9 +67,8 @@ void FlowBlockRenderable::renderAt(const QVector3D& location, const BlockOrienta
     }
   }
   Renderable* delegate_renderable = renderables_.value(orientation, NULL);
-  if (delegate_renderable) {
-    delegate_renderable->renderAt(location, orientation);
-  } else {
+  if (!delegate_renderable) {
     qWarning() << __PRETTY_FUNCTION__ << "No delegate renderable found for orientation" << orientation->name();
   }
+  return delegate_renderable;
 }
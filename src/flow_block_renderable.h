@@ -29,8 +29,15 @@ class FlowBlockRenderable : public Renderable {
 
   virtual void initialize();
   virtual void renderAt(const QVector3D& location, const BlockOrientation* orientation) const;
+  virtual void addToMesh(const QVector3D& location, const BlockOrientation* orientation, MeshBuilder* mesh) const;
 
  private:
+  /**
+    * Returns the renderable that draws blocks in \p orientation, creating the renderables for every orientation the
+    * first time it is called.  Returns NULL if \p orientation is not valid for this block.
+    */
+  Renderable* delegateRenderable(const BlockOrientation* orientation) const;
+
   mutable QHash<const BlockOrientation*, RectangularPrismRenderable*> renderables_;
 };
 
@@ -0,0 +1,377 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "forest_tool.h"
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QtConcurrentMap>
+
+#include "block_instance.h"
+#include "block_manager.h"
+#include "block_prototype.h"
+#include "block_transaction.h"
+#include "chunk.h"
+#include "chunk_position.h"
+#include "diagram.h"
+#include "span_mask.h"
+#include "tree_generator.h"
+
+/**
+  * Scrambles the bits of \p h, so that inputs differing in a single bit give unrelated results.  This is the finalizer
+  * of MurmurHash3.
+  */
+static quint32 mixBits(quint32 h) {
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h;
+}
+
+/**
+  * Returns a random-looking number which depends only on \p seed, the cell (\p i, \p j) of the pattern of trees, and
+  * \p salt, which picks one of several unrelated numbers for the same cell.
+  */
+static quint32 hashCell(quint32 seed, int i, int j, quint32 salt) {
+  return mixBits(mixBits(mixBits(seed ^ (salt * 0x9E3779B9u)) ^ static_cast<quint32>(i)) ^ static_cast<quint32>(j));
+}
+
+/**
+  * Returns \p a divided by \p b, rounded towards negative infinity.  \p b must be positive.
+  */
+static int floorDivide(int a, int b) {
+  return a >= 0 ? a / b : -((b - 1 - a) / b);
+}
+
+/**
+  * The one place in a cell of the pattern of trees where a tree may stand.  The pattern divides every level into cells
+  * kTreeSpacing blocks on a side and puts a candidate at a random place in each, with a random priority.  A candidate
+  * becomes a tree unless a candidate of higher priority is closer than kTreeSpacing, which leaves the trees spread
+  * evenly but irregularly, and can be decided for any candidate by looking only at its neighbors.
+  */
+class ForestCandidate {
+ public:
+  ForestCandidate(quint32 seed, int i, int j)
+      : i_(i),
+        j_(j),
+        x_(i * ForestTool::kTreeSpacing + hashCell(seed, i, j, 0) % ForestTool::kTreeSpacing),
+        z_(j * ForestTool::kTreeSpacing + hashCell(seed, i, j, 1) % ForestTool::kTreeSpacing),
+        priority_(hashCell(seed, i, j, 2)) {}
+
+  int i() const {
+    return i_;
+  }
+  int j() const {
+    return j_;
+  }
+  int x() const {
+    return x_;
+  }
+  int z() const {
+    return z_;
+  }
+  quint32 priority() const {
+    return priority_;
+  }
+
+  /**
+    * Returns whether this candidate wins over \p other when they are too close together to both be trees.  Equal
+    * priorities are very rare, and go to the cell that comes first.
+    */
+  bool beats(const ForestCandidate& other) const {
+    if (priority_ != other.priority_) {
+      return priority_ > other.priority_;
+    }
+    return i_ < other.i_ || (i_ == other.i_ && j_ < other.j_);
+  }
+
+  /**
+    * Returns whether a tree stands here: whether this candidate beats every other one closer than kTreeSpacing.  Those
+    * can only be in the eight neighboring cells.
+    */
+  bool isTree(quint32 seed) const {
+    for (int dj = -1; dj <= 1; ++dj) {
+      for (int di = -1; di <= 1; ++di) {
+        if (di == 0 && dj == 0) {
+          continue;
+        }
+        ForestCandidate other(seed, i_ + di, j_ + dj);
+        int dx = other.x() - x_;
+        int dz = other.z() - z_;
+        if (dx * dx + dz * dz < ForestTool::kTreeSpacing * ForestTool::kTreeSpacing && other.beats(*this)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+ private:
+  int i_;
+  int j_;
+  int x_;
+  int z_;
+  quint32 priority_;
+};
+
+/**
+  * One tree to be grown, and what it is made of.
+  */
+class ForestTreeJob {
+ public:
+  ForestTreeJob(const BlockPosition& base,
+                quint32 priority,
+                quint32 tree_seed,
+                const QHash<ChunkPosition, Chunk>* chunks,
+                BlockPrototype* wood,
+                BlockPrototype* leaves,
+                const BlockOrientation* orientation,
+                BlockPrototype* air)
+      : base_(base),
+        priority_(priority),
+        tree_seed_(tree_seed),
+        chunks_(chunks),
+        wood_(wood),
+        leaves_(leaves),
+        orientation_(orientation),
+        air_(air) {}
+
+  const BlockPosition& base() const {
+    return base_;
+  }
+
+  /**
+    * Returns the priority of the tree in the pattern.  Where trees overlap, the one with the higher priority wins.
+    */
+  quint32 priority() const {
+    return priority_;
+  }
+
+  quint32 treeSeed() const {
+    return tree_seed_;
+  }
+
+  /**
+    * Returns the diagram's chunks, which the tree is grown against.  They are shared by every job.
+    */
+  const QHash<ChunkPosition, Chunk>& chunks() const {
+    return *chunks_;
+  }
+
+  BlockPrototype* wood() const {
+    return wood_;
+  }
+  BlockPrototype* leaves() const {
+    return leaves_;
+  }
+  const BlockOrientation* orientation() const {
+    return orientation_;
+  }
+  BlockPrototype* air() const {
+    return air_;
+  }
+
+ private:
+  BlockPosition base_;
+  quint32 priority_;
+  quint32 tree_seed_;
+  const QHash<ChunkPosition, Chunk>* chunks_;
+  BlockPrototype* wood_;
+  BlockPrototype* leaves_;
+  const BlockOrientation* orientation_;
+  BlockPrototype* air_;
+};
+
+/**
+  * The blocks of a grown tree.  The new blocks come trunk first, and each is paired with the block it replaces, which
+  * is air where the cell was empty.
+  */
+class ForestTree {
+ public:
+  ForestTree() : trunk_size_(0) {}
+
+  const QList<BlockInstance>& oldBlocks() const {
+    return old_blocks_;
+  }
+  const QList<BlockInstance>& newBlocks() const {
+    return new_blocks_;
+  }
+
+  /**
+    * Returns how many of the new blocks belong to the trunk.
+    */
+  int trunkSize() const {
+    return trunk_size_;
+  }
+
+  void addBlock(const BlockInstance& old_block, const BlockInstance& new_block) {
+    old_blocks_.append(old_block);
+    new_blocks_.append(new_block);
+  }
+
+  void setTrunkSize(int trunk_size) {
+    trunk_size_ = trunk_size;
+  }
+
+ private:
+  QList<BlockInstance> old_blocks_;
+  QList<BlockInstance> new_blocks_;
+  int trunk_size_;
+};
+
+/**
+  * Returns the block at \p position in \p chunks, or a block of \p air if there is none.
+  */
+static BlockInstance blockAt(const QHash<ChunkPosition, Chunk>& chunks, const BlockPosition& position,
+                             BlockPrototype* air) {
+  QHash<ChunkPosition, Chunk>::const_iterator chunk = chunks.constFind(ChunkPosition::containing(position));
+  if (chunk != chunks.constEnd()) {
+    int x = ChunkPosition::localCoordinate(position.x());
+    int y = ChunkPosition::localCoordinate(position.y());
+    int z = ChunkPosition::localCoordinate(position.z());
+    BlockPrototype* prototype = chunk.value().prototypeAt(x, y, z);
+    if (prototype) {
+      return BlockInstance(prototype, position, chunk.value().orientationAt(x, y, z));
+    }
+  }
+  return BlockInstance(air, position, BlockOrientation::noOrientation());
+}
+
+/**
+  * Grows the tree of \p job.  The trunk replaces whatever is in its way, but leaves only go where there is nothing.
+  */
+static ForestTree growForestTree(const ForestTreeJob& job) {
+  QList<BlockPosition> trunk;
+  QList<BlockPosition> leaves;
+  TreeGenerator(job.treeSeed()).grow(job.base(), &trunk, &leaves);
+  ForestTree tree;
+  foreach (const BlockPosition& position, trunk) {
+    tree.addBlock(blockAt(job.chunks(), position, job.air()), BlockInstance(job.wood(), position, job.orientation()));
+  }
+  tree.setTrunkSize(tree.newBlocks().size());
+  foreach (const BlockPosition& position, leaves) {
+    BlockInstance old_block = blockAt(job.chunks(), position, job.air());
+    if (old_block.prototype() == job.air()) {
+      tree.addBlock(old_block, BlockInstance(job.leaves(), position, job.orientation()));
+    }
+  }
+  return tree;
+}
+
+/**
+  * Orders \p a before \p b if it has the higher priority.
+  */
+static bool hasHigherPriority(const ForestTreeJob& a, const ForestTreeJob& b) {
+  return a.priority() > b.priority();
+}
+
+ForestTool::ForestTool(Diagram* diagram, BlockManager* block_mgr)
+    : BrushTool(diagram), block_mgr_(block_mgr), seed_(0) {}
+
+QString ForestTool::actionName() const {
+  return "Plant Forest";
+}
+
+void ForestTool::setSeed(quint32 seed) {
+  seed_ = seed;
+  clear();
+}
+
+void ForestTool::paint(const SpanMask& mask,
+                       BlockPrototype* prototype,
+                       const BlockOrientation* orientation,
+                       BlockTransaction* segment) {
+  if (!prototype || prototype->type() == kBlockTypeAir) {
+    return;
+  }
+  // Taking the chunks copies nothing, and every job reads the same snapshot.
+  QHash<ChunkPosition, Chunk> chunks = diagram()->chunks();
+  BlockPrototype* leaves = block_mgr_->getPrototype(TreeGenerator::leafType(prototype->type()));
+  BlockPrototype* air = block_mgr_->getPrototype(kBlockTypeAir);
+
+  // Find the trees within kScatterRadius of any span.  Each level has its own trees, at the same places but of
+  // different shapes.
+  QList<ForestTreeJob> jobs;
+  foreach (const BlockSpan& span, mask.spans()) {
+    int first_i = floorDivide(span.firstX() - kScatterRadius, kTreeSpacing);
+    int last_i = floorDivide(span.lastX() + kScatterRadius, kTreeSpacing);
+    int first_j = floorDivide(span.z() - kScatterRadius, kTreeSpacing);
+    int last_j = floorDivide(span.z() + kScatterRadius, kTreeSpacing);
+    for (int j = first_j; j <= last_j; ++j) {
+      for (int i = first_i; i <= last_i; ++i) {
+        ForestCandidate candidate(seed_, i, j);
+        int dx = qBound(span.firstX(), candidate.x(), span.lastX()) - candidate.x();
+        int dz = span.z() - candidate.z();
+        if (dx * dx + dz * dz > kScatterRadius * kScatterRadius) {
+          continue;
+        }
+        BlockPosition base(candidate.x(), span.y(), candidate.z());
+        if (planted_.contains(base) || !candidate.isTree(seed_)) {
+          continue;
+        }
+        planted_.insert(base);
+        quint32 tree_seed = hashCell(seed_ ^ mixBits(static_cast<quint32>(span.y())), i, j, 3);
+        jobs.append(ForestTreeJob(base, candidate.priority(), tree_seed, &chunks, prototype, leaves, orientation, air));
+      }
+    }
+  }
+  if (jobs.isEmpty()) {
+    return;
+  }
+  qSort(jobs.begin(), jobs.end(), hasHigherPriority);
+  QList<ForestTree> trees = QtConcurrent::blockingMapped<QList<ForestTree> >(jobs, growForestTree);
+
+  // All the trunks go in before any leaves, so that a tree never loses its trunk to its neighbor's leaves, and
+  // otherwise the tree with the higher priority takes any cell two trees both want.  Trees planted by earlier segments
+  // of the stroke come before all of these, except that a trunk here still replaces their leaves, just as it would
+  // have if the whole stroke had been painted at once.
+  QList<BlockInstance> old_blocks;
+  QList<BlockInstance> new_blocks;
+  for (int pass = 0; pass < 2; ++pass) {
+    foreach (const ForestTree& tree, trees) {
+      int first = pass == 0 ? 0 : tree.trunkSize();
+      int last = pass == 0 ? tree.trunkSize() : tree.newBlocks().size();
+      for (int k = first; k < last; ++k) {
+        const BlockInstance& new_block = tree.newBlocks().at(k);
+        if (trunk_cells_.contains(new_block.position())) {
+          continue;
+        }
+        if (pass == 0) {
+          trunk_cells_.insert(new_block.position());
+        } else if (leaf_cells_.contains(new_block.position())) {
+          continue;
+        } else {
+          leaf_cells_.insert(new_block.position());
+        }
+        const BlockInstance& old_block = tree.oldBlocks().at(k);
+        if (old_block.prototype() != air) {
+          old_blocks.append(old_block);
+        }
+        new_blocks.append(new_block);
+      }
+    }
+  }
+  segment->replaceBlocks(old_blocks, new_blocks);
+}
+
+void ForestTool::resetStroke() {
+  BrushTool::resetStroke();
+  planted_.clear();
+  trunk_cells_.clear();
+  leaf_cells_.clear();
+}
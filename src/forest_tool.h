@@ -0,0 +1,94 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FOREST_TOOL_H
+#define FOREST_TOOL_H
+
+#include <QSet>
+
+#include "block_position.h"
+#include "brush_tool.h"
+
+class BlockManager;
+class Diagram;
+
+/**
+  * A brush that plants trees, like the ones TreeTool plants, wherever it is dragged, to cover hillsides in forest
+  * without clicking out every tree.
+  *
+  * The trees stand at the points of a fixed Poisson-disk pattern covering every level, so that no two trees are closer
+  * than kTreeSpacing blocks, and the brush plants the ones within kScatterRadius blocks of its path.  The pattern and
+  * each tree's shape are pure functions of the seed and the tree's position, so going over the same ground again, or
+  * painting it again after an undo, plants exactly the same trees.  Each segment of a stroke grows its trees in
+  * parallel on the global thread pool, reading the diagram's chunks directly, so the preview keeps up with the mouse.
+  * Where trees overlap, the one with the higher priority in the pattern wins, except that a trunk always wins over
+  * leaves, and leaves never replace existing blocks.  The tool remembers which trees a stroke has planted and which
+  * cells it has filled, so a stroke comes out the same however the mouse movements split it into segments.
+  */
+class ForestTool : public BrushTool {
+ public:
+  /**
+    * The least distance, in blocks, between two trees.
+    */
+  static const int kTreeSpacing = 6;
+
+  /**
+    * How far, in blocks, from the path of the brush trees are planted.
+    */
+  static const int kScatterRadius = 8;
+
+  ForestTool(Diagram* diagram, BlockManager* block_mgr);
+  virtual QString actionName() const;
+
+  /**
+    * Returns the seed the pattern of trees and their shapes are drawn from.
+    */
+  quint32 seed() const {
+    return seed_;
+  }
+
+  /**
+    * Sets the seed the pattern of trees and their shapes are drawn from.  Any stroke in progress is abandoned.
+    */
+  void setSeed(quint32 seed);
+
+ protected:
+  virtual void paint(const SpanMask& mask,
+                     BlockPrototype* prototype,
+                     const BlockOrientation* orientation,
+                     BlockTransaction* segment);
+  virtual void resetStroke();
+
+ private:
+  BlockManager* block_mgr_;
+  quint32 seed_;
+
+  /**
+    * The bases of the trees the stroke has planted, which later segments leave alone.
+    */
+  QSet<BlockPosition> planted_;
+
+  /**
+    * The cells the stroke has filled with trunks.
+    */
+  QSet<BlockPosition> trunk_cells_;
+
+  /**
+    * The cells the stroke has filled with leaves.
+    */
+  QSet<BlockPosition> leaf_cells_;
+};
+
+#endif // FOREST_TOOL_H
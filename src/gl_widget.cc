@@ -22,6 +22,7 @@
 
 #include "block_manager.h"
 #include "diagram.h"
+#include "diagram_subscription.h"
 #include "matrix.h"
 #include "skybox_renderable.h"
 #include "texture.h"
@@ -58,8 +59,10 @@ GLWidget::~GLWidget() {
 
 void GLWidget::setDiagram(Diagram* diagram) {
   diagram_ = diagram;
-  connect(diagram_, SIGNAL(diagramChanged(BlockTransaction)), SLOT(setSceneDirty()));
-  connect(diagram_, SIGNAL(ephemeralBlocksChanged(BlockTransaction)), SLOT(setSceneDirty()));
+  // The preview shows the whole world, but subscribing still gets us one repaint per frame instead of one per commit.
+  DiagramSubscription* subscription = diagram_->subscribe(BlockRegion::everything(), this);
+  connect(subscription, SIGNAL(diagramChanged(BlockTransaction)), SLOT(setSceneDirty()));
+  connect(subscription, SIGNAL(ephemeralBlocksChanged(BlockTransaction, BlockTransaction)), SLOT(setSceneDirty()));
 }
 
 void GLWidget::setBlockManager(BlockManager* block_mgr) {
@@ -0,0 +1,173 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gradient_noise.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define GRADIENT_NOISE_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+  * The gradients of three-dimensional noise, indexed by the bottom four bits of a hash: the twelve directions to the
+  * edges of a cube, with four of them repeated so that a hash can pick one without a division.
+  */
+static const float kGradientX[16] = { 1, -1, 1, -1, 1, -1, 1, -1, 0, 0, 0, 0, 1, -1, 0, 0 };
+static const float kGradientY[16] = { 1, 1, -1, -1, 0, 0, 0, 0, 1, -1, 1, -1, 1, 1, -1, -1 };
+static const float kGradientZ[16] = { 0, 0, 0, 0, 1, 1, -1, -1, 1, 1, -1, -1, 0, 0, 1, -1 };
+
+/**
+  * The gradients of two-dimensional noise, indexed by the bottom three bits of a hash.
+  */
+static const float kGradient2X[8] = { 1, -1, 1, -1, 1, -1, 0, 0 };
+static const float kGradient2Z[8] = { 1, 1, -1, -1, 0, 0, 1, -1 };
+
+/**
+  * The number of points noise4() evaluates at once.
+  */
+static const int kLanes = 4;
+
+/**
+  * Perlin's fade curve, 6t^5 - 15t^4 + 10t^3, which eases in and out of each lattice cell so that the noise has no
+  * creases.
+  */
+static inline float fade(float t) {
+  return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+static inline float lerp(float t, float a, float b) {
+  return a + t * (b - a);
+}
+
+GradientNoise::GradientNoise(quint32 seed) {
+  for (int i = 0; i < kPeriod; ++i) {
+    permutation_[i] = static_cast<quint8>(i);
+  }
+  // A Fisher-Yates shuffle driven by xorshift, rather than qrand(), so that the permutation is the same on every
+  // platform and doesn't disturb anyone else's random numbers.
+  quint32 state = seed ^ 0x9E3779B9u;
+  if (!state) {
+    state = 1;
+  }
+  for (int i = kPeriod - 1; i > 0; --i) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    int j = static_cast<int>(state % static_cast<quint32>(i + 1));
+    qSwap(permutation_[i], permutation_[j]);
+  }
+}
+
+float GradientNoise::noise(float x, float z) const {
+  float floor_x = floorf(x);
+  float floor_z = floorf(z);
+  int cell_x = static_cast<int>(floor_x) & (kPeriod - 1);
+  int cell_z = static_cast<int>(floor_z) & (kPeriod - 1);
+  float tx = x - floor_x;
+  float tz = z - floor_z;
+  int row0 = permutation_[cell_z];
+  int row1 = permutation_[(cell_z + 1) & (kPeriod - 1)];
+  int h00 = permutation_[(row0 + cell_x) & (kPeriod - 1)] & 7;
+  int h10 = permutation_[(row0 + cell_x + 1) & (kPeriod - 1)] & 7;
+  int h01 = permutation_[(row1 + cell_x) & (kPeriod - 1)] & 7;
+  int h11 = permutation_[(row1 + cell_x + 1) & (kPeriod - 1)] & 7;
+  float d00 = kGradient2X[h00] * tx + kGradient2Z[h00] * tz;
+  float d10 = kGradient2X[h10] * (tx - 1.0f) + kGradient2Z[h10] * tz;
+  float d01 = kGradient2X[h01] * tx + kGradient2Z[h01] * (tz - 1.0f);
+  float d11 = kGradient2X[h11] * (tx - 1.0f) + kGradient2Z[h11] * (tz - 1.0f);
+  float u = fade(tx);
+  return lerp(fade(tz), lerp(u, d00, d10), lerp(u, d01, d11));
+}
+
+void GradientNoise::noise4(const float* x, float y, float z, float* result) const {
+  // The rows of the lattice each corner lies in depend only on y and z, so they are hashed once for all four points.
+  float floor_y = floorf(y);
+  float floor_z = floorf(z);
+  int cell_y = static_cast<int>(floor_y) & (kPeriod - 1);
+  int cell_z = static_cast<int>(floor_z) & (kPeriod - 1);
+  float ty = y - floor_y;
+  float tz = z - floor_z;
+  int rows[4];
+  for (int corner = 0; corner < 4; ++corner) {
+    int plane = permutation_[(cell_z + (corner >> 1)) & (kPeriod - 1)];
+    rows[corner] = permutation_[(plane + cell_y + (corner & 1)) & (kPeriod - 1)];
+  }
+
+  // Gather the gradient at each of the eight corners of each point's cell, corner-major so that each corner's
+  // gradients for the four points sit together.  Corner bit 0 is x, bit 1 is y and bit 2 is z.
+  float tx[kLanes];
+  float gradient_x[8][kLanes];
+  float gradient_y[8][kLanes];
+  float gradient_z[8][kLanes];
+  for (int lane = 0; lane < kLanes; ++lane) {
+    float floor_x = floorf(x[lane]);
+    int cell_x = static_cast<int>(floor_x) & (kPeriod - 1);
+    tx[lane] = x[lane] - floor_x;
+    for (int corner = 0; corner < 8; ++corner) {
+      int hash = permutation_[(rows[corner >> 1] + cell_x + (corner & 1)) & (kPeriod - 1)] & 15;
+      gradient_x[corner][lane] = kGradientX[hash];
+      gradient_y[corner][lane] = kGradientY[hash];
+      gradient_z[corner][lane] = kGradientZ[hash];
+    }
+  }
+
+#ifdef GRADIENT_NOISE_USE_SSE2
+  const __m128 one = _mm_set1_ps(1.0f);
+  __m128 offset_x[2];
+  offset_x[0] = _mm_loadu_ps(tx);
+  offset_x[1] = _mm_sub_ps(offset_x[0], one);
+  __m128 offset_y[2] = { _mm_set1_ps(ty), _mm_set1_ps(ty - 1.0f) };
+  __m128 offset_z[2] = { _mm_set1_ps(tz), _mm_set1_ps(tz - 1.0f) };
+  __m128 dots[8];
+  for (int corner = 0; corner < 8; ++corner) {
+    dots[corner] = _mm_add_ps(
+        _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(gradient_x[corner]), offset_x[corner & 1]),
+                   _mm_mul_ps(_mm_loadu_ps(gradient_y[corner]), offset_y[(corner >> 1) & 1])),
+        _mm_mul_ps(_mm_loadu_ps(gradient_z[corner]), offset_z[corner >> 2]));
+  }
+  // fade(t) for x, computed in all four lanes the same way fade() does it.
+  __m128 t = offset_x[0];
+  __m128 u = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t),
+                        _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))),
+                                   _mm_set1_ps(10.0f)));
+  __m128 v = _mm_set1_ps(fade(ty));
+  __m128 w = _mm_set1_ps(fade(tz));
+  __m128 edges[4];
+  for (int edge = 0; edge < 4; ++edge) {
+    edges[edge] = _mm_add_ps(dots[edge * 2], _mm_mul_ps(u, _mm_sub_ps(dots[edge * 2 + 1], dots[edge * 2])));
+  }
+  __m128 faces[2];
+  for (int face = 0; face < 2; ++face) {
+    faces[face] = _mm_add_ps(edges[face * 2], _mm_mul_ps(v, _mm_sub_ps(edges[face * 2 + 1], edges[face * 2])));
+  }
+  _mm_storeu_ps(result, _mm_add_ps(faces[0], _mm_mul_ps(w, _mm_sub_ps(faces[1], faces[0]))));
+#else
+  float v = fade(ty);
+  float w = fade(tz);
+  for (int lane = 0; lane < kLanes; ++lane) {
+    float dots[8];
+    for (int corner = 0; corner < 8; ++corner) {
+      dots[corner] = gradient_x[corner][lane] * (corner & 1 ? tx[lane] - 1.0f : tx[lane]) +
+                     gradient_y[corner][lane] * (corner & 2 ? ty - 1.0f : ty) +
+                     gradient_z[corner][lane] * (corner & 4 ? tz - 1.0f : tz);
+    }
+    float u = fade(tx[lane]);
+    result[lane] = lerp(w, lerp(v, lerp(u, dots[0], dots[1]), lerp(u, dots[2], dots[3])),
+                        lerp(v, lerp(u, dots[4], dots[5]), lerp(u, dots[6], dots[7])));
+  }
+#endif
+}
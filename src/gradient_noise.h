@@ -0,0 +1,58 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GRADIENT_NOISE_H
+#define GRADIENT_NOISE_H
+
+#include <QtGlobal>
+
+/**
+  * Seeded gradient noise in the style of Ken Perlin's improved noise: a smooth random function that varies by about
+  * one bump per unit and lies between -1 and 1.  The lattice is hashed through a permutation of 256 entries shuffled
+  * by the seed, so the same seed always gives the same noise, on every platform, and the noise repeats every 256
+  * units along each axis.
+  *
+  * Three-dimensional noise is evaluated four points at a time along _x_, the direction cells are stored in a chunk
+  * layer.  The lattice hashing is done a point at a time, but the gradients, fades and interpolation run in the four
+  * lanes of an SSE2 register where it is available.
+  */
+class GradientNoise {
+ public:
+  /**
+    * The period of the noise along each axis.  Callers with large coordinates should wrap them into
+    * [0, kPeriod) in double precision before converting them to float, so that no precision is lost.
+    */
+  static const int kPeriod = 256;
+
+  /**
+    * Constructs the noise for \p seed.
+    */
+  explicit GradientNoise(quint32 seed);
+
+  /**
+    * Returns the two-dimensional noise at (\p x, \p z).
+    */
+  float noise(float x, float z) const;
+
+  /**
+    * Writes the three-dimensional noise at (\p x[i], \p y, \p z) to \p result[i], for \p i from 0 to 3.
+    */
+  void noise4(const float* x, float y, float z, float* result) const;
+
+ private:
+  quint8 permutation_[kPeriod];
+};
+
+#endif // GRADIENT_NOISE_H
@@ -0,0 +1,32 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "image_convert_dialog.h"
+
+ImageConvertDialog::ImageConvertDialog(const QSize& size, int level, QWidget* parent) : QDialog(parent) {
+  ui.setupUi(this);
+  ui.x_spin_box_->setValue(-size.width() / 2);
+  ui.z_spin_box_->setValue(-size.height() / 2);
+  ui.level_spin_box_->setValue(level);
+  ui.size_label_->setText(QString("%1 x %2 blocks").arg(size.width()).arg(size.height()));
+}
+
+BlockPosition ImageConvertDialog::origin() const {
+  return BlockPosition(ui.x_spin_box_->value(), ui.level_spin_box_->value(), ui.z_spin_box_->value());
+}
+
+ImageConverter::Dithering ImageConvertDialog::dithering() const {
+  return ui.dither_check_box_->isChecked() ? ImageConverter::kDitheringFloydSteinberg : ImageConverter::kDitheringNone;
+}
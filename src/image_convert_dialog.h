@@ -0,0 +1,51 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IMAGE_CONVERT_DIALOG_H
+#define IMAGE_CONVERT_DIALOG_H
+
+#include "block_position.h"
+#include "image_converter.h"
+#include "ui_image_convert_dialog.h"
+
+/**
+  * The dialog that asks where to build an image out of blocks, and whether to dither it (see
+  * LevelWidget::convertImage()).
+  */
+class ImageConvertDialog : public QDialog {
+  Q_OBJECT
+
+ public:
+  /**
+    * Constructs a dialog for converting an image of \p size pixels, placing it on \p level by default.  The image
+    * starts out centered on the origin.
+    */
+  ImageConvertDialog(const QSize& size, int level, QWidget* parent = NULL);
+
+  /**
+    * Returns where the block for the top left pixel of the image should go.
+    */
+  BlockPosition origin() const;
+
+  /**
+    * Returns how the image should be dithered.
+    */
+  ImageConverter::Dithering dithering() const;
+
+ private:
+  Ui::ImageConvertDialog ui;
+};
+
+#endif // IMAGE_CONVERT_DIALOG_H
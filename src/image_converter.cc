@@ -0,0 +1,363 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "image_converter.h"
+
+#include <QList>
+#include <QPixmap>
+#include <QtConcurrentMap>
+
+#include <float.h>
+#include <math.h>
+
+#include "block_manager.h"
+#include "block_prototype.h"
+#include "chunk.h"
+#include "chunk_position.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define IMAGE_CONVERTER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+  * The number of palette entries compared at once by nearestBlock().  The palette is padded to a multiple of this.
+  */
+static const int kPaletteStride = 4;
+
+/**
+  * A Lab component far from that of any real color, used to pad the palette.
+  */
+static const float kPaddingComponent = 1e6f;
+
+/**
+  * The number of bits of a color's hash used to pick its slot in the cache of recently chosen blocks.
+  */
+static const int kCacheBits = 12;
+
+/**
+  * The white point of the sRGB color space (D65), in CIE XYZ.
+  */
+static const float kWhiteX = 0.95047f;
+static const float kWhiteY = 1.0f;
+static const float kWhiteZ = 1.08883f;
+
+/**
+  * The nonlinear part of the conversion from CIE XYZ to Lab, applied to each component divided by the white point's.
+  */
+static float labCurve(float t) {
+  if (t > 216.0f / 24389.0f) {
+    return static_cast<float>(pow(t, 1.0 / 3.0));
+  }
+  return (24389.0f / 27.0f * t + 16.0f) / 116.0f;
+}
+
+/**
+  * One band of the image, a chunk tall and as wide as the whole image, to be turned into chunk layers.
+  */
+class ImageBandJob {
+ public:
+  ImageBandJob(int band, const QImage* image, const QVector<qint16>* dithered_blocks,
+               const ImageConverter* converter)
+      : band_(band), image_(image), dithered_blocks_(dithered_blocks), converter_(converter) {}
+
+  /**
+    * Returns the position of the band in the image, in chunks.
+    */
+  int band() const {
+    return band_;
+  }
+
+  /**
+    * Returns the image being converted, in QImage::Format_ARGB32.
+    */
+  const QImage& image() const {
+    return *image_;
+  }
+
+  /**
+    * Returns the blocks already chosen for each pixel by ImageConverter::ditheredBlocks(), or an empty vector if the
+    * image isn't being dithered.
+    */
+  const QVector<qint16>& ditheredBlocks() const {
+    return *dithered_blocks_;
+  }
+
+  const ImageConverter& converter() const {
+    return *converter_;
+  }
+
+ private:
+  int band_;
+  const QImage* image_;
+  const QVector<qint16>* dithered_blocks_;
+  const ImageConverter* converter_;
+};
+
+/**
+  * Returns the layers holding the blocks for the band of the image in \p job.
+  */
+static QList<BlockClipboard::Layer> convertBand(const ImageBandJob& job) {
+  const QImage& image = job.image();
+  const QVector<qint16>& dithered_blocks = job.ditheredBlocks();
+  const ImageConverter& converter = job.converter();
+  int width = image.width();
+  int first_y = job.band() * kChunkSize;
+  int last_y = qMin(first_y + kChunkMask, image.height() - 1);
+  QVector<ChunkLayer> layers((width + kChunkMask) >> kChunkShift);
+
+  // Without dithering, the block for a color never changes, so recent choices are remembered by color.  Only opaque
+  // colors are looked up, and they are stored with their alpha set, so an empty slot is one holding zero.
+  QVector<QRgb> cached_colors(1 << kCacheBits, 0);
+  QVector<int> cached_blocks(1 << kCacheBits, 0);
+  for (int y = first_y; y <= last_y; ++y) {
+    const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+    for (int x = 0; x < width; ++x) {
+      int block;
+      if (!dithered_blocks.isEmpty()) {
+        block = dithered_blocks.at(y * width + x);
+      } else if (qAlpha(line[x]) < ImageConverter::kOpaqueAlpha) {
+        block = -1;
+      } else {
+        QRgb color = line[x] | 0xFF000000;
+        int slot = static_cast<quint32>(color * 2654435761u) >> (32 - kCacheBits);
+        if (cached_colors.at(slot) != color) {
+          float l, a, b;
+          converter.toLab(color, &l, &a, &b);
+          cached_colors[slot] = color;
+          cached_blocks[slot] = converter.nearestBlock(l, a, b);
+        }
+        block = cached_blocks.at(slot);
+      }
+      if (block >= 0) {
+        BlockPrototype* prototype = converter.block(block);
+        layers[x >> kChunkShift].setBlock(ChunkLayer::cellIndex(x & kChunkMask, y & kChunkMask),
+                                          prototype, prototype->defaultOrientation());
+      }
+    }
+  }
+
+  QList<BlockClipboard::Layer> result;
+  for (int i = 0; i < layers.size(); ++i) {
+    if (!layers.at(i).isEmpty()) {
+      result.append(BlockClipboard::Layer(ChunkPosition(i, 0, job.band()), 0, layers.at(i)));
+    }
+  }
+  return result;
+}
+
+ImageConverter::ImageConverter(BlockManager* block_mgr) {
+  linear_.reserve(256);
+  for (int i = 0; i < 256; ++i) {
+    double value = i / 255.0;
+    linear_.append(static_cast<float>(value <= 0.04045 ? value / 12.92 : pow((value + 0.055) / 1.055, 2.4)));
+  }
+
+  BlockTypeIterator iter = BlockPrototype::blockIterator();
+  while (iter.hasNext()) {
+    BlockPrototype* prototype = block_mgr->getPrototype(iter.next());
+    if (!prototype->isOpaqueCube()) {
+      continue;
+    }
+    float red, green, blue;
+    if (averageLinearColor(prototype, &red, &green, &blue)) {
+      addBlock(prototype, red, green, blue);
+    }
+  }
+
+  while (lightness_.size() % kPaletteStride) {
+    lightness_.append(kPaddingComponent);
+    green_red_.append(kPaddingComponent);
+    blue_yellow_.append(kPaddingComponent);
+  }
+}
+
+bool ImageConverter::averageLinearColor(BlockPrototype* prototype, float* red, float* green, float* blue) const {
+  // Average in linear light, which is how the eye would blend the texture's pixels from a distance.
+  QImage sprite = prototype->sprite().toImage().convertToFormat(QImage::Format_ARGB32);
+  double red_sum = 0;
+  double green_sum = 0;
+  double blue_sum = 0;
+  int count = 0;
+  for (int y = 0; y < sprite.height(); ++y) {
+    const QRgb* line = reinterpret_cast<const QRgb*>(sprite.constScanLine(y));
+    for (int x = 0; x < sprite.width(); ++x) {
+      if (qAlpha(line[x]) >= kOpaqueAlpha) {
+        red_sum += linear_.at(qRed(line[x]));
+        green_sum += linear_.at(qGreen(line[x]));
+        blue_sum += linear_.at(qBlue(line[x]));
+        ++count;
+      }
+    }
+  }
+  if (!count) {
+    return false;
+  }
+  *red = red_sum / count;
+  *green = green_sum / count;
+  *blue = blue_sum / count;
+  return true;
+}
+
+QRgb ImageConverter::averageColor(BlockPrototype* prototype) const {
+  float linear[3];
+  if (!averageLinearColor(prototype, &linear[0], &linear[1], &linear[2])) {
+    return qRgb(0x80, 0x80, 0x80);
+  }
+  int channels[3];
+  for (int i = 0; i < 3; ++i) {
+    double value = linear[i] <= 0.0031308 ? 12.92 * linear[i] : 1.055 * pow(linear[i], 1.0 / 2.4) - 0.055;
+    channels[i] = qBound(0, qRound(value * 255.0), 255);
+  }
+  return qRgb(channels[0], channels[1], channels[2]);
+}
+
+void ImageConverter::addBlock(BlockPrototype* prototype, float red, float green, float blue) {
+  float l, a, b;
+  linearToLab(red, green, blue, &l, &a, &b);
+  blocks_.append(prototype);
+  lightness_.append(l);
+  green_red_.append(a);
+  blue_yellow_.append(b);
+}
+
+BlockClipboard ImageConverter::convert(const QImage& image, Dithering dithering) const {
+  if (image.isNull() || blocks_.isEmpty()) {
+    return BlockClipboard();
+  }
+  QImage argb_image = image.convertToFormat(QImage::Format_ARGB32);
+  QVector<qint16> dithered_blocks;
+  if (dithering == kDitheringFloydSteinberg) {
+    dithered_blocks = ditheredBlocks(argb_image);
+  }
+  QList<ImageBandJob> jobs;
+  for (int band = 0; band * kChunkSize < argb_image.height(); ++band) {
+    jobs.append(ImageBandJob(band, &argb_image, &dithered_blocks, this));
+  }
+  QList<QList<BlockClipboard::Layer> > results =
+      QtConcurrent::blockingMapped<QList<QList<BlockClipboard::Layer> > >(jobs, convertBand);
+  BlockClipboard clipboard(argb_image.width(), 1, argb_image.height());
+  clipboard.setLayers(results);
+  return clipboard;
+}
+
+QVector<qint16> ImageConverter::ditheredBlocks(const QImage& image) const {
+  int width = image.width();
+  QVector<qint16> blocks(width * image.height());
+  // The error carried into the current row and the next, three components per pixel, with a pixel of padding at each
+  // end so that the error pushed off the sides of the image needs no special case.
+  int row_size = 3 * (width + 2);
+  QVector<float> errors(2 * row_size, 0.0f);
+  for (int y = 0; y < image.height(); ++y) {
+    float* current = errors.data() + (y & 1) * row_size;
+    float* next = errors.data() + ((y + 1) & 1) * row_size;
+    qFill(next, next + row_size, 0.0f);
+    const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+    for (int x = 0; x < width; ++x) {
+      if (qAlpha(line[x]) < kOpaqueAlpha) {
+        blocks[y * width + x] = -1;
+        continue;
+      }
+      float wanted[3];
+      toLab(line[x], &wanted[0], &wanted[1], &wanted[2]);
+      float* error = current + 3 * (x + 1);
+      for (int i = 0; i < 3; ++i) {
+        wanted[i] += error[i];
+      }
+      int block = nearestBlock(wanted[0], wanted[1], wanted[2]);
+      blocks[y * width + x] = block;
+      float chosen[3] = {lightness_.at(block), green_red_.at(block), blue_yellow_.at(block)};
+      for (int i = 0; i < 3; ++i) {
+        float remainder = wanted[i] - chosen[i];
+        error[3 + i] += remainder * 7.0f / 16.0f;
+        next[3 * x + i] += remainder * 3.0f / 16.0f;
+        next[3 * (x + 1) + i] += remainder * 5.0f / 16.0f;
+        next[3 * (x + 2) + i] += remainder / 16.0f;
+      }
+    }
+  }
+  return blocks;
+}
+
+void ImageConverter::toLab(QRgb rgb, float* l, float* a, float* b) const {
+  linearToLab(linear_.at(qRed(rgb)), linear_.at(qGreen(rgb)), linear_.at(qBlue(rgb)), l, a, b);
+}
+
+// Static.
+void ImageConverter::linearToLab(float red, float green, float blue, float* l, float* a, float* b) {
+  float x = labCurve((0.4124f * red + 0.3576f * green + 0.1805f * blue) / kWhiteX);
+  float y = labCurve((0.2126f * red + 0.7152f * green + 0.0722f * blue) / kWhiteY);
+  float z = labCurve((0.0193f * red + 0.1192f * green + 0.9505f * blue) / kWhiteZ);
+  *l = 116.0f * y - 16.0f;
+  *a = 500.0f * (x - y);
+  *b = 200.0f * (y - z);
+}
+
+int ImageConverter::nearestBlock(float l, float a, float b) const {
+  Q_ASSERT(!blocks_.isEmpty());
+  const float* lightness = lightness_.constData();
+  const float* green_red = green_red_.constData();
+  const float* blue_yellow = blue_yellow_.constData();
+  int count = lightness_.size();
+#ifdef IMAGE_CONVERTER_USE_SSE2
+  // Keep the closest block seen so far in each of the four lanes, then pick the closest of the four.
+  __m128 wanted_l = _mm_set1_ps(l);
+  __m128 wanted_a = _mm_set1_ps(a);
+  __m128 wanted_b = _mm_set1_ps(b);
+  __m128 best_distances = _mm_set1_ps(FLT_MAX);
+  __m128i best_indices = _mm_setzero_si128();
+  __m128i indices = _mm_setr_epi32(0, 1, 2, 3);
+  const __m128i stride = _mm_set1_epi32(kPaletteStride);
+  for (int i = 0; i < count; i += kPaletteStride) {
+    __m128 delta_l = _mm_sub_ps(_mm_loadu_ps(lightness + i), wanted_l);
+    __m128 delta_a = _mm_sub_ps(_mm_loadu_ps(green_red + i), wanted_a);
+    __m128 delta_b = _mm_sub_ps(_mm_loadu_ps(blue_yellow + i), wanted_b);
+    __m128 distances = _mm_add_ps(_mm_add_ps(_mm_mul_ps(delta_l, delta_l), _mm_mul_ps(delta_a, delta_a)),
+                                  _mm_mul_ps(delta_b, delta_b));
+    __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distances, best_distances));
+    best_distances = _mm_min_ps(distances, best_distances);
+    best_indices = _mm_or_si128(_mm_and_si128(closer, indices), _mm_andnot_si128(closer, best_indices));
+    indices = _mm_add_epi32(indices, stride);
+  }
+  float lane_distances[kPaletteStride];
+  qint32 lane_indices[kPaletteStride];
+  _mm_storeu_ps(lane_distances, best_distances);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lane_indices), best_indices);
+  int best = lane_indices[0];
+  float best_distance = lane_distances[0];
+  for (int lane = 1; lane < kPaletteStride; ++lane) {
+    if (lane_distances[lane] < best_distance ||
+        (lane_distances[lane] == best_distance && lane_indices[lane] < best)) {
+      best = lane_indices[lane];
+      best_distance = lane_distances[lane];
+    }
+  }
+  return best;
+#else
+  int best = 0;
+  float best_distance = FLT_MAX;
+  for (int i = 0; i < count; ++i) {
+    float delta_l = lightness[i] - l;
+    float delta_a = green_red[i] - a;
+    float delta_b = blue_yellow[i] - b;
+    float distance = delta_l * delta_l + delta_a * delta_a + delta_b * delta_b;
+    if (distance < best_distance) {
+      best = i;
+      best_distance = distance;
+    }
+  }
+  return best;
+#endif
+}
@@ -0,0 +1,136 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IMAGE_CONVERTER_H
+#define IMAGE_CONVERTER_H
+
+#include <QImage>
+#include <QVector>
+
+#include "block_clipboard.h"
+
+class BlockManager;
+class BlockPrototype;
+
+/**
+  * Turns an image into a level of blocks, one block per pixel, so that pixel art can be built without tracing it
+  * block by block over a template image.
+  *
+  * Each pixel becomes the block whose texture is closest in color on average.  Only opaque full cubes are used, since
+  * anything else wouldn't look like its sprite from above.  Colors are compared in CIE Lab space, where distances
+  * roughly match how different colors look, and the search over the palette compares four blocks at a time with SSE2
+  * where it is available.  The image is converted a chunk row at a time in parallel on the global thread pool; without
+  * dithering, each row also remembers the blocks it has already chosen for recent colors, since most images reuse a
+  * small number of them.  Floyd-Steinberg dithering carries each pixel's error into the next row, so the blocks are
+  * then chosen in a single pass before the rows are built in parallel.
+  */
+class ImageConverter {
+ public:
+  enum Dithering {
+    kDitheringNone,
+    kDitheringFloydSteinberg
+  };
+
+  /**
+    * The lowest alpha a pixel can have and still become a block.  TerrainGenerator uses the same test for which
+    * heightmap pixels have a column.
+    */
+  static const int kOpaqueAlpha = 128;
+
+  /**
+    * Builds the palette of blocks from the sprites of every block type \p block_mgr knows of.  Because this reads the
+    * sprite pixmaps, it must be done on the GUI thread.
+    */
+  explicit ImageConverter(BlockManager* block_mgr);
+
+  /**
+    * Returns a clipboard one level tall holding the blocks for \p image, with pixel (_x_, _y_) at block (_x_, 0, _y_),
+    * so that the top of the image is to the north.  Pixels that are more than half transparent are left as air.
+    */
+  BlockClipboard convert(const QImage& image, Dithering dithering) const;
+
+  /**
+    * Converts \p rgb, an sRGB color, to CIE Lab, writing its lightness to \p l and its green-red and blue-yellow
+    * components to \p a and \p b.
+    */
+  void toLab(QRgb rgb, float* l, float* a, float* b) const;
+
+  /**
+    * Returns the index of the block in the palette whose color is closest to the CIE Lab color \p l, \p a, \p b.
+    * There must be at least one block in the palette.
+    */
+  int nearestBlock(float l, float a, float b) const;
+
+  /**
+    * Returns the average color of the sprite for \p prototype, ignoring its transparent pixels.  Unlike the rest of
+    * this class, this works for any block, not just those in the palette.  Blocks whose sprites are entirely
+    * transparent are given a mid gray.
+    */
+  QRgb averageColor(BlockPrototype* prototype) const;
+
+  /**
+    * Returns the block at \p index in the palette.
+    */
+  BlockPrototype* block(int index) const {
+    return blocks_.at(index);
+  }
+
+  /**
+    * Returns the number of blocks in the palette.
+    */
+  int paletteSize() const {
+    return blocks_.size();
+  }
+
+ private:
+  /**
+    * Chooses the block for every pixel of \p image, which must be in QImage::Format_ARGB32, with Floyd-Steinberg
+    * dithering.  The result holds the palette index for each pixel a row at a time, or -1 for pixels left as air.
+    */
+  QVector<qint16> ditheredBlocks(const QImage& image) const;
+
+  /**
+    * Finds the average color of the sprite for \p prototype in linear RGB.
+    * @return Whether the sprite has any pixels opaque enough to count.
+    */
+  bool averageLinearColor(BlockPrototype* prototype, float* red, float* green, float* blue) const;
+
+  /**
+    * Appends the block \p prototype, whose average color in linear RGB is \p red, \p green, \p blue, to the palette.
+    */
+  void addBlock(BlockPrototype* prototype, float red, float green, float blue);
+
+  /**
+    * Converts \p red, \p green, \p blue, a color in linear RGB, to CIE Lab.
+    */
+  static void linearToLab(float red, float green, float blue, float* l, float* a, float* b);
+
+  /**
+    * The linear intensity of each 8-bit sRGB channel value.
+    */
+  QVector<float> linear_;
+
+  QVector<BlockPrototype*> blocks_;
+
+  /**
+    * The Lab colors of the blocks, one array per component so that they can be loaded four at a time.  The arrays are
+    * padded to a multiple of four with colors far from any real one.
+    */
+  QVector<float> lightness_;
+  QVector<float> green_red_;
+  QVector<float> blue_yellow_;
+};
+
+#endif // IMAGE_CONVERTER_H
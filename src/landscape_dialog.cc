@@ -0,0 +1,50 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "landscape_dialog.h"
+
+#include "landscape_generator.h"
+
+LandscapeDialog::LandscapeDialog(int level, QWidget* parent) : QDialog(parent) {
+  ui.setupUi(this);
+  ui.x_spin_box_->setValue(-ui.width_spin_box_->value() / 2);
+  ui.z_spin_box_->setValue(-ui.depth_spin_box_->value() / 2);
+  ui.level_spin_box_->setValue(level);
+  ui.seed_spin_box_->setValue(qrand());
+}
+
+BlockPosition LandscapeDialog::origin() const {
+  return BlockPosition(ui.x_spin_box_->value(), ui.level_spin_box_->value(), ui.z_spin_box_->value());
+}
+
+int LandscapeDialog::width() const {
+  return ui.width_spin_box_->value();
+}
+
+int LandscapeDialog::depth() const {
+  return ui.depth_spin_box_->value();
+}
+
+quint32 LandscapeDialog::seed() const {
+  return ui.seed_spin_box_->value();
+}
+
+void LandscapeDialog::configure(LandscapeGenerator* generator) const {
+  generator->setHeight(ui.height_spin_box_->value());
+  generator->setFeatureSize(ui.feature_size_spin_box_->value());
+  generator->setSeaLevel(ui.sea_level_spin_box_->value());
+  generator->setCaves(ui.caves_check_box_->isChecked());
+  generator->setOres(ui.ores_check_box_->isChecked());
+}
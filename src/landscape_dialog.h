@@ -0,0 +1,63 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LANDSCAPE_DIALOG_H
+#define LANDSCAPE_DIALOG_H
+
+#include "block_position.h"
+#include "ui_landscape_dialog.h"
+
+class LandscapeGenerator;
+
+/**
+  * The dialog that asks where to generate a landscape, how big to make it, and what it should look like (see
+  * LevelWidget::generateLandscape()).
+  */
+class LandscapeDialog : public QDialog {
+  Q_OBJECT
+
+ public:
+  /**
+    * Constructs a dialog for generating a landscape on \p level by default.  The landscape starts out centered on the
+    * origin, with a random seed.
+    */
+  explicit LandscapeDialog(int level, QWidget* parent = NULL);
+
+  /**
+    * Returns where the corner of the landscape at its west, north and bottom edges should go.
+    */
+  BlockPosition origin() const;
+
+  /**
+    * Returns the size of the landscape along x and z.
+    */
+  int width() const;
+  int depth() const;
+
+  /**
+    * Returns the seed the landscape should be generated from.
+    */
+  quint32 seed() const;
+
+  /**
+    * Applies the chosen height, hill size, sea level, caves and ores to \p generator.
+    */
+  void configure(LandscapeGenerator* generator) const;
+
+ private:
+  Ui::LandscapeDialog ui;
+};
+
+#endif // LANDSCAPE_DIALOG_H
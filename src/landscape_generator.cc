@@ -0,0 +1,328 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "landscape_generator.h"
+
+#include <QList>
+#include <QtConcurrentMap>
+
+#include <math.h>
+
+#include "block_manager.h"
+#include "block_prototype.h"
+#include "chunk.h"
+#include "chunk_position.h"
+
+/**
+  * The number of octaves of noise summed for the height of the hills.  Each octave has twice the frequency and half the
+  * amplitude of the one before.
+  */
+static const int kHillOctaves = 5;
+
+/**
+  * How far apart, in blocks, the octaves of hill noise are sampled, so that their lattices don't line up.
+  */
+static const int kOctaveOffset = 1013;
+
+/**
+  * The rough size of a cave, across and from floor to ceiling.
+  */
+static const int kCaveWidth = 24;
+static const int kCaveHeight = 12;
+
+/**
+  * How high the cave noise must be for a cell to be hollowed out.
+  */
+static const float kCaveThreshold = 0.35f;
+
+/**
+  * The rough size of a pocket of ore.
+  */
+static const int kOreSize = 5;
+
+/**
+  * How high the ore noise must be for stone to turn into ore, and into one of the rarer ores at the cores of
+  * pockets deep enough down.
+  */
+static const float kOreThreshold = 0.6f;
+static const float kRareOreThreshold = 0.7f;
+
+/**
+  * The levels, counting from the bottom of the landscape, below which each ore may be found.  Coal may be found at
+  * any depth.
+  */
+static const int kDiamondOreLevel = 16;
+static const int kGoldOreLevel = 32;
+static const int kIronOreLevel = 64;
+
+/**
+  * The number of blocks of dirt under the grass.
+  */
+static const int kDirtDepth = 3;
+
+/**
+  * The types of the blocks a landscape is built from.
+  */
+static const blocktype_t kStoneType = 0x01;
+static const blocktype_t kGrassType = 0x02;
+static const blocktype_t kDirtType = 0x03;
+static const blocktype_t kBedrockType = 0x07;
+static const blocktype_t kWaterType = 0x08;
+static const blocktype_t kSandType = 0x0C;
+static const blocktype_t kGoldOreType = 0x0E;
+static const blocktype_t kIronOreType = 0x0F;
+static const blocktype_t kCoalOreType = 0x10;
+static const blocktype_t kDiamondOreType = 0x38;
+
+/**
+  * Returns \p coordinate times \p frequency, wrapped into [0, GradientNoise::kPeriod).  The noise repeats with that
+  * period anyway, and wrapping in double precision keeps the fraction exact however far from the origin the block is.
+  */
+static float noiseCoordinate(double coordinate, double frequency) {
+  double u = coordinate * frequency;
+  return static_cast<float>(u - GradientNoise::kPeriod * floor(u / GradientNoise::kPeriod));
+}
+
+/**
+  * One chunk column of the landscape to be generated.
+  */
+class LandscapeColumnJob {
+ public:
+  LandscapeColumnJob(const LandscapeGenerator* generator, int x, int z, int chunk_x, int chunk_z, int width, int depth)
+      : generator_(generator), x_(x), z_(z), chunk_x_(chunk_x), chunk_z_(chunk_z), width_(width), depth_(depth) {}
+
+  const LandscapeGenerator* generator() const {
+    return generator_;
+  }
+
+  /**
+    * Returns the position in the world of the corner of the whole landscape.
+    */
+  int x() const {
+    return x_;
+  }
+  int z() const {
+    return z_;
+  }
+
+  /**
+    * Returns the position of the column in the landscape, in chunks.
+    */
+  int chunkX() const {
+    return chunk_x_;
+  }
+  int chunkZ() const {
+    return chunk_z_;
+  }
+
+  /**
+    * Returns the size of the whole landscape along x and z.
+    */
+  int width() const {
+    return width_;
+  }
+  int depth() const {
+    return depth_;
+  }
+
+ private:
+  const LandscapeGenerator* generator_;
+  int x_;
+  int z_;
+  int chunk_x_;
+  int chunk_z_;
+  int width_;
+  int depth_;
+};
+
+/**
+  * Returns the layers holding the landscape in the chunk column of \p job.
+  */
+static QList<BlockClipboard::Layer> generateLandscapeColumn(const LandscapeColumnJob& job) {
+  int first_x = job.chunkX() * kChunkSize;
+  int first_z = job.chunkZ() * kChunkSize;
+  QVector<ChunkLayer> layers;
+  job.generator()->generateColumn(job.x() + first_x, job.z() + first_z, qMin(kChunkSize, job.width() - first_x),
+                                  qMin(kChunkSize, job.depth() - first_z), &layers);
+  QList<BlockClipboard::Layer> result;
+  for (int level = 0; level < layers.size(); ++level) {
+    if (!layers.at(level).isEmpty()) {
+      ChunkPosition chunk_position(job.chunkX(), ChunkPosition::chunkCoordinate(level), job.chunkZ());
+      result.append(BlockClipboard::Layer(chunk_position, ChunkPosition::localCoordinate(level), layers.at(level)));
+    }
+  }
+  return result;
+}
+
+LandscapeGenerator::LandscapeGenerator(BlockManager* block_mgr, quint32 seed)
+    : height_(64),
+      feature_size_(64),
+      sea_level_(20),
+      caves_(true),
+      ores_(true),
+      hill_noise_(seed),
+      cave_noise_(seed + 1),
+      ore_noise_(seed + 2),
+      bedrock_(block_mgr->getPrototype(kBedrockType)),
+      stone_(block_mgr->getPrototype(kStoneType)),
+      dirt_(block_mgr->getPrototype(kDirtType)),
+      grass_(block_mgr->getPrototype(kGrassType)),
+      sand_(block_mgr->getPrototype(kSandType)),
+      water_(block_mgr->getPrototype(kWaterType)),
+      coal_ore_(block_mgr->getPrototype(kCoalOreType)),
+      iron_ore_(block_mgr->getPrototype(kIronOreType)),
+      gold_ore_(block_mgr->getPrototype(kGoldOreType)),
+      diamond_ore_(block_mgr->getPrototype(kDiamondOreType)) {}
+
+void LandscapeGenerator::setHeight(int height) {
+  Q_ASSERT(height > 0);
+  height_ = height;
+}
+
+void LandscapeGenerator::setFeatureSize(int feature_size) {
+  Q_ASSERT(feature_size > 0);
+  feature_size_ = feature_size;
+}
+
+void LandscapeGenerator::setSeaLevel(int sea_level) {
+  sea_level_ = sea_level;
+}
+
+void LandscapeGenerator::setCaves(bool caves) {
+  caves_ = caves;
+}
+
+void LandscapeGenerator::setOres(bool ores) {
+  ores_ = ores;
+}
+
+BlockClipboard LandscapeGenerator::generate(int x, int z, int width, int depth) const {
+  if (width <= 0 || depth <= 0) {
+    return BlockClipboard();
+  }
+  QList<LandscapeColumnJob> jobs;
+  for (int chunk_z = 0; chunk_z * kChunkSize < depth; ++chunk_z) {
+    for (int chunk_x = 0; chunk_x * kChunkSize < width; ++chunk_x) {
+      jobs.append(LandscapeColumnJob(this, x, z, chunk_x, chunk_z, width, depth));
+    }
+  }
+  QList<QList<BlockClipboard::Layer> > results =
+      QtConcurrent::blockingMapped<QList<QList<BlockClipboard::Layer> > >(jobs, generateLandscapeColumn);
+  BlockClipboard clipboard(width, height_, depth);
+  clipboard.setLayers(results);
+  return clipboard;
+}
+
+void LandscapeGenerator::generateColumn(int x, int z, int width, int depth, QVector<ChunkLayer>* layers) const {
+  Q_ASSERT(width <= kChunkSize && depth <= kChunkSize);
+  // The surface comes first, since it decides which levels need any cave or ore noise at all.
+  int surface_heights[kChunkLayerArea];
+  int row_heights[kChunkSize];
+  int column_height = 0;
+  for (int local_z = 0; local_z < depth; ++local_z) {
+    row_heights[local_z] = 0;
+    for (int local_x = 0; local_x < width; ++local_x) {
+      int surface_height = surfaceHeight(x + local_x, z + local_z);
+      surface_heights[ChunkLayer::cellIndex(local_x, local_z)] = surface_height;
+      row_heights[local_z] = qMax(row_heights[local_z], surface_height);
+      column_height = qMax(column_height, qMax(surface_height, qMin(sea_level_, height_)));
+    }
+  }
+  layers->resize(column_height);
+
+  // Noise is evaluated for whole rows of a chunk, four cells at a time, even past the edge of the landscape.
+  float cave_x[kChunkSize];
+  float ore_x[kChunkSize];
+  for (int local_x = 0; local_x < kChunkSize; ++local_x) {
+    cave_x[local_x] = noiseCoordinate(x + local_x, 1.0 / kCaveWidth);
+    ore_x[local_x] = noiseCoordinate(x + local_x, 1.0 / kOreSize);
+  }
+  float caves[kChunkSize];
+  float ores[kChunkSize];
+  for (int level = 0; level < column_height; ++level) {
+    ChunkLayer& layer = (*layers)[level];
+    float cave_y = noiseCoordinate(level, 1.0 / kCaveHeight);
+    float ore_y = noiseCoordinate(level, 1.0 / kOreSize);
+    for (int local_z = 0; local_z < depth; ++local_z) {
+      bool carve = caves_ && level > 0 && level < row_heights[local_z] - 1;
+      bool mine = ores_ && level > 0 && level < row_heights[local_z] - 1 - kDirtDepth;
+      if (carve) {
+        float cave_z = noiseCoordinate(z + local_z, 1.0 / kCaveWidth);
+        for (int local_x = 0; local_x < kChunkSize; local_x += 4) {
+          cave_noise_.noise4(cave_x + local_x, cave_y, cave_z, caves + local_x);
+        }
+      }
+      if (mine) {
+        float ore_z = noiseCoordinate(z + local_z, 1.0 / kOreSize);
+        for (int local_x = 0; local_x < kChunkSize; local_x += 4) {
+          ore_noise_.noise4(ore_x + local_x, ore_y, ore_z, ores + local_x);
+        }
+      }
+      for (int local_x = 0; local_x < width; ++local_x) {
+        int cell = ChunkLayer::cellIndex(local_x, local_z);
+        BlockPrototype* prototype = blockAt(level, surface_heights[cell], carve ? caves[local_x] : 0.0f,
+                                            mine ? ores[local_x] : 0.0f);
+        if (prototype) {
+          layer.setBlock(cell, prototype, prototype->defaultOrientation());
+        }
+      }
+    }
+  }
+}
+
+int LandscapeGenerator::surfaceHeight(int x, int z) const {
+  float sum = 0.0f;
+  float total = 0.0f;
+  float amplitude = 1.0f;
+  double frequency = 1.0 / feature_size_;
+  for (int octave = 0; octave < kHillOctaves; ++octave) {
+    sum += amplitude * hill_noise_.noise(noiseCoordinate(x + octave * kOctaveOffset, frequency),
+                                         noiseCoordinate(z + octave * kOctaveOffset, frequency));
+    total += amplitude;
+    amplitude *= 0.5f;
+    frequency *= 2.0;
+  }
+  return qBound(1, qRound(height_ * (0.4f + 0.75f * sum / total)), height_);
+}
+
+BlockPrototype* LandscapeGenerator::blockAt(int level, int surface_height, float cave, float ore) const {
+  if (level >= surface_height) {
+    return level < sea_level_ ? water_ : NULL;
+  }
+  if (level == 0) {
+    return bedrock_;
+  }
+  // The top block is never hollowed out, so caves only open up to the sky where hills are steep.
+  bool underwater = (surface_height <= sea_level_);
+  if (level == surface_height - 1) {
+    return underwater ? sand_ : grass_;
+  }
+  if (cave > kCaveThreshold) {
+    return NULL;
+  }
+  if (level >= surface_height - 1 - kDirtDepth) {
+    return underwater ? sand_ : dirt_;
+  }
+  if (ore > kOreThreshold) {
+    if (ore > kRareOreThreshold && level < kDiamondOreLevel) {
+      return diamond_ore_;
+    }
+    if (ore > kRareOreThreshold && level < kGoldOreLevel) {
+      return gold_ore_;
+    }
+    return level < kIronOreLevel ? iron_ore_ : coal_ore_;
+  }
+  return stone_;
+}
@@ -0,0 +1,120 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LANDSCAPE_GENERATOR_H
+#define LANDSCAPE_GENERATOR_H
+
+#include <QVector>
+
+#include "block_clipboard.h"
+#include "gradient_noise.h"
+
+class BlockManager;
+class BlockPrototype;
+
+/**
+  * Builds a landscape out of seeded noise, to give large builds some ground to stand on: rolling hills of grass over
+  * dirt and stone, sand and water below sea level, caves hollowed out of the hills, and pockets of ore in the stone.
+  *
+  * The landscape is a pure function of the seed, the settings and world coordinates.  Generating the same area twice
+  * gives the same blocks, and areas generated side by side with the same seed meet seamlessly.
+  *
+  * Hill heights come from several octaves of two-dimensional GradientNoise, and caves and ores from three-dimensional
+  * noise, which is evaluated four cells at a time.  Each chunk column is generated in parallel on the global thread
+  * pool, straight into chunk layers.
+  */
+class LandscapeGenerator {
+ public:
+  /**
+    * Prepares to generate the landscape for \p seed, using \p block_mgr to look up its blocks.  Because this looks up
+    * prototypes, it must be done on the GUI thread.
+    */
+  LandscapeGenerator(BlockManager* block_mgr, quint32 seed);
+
+  /**
+    * Sets how many levels the landscape may span.  The default is 64.
+    */
+  void setHeight(int height);
+
+  /**
+    * Sets the rough width of a hill, in blocks.  The default is 64.
+    */
+  void setFeatureSize(int feature_size);
+
+  /**
+    * Sets the level up to which low ground is flooded with water, counting from the bottom of the landscape.  Zero
+    * means no water.  The default is 20.
+    */
+  void setSeaLevel(int sea_level);
+
+  /**
+    * Sets whether caves are hollowed out of the ground.  The default is yes.
+    */
+  void setCaves(bool caves);
+
+  /**
+    * Sets whether pockets of ore are scattered through the stone.  The default is yes.
+    */
+  void setOres(bool ores);
+
+  /**
+    * Returns a clipboard holding the \p width x \p depth blocks of landscape whose corner at its west and north edges
+    * is at \p x, \p z in the world.  The clipboard is as tall as the landscape's height.
+    */
+  BlockClipboard generate(int x, int z, int width, int depth) const;
+
+  /**
+    * Fills \p layers, one per level, with the landscape in the \p width x \p depth blocks of a chunk column whose
+    * corner at its west and north edges is at \p x, \p z in the world, and whose cells start at that corner.  Levels
+    * above the highest block are left out.  This is what generate() runs for each chunk column, and is safe to call
+    * from any thread.
+    */
+  void generateColumn(int x, int z, int width, int depth, QVector<ChunkLayer>* layers) const;
+
+ private:
+  /**
+    * Returns the number of blocks of ground under the water, or under the air, at \p x, \p z in the world.
+    */
+  int surfaceHeight(int x, int z) const;
+
+  /**
+    * Returns the block at \p level in a column of ground \p surface_height blocks tall, given the cave and ore noise
+    * for the cell.
+    */
+  BlockPrototype* blockAt(int level, int surface_height, float cave, float ore) const;
+
+  int height_;
+  int feature_size_;
+  int sea_level_;
+  bool caves_;
+  bool ores_;
+
+  GradientNoise hill_noise_;
+  GradientNoise cave_noise_;
+  GradientNoise ore_noise_;
+
+  BlockPrototype* bedrock_;
+  BlockPrototype* stone_;
+  BlockPrototype* dirt_;
+  BlockPrototype* grass_;
+  BlockPrototype* sand_;
+  BlockPrototype* water_;
+  BlockPrototype* coal_ore_;
+  BlockPrototype* iron_ore_;
+  BlockPrototype* gold_ore_;
+  BlockPrototype* diamond_ore_;
+};
+
+#endif // LANDSCAPE_GENERATOR_H
@@ -15,15 +15,40 @@
 
 #include "level_widget.h"
 
+#include <QApplication>
+#include <QFileInfo>
+#include <QGraphicsItem>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QPainter>
+#include <qmath.h>
+
+#include "array_dialog.h"
 #include "block_manager.h"
 #include "block_position.h"
+#include "block_region.h"
 #include "block_transaction.h"
 #include "diagram.h"
+#include "diagram_subscription.h"
 #include "eraser_tool.h"
+#include "find_replace_dialog.h"
+#include "image_convert_dialog.h"
+#include "image_converter.h"
+#include "landscape_dialog.h"
+#include "landscape_generator.h"
 #include "line_tool.h"
 #include "macros.h"
+#include "mesh_import_dialog.h"
+#include "paste_tool.h"
 #include "pencil_tool.h"
+#include "prefab_library.h"
 #include "rectangle_tool.h"
+#include "selection_tool.h"
+#include "span_mask.h"
+#include "sprite_engine.h"
+#include "terrain_dialog.h"
+#include "terrain_generator.h"
+#include "triangle_mesh.h"
 
 #include "undo_command.h"
 
@@ -35,17 +60,55 @@ static const int kCanvasHeight = 10000;
 
 static const int kGhostLevelOffsets[] = {-1, 0};
 
+/**
+  * A block in the scene, drawn straight from the sprite atlas so that every block shares the one pixmap.  Sprites that
+  * aren't in the atlas are drawn from a pixmap of their own instead (see SpriteEngine::spriteRect()).
+  */
+class SpriteItem : public QGraphicsItem {
+ public:
+  explicit SpriteItem(const BlockInstance& block) : sprite_engine_(block.prototype()->spriteEngine()) {
+    source_rect_ = sprite_engine_->spriteRect(sprite_engine_->blockId(block.prototype()->type()),
+                                              block.orientation()->id());
+    if (source_rect_.isNull()) {
+      sprite_ = block.prototype()->sprite(block.orientation());
+    }
+  }
+
+  QRectF boundingRect() const {
+    return QRectF(-0.5 * kSpriteWidth, -0.5 * kSpriteHeight, kSpriteWidth, kSpriteHeight);
+  }
+
+  void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+    if (source_rect_.isNull()) {
+      painter->drawPixmap(boundingRect(), sprite_, sprite_.rect());
+    } else {
+      painter->drawPixmap(boundingRect(), sprite_engine_->atlas(), source_rect_);
+    }
+  }
+
+ private:
+  SpriteEngine* sprite_engine_;
+  QRect source_rect_;
+  QPixmap sprite_;
+};
+
 LevelWidget::LevelWidget(QWidget* parent) :
     QGraphicsView(parent),
     scene_(new QGraphicsScene(this)),
     level_(0),
     diagram_(NULL),
+    subscription_(NULL),
     block_mgr_(NULL),
     in_pan_mode_(false),
     last_block_position_(0, 0, 0),
     block_type_(kBlockTypeUnknown),
     copied_level_(-1),
-    selected_tool_(NULL) {
+    selected_tool_(NULL),
+    previewing_tool_(NULL),
+    has_selection_(false),
+    clipboard_prefab_turns_(0) {
   setScene(scene_);
   setBackgroundBrush(QBrush(QPixmap(":/grid_background.png")));
   setSceneRect(QRectF(-kCanvasWidth / 2, -kCanvasHeight / 2, kCanvasWidth, kCanvasHeight));
@@ -69,39 +132,52 @@ void LevelWidget::setBlockManager(BlockManager* block_mgr) {
 }
 
 void LevelWidget::setDiagram(Diagram* diagram) {
+  if (diagram_) {
+    disconnect(diagram_, NULL, this, NULL);
+  }
   diagram_ = diagram;
-  connect(diagram, SIGNAL(diagramChanged(BlockTransaction)), SLOT(updateLevel(BlockTransaction)));
-  connect(diagram, SIGNAL(ephemeralBlocksChanged(BlockTransaction)), SLOT(updateEphemeralBlocks(BlockTransaction)));
+  // This must hear about commits as they happen, not when the subscription next delivers them.
+  connect(diagram_, SIGNAL(diagramChanged(BlockTransaction)), SLOT(forgetPreview()));
+  delete subscription_;
+  subscription_ = diagram->subscribe(visibleRegion(), this);
+  connect(subscription_, SIGNAL(diagramChanged(BlockTransaction)), SLOT(updateLevel(BlockTransaction)));
+  connect(subscription_, SIGNAL(ephemeralBlocksChanged(BlockTransaction, BlockTransaction)),
+          SLOT(updateEphemeralBlocks(BlockTransaction, BlockTransaction)));
   setLevel(0);
 }
 
+BlockRegion LevelWidget::visibleRegion() const {
+  int min_level = level_;
+  int max_level = level_;
+  for (int i = 0; i < arraysize(kGhostLevelOffsets); ++i) {
+    min_level = qMin(min_level, level_ + kGhostLevelOffsets[i]);
+    max_level = qMax(max_level, level_ + kGhostLevelOffsets[i]);
+  }
+  return BlockRegion::levels(min_level, max_level);
+}
+
 void LevelWidget::updateLevel(const BlockTransaction& transaction) {
   qDebug() << "Diagram changed.";
 
-  // Remove all ephemeral items from the view.
-  foreach(QGraphicsItem* item, ephemeral_items_) {
-    scene()->removeItem(item);
-  }
-  ephemeral_items_.clear();
-
   foreach (const BlockInstance& old_block, transaction.old_blocks()) {
     removeBlock(old_block.position());
   }
   foreach (const BlockInstance& new_block, transaction.new_blocks()) {
     addBlock(new_block);
   }
-  // QGraphicsScene doesn't notify the view that things have changed until the next event loop
-  // cycle.  Qt apparently optimizes mouse moves so that they don't return control to the event loop
-  // while the mouse is in motion, which causes the view to freeze.  This hack fixes the problem.
-  qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
 }
 
-void LevelWidget::updateEphemeralBlocks(const BlockTransaction& transaction) {
-  // Remove all ephemeral items from the view.
-  foreach(QGraphicsItem* item, ephemeral_items_) {
-    scene()->removeItem(item);
+void LevelWidget::forgetPreview() {
+  previewing_tool_ = NULL;
+}
+
+void LevelWidget::updateEphemeralBlocks(const BlockTransaction& retracted, const BlockTransaction& transaction) {
+  foreach (const BlockInstance& old_block, retracted.old_blocks()) {
+    delete ephemeral_removal_items_.take(old_block.position());
+  }
+  foreach (const BlockInstance& new_block, retracted.new_blocks()) {
+    delete ephemeral_items_.take(new_block.position());
   }
-  ephemeral_items_.clear();
 
   foreach (const BlockInstance& old_block, transaction.old_blocks()) {
     ephemerallyRemoveBlock(old_block);
@@ -109,16 +185,13 @@ void LevelWidget::updateEphemeralBlocks(const BlockTransaction& transaction) {
   foreach (const BlockInstance& new_block, transaction.new_blocks()) {
     ephemerallyAddBlock(new_block);
   }
-  // QGraphicsScene doesn't notify the view that things have changed until the next event loop
-  // cycle.  Qt apparently optimizes mouse moves so that they don't return control to the event loop
-  // while the mouse is in motion, which causes the view to freeze.  This hack fixes the problem.
-  qApp->processEvents(QEventLoop::ExcludeUserInputEvents);
 }
 
 void LevelWidget::loadLevel() {
   scene()->clear();
   item_model_.clear();
   ephemeral_items_.clear();
+  ephemeral_removal_items_.clear();
   if (!diagram_) {
     return;
   }
@@ -162,15 +235,46 @@ void LevelWidget::updateTool(QMouseEvent* event) {
   }
 }
 
+void LevelWidget::previewTool() {
+  Tool* tool = currentTool();
+  if (tool != previewing_tool_) {
+    // Whatever the diagram is showing was drawn by some other tool, if anything.
+    tool->resetPreview();
+    previewing_tool_ = tool;
+  }
+  BlockPrototype* prototype = block_mgr_->getPrototype(block_type_);
+  BlockTransaction retracted;
+  BlockTransaction transaction;
+  if (tool->drawPreview(prototype, prototype->defaultOrientation(), &retracted, &transaction)) {
+    diagram_->patchEphemeral(retracted, transaction);
+  } else {
+    diagram_->commitEphemeral(transaction);
+  }
+}
+
 Tool* LevelWidget::currentTool() const {
   if (!modifier_tool_.isNull()) {
     return modifier_tool_.data();
+  } else if (!paste_tool_.isNull()) {
+    return paste_tool_.data();
   } else {
     return selected_tool_;
   }
 }
 
+SelectionTool* LevelWidget::currentSelectionTool() const {
+  return dynamic_cast<SelectionTool*>(currentTool());
+}
+
 void LevelWidget::keyPressEvent(QKeyEvent* event) {
+  if (event->key() == Qt::Key_Escape) {
+    if (!paste_tool_.isNull()) {
+      cancelPaste();
+    } else {
+      clearSelection();
+    }
+    return;
+  }
   updateTool(event);
 }
 
@@ -205,16 +309,18 @@ void LevelWidget::mousePressEvent(QMouseEvent* event) {
   }
 
   currentTool()->acceptLastPosition();
-  BlockTransaction transaction;
-  BlockPrototype* prototype = block_mgr_->getPrototype(block_type_);
-  currentTool()->draw(prototype, prototype->defaultOrientation(), &transaction);
-  diagram_->commitEphemeral(transaction);
+  previewTool();
 }
 
 void LevelWidget::mouseReleaseEvent(QMouseEvent* event) {
   BlockPosition pos = positionForPoint(mapToScene(event->pos()));
 
-  if (!currentTool()->wantsMorePositions()) {
+  SelectionTool* selection_tool = currentSelectionTool();
+  if (selection_tool && !selection_tool->wantsMorePositions()) {
+    has_selection_ = selection_tool->selectedBox(&selection_corner_, &selection_opposite_corner_);
+    selection_tool->clear();
+    viewport()->update();
+  } else if (!currentTool()->wantsMorePositions()) {
     // Commit the current transaction for real.  QUndoStack insists upon being the one to perform the command when we
     // push it, so we don't actually call Diagram::commit directly here (that happens in UndoCommand::redo, oddly).
     BlockTransaction transaction;
@@ -238,10 +344,11 @@ void LevelWidget::mouseMoveEvent(QMouseEvent* event) {
   BlockPosition pos = positionForPoint(mapToScene(event->pos()));
   // currentTool()->proposePosition()?
   currentTool()->proposePosition(pos);
-  BlockTransaction transaction;
-  BlockPrototype* prototype = block_mgr_->getPrototype(block_type_);
-  currentTool()->draw(prototype, prototype->defaultOrientation(), &transaction);
-  diagram_->commitEphemeral(transaction);
+  previewTool();
+  if (currentSelectionTool()) {
+    // The box being selected is drawn in the foreground rather than by the diagram.
+    viewport()->update();
+  }
 }
 
 QGraphicsItem* LevelWidget::itemAtPosition(const BlockPosition& position) const {
@@ -266,6 +373,23 @@ void LevelWidget::drawBackground(QPainter* painter, const QRectF& rect) {
 
 void LevelWidget::drawForeground(QPainter* painter, const QRectF& rect) {
   painter->drawPixmap(3, 3, 11, 11, QPixmap(":/origin.png"));
+
+  BlockPosition corner = selection_corner_;
+  BlockPosition opposite_corner = selection_opposite_corner_;
+  SelectionTool* selection_tool = currentSelectionTool();
+  if (!(selection_tool && selection_tool->selectedBox(&corner, &opposite_corner)) && !has_selection_) {
+    return;
+  }
+  QRectF box(QPointF((qMin(corner.x(), opposite_corner.x()) - 0.5) * kSpriteWidth,
+                     (qMin(corner.z(), opposite_corner.z()) - 0.5) * kSpriteHeight),
+             QPointF((qMax(corner.x(), opposite_corner.x()) + 0.5) * kSpriteWidth,
+                     (qMax(corner.z(), opposite_corner.z()) + 0.5) * kSpriteHeight));
+  // The outline is solid on the levels the box spans, and dashed on the others to show where it is.
+  bool spans_level = qMin(corner.y(), opposite_corner.y()) <= level_ && level_ <= qMax(corner.y(), opposite_corner.y());
+  painter->setOpacity(1.0);
+  painter->setBrush(Qt::NoBrush);
+  painter->setPen(QPen(Qt::blue, 0, spans_level ? Qt::SolidLine : Qt::DashLine));
+  painter->drawRect(box);
 }
 
 QGraphicsItem* LevelWidget::ephemerallyAddBlock(const BlockInstance& block) {
@@ -276,16 +400,16 @@ QGraphicsItem* LevelWidget::ephemerallyAddBlock(const BlockInstance& block) {
   const BlockPosition& position = block.position();
 
   BlockPrototype* prototype = block.prototype();
-  QGraphicsPixmapItem* item = scene()->addPixmap(prototype->sprite(block.orientation()));
-  item->setOffset(-0.5 * kSpriteWidth, -0.5 * kSpriteHeight);
+  SpriteItem* item = new SpriteItem(block);
+  scene()->addItem(item);
   item->setPos(position.x() * kSpriteWidth, position.z() * kSpriteHeight);
-  item->setShapeMode(QGraphicsPixmapItem::BoundingRectShape);
   item->setData(0, prototype->type());
   item->setZValue(position.y() + 64.0);  // Stack on top of normal blocks.
   if (!currentTool()->isBrush()) {
     item->setOpacity(0.25);
   }
-  ephemeral_items_.append(item);
+  delete ephemeral_items_.take(position);
+  ephemeral_items_.insert(position, item);
   return item;
 }
 
@@ -313,7 +437,8 @@ QGraphicsItem* LevelWidget::ephemerallyRemoveBlock(const BlockInstance& block) {
   if (!currentTool()->isBrush()) {
     item->setOpacity(0.25);
   }
-  ephemeral_items_.append(item);
+  delete ephemeral_removal_items_.take(position);
+  ephemeral_removal_items_.insert(position, item);
   return item;
 }
 
@@ -337,10 +462,9 @@ QGraphicsItem* LevelWidget::addBlock(const BlockInstance& block) {
   }
 
   BlockPrototype* prototype = block.prototype();
-  QGraphicsPixmapItem* item = scene()->addPixmap(prototype->sprite(block.orientation()));
-  item->setOffset(-0.5 * kSpriteWidth, -0.5 * kSpriteHeight);
+  SpriteItem* item = new SpriteItem(block);
+  scene()->addItem(item);
   item->setPos(position.x() * kSpriteWidth, position.z() * kSpriteHeight);
-  item->setShapeMode(QGraphicsPixmapItem::BoundingRectShape);
   item->setData(0, prototype->type());
   item->setZValue(position.y());
   if (position.y() != level_) {
@@ -369,6 +493,9 @@ void LevelWidget::removeBlock(const BlockPosition& position) {
 
 void LevelWidget::setLevel(int level) {
   level_ = level;
+  if (subscription_) {
+    subscription_->setRegion(visibleRegion());
+  }
   loadLevel();
   emit levelChanged(level);
 }
@@ -378,6 +505,7 @@ void LevelWidget::setBlockType(blocktype_t type) {
 }
 
 void LevelWidget::setSelectedTool(Tool* tool) {
+  cancelPaste();
   selected_tool_ = tool;
   selected_tool_->clear();
 }
@@ -402,6 +530,340 @@ void LevelWidget::extrudeDownwards() {
   setLevel(level_ - 1);
 }
 
+BlockClipboard LevelWidget::selectedBlocks() const {
+  if (!has_selection_) {
+    return BlockClipboard();
+  }
+  return diagram_->copyRegion(selection_corner_, selection_opposite_corner_);
+}
+
+void LevelWidget::pasteBlocks(const BlockClipboard& clipboard) {
+  clipboard_ = clipboard;
+  clipboard_prefab_.clear();
+  pasteClipboard();
+}
+
+void LevelWidget::importMesh(const TriangleMesh& mesh) {
+  MeshImportDialog dialog(mesh, level_, this);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  SpanMask mask = dialog.voxelizer().voxelize(dialog.fill(), dialog.origin());
+  BlockPrototype* prototype = block_mgr_->getPrototype(block_type_);
+  BlockTransaction transaction;
+  diagram_->fillSpans(mask, prototype, prototype->defaultOrientation(), &transaction);
+  QApplication::restoreOverrideCursor();
+  pushCommand(transaction, "Import Mesh");
+}
+
+void LevelWidget::convertImage(const QImage& image) {
+  ImageConvertDialog dialog(image.size(), level_, this);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  pasteGenerated(ImageConverter(block_mgr_).convert(image, dialog.dithering()), dialog.origin(), "Convert Image");
+  QApplication::restoreOverrideCursor();
+}
+
+void LevelWidget::generateTerrain(const QImage& heightmap) {
+  TerrainDialog dialog(heightmap.size(), level_, this);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+  QImage splat_map;
+  if (!dialog.splatMapFilename().isEmpty()) {
+    splat_map = QImage(dialog.splatMapFilename());
+    if (splat_map.isNull()) {
+      QMessageBox::warning(this, "MCModeler - Generate Terrain",
+                           QString("%1 could not be opened.").arg(QFileInfo(dialog.splatMapFilename()).fileName()));
+      return;
+    }
+  }
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  TerrainGenerator generator(heightmap, dialog.maximumHeight(), block_mgr_->getPrototype(block_type_));
+  if (!splat_map.isNull()) {
+    generator.setSplatMap(splat_map, ImageConverter(block_mgr_), dialog.surfaceDepth());
+  }
+  pasteGenerated(generator.generate(), dialog.origin(), "Generate Terrain");
+  QApplication::restoreOverrideCursor();
+}
+
+void LevelWidget::copySelection() {
+  if (!has_selection_) {
+    return;
+  }
+  clipboard_ = selectedBlocks();
+  clipboard_prefab_.clear();
+}
+
+void LevelWidget::cutSelection() {
+  if (!has_selection_) {
+    return;
+  }
+  copySelection();
+  SpanMask mask;
+  for (int y = qMin(selection_corner_.y(), selection_opposite_corner_.y());
+       y <= qMax(selection_corner_.y(), selection_opposite_corner_.y()); ++y) {
+    for (int z = qMin(selection_corner_.z(), selection_opposite_corner_.z());
+         z <= qMax(selection_corner_.z(), selection_opposite_corner_.z()); ++z) {
+      mask.addSpan(selection_corner_.x(), selection_opposite_corner_.x(), y, z);
+    }
+  }
+  BlockTransaction transaction;
+  diagram_->fillSpans(mask, NULL, NULL, &transaction);
+  pushCommand(transaction, "Cut");
+}
+
+void LevelWidget::pasteClipboard() {
+  if (clipboard_.isEmpty()) {
+    return;
+  }
+  paste_tool_.reset(new PasteTool(diagram_, clipboard_));
+  previewTool();
+}
+
+void LevelWidget::saveSelectionAsPrefab() {
+  if (!has_selection_) {
+    return;
+  }
+  bool ok = false;
+  QString name = QInputDialog::getText(this, "MCModeler - Save Prefab", "What should the prefab be called?",
+                                       QLineEdit::Normal, QString(), &ok).trimmed();
+  if (!ok || name.isEmpty()) {
+    return;
+  }
+  if (prefabLibrary()->names().contains(name) &&
+      QMessageBox::question(this, "MCModeler - Save Prefab",
+                            QString("There is already a prefab called %1.  Do you want to replace it?").arg(name),
+                            QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
+    return;
+  }
+  QString error;
+  if (!prefabLibrary()->save(name, selectedBlocks(), &error)) {
+    QMessageBox::warning(this, "MCModeler - Save Prefab", QString("%1 could not be saved.  %2").arg(name, error));
+  }
+}
+
+void LevelWidget::stampPrefab() {
+  QStringList names = prefabLibrary()->names();
+  if (names.isEmpty()) {
+    QMessageBox::information(this, "MCModeler - Stamp Prefab",
+                             "There are no prefabs yet.  To make one, select some blocks and choose Save Selection as "
+                             "Prefab.");
+    return;
+  }
+  bool ok = false;
+  QString name = QInputDialog::getItem(this, "MCModeler - Stamp Prefab", "Which prefab do you want to stamp?", names,
+                                       0, false, &ok);
+  if (!ok) {
+    return;
+  }
+  QString error;
+  BlockClipboard prefab = prefabLibrary()->prefab(name, 0, &error);
+  if (prefab.isEmpty()) {
+    QMessageBox::warning(this, "MCModeler - Stamp Prefab", QString("%1 could not be read.  %2").arg(name, error));
+    return;
+  }
+  pasteBlocks(prefab);
+  clipboard_prefab_ = name;
+  clipboard_prefab_turns_ = 0;
+}
+
+PrefabLibrary* LevelWidget::prefabLibrary() {
+  if (prefab_library_.isNull()) {
+    prefab_library_.reset(new PrefabLibrary(block_mgr_, PrefabLibrary::defaultDirectory()));
+  }
+  return prefab_library_.data();
+}
+
+void LevelWidget::cancelPaste() {
+  if (paste_tool_.isNull()) {
+    return;
+  }
+  paste_tool_.reset(NULL);
+  previewing_tool_ = NULL;
+  diagram_->commitEphemeral(BlockTransaction());
+}
+
+void LevelWidget::clearSelection() {
+  has_selection_ = false;
+  viewport()->update();
+}
+
+void LevelWidget::rotateClockwise() {
+  transform(BlockTransform::kRotateClockwise);
+}
+
+void LevelWidget::rotateCounterclockwise() {
+  transform(BlockTransform::kRotateCounterclockwise);
+}
+
+void LevelWidget::rotateHalfTurn() {
+  transform(BlockTransform::kRotateHalfTurn);
+}
+
+void LevelWidget::flipEastWest() {
+  transform(BlockTransform::kMirrorX);
+}
+
+void LevelWidget::flipNorthSouth() {
+  transform(BlockTransform::kMirrorZ);
+}
+
+void LevelWidget::transform(BlockTransform::Kind kind) {
+  if (!paste_tool_.isNull()) {
+    // A prefab is rotated by taking the library's rotation of it, which is only made once.
+    int quarter_turns = kind == BlockTransform::kRotateClockwise ? 1 :
+                        kind == BlockTransform::kRotateHalfTurn ? 2 :
+                        kind == BlockTransform::kRotateCounterclockwise ? 3 : 0;
+    BlockClipboard rotated;
+    if (!clipboard_prefab_.isEmpty() && quarter_turns) {
+      clipboard_prefab_turns_ = (clipboard_prefab_turns_ + quarter_turns) % PrefabLibrary::kRotationCount;
+      QString error;
+      rotated = prefabLibrary()->prefab(clipboard_prefab_, clipboard_prefab_turns_, &error);
+    }
+    if (rotated.isEmpty()) {
+      clipboard_ = clipboard_.transformed(kind);
+      clipboard_prefab_.clear();
+    } else {
+      clipboard_ = rotated;
+    }
+    // The new tool may well be allocated where the old one was, so make sure its preview is drawn from scratch.
+    previewing_tool_ = NULL;
+    paste_tool_.reset(new PasteTool(diagram_, clipboard_));
+    previewTool();
+    return;
+  }
+  if (!has_selection_) {
+    return;
+  }
+  BlockClipboard transformed = diagram_->copyRegion(selection_corner_, selection_opposite_corner_).transformed(kind);
+  BlockPosition origin(qMin(selection_corner_.x(), selection_opposite_corner_.x()),
+                       qMin(selection_corner_.y(), selection_opposite_corner_.y()),
+                       qMin(selection_corner_.z(), selection_opposite_corner_.z()));
+  BlockPosition opposite_corner(origin.x() + transformed.width() - 1,
+                                origin.y() + transformed.height() - 1,
+                                origin.z() + transformed.depth() - 1);
+
+  // Clear whatever the old box covered that the new one doesn't, then paste the transformed blocks over the new box.
+  int old_last_z = qMax(selection_corner_.z(), selection_opposite_corner_.z());
+  SpanMask old_box;
+  SpanMask new_box;
+  for (int y = origin.y(); y <= opposite_corner.y(); ++y) {
+    for (int z = origin.z(); z <= old_last_z; ++z) {
+      old_box.addSpan(selection_corner_.x(), selection_opposite_corner_.x(), y, z);
+    }
+    for (int z = origin.z(); z <= opposite_corner.z(); ++z) {
+      new_box.addSpan(origin.x(), opposite_corner.x(), y, z);
+    }
+  }
+  BlockTransaction transaction;
+  diagram_->fillSpans(old_box.subtracted(new_box), NULL, NULL, &transaction);
+  diagram_->paste(transformed, origin, &transaction);
+
+  pushCommand(transaction, BlockTransform::swapsAxes(kind) || kind == BlockTransform::kRotateHalfTurn ?
+                           "Rotate Selection" : "Flip Selection");
+
+  selection_corner_ = origin;
+  selection_opposite_corner_ = opposite_corner;
+  viewport()->update();
+}
+
+void LevelWidget::arraySelection() {
+  if (!has_selection_) {
+    return;
+  }
+  ArrayDialog dialog(this);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+  BlockClipboard clipboard = diagram_->copyRegion(selection_corner_, selection_opposite_corner_);
+  BlockPosition origin(qMin(selection_corner_.x(), selection_opposite_corner_.x()),
+                       qMin(selection_corner_.y(), selection_opposite_corner_.y()),
+                       qMin(selection_corner_.z(), selection_opposite_corner_.z()));
+  QList<BlockClipboard> clipboards;
+  QList<BlockPosition> origins;
+  if (dialog.arrangement() == ArrayDialog::kArrangementLinear) {
+    BlockPosition step = dialog.step();
+    for (int i = 1; i < dialog.copies(); ++i) {
+      clipboards.append(clipboard);
+      origins.append(BlockPosition(origin.x() + step.x() * i, origin.y() + step.y() * i, origin.z() + step.z() * i));
+    }
+  } else {
+    // Each copy is the selection turned by the nearest quarter turn to its angle around the center, with its own
+    // center moved exactly that angle around the center.
+    BlockClipboard turned[4] = {clipboard,
+                                clipboard.transformed(BlockTransform::kRotateClockwise),
+                                clipboard.transformed(BlockTransform::kRotateHalfTurn),
+                                clipboard.transformed(BlockTransform::kRotateCounterclockwise)};
+    double selection_center_x = origin.x() + (clipboard.width() - 1) / 2.0;
+    double selection_center_z = origin.z() + (clipboard.depth() - 1) / 2.0;
+    double dx = -dialog.center().x();
+    double dz = -dialog.center().z();
+    for (int i = 1; i < dialog.copies(); ++i) {
+      double angle = 2.0 * M_PI * i / dialog.copies();
+      const BlockClipboard& copy = turned[qRound(angle / (M_PI / 2.0)) % 4];
+      // Seen from above, with north at the top, a clockwise turn takes (x, z) to (-z, x).
+      double center_x = selection_center_x - dx + dx * qCos(angle) - dz * qSin(angle);
+      double center_z = selection_center_z - dz + dx * qSin(angle) + dz * qCos(angle);
+      clipboards.append(copy);
+      origins.append(BlockPosition(qRound(center_x - (copy.width() - 1) / 2.0),
+                                   origin.y(),
+                                   qRound(center_z - (copy.depth() - 1) / 2.0)));
+    }
+  }
+
+  BlockTransaction transaction;
+  diagram_->pasteArray(clipboards, origins, &transaction);
+  pushCommand(transaction, "Array");
+}
+
+void LevelWidget::findAndReplace() {
+  FindReplaceDialog dialog(block_mgr_, block_type_, level_, this);
+  if (has_selection_) {
+    dialog.setSelection(BlockRegion::box(selection_corner_, selection_opposite_corner_));
+  }
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+  BlockTransaction transaction;
+  diagram_->findAndReplace(dialog.replacement(), &transaction);
+  pushCommand(transaction, "Replace");
+}
+
+void LevelWidget::pushCommand(const BlockTransaction& transaction, const QString& text) {
+  if (transaction.isEmpty()) {
+    return;
+  }
+  UndoCommand* command = new UndoCommand(transaction, diagram_);
+  command->setText(text);
+  undo_stack_.push(command);
+}
+
+void LevelWidget::pasteGenerated(const BlockClipboard& clipboard, const BlockPosition& origin, const QString& text) {
+  if (clipboard.isEmpty()) {
+    return;
+  }
+  BlockTransaction transaction;
+  diagram_->paste(clipboard, origin, &transaction);
+  pushCommand(transaction, text);
+}
+
+void LevelWidget::generateLandscape() {
+  LandscapeDialog dialog(level_, this);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  LandscapeGenerator generator(block_mgr_, dialog.seed());
+  dialog.configure(&generator);
+  pasteGenerated(generator.generate(dialog.origin().x(), dialog.origin().z(), dialog.width(), dialog.depth()),
+                 dialog.origin(), "Generate Landscape");
+  QApplication::restoreOverrideCursor();
+}
+
 void LevelWidget::setTemplateImage(const QString& filename) {
   if (!filename.isEmpty()) {
     template_image_ = QPixmap(filename);
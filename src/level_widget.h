@@ -24,14 +24,21 @@
 #include <QUndoStack>
 #include <QUndoView>
 
+#include "block_clipboard.h"
+#include "block_transform.h"
 #include "block_type.h"
 #include "block_position.h"
 
 class Diagram;
+class DiagramSubscription;
 class BlockInstance;
 class BlockManager;
+class BlockRegion;
 class BlockTransaction;
+class PrefabLibrary;
+class SelectionTool;
 class Tool;
+class TriangleMesh;
 
 /**
   * The canvas widget with which the user can interact to add and remove blocks.
@@ -39,9 +46,10 @@ class Tool;
   * The LevelWidget is a view in the sense of model/view/controller.  As such, it _never_ directly changes the state of
   * the world, but merely updates and listens for changes to the model (in this case, a Diagram).
   *
-  * When the diagram changes, it emits Diagram::diagramChanged(), which is connected to updateLevel() in this class.
-  * This causes the view to apply the BlockTransaction (which was very likely a consequence of its own request to the
-  * Diagram), which synchronizes the view with the model.
+  * The LevelWidget subscribes to the levels it displays (see Diagram::subscribe()).  When the diagram changes within
+  * those levels, the subscription emits DiagramSubscription::diagramChanged(), which is connected to updateLevel() in
+  * this class.  This causes the view to apply the BlockTransaction (which was very likely a consequence of its own
+  * request to the Diagram), which synchronizes the view with the model.
   *
   * tl;dr: Don't mess around with the QGraphicsItems in any method other than updateLevel().
   */
@@ -54,6 +62,46 @@ class LevelWidget : public QGraphicsView {
   void setDiagram(Diagram* diagram);
   void setBlockManager(BlockManager* block_mgr);
 
+  /**
+    * Returns whether any blocks are selected.
+    */
+  bool hasSelection() const {
+    return has_selection_;
+  }
+
+  /**
+    * Returns a copy of the blocks inside the current selection, without touching the clipboard.  If nothing is
+    * selected, returns an empty clipboard.
+    */
+  BlockClipboard selectedBlocks() const;
+
+  /**
+    * Replaces the clipboard with \p clipboard and starts pasting it.
+    * @sa pasteClipboard()
+    */
+  void pasteBlocks(const BlockClipboard& clipboard);
+
+  /**
+    * Asks how big to make \p mesh and where to put it, and then builds it out of the current block type in a single
+    * undoable step.
+    * @sa MeshImportDialog
+    */
+  void importMesh(const TriangleMesh& mesh);
+
+  /**
+    * Asks where to put \p image, and then builds it out of blocks on a single level, one block per pixel, in a single
+    * undoable step.  Transparent pixels clear whatever was there.
+    * @sa ImageConverter
+    */
+  void convertImage(const QImage& image);
+
+  /**
+    * Asks where to put terrain built from \p heightmap and how high to make it, and then builds it out of the current
+    * block type in a single undoable step.  Everything above the ground inside the terrain's box is cleared.
+    * @sa TerrainGenerator
+    */
+  void generateTerrain(const QImage& heightmap);
+
  signals:
   /**
     * Emitted whenever the currently displayed level changes.
@@ -101,6 +149,96 @@ class LevelWidget : public QGraphicsView {
     */
   void extrudeDownwards();
 
+  /**
+    * Copies the blocks inside the current selection into the clipboard.  If nothing is selected, does nothing.
+    * @sa SelectionTool
+    */
+  void copySelection();
+
+  /**
+    * Copies the blocks inside the current selection into the clipboard, then clears the selection in a single undoable
+    * step.  If nothing is selected, does nothing.
+    */
+  void cutSelection();
+
+  /**
+    * Starts pasting the contents of the clipboard.  Until the paste is cancelled (by pressing Escape or picking
+    * another tool), the clipboard follows the mouse as a preview, and each click pastes a copy of it on the current
+    * level, with its lowest level there.  If the clipboard is empty, does nothing.
+    */
+  void pasteClipboard();
+
+  /**
+    * Asks for a name, and then saves the blocks inside the current selection under that name in the prefab library.
+    * If nothing is selected, does nothing.
+    * @sa PrefabLibrary
+    */
+  void saveSelectionAsPrefab();
+
+  /**
+    * Asks which prefab in the prefab library to stamp, and then starts pasting it as if it were the clipboard, which it
+    * replaces.  Rotating the prefab while pasting it uses the rotations the library keeps, rather than rotating the
+    * clipboard again.
+    */
+  void stampPrefab();
+
+  /**
+    * Forgets the current selection.
+    */
+  void clearSelection();
+
+  /**
+    * Rotates the blocks inside the current selection a quarter turn clockwise, as seen from above, turning their
+    * orientations to match.  If the clipboard is being pasted, rotates the clipboard instead.
+    * @sa transform()
+    */
+  void rotateClockwise();
+
+  /**
+    * Rotates the blocks inside the current selection, or the clipboard being pasted, a quarter turn counterclockwise.
+    */
+  void rotateCounterclockwise();
+
+  /**
+    * Rotates the blocks inside the current selection, or the clipboard being pasted, a half turn.
+    */
+  void rotateHalfTurn();
+
+  /**
+    * Mirrors the blocks inside the current selection, or the clipboard being pasted, so that east and west trade
+    * places.
+    */
+  void flipEastWest();
+
+  /**
+    * Mirrors the blocks inside the current selection, or the clipboard being pasted, so that north and south trade
+    * places.
+    */
+  void flipNorthSouth();
+
+  /**
+    * Asks how many copies of the current selection to make, and whether to lay them out in a line or around a center,
+    * and then makes them in a single undoable step.  Copies arranged around a center are rotated to face it, to the
+    * nearest quarter turn.  If nothing is selected, does nothing.
+    * @sa ArrayDialog
+    */
+  void arraySelection();
+
+  /**
+    * Asks which blocks to find and what to replace them with, and where to look, and then replaces them all in a
+    * single undoable step.
+    * @sa FindReplaceDialog
+    */
+  void findAndReplace();
+
+  /**
+    * Asks where to generate a landscape of hills, water, caves and ore, and what it should look like, and then builds
+    * it in a single undoable step.  The whole box the landscape spans is replaced, as if it were pasted, so the air
+    * above the hills clears whatever was there.
+    * @sa LandscapeGenerator
+    */
+  void generateLandscape();
+
   /**
     * Sets the image located at the file path \p filename to be the "template image".  It will be shown in a faded out
     * state on all levels, and blocks will be drawn on top of it.  It is not saved into the diagram.
@@ -186,15 +324,15 @@ class LevelWidget : public QGraphicsView {
   void removeBlock(const BlockPosition& position);
 
   /**
-    * Adds \p block to the LevelWidget as an ephemeral block.  The block will only be shown until the next time
-    * updateEphemeralBlocks() is called, at which point it will be removed.  Ephemeral blocks are drawn on top of
-    * non-ephemeral blocks, and will be drawn translucent if the current tool is not a brush.
+    * Adds \p block to the LevelWidget as an ephemeral block.  The block will only be shown until
+    * updateEphemeralBlocks() retracts it.  Ephemeral blocks are drawn on top of non-ephemeral blocks, and will be drawn
+    * translucent if the current tool is not a brush.
     */
   QGraphicsItem* ephemerallyAddBlock(const BlockInstance& block);
 
   /**
-    * Adds \p block to the LevelWidget as an ephemerally removed block.  The block will only be hidden until the next
-    * time updateEphemeralBlocks() is called, at which point it will be shown again.  If a block is ephemerally
+    * Adds \p block to the LevelWidget as an ephemerally removed block.  The block will only be hidden until
+    * updateEphemeralBlocks() retracts the removal, at which point it will be shown again.  If a block is ephemerally
     * removed from a position and another is ephemerally added there, the added one will take precedence.
     *
     * @note Ephemerally removed blocks are implemented using a hack.  Rather than actually removing blocks from the
@@ -212,10 +350,19 @@ class LevelWidget : public QGraphicsView {
   void updateLevel(const BlockTransaction& transaction);
 
   /**
-    * Applies \p transaction to the ephemeral blocks of the current level.  Both added and removed blocks are applied.
-    * Called whenever the Diagram changes its ephemeral blocks.
+    * Takes back the ephemeral changes in \p retracted, then applies those in \p transaction, to the ephemeral blocks of
+    * the current level.  Only the positions named in the two transactions are touched.  Called whenever the Diagram
+    * changes its ephemeral blocks.
+    */
+  void updateEphemeralBlocks(const BlockTransaction& retracted, const BlockTransaction& transaction);
+
+  /**
+    * Makes the next preview be drawn in full.  Called as soon as the Diagram commits a transaction, which throws away
+    * its ephemeral blocks, so that no tool goes on patching a preview that is no longer there.  This can't wait for
+    * updateLevel(), since the subscription may hold the change back for a while, and a preview drawn in the meantime
+    * would be a patch against nothing.
     */
-  void updateEphemeralBlocks(const BlockTransaction& transaction);
+  void forgetPreview();
 
  protected:
   virtual void showEvent(QShowEvent* event);
@@ -227,11 +374,57 @@ class LevelWidget : public QGraphicsView {
     */
   Tool* currentTool() const;
 
+  /**
+    * Returns currentTool() if it is a SelectionTool, or NULL otherwise.
+    */
+  SelectionTool* currentSelectionTool() const;
+
+  /**
+    * Stops pasting, if we were, and takes away the preview of the paste.
+    */
+  void cancelPaste();
+
+  /**
+    * Applies \p kind to the clipboard if it is being pasted, or else to the blocks inside the current selection in a
+    * single undoable step.  A transformed selection keeps its corner with the smallest coordinates, and the selection
+    * is changed to cover the transformed blocks.  Cells the selection no longer covers afterwards are cleared.
+    */
+  void transform(BlockTransform::Kind kind);
+
+  /**
+    * Returns the prefab library, creating it the first time it is needed.
+    */
+  PrefabLibrary* prefabLibrary();
+
+  /**
+    * Pushes \p transaction onto the undo stack as a command named \p text, unless it would change nothing.
+    */
+  void pushCommand(const BlockTransaction& transaction, const QString& text);
+
+  /**
+    * Pastes \p clipboard, built by a generator or converter, at \p origin as a command named \p text (see
+    * pushCommand()).  Clipboards with nothing in them are ignored.
+    */
+  void pasteGenerated(const BlockClipboard& clipboard, const BlockPosition& origin, const QString& text);
+
+  /**
+    * Shows what the current tool would draw as ephemeral blocks.  If the current tool drew the preview that is already
+    * showing, only the difference is sent to the diagram (see Tool::drawPreview()).
+    */
+  void previewTool();
+
+  /**
+    * Returns the region of the diagram shown by this widget at the current level, including ghosted levels.
+    */
+  BlockRegion visibleRegion() const;
+
   QHash<BlockPosition, QGraphicsItem*> item_model_;
-  QVector<QGraphicsItem*> ephemeral_items_;
+  QHash<BlockPosition, QGraphicsItem*> ephemeral_items_;
+  QHash<BlockPosition, QGraphicsItem*> ephemeral_removal_items_;
   QGraphicsScene* scene_;
   int level_;
   Diagram* diagram_;
+  DiagramSubscription* subscription_;
   BlockManager* block_mgr_;
   bool in_pan_mode_;
   BlockPosition last_block_position_;
@@ -246,6 +439,28 @@ class LevelWidget : public QGraphicsView {
   /// The tool, if any, that we are using instead of selected_tool_ due to modifier keys.
   QScopedPointer<Tool> modifier_tool_;
 
+  /// The tool used while pasting the clipboard, which takes precedence over selected_tool_.
+  QScopedPointer<Tool> paste_tool_;
+
+  /// The tool that drew the preview the diagram is currently showing, or NULL if the next preview must be drawn in
+  /// full.  This is only ever compared against, never dereferenced, since modifier tools are deleted when released.
+  Tool* previewing_tool_;
+
+  /// Whether a box has been selected, and if so, its opposite corners.
+  bool has_selection_;
+  BlockPosition selection_corner_;
+  BlockPosition selection_opposite_corner_;
+
+  BlockClipboard clipboard_;
+
+  /// The name of the prefab in clipboard_, and how many quarter turns clockwise it has been rotated, or an empty name
+  /// if clipboard_ holds something else.
+  QString clipboard_prefab_;
+  int clipboard_prefab_turns_;
+
+  /// The prefab library, or NULL if it hasn't been needed yet.
+  QScopedPointer<PrefabLibrary> prefab_library_;
+
   QUndoStack undo_stack_;
   QUndoView undo_view_;
 };
@@ -17,23 +17,22 @@
 #define LINE_TOOL_H
 
 #include "block_position.h"
-#include "tool.h"
+#include "shape_tool.h"
 
-class BlockOracle;
+class Diagram;
 
 /**
   * A Tool that draws straight lines between points.
   */
-class LineTool : public Tool {
+class LineTool : public ShapeTool {
  public:
-  explicit LineTool(BlockOracle* oracle);
+  explicit LineTool(Diagram* diagram);
   virtual QString actionName() const;
   virtual bool wantsMorePositions();
   virtual bool isBrush() const;
-  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
 
- private:
-  BlockOracle* oracle_;
+ protected:
+  virtual void rasterize(SpanMask* mask);
 };
 
 #endif // LINE_TOOL_H
@@ -15,24 +15,43 @@
 
 #include "main_window.h"
 
+#include <QInputDialog>
 #include <QtGui/QApplication>
 
+#include <limits.h>
+
 #include "about_box.h"
+#include "application.h"
 #include "block_manager.h"
 #include "block_picker.h"
 #include "block_prototype.h"
 #include "block_type.h"
 #include "circle_tool.h"
+#include "cone_tool.h"
+#include "cuboid_tool.h"
+#include "cylinder_tool.h"
 #include "diagram.h"
+#include "dome_tool.h"
 #include "eraser_tool.h"
 #include "filled_rectangle_tool.h"
 #include "flood_fill_tool.h"
+#include "forest_tool.h"
 #include "line_tool.h"
+#include "mesh_exporter.h"
 #include "pencil_tool.h"
 #include "rectangle_tool.h"
+#include "region_file.h"
+#include "region_import_dialog.h"
+#include "schematic_file.h"
+#include "selection_tool.h"
 #include "sphere_tool.h"
 #include "tool_picker.h"
+#include "torus_tool.h"
 #include "tree_tool.h"
+#include "triangle_mesh.h"
+#include "vox_color_table.h"
+#include "vox_file.h"
+#include "vox_palette_dialog.h"
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent),
@@ -40,6 +59,8 @@ MainWindow::MainWindow(QWidget* parent)
       block_mgr_(NULL),
       toolbox_initialized_(false),
       pending_action_(NULL),
+      flood_fill_tool_(NULL),
+      forest_tool_(NULL),
       bill_of_materials_window_(NULL) {
   ui.setupUi(this);
 
@@ -86,9 +107,30 @@ void MainWindow::setupToolbox() {
   ui.tool_picker_->addTool(new LineTool(diagram_), "Line", QIcon(":/icons/line_tool.png"));
   ui.tool_picker_->addTool(new RectangleTool(diagram_), "Rectangle", QIcon(":/icons/rectangle_tool.png"));
   ui.tool_picker_->addTool(new CircleTool(diagram_), "Circle", QIcon(":/icons/circle_tool.png"));
-  ui.tool_picker_->addTool(new FloodFillTool(diagram_), "Flood Fill", QIcon(":/icons/flood_fill_tool.png"));
+  ui.tool_picker_->addTool(new SelectionTool(), "Select", QIcon(":/icons/rectangle_tool.png"));
+  flood_fill_tool_ = new FloodFillTool(diagram_);
+  QSettings* settings = Application::instance()->settings();
+  flood_fill_tool_->setMaximumExtent(settings->value("FloodFillExtent", flood_fill_tool_->maximumExtent()).toInt());
+  ui.action_flood_fill_three_dimensional_->setChecked(settings->value("FloodFillThreeDimensional", false).toBool());
+  flood_fill_tool_->setThreeDimensional(ui.action_flood_fill_three_dimensional_->isChecked());
+  ui.tool_picker_->addTool(flood_fill_tool_, "Flood Fill", QIcon(":/icons/flood_fill_tool.png"));
   ui.tool_picker_->addTool(new TreeTool(diagram_, block_mgr_), "Tree", QIcon(":/icons/tree_tool.png"));
-  ui.tool_picker_->addTool(new SphereTool(diagram_), "Sphere", QIcon(":/icons/sphere_tool.png"));
+  forest_tool_ = new ForestTool(diagram_, block_mgr_);
+  forest_tool_->setSeed(settings->value("ForestSeed", qrand()).toUInt());
+  ui.tool_picker_->addTool(forest_tool_, "Forest", QIcon(":/icons/tree_tool.png"));
+  addSolidTool(new SphereTool(diagram_), "Sphere", QIcon(":/icons/sphere_tool.png"));
+  addSolidTool(new DomeTool(diagram_), "Dome", QIcon(":/icons/sphere_tool.png"));
+  addSolidTool(new CylinderTool(diagram_), "Cylinder", QIcon(":/icons/circle_tool.png"));
+  addSolidTool(new ConeTool(diagram_), "Cone", QIcon(":/icons/circle_tool.png"));
+  addSolidTool(new TorusTool(diagram_), "Torus", QIcon(":/icons/circle_tool.png"));
+  addSolidTool(new CuboidTool(diagram_), "Cuboid", QIcon(":/icons/filled_rectangle_tool.png"));
+  ui.action_fill_solid_shapes_->setChecked(settings->value("SolidShapesFilled", false).toBool());
+  setSolidShapesFilled(ui.action_fill_solid_shapes_->isChecked());
+}
+
+void MainWindow::addSolidTool(SolidTool* tool, const QString& name, const QIcon& icon) {
+  solid_tools_.append(tool);
+  ui.tool_picker_->addTool(tool, name, icon);
 }
 
 void MainWindow::setTemplateImage() {
@@ -207,6 +249,333 @@ void MainWindow::showBillOfMaterials() {
   bill_of_materials_window_->setVisible(true);
 }
 
+void MainWindow::setFloodFillThreeDimensional(bool three_dimensional) {
+  if (!flood_fill_tool_) {
+    return;
+  }
+  flood_fill_tool_->setThreeDimensional(three_dimensional);
+  Application::instance()->settings()->setValue("FloodFillThreeDimensional", three_dimensional);
+}
+
+void MainWindow::setSolidShapesFilled(bool filled) {
+  foreach (SolidTool* tool, solid_tools_) {
+    tool->setFilled(filled);
+  }
+  Application::instance()->settings()->setValue("SolidShapesFilled", filled);
+}
+
+void MainWindow::setFloodFillExtent() {
+  if (!flood_fill_tool_) {
+    return;
+  }
+  bool ok = false;
+  int extent = QInputDialog::getInt(this, "MCModeler - Flood Fill Extent",
+                                    "How many blocks away from where you click may the flood fill reach?",
+                                    flood_fill_tool_->maximumExtent(), 0, 256, 1, &ok);
+  if (!ok) {
+    return;
+  }
+  flood_fill_tool_->setMaximumExtent(extent);
+  Application::instance()->settings()->setValue("FloodFillExtent", flood_fill_tool_->maximumExtent());
+}
+
+void MainWindow::setForestSeed() {
+  if (!forest_tool_) {
+    return;
+  }
+  bool ok = false;
+  int seed = QInputDialog::getInt(this, "MCModeler - Forest Seed",
+                                  "Which seed should the forest brush plant trees from?  The same seed always plants "
+                                  "the same trees.",
+                                  forest_tool_->seed() & INT_MAX, 0, INT_MAX, 1, &ok);
+  if (!ok) {
+    return;
+  }
+  forest_tool_->setSeed(seed);
+  Application::instance()->settings()->setValue("ForestSeed", forest_tool_->seed());
+}
+
+void MainWindow::importSchematic() {
+  QFileDialog* open_dialog = new QFileDialog(this);
+  open_dialog->setFileMode(QFileDialog::ExistingFile);
+  open_dialog->setAcceptMode(QFileDialog::AcceptOpen);
+  open_dialog->setNameFilter("Schematics (*.schematic)");
+  open_dialog->open(this, SLOT(importSchematicFile(QString)));
+}
+
+void MainWindow::importSchematicFile(const QString& filename) {
+  QFileDialog* dlg = qobject_cast<QFileDialog*>(sender());
+  if (dlg) {
+    dlg->deleteLater();
+  }
+  if (filename.isEmpty()) {
+    return;
+  }
+  BlockClipboard clipboard;
+  QString error;
+  if (!SchematicFile::read(filename, block_mgr_, &clipboard, &error)) {
+    showFileError("MCModeler - Import Schematic",
+                  QString("%1 could not be imported.").arg(QFileInfo(filename).fileName()), error);
+    return;
+  }
+  ui.level_widget_->pasteBlocks(clipboard);
+}
+
+void MainWindow::exportSchematic() {
+  if (!ui.level_widget_->hasSelection()) {
+    QMessageBox::information(this, "MCModeler - Export Schematic",
+                             "Select the blocks you would like to export with the Select tool first.");
+    return;
+  }
+  QFileDialog* save_dialog = new QFileDialog(this);
+  save_dialog->setFileMode(QFileDialog::AnyFile);
+  save_dialog->setAcceptMode(QFileDialog::AcceptSave);
+  save_dialog->setNameFilter("Schematics (*.schematic)");
+  save_dialog->setDefaultSuffix("schematic");
+  save_dialog->open(this, SLOT(exportSchematicFile(QString)));
+}
+
+void MainWindow::exportSchematicFile(const QString& filename) {
+  QFileDialog* dlg = qobject_cast<QFileDialog*>(sender());
+  if (dlg) {
+    dlg->deleteLater();
+  }
+  if (filename.isEmpty()) {
+    return;
+  }
+  QString error;
+  if (!SchematicFile::write(filename, ui.level_widget_->selectedBlocks(), &error)) {
+    showFileError("MCModeler - Export Schematic",
+                  QString("%1 could not be saved.").arg(QFileInfo(filename).fileName()), error);
+  }
+}
+
+void MainWindow::importRegion() {
+  QFileDialog* open_dialog = new QFileDialog(this);
+  open_dialog->setFileMode(QFileDialog::ExistingFile);
+  open_dialog->setAcceptMode(QFileDialog::AcceptOpen);
+  open_dialog->setNameFilter("Region files (*.mca *.mcr)");
+  open_dialog->open(this, SLOT(importRegionFile(QString)));
+}
+
+void MainWindow::importRegionFile(const QString& filename) {
+  QFileDialog* dlg = qobject_cast<QFileDialog*>(sender());
+  if (dlg) {
+    dlg->deleteLater();
+  }
+  if (filename.isEmpty()) {
+    return;
+  }
+  QString title = "MCModeler - Import from Minecraft World";
+  QString failure = QString("%1 could not be imported.").arg(QFileInfo(filename).fileName());
+  int region_x = 0;
+  int region_z = 0;
+  if (!RegionFile::regionCoordinates(filename, &region_x, &region_z)) {
+    showFileError(title, failure, "Region files must keep the names Minecraft gave them, like r.0.0.mca.");
+    return;
+  }
+  RegionImportDialog dialog(region_x, region_z, this);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+  BlockClipboard clipboard;
+  QString error;
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  bool ok = RegionFile::read(filename, dialog.corner(), dialog.oppositeCorner(), block_mgr_, &clipboard, &error);
+  QApplication::restoreOverrideCursor();
+  if (!ok) {
+    showFileError(title, failure, error);
+    return;
+  }
+  ui.level_widget_->pasteBlocks(clipboard);
+}
+
+void MainWindow::exportMesh() {
+  QFileDialog* save_dialog = new QFileDialog(this);
+  save_dialog->setFileMode(QFileDialog::AnyFile);
+  save_dialog->setAcceptMode(QFileDialog::AcceptSave);
+  save_dialog->setNameFilters(QStringList() << "Wavefront OBJ (*.obj)" << "Stanford PLY (*.ply)"
+                                            << "Binary glTF (*.glb)");
+  save_dialog->setDefaultSuffix("obj");
+  save_dialog->open(this, SLOT(exportMeshFile(QString)));
+}
+
+void MainWindow::exportMeshFile(const QString& filename) {
+  QFileDialog* dlg = qobject_cast<QFileDialog*>(sender());
+  if (dlg) {
+    dlg->deleteLater();
+  }
+  if (filename.isEmpty()) {
+    return;
+  }
+  QString error;
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  bool ok = MeshExporter::write(filename, *diagram_, &error);
+  QApplication::restoreOverrideCursor();
+  if (!ok) {
+    showFileError("MCModeler - Export Mesh",
+                  QString("%1 could not be exported.").arg(QFileInfo(filename).fileName()), error);
+  }
+}
+
+void MainWindow::importMesh() {
+  QFileDialog* open_dialog = new QFileDialog(this);
+  open_dialog->setFileMode(QFileDialog::ExistingFile);
+  open_dialog->setAcceptMode(QFileDialog::AcceptOpen);
+  open_dialog->setNameFilter("Meshes (*.obj *.stl)");
+  open_dialog->open(this, SLOT(importMeshFile(QString)));
+}
+
+void MainWindow::importMeshFile(const QString& filename) {
+  QFileDialog* dlg = qobject_cast<QFileDialog*>(sender());
+  if (dlg) {
+    dlg->deleteLater();
+  }
+  if (filename.isEmpty()) {
+    return;
+  }
+  TriangleMesh mesh;
+  QString error;
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  bool ok = TriangleMesh::read(filename, &mesh, &error);
+  QApplication::restoreOverrideCursor();
+  if (!ok) {
+    showFileError("MCModeler - Import Mesh",
+                  QString("%1 could not be imported.").arg(QFileInfo(filename).fileName()), error);
+    return;
+  }
+  ui.level_widget_->importMesh(mesh);
+}
+
+void MainWindow::importVox() {
+  QFileDialog* open_dialog = new QFileDialog(this);
+  open_dialog->setFileMode(QFileDialog::ExistingFile);
+  open_dialog->setAcceptMode(QFileDialog::AcceptOpen);
+  open_dialog->setNameFilter("MagicaVoxel models (*.vox)");
+  open_dialog->open(this, SLOT(importVoxFile(QString)));
+}
+
+void MainWindow::importVoxFile(const QString& filename) {
+  QFileDialog* dlg = qobject_cast<QFileDialog*>(sender());
+  if (dlg) {
+    dlg->deleteLater();
+  }
+  if (filename.isEmpty()) {
+    return;
+  }
+  QString title = "MCModeler - Import MagicaVoxel Model";
+  QString failure = QString("%1 could not be imported.").arg(QFileInfo(filename).fileName());
+  VoxFile vox;
+  QString error;
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  bool ok = VoxFile::read(filename, &vox, &error);
+  QApplication::restoreOverrideCursor();
+  if (!ok) {
+    showFileError(title, failure, error);
+    return;
+  }
+  VoxColorTable table(block_mgr_);
+  VoxPaletteDialog dialog(vox.usedColors(), block_mgr_, table, this);
+  if (dialog.exec() != QDialog::Accepted) {
+    return;
+  }
+  dialog.applyTo(&table);
+  table.save();
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  BlockClipboard clipboard = vox.toClipboard(block_mgr_, table);
+  QApplication::restoreOverrideCursor();
+  if (clipboard.isEmpty()) {
+    showFileError(title, failure, "Every color of the model was left out.");
+    return;
+  }
+  ui.level_widget_->pasteBlocks(clipboard);
+}
+
+void MainWindow::exportVox() {
+  QFileDialog* save_dialog = new QFileDialog(this);
+  save_dialog->setFileMode(QFileDialog::AnyFile);
+  save_dialog->setAcceptMode(QFileDialog::AcceptSave);
+  save_dialog->setNameFilter("MagicaVoxel models (*.vox)");
+  save_dialog->setDefaultSuffix("vox");
+  save_dialog->open(this, SLOT(exportVoxFile(QString)));
+}
+
+void MainWindow::exportVoxFile(const QString& filename) {
+  QFileDialog* dlg = qobject_cast<QFileDialog*>(sender());
+  if (dlg) {
+    dlg->deleteLater();
+  }
+  if (filename.isEmpty()) {
+    return;
+  }
+  QString error;
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  bool ok = VoxFile::write(filename, *diagram_, VoxColorTable(block_mgr_), &error);
+  QApplication::restoreOverrideCursor();
+  if (!ok) {
+    showFileError("MCModeler - Export MagicaVoxel Model",
+                  QString("%1 could not be exported.").arg(QFileInfo(filename).fileName()), error);
+  }
+}
+
+void MainWindow::convertImage() {
+  QFileDialog* open_dialog = new QFileDialog(this);
+  open_dialog->setFileMode(QFileDialog::ExistingFile);
+  open_dialog->setAcceptMode(QFileDialog::AcceptOpen);
+  open_dialog->setNameFilter("Images (*.png *.gif *.bmp *.jpg *.jpeg)");
+  open_dialog->open(this, SLOT(convertImageFile(QString)));
+}
+
+void MainWindow::convertImageFile(const QString& filename) {
+  QFileDialog* dlg = qobject_cast<QFileDialog*>(sender());
+  if (dlg) {
+    dlg->deleteLater();
+  }
+  if (filename.isEmpty()) {
+    return;
+  }
+  QImage image(filename);
+  if (image.isNull()) {
+    showFileError("MCModeler - Convert Image", QString("%1 could not be opened.").arg(QFileInfo(filename).fileName()),
+                  "The file is not an image MCModeler can read.");
+    return;
+  }
+  ui.level_widget_->convertImage(image);
+}
+
+void MainWindow::generateTerrain() {
+  QFileDialog* open_dialog = new QFileDialog(this);
+  open_dialog->setFileMode(QFileDialog::ExistingFile);
+  open_dialog->setAcceptMode(QFileDialog::AcceptOpen);
+  open_dialog->setNameFilter("Images (*.png *.gif *.bmp *.jpg *.jpeg)");
+  open_dialog->open(this, SLOT(generateTerrainFile(QString)));
+}
+
+void MainWindow::generateTerrainFile(const QString& filename) {
+  QFileDialog* dlg = qobject_cast<QFileDialog*>(sender());
+  if (dlg) {
+    dlg->deleteLater();
+  }
+  if (filename.isEmpty()) {
+    return;
+  }
+  QImage heightmap(filename);
+  if (heightmap.isNull()) {
+    showFileError("MCModeler - Generate Terrain",
+                  QString("%1 could not be opened.").arg(QFileInfo(filename).fileName()),
+                  "The file is not an image MCModeler can read.");
+    return;
+  }
+  ui.level_widget_->generateTerrain(heightmap);
+}
+
+void MainWindow::showFileError(const QString& title, const QString& text, const QString& error) {
+  QMessageBox* message = new QMessageBox(QMessageBox::Warning, title, text, QMessageBox::Ok, this);
+  message->setInformativeText(error);
+  message->setAttribute(Qt::WA_DeleteOnClose);
+  message->open();
+}
+
 void MainWindow::quit() {
   pending_action_ = ui.action_quit_;
   if (isWindowModified()) {
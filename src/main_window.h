@@ -20,6 +20,9 @@
 
 class Diagram;
 class BlockManager;
+class FloodFillTool;
+class ForestTool;
+class SolidTool;
 
 #include "bill_of_materials_window.h"
 
@@ -53,6 +56,84 @@ class MainWindow : public QMainWindow {
 
   void showBillOfMaterials();
 
+  /**
+    * Sets whether the flood fill tool spreads between levels, and remembers the choice in the settings.
+    */
+  void setFloodFillThreeDimensional(bool three_dimensional);
+
+  /**
+    * Asks the user how far the flood fill tool may spread, and remembers the answer in the settings.
+    */
+  void setFloodFillExtent();
+
+  /**
+    * Asks the user for the seed the forest brush plants trees from, and remembers the answer in the settings.
+    */
+  void setForestSeed();
+
+  /**
+    * Sets whether the sphere, dome, cylinder, cone, torus and cuboid tools draw whole solids rather than just their
+    * shells, and remembers the choice in the settings.
+    */
+  void setSolidShapesFilled(bool filled);
+
+  /**
+    * Asks for an MCEdit schematic file and starts pasting its blocks, as if they had been copied.
+    */
+  void importSchematic();
+  void importSchematicFile(const QString& filename);
+
+  /**
+    * Asks where to save the blocks inside the current selection as an MCEdit schematic file.
+    */
+  void exportSchematic();
+  void exportSchematicFile(const QString& filename);
+
+  /**
+    * Asks for a Minecraft region file and which box of blocks to take from it, then starts pasting those blocks.
+    */
+  void importRegion();
+  void importRegionFile(const QString& filename);
+
+  /**
+    * Asks where to export the whole diagram as a textured mesh, in a format chosen by the file name (see
+    * MeshExporter).
+    */
+  void exportMesh();
+  void exportMeshFile(const QString& filename);
+
+  /**
+    * Asks for a Wavefront OBJ or STL mesh, then asks how to build it out of the current block type (see
+    * LevelWidget::importMesh()).
+    */
+  void importMesh();
+  void importMeshFile(const QString& filename);
+
+  /**
+    * Asks for an image, then asks where to build it out of blocks (see LevelWidget::convertImage()).
+    */
+  void convertImage();
+  void convertImageFile(const QString& filename);
+
+  /**
+    * Asks for a grayscale heightmap, then asks how to build terrain from it (see LevelWidget::generateTerrain()).
+    */
+  void generateTerrain();
+  void generateTerrainFile(const QString& filename);
+
+  /**
+    * Asks for a MagicaVoxel model, then asks which block each of its colors stands for, then starts pasting it (see
+    * VoxFile).
+    */
+  void importVox();
+  void importVoxFile(const QString& filename);
+
+  /**
+    * Asks where to save the whole diagram as a MagicaVoxel model (see VoxFile).
+    */
+  void exportVox();
+  void exportVoxFile(const QString& filename);
+
  protected:
   virtual void closeEvent(QCloseEvent* event);
   virtual bool event(QEvent* event);
@@ -60,6 +141,16 @@ class MainWindow : public QMainWindow {
  private:
   void setupToolbox();
 
+  /**
+    * Adds \p tool to the tool picker under \p name and \p icon, and includes it in setSolidShapesFilled().
+    */
+  void addSolidTool(SolidTool* tool, const QString& name, const QIcon& icon);
+
+  /**
+    * Shows a warning titled \p title that \p text, explaining why with \p error.
+    */
+  void showFileError(const QString& title, const QString& text, const QString& error);
+
   void doOpen();
   void maybeSave();
   void performPendingAction();
@@ -69,6 +160,9 @@ class MainWindow : public QMainWindow {
   BlockManager* block_mgr_;
   bool toolbox_initialized_;
   QAction* pending_action_;
+  FloodFillTool* flood_fill_tool_;
+  ForestTool* forest_tool_;
+  QList<SolidTool*> solid_tools_;
   QScopedPointer<BillOfMaterialsWindow> bill_of_materials_window_;
 };
 
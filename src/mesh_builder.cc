@@ -0,0 +1,58 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mesh_builder.h"
+
+#include "texture.h"
+#include "texture_atlas.h"
+
+uint qHash(const MeshVertex& vertex) {
+  const QVector3D& position = vertex.position();
+  const QVector2D& tex_coord = vertex.texCoord();
+  // Positions are the most varied part of a vertex, so they are all that's worth mixing in.
+  return qHash(qRound(position.x() * 64)) ^ (qHash(qRound(position.y() * 64)) * 31) ^
+         (qHash(qRound(position.z() * 64)) * 961) ^ qHash(qRound((tex_coord.x() + tex_coord.y()) * 1024));
+}
+
+MeshBuilder::MeshBuilder(TextureAtlas* atlas) : atlas_(atlas) {
+}
+
+void MeshBuilder::addQuad(const QVector3D* corners, const QVector2D* tex_coords, const Texture& texture) {
+  int cell = atlas_->cellFor(texture);
+  QVector3D normal = QVector3D::normal(corners[0], corners[1], corners[2]);
+  quint32 quad[4];
+  for (int corner = 0; corner < 4; ++corner) {
+    quad[corner] = addVertex(MeshVertex(corners[corner], normal,
+                                        TextureAtlas::mapTextureCoord(cell, tex_coords[corner])));
+  }
+  indices_ << quad[0] << quad[1] << quad[2] << quad[0] << quad[2] << quad[3];
+}
+
+void MeshBuilder::clear() {
+  vertices_.clear();
+  indices_.clear();
+  vertex_indices_.clear();
+}
+
+quint32 MeshBuilder::addVertex(const MeshVertex& vertex) {
+  QHash<MeshVertex, quint32>::const_iterator iter = vertex_indices_.constFind(vertex);
+  if (iter != vertex_indices_.constEnd()) {
+    return iter.value();
+  }
+  quint32 index = vertices_.size();
+  vertices_.append(vertex);
+  vertex_indices_.insert(vertex, index);
+  return index;
+}
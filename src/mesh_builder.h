@@ -0,0 +1,119 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MESH_BUILDER_H
+#define MESH_BUILDER_H
+
+#include <QHash>
+#include <QVector>
+#include <QVector2D>
+#include <QVector3D>
+
+class Texture;
+class TextureAtlas;
+
+/**
+  * One corner of an exported triangle: where it is, which way its face points, and where it falls in the texture atlas.
+  */
+class MeshVertex {
+ public:
+  MeshVertex() {}
+  MeshVertex(const QVector3D& position, const QVector3D& normal, const QVector2D& tex_coord)
+      : position_(position), normal_(normal), tex_coord_(tex_coord) {}
+
+  const QVector3D& position() const {
+    return position_;
+  }
+
+  const QVector3D& normal() const {
+    return normal_;
+  }
+
+  const QVector2D& texCoord() const {
+    return tex_coord_;
+  }
+
+  bool operator==(const MeshVertex& other) const {
+    return position_ == other.position_ && normal_ == other.normal_ && tex_coord_ == other.tex_coord_;
+  }
+
+ private:
+  QVector3D position_;
+  QVector3D normal_;
+  QVector2D tex_coord_;
+};
+
+uint qHash(const MeshVertex& vertex);
+
+/**
+  * Collects geometry from Renderable::addToMesh() into an indexed triangle mesh, for exporting to other programs.
+  *
+  * Each quad is split into two triangles, and its texture is packed into a TextureAtlas so that the whole mesh can
+  * share one material.  Corners that match exactly in position, normal and texture coordinate are welded into one
+  * vertex, which for a wall of cubes shares most corners between the faces around them.  A builder is meant to hold a
+  * piece of a mesh at a time (MeshExporter uses one chunk), and to be cleared once that piece has been written out.
+  */
+class MeshBuilder {
+ public:
+  /**
+    * Constructs an empty builder that packs textures into \p atlas, which must outlive it.
+    */
+  explicit MeshBuilder(TextureAtlas* atlas);
+
+  /**
+    * Adds a quad with \p corners (four of them, counterclockwise from the front) textured with \p texture at
+    * \p tex_coords (one per corner).
+    */
+  void addQuad(const QVector3D* corners, const QVector2D* tex_coords, const Texture& texture);
+
+  /**
+    * Returns whether the builder holds no triangles.
+    */
+  bool isEmpty() const {
+    return indices_.isEmpty();
+  }
+
+  /**
+    * Removes all the vertices and triangles, keeping the textures in the atlas.
+    */
+  void clear();
+
+  /**
+    * Returns the welded vertices.
+    */
+  const QVector<MeshVertex>& vertices() const {
+    return vertices_;
+  }
+
+  /**
+    * Returns the triangles, as three indices into vertices() each.
+    */
+  const QVector<quint32>& indices() const {
+    return indices_;
+  }
+
+ private:
+  /**
+    * Returns the index of \p vertex, adding it if no matching vertex has been added yet.
+    */
+  quint32 addVertex(const MeshVertex& vertex);
+
+  TextureAtlas* atlas_;
+  QVector<MeshVertex> vertices_;
+  QVector<quint32> indices_;
+  QHash<MeshVertex, quint32> vertex_indices_;
+};
+
+#endif // MESH_BUILDER_H
@@ -0,0 +1,447 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mesh_exporter.h"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+#include "block_position.h"
+#include "block_prototype.h"
+#include "chunk.h"
+#include "chunk_position.h"
+#include "diagram.h"
+#include "mesh_builder.h"
+#include "texture_atlas.h"
+
+/**
+  * The number of bytes copied at a time from spooled geometry into the final file.
+  */
+static const int kCopyBufferSize = 1 << 20;
+
+/**
+  * The number of bytes of each vertex spooled by GltfMeshWriter: a position, a normal and a texture coordinate.
+  */
+static const int kGltfVertexSize = 32;
+
+/**
+  * Returns the name of the file \p filename's atlas image is saved in, when it isn't embedded.
+  */
+static QString atlasFilename(const QString& filename) {
+  QFileInfo info(filename);
+  return info.path() + "/" + info.completeBaseName() + ".png";
+}
+
+/**
+  * Appends the contents of \p source to \p destination, a buffer at a time.
+  * @return Whether everything was copied.
+  */
+static bool copyFile(QIODevice* source, QIODevice* destination) {
+  if (!source->seek(0)) {
+    return false;
+  }
+  QByteArray buffer;
+  while (!source->atEnd()) {
+    buffer = source->read(kCopyBufferSize);
+    if (buffer.isEmpty() || destination->write(buffer) != buffer.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+  * Writes a mesh in some format, a piece at a time.
+  */
+class MeshWriter {
+ public:
+  virtual ~MeshWriter() {}
+
+  /**
+    * Starts writing a mesh to \p filename.
+    * @return Whether the files needed could be created.
+    */
+  virtual bool open(const QString& filename) = 0;
+
+  /**
+    * Appends the triangles in \p mesh.
+    */
+  virtual void writePiece(const MeshBuilder& mesh) = 0;
+
+  /**
+    * Writes whatever has to come after the geometry, including \p atlas, and closes the files.
+    * @return Whether everything was written successfully.
+    */
+  virtual bool close(const TextureAtlas& atlas) = 0;
+};
+
+/**
+  * Writes Wavefront OBJ files.  OBJ allows vertices and faces to be interleaved, so each piece is written out as soon
+  * as it arrives.
+  */
+class ObjMeshWriter : public MeshWriter {
+ public:
+  ObjMeshWriter() : vertex_count_(0) {}
+
+  virtual bool open(const QString& filename) {
+    filename_ = filename;
+    file_.setFileName(filename);
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Text)) {
+      return false;
+    }
+    stream_.setDevice(&file_);
+    stream_.setRealNumberPrecision(9);
+    stream_ << "# Exported from MCModeler\n";
+    stream_ << "mtllib " << QFileInfo(materialFilename()).fileName() << "\n";
+    stream_ << "usemtl blocks\n";
+    return true;
+  }
+
+  virtual void writePiece(const MeshBuilder& mesh) {
+    foreach (const MeshVertex& vertex, mesh.vertices()) {
+      const QVector3D& position = vertex.position();
+      const QVector3D& normal = vertex.normal();
+      stream_ << "v " << position.x() << " " << position.y() << " " << position.z() << "\n";
+      stream_ << "vt " << vertex.texCoord().x() << " " << vertex.texCoord().y() << "\n";
+      stream_ << "vn " << normal.x() << " " << normal.y() << " " << normal.z() << "\n";
+    }
+    // OBJ indices count from 1, across the whole file.
+    const QVector<quint32>& indices = mesh.indices();
+    for (int i = 0; i < indices.size(); i += 3) {
+      stream_ << "f";
+      for (int corner = 0; corner < 3; ++corner) {
+        qint64 index = vertex_count_ + indices.at(i + corner) + 1;
+        stream_ << " " << index << "/" << index << "/" << index;
+      }
+      stream_ << "\n";
+    }
+    vertex_count_ += mesh.vertices().size();
+  }
+
+  virtual bool close(const TextureAtlas& atlas) {
+    stream_.flush();
+    bool ok = (stream_.status() == QTextStream::Ok && file_.error() == QFile::NoError);
+    file_.close();
+
+    QFile material_file(materialFilename());
+    if (!material_file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+      return false;
+    }
+    QString atlas_name = QFileInfo(atlasFilename(filename_)).fileName();
+    QTextStream material(&material_file);
+    material << "# Exported from MCModeler\n";
+    material << "newmtl blocks\n";
+    material << "Ka 1 1 1\n";
+    material << "Kd 1 1 1\n";
+    material << "map_Kd " << atlas_name << "\n";
+    material << "map_d " << atlas_name << "\n";
+    material.flush();
+    ok = ok && material.status() == QTextStream::Ok;
+    material_file.close();
+    return atlas.image().save(atlasFilename(filename_), "PNG") && ok;
+  }
+
+ private:
+  QString materialFilename() const {
+    QFileInfo info(filename_);
+    return info.path() + "/" + info.completeBaseName() + ".mtl";
+  }
+
+  QString filename_;
+  QFile file_;
+  QTextStream stream_;
+  qint64 vertex_count_;
+};
+
+/**
+  * Writes binary Stanford PLY files.  The header needs the number of vertices and faces, so the pieces are spooled to
+  * temporary files until close(), when the header is written and the spooled data copied after it.
+  */
+class PlyMeshWriter : public MeshWriter {
+ public:
+  PlyMeshWriter() : vertex_count_(0), face_count_(0) {}
+
+  virtual bool open(const QString& filename) {
+    filename_ = filename;
+    if (!vertex_file_.open() || !face_file_.open()) {
+      return false;
+    }
+    vertex_stream_.setDevice(&vertex_file_);
+    face_stream_.setDevice(&face_file_);
+    foreach (QDataStream* stream, QList<QDataStream*>() << &vertex_stream_ << &face_stream_) {
+      stream->setByteOrder(QDataStream::LittleEndian);
+      stream->setFloatingPointPrecision(QDataStream::SinglePrecision);
+    }
+    return true;
+  }
+
+  virtual void writePiece(const MeshBuilder& mesh) {
+    foreach (const MeshVertex& vertex, mesh.vertices()) {
+      vertex_stream_ << static_cast<float>(vertex.position().x()) << static_cast<float>(vertex.position().y())
+                     << static_cast<float>(vertex.position().z())
+                     << static_cast<float>(vertex.normal().x()) << static_cast<float>(vertex.normal().y())
+                     << static_cast<float>(vertex.normal().z())
+                     << static_cast<float>(vertex.texCoord().x()) << static_cast<float>(vertex.texCoord().y());
+    }
+    const QVector<quint32>& indices = mesh.indices();
+    for (int i = 0; i < indices.size(); i += 3) {
+      face_stream_ << static_cast<quint8>(3);
+      for (int corner = 0; corner < 3; ++corner) {
+        face_stream_ << static_cast<qint32>(vertex_count_ + indices.at(i + corner));
+      }
+    }
+    vertex_count_ += mesh.vertices().size();
+    face_count_ += indices.size() / 3;
+  }
+
+  virtual bool close(const TextureAtlas& atlas) {
+    if (vertex_stream_.status() != QDataStream::Ok || face_stream_.status() != QDataStream::Ok) {
+      return false;
+    }
+    QFile file(filename_);
+    if (!file.open(QIODevice::WriteOnly)) {
+      return false;
+    }
+    QString header;
+    QTextStream header_stream(&header);
+    header_stream << "ply\n";
+    header_stream << "format binary_little_endian 1.0\n";
+    header_stream << "comment Exported from MCModeler\n";
+    header_stream << "comment TextureFile " << QFileInfo(atlasFilename(filename_)).fileName() << "\n";
+    header_stream << "element vertex " << vertex_count_ << "\n";
+    header_stream << "property float x\nproperty float y\nproperty float z\n";
+    header_stream << "property float nx\nproperty float ny\nproperty float nz\n";
+    header_stream << "property float s\nproperty float t\n";
+    header_stream << "element face " << face_count_ << "\n";
+    header_stream << "property list uchar int vertex_indices\n";
+    header_stream << "end_header\n";
+    header_stream.flush();
+    QByteArray header_bytes = header.toAscii();
+    bool ok = (file.write(header_bytes) == header_bytes.size() &&
+               copyFile(&vertex_file_, &file) && copyFile(&face_file_, &file));
+    file.close();
+    return atlas.image().save(atlasFilename(filename_), "PNG") && ok;
+  }
+
+ private:
+  QString filename_;
+  QTemporaryFile vertex_file_;
+  QTemporaryFile face_file_;
+  QDataStream vertex_stream_;
+  QDataStream face_stream_;
+  qint64 vertex_count_;
+  qint64 face_count_;
+};
+
+/**
+  * Writes binary glTF 2.0 files.  Like PlyMeshWriter, the pieces are spooled to temporary files, since the JSON that
+  * comes first in the file needs the size of the geometry and the bounds of its positions.  The vertices are
+  * interleaved in one buffer view, the indices are in a second, and the atlas is embedded as a PNG in a third.
+  */
+class GltfMeshWriter : public MeshWriter {
+ public:
+  GltfMeshWriter() : vertex_count_(0), index_count_(0) {}
+
+  virtual bool open(const QString& filename) {
+    filename_ = filename;
+    if (!vertex_file_.open() || !index_file_.open()) {
+      return false;
+    }
+    vertex_stream_.setDevice(&vertex_file_);
+    index_stream_.setDevice(&index_file_);
+    foreach (QDataStream* stream, QList<QDataStream*>() << &vertex_stream_ << &index_stream_) {
+      stream->setByteOrder(QDataStream::LittleEndian);
+      stream->setFloatingPointPrecision(QDataStream::SinglePrecision);
+    }
+    return true;
+  }
+
+  virtual void writePiece(const MeshBuilder& mesh) {
+    foreach (const MeshVertex& vertex, mesh.vertices()) {
+      const QVector3D& position = vertex.position();
+      if (!vertex_count_) {
+        minimum_ = maximum_ = position;
+      }
+      minimum_ = QVector3D(qMin(minimum_.x(), position.x()), qMin(minimum_.y(), position.y()),
+                           qMin(minimum_.z(), position.z()));
+      maximum_ = QVector3D(qMax(maximum_.x(), position.x()), qMax(maximum_.y(), position.y()),
+                           qMax(maximum_.z(), position.z()));
+      ++vertex_count_;
+      // glTF puts v = 0 at the top of images, unlike OpenGL.
+      vertex_stream_ << static_cast<float>(position.x()) << static_cast<float>(position.y())
+                     << static_cast<float>(position.z())
+                     << static_cast<float>(vertex.normal().x()) << static_cast<float>(vertex.normal().y())
+                     << static_cast<float>(vertex.normal().z())
+                     << static_cast<float>(vertex.texCoord().x()) << static_cast<float>(1.0 - vertex.texCoord().y());
+    }
+    quint32 base = vertex_count_ - mesh.vertices().size();
+    foreach (quint32 index, mesh.indices()) {
+      index_stream_ << base + index;
+    }
+    index_count_ += mesh.indices().size();
+  }
+
+  virtual bool close(const TextureAtlas& atlas) {
+    if (vertex_stream_.status() != QDataStream::Ok || index_stream_.status() != QDataStream::Ok ||
+        vertex_count_ > 0xFFFFFFFFLL) {
+      return false;
+    }
+    QByteArray png;
+    QBuffer png_buffer(&png);
+    png_buffer.open(QIODevice::WriteOnly);
+    if (!atlas.image().save(&png_buffer, "PNG")) {
+      return false;
+    }
+    qint64 vertex_bytes = vertex_count_ * kGltfVertexSize;
+    qint64 index_bytes = index_count_ * 4;
+    qint64 png_bytes = png.size();
+    // Every chunk of a .glb file must be a multiple of four bytes long.
+    png.append(QByteArray((4 - png.size() % 4) % 4, '\0'));
+    qint64 binary_bytes = vertex_bytes + index_bytes + png.size();
+
+    QString json = QString(
+        "{\"asset\":{\"version\":\"2.0\",\"generator\":\"MCModeler\"},"
+        "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+        "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2},"
+        "\"indices\":3,\"material\":0}]}],"
+        "\"materials\":[{\"pbrMetallicRoughness\":{\"baseColorTexture\":{\"index\":0},\"metallicFactor\":0},"
+        "\"alphaMode\":\"MASK\"}],"
+        "\"textures\":[{\"source\":0,\"sampler\":0}],"
+        "\"samplers\":[{\"magFilter\":9728,\"minFilter\":9728}],"
+        "\"images\":[{\"bufferView\":2,\"mimeType\":\"image/png\"}],"
+        "\"buffers\":[{\"byteLength\":%1}],"
+        "\"bufferViews\":["
+        "{\"buffer\":0,\"byteOffset\":0,\"byteLength\":%2,\"byteStride\":%3,\"target\":34962},"
+        "{\"buffer\":0,\"byteOffset\":%2,\"byteLength\":%4,\"target\":34963},"
+        "{\"buffer\":0,\"byteOffset\":%5,\"byteLength\":%6}],"
+        "\"accessors\":["
+        "{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5126,\"count\":%7,\"type\":\"VEC3\","
+        "\"min\":[%8],\"max\":[%9]},"
+        "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":%7,\"type\":\"VEC3\"},"
+        "{\"bufferView\":0,\"byteOffset\":24,\"componentType\":5126,\"count\":%7,\"type\":\"VEC2\"},"
+        "{\"bufferView\":1,\"byteOffset\":0,\"componentType\":5125,\"count\":%10,\"type\":\"SCALAR\"}]}")
+        .arg(binary_bytes).arg(vertex_bytes).arg(kGltfVertexSize).arg(index_bytes)
+        .arg(vertex_bytes + index_bytes).arg(png_bytes).arg(vertex_count_)
+        .arg(vectorToJson(minimum_)).arg(vectorToJson(maximum_)).arg(index_count_);
+    QByteArray json_bytes = json.toUtf8();
+    json_bytes.append(QByteArray((4 - json_bytes.size() % 4) % 4, ' '));
+
+    QFile file(filename_);
+    if (!file.open(QIODevice::WriteOnly)) {
+      return false;
+    }
+    QDataStream stream(&file);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << static_cast<quint32>(0x46546C67)  // "glTF"
+           << static_cast<quint32>(2)
+           << static_cast<quint32>(12 + 8 + json_bytes.size() + 8 + binary_bytes);
+    stream << static_cast<quint32>(json_bytes.size()) << static_cast<quint32>(0x4E4F534A);  // "JSON"
+    stream.writeRawData(json_bytes.constData(), json_bytes.size());
+    stream << static_cast<quint32>(binary_bytes) << static_cast<quint32>(0x004E4942);  // "BIN"
+    bool ok = (stream.status() == QDataStream::Ok &&
+               copyFile(&vertex_file_, &file) && copyFile(&index_file_, &file) && file.write(png) == png.size());
+    file.close();
+    return ok;
+  }
+
+ private:
+  static QString vectorToJson(const QVector3D& vector) {
+    return QString("%1,%2,%3").arg(vector.x(), 0, 'g', 9).arg(vector.y(), 0, 'g', 9).arg(vector.z(), 0, 'g', 9);
+  }
+
+  QString filename_;
+  QTemporaryFile vertex_file_;
+  QTemporaryFile index_file_;
+  QDataStream vertex_stream_;
+  QDataStream index_stream_;
+  qint64 vertex_count_;
+  qint64 index_count_;
+  QVector3D minimum_;
+  QVector3D maximum_;
+};
+
+// Static.
+bool MeshExporter::formatForFilename(const QString& filename, Format* format) {
+  QString suffix = QFileInfo(filename).suffix().toLower();
+  if (suffix == "obj") {
+    *format = kFormatObj;
+  } else if (suffix == "ply") {
+    *format = kFormatPly;
+  } else if (suffix == "glb") {
+    *format = kFormatGltf;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Static.
+bool MeshExporter::write(const QString& filename, const Diagram& diagram, QString* error) {
+  Format format = kFormatObj;
+  if (!formatForFilename(filename, &format)) {
+    *error = "Meshes can be exported as .obj, .ply or .glb files.";
+    return false;
+  }
+  if (!diagram.blockCount()) {
+    *error = "The diagram has no blocks to export.";
+    return false;
+  }
+  QScopedPointer<MeshWriter> writer;
+  if (format == kFormatObj) {
+    writer.reset(new ObjMeshWriter());
+  } else if (format == kFormatPly) {
+    writer.reset(new PlyMeshWriter());
+  } else {
+    writer.reset(new GltfMeshWriter());
+  }
+  if (!writer->open(filename)) {
+    *error = "The file could not be created.";
+    return false;
+  }
+
+  TextureAtlas atlas;
+  MeshBuilder mesh(&atlas);
+  QHash<ChunkPosition, Chunk> chunks = diagram.chunks();
+  for (QHash<ChunkPosition, Chunk>::const_iterator iter = chunks.constBegin(); iter != chunks.constEnd(); ++iter) {
+    BlockPosition origin = iter.key().minimumBlock();
+    for (int y = 0; y < kChunkSize; ++y) {
+      const ChunkLayer& layer = iter.value().layer(y);
+      if (layer.isEmpty()) {
+        continue;
+      }
+      for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+        BlockPrototype* prototype = layer.prototypeAt(cell);
+        if (prototype) {
+          BlockPosition position(origin.x() + (cell & kChunkMask), origin.y() + y, origin.z() + (cell >> kChunkShift));
+          prototype->addToMesh(position, layer.orientationAt(cell), &mesh);
+        }
+      }
+    }
+    if (!mesh.isEmpty()) {
+      writer->writePiece(mesh);
+      mesh.clear();
+    }
+  }
+  if (!writer->close(atlas)) {
+    *error = "The file could not be written.";
+    return false;
+  }
+  return true;
+}
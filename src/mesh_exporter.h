@@ -0,0 +1,59 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MESH_EXPORTER_H
+#define MESH_EXPORTER_H
+
+#include <QString>
+
+class Diagram;
+
+/**
+  * Exports the blocks of a diagram as a textured triangle mesh, for rendering in other programs.
+  *
+  * The geometry comes from each block's Renderable (see Renderable::addToMesh()), so it matches what the 3D preview
+  * draws, including the faces it culls between neighbouring blocks.  All the textures are packed into one atlas (see
+  * TextureAtlas), so the mesh has a single material.  The diagram is converted and written a chunk at a time, and
+  * vertices are welded within each chunk, so only one chunk's worth of geometry is ever held in memory however large
+  * the diagram is.
+  *
+  * Three formats are supported, chosen by the suffix of the file name:
+  * - .obj: Wavefront OBJ, with the material in a .mtl file and the atlas in a .png file alongside it.
+  * - .ply: binary Stanford PLY, with the atlas in a .png file alongside it.  The geometry is spooled to temporary files
+  *   until the vertex and face counts the header needs are known.
+  * - .glb: binary glTF 2.0, with the atlas embedded.  The geometry is spooled the same way as for PLY.
+  */
+class MeshExporter {
+ public:
+  enum Format {
+    kFormatObj,
+    kFormatPly,
+    kFormatGltf
+  };
+
+  /**
+    * Sets \p format to the format for \p filename, judging by its suffix.
+    * @return Whether the suffix is that of a supported format.
+    */
+  static bool formatForFilename(const QString& filename, Format* format);
+
+  /**
+    * Writes every physical block of \p diagram to a mesh at \p filename.
+    * @return Whether the mesh was written successfully.  If not, \p error is set to a description of the problem.
+    */
+  static bool write(const QString& filename, const Diagram& diagram, QString* error);
+};
+
+#endif // MESH_EXPORTER_H
@@ -0,0 +1,62 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mesh_import_dialog.h"
+
+#include <QPushButton>
+
+/**
+  * The most blocks a model may span along its longest side at the scale it starts out at.  Models drawn in small units,
+  * like millimetres, start out scaled down to this size rather than enormous.
+  */
+static const int kDefaultSize = 64;
+
+MeshImportDialog::MeshImportDialog(const TriangleMesh& mesh, int level, QWidget* parent)
+    : QDialog(parent), mesh_(mesh) {
+  ui.setupUi(this);
+  ui.level_spin_box_->setValue(level);
+  QVector3D extent = mesh.maximum() - mesh.minimum();
+  qreal longest = qMax(extent.x(), qMax(extent.y(), extent.z()));
+  if (longest > kDefaultSize) {
+    ui.scale_spin_box_->setValue(kDefaultSize / longest);
+  }
+  connect(ui.scale_spin_box_, SIGNAL(valueChanged(double)), SLOT(updateSize()));
+  connect(ui.up_axis_combo_box_, SIGNAL(currentIndexChanged(int)), SLOT(updateSize()));
+  updateSize();
+}
+
+Voxelizer MeshImportDialog::voxelizer() const {
+  return Voxelizer(mesh_, ui.scale_spin_box_->value(),
+                   static_cast<Voxelizer::UpAxis>(ui.up_axis_combo_box_->currentIndex()));
+}
+
+Voxelizer::Fill MeshImportDialog::fill() const {
+  return static_cast<Voxelizer::Fill>(ui.fill_combo_box_->currentIndex());
+}
+
+BlockPosition MeshImportDialog::origin() const {
+  return BlockPosition(ui.x_spin_box_->value(), ui.level_spin_box_->value(), ui.z_spin_box_->value());
+}
+
+void MeshImportDialog::updateSize() {
+  Voxelizer sized = voxelizer();
+  if (sized.isValid()) {
+    ui.size_label_->setText(QString("%1 x %2 blocks, %3 levels").arg(sized.width()).arg(sized.depth())
+                            .arg(sized.height()));
+  } else {
+    ui.size_label_->setText(QString("Too big; at most %1 blocks per side").arg(Voxelizer::kMaximumSize));
+  }
+  ui.button_box_->button(QDialogButtonBox::Ok)->setEnabled(sized.isValid());
+}
@@ -0,0 +1,64 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MESH_IMPORT_DIALOG_H
+#define MESH_IMPORT_DIALOG_H
+
+#include "block_position.h"
+#include "triangle_mesh.h"
+#include "ui_mesh_import_dialog.h"
+#include "voxelizer.h"
+
+/**
+  * The dialog that asks how to turn a TriangleMesh into blocks (see LevelWidget::importMesh()): how many blocks long
+  * each unit of the mesh should be, which way is up, whether to fill it in, and where to put it.  The size the model
+  * will come out at is shown as the scale changes.
+  */
+class MeshImportDialog : public QDialog {
+  Q_OBJECT
+
+ public:
+  /**
+    * Constructs a dialog for importing \p mesh, placing it on \p level by default.
+    */
+  MeshImportDialog(const TriangleMesh& mesh, int level, QWidget* parent = NULL);
+
+  /**
+    * Returns a Voxelizer for the mesh at the chosen scale and with the chosen axis up.
+    */
+  Voxelizer voxelizer() const;
+
+  /**
+    * Returns how the mesh should be filled.
+    */
+  Voxelizer::Fill fill() const;
+
+  /**
+    * Returns where the corner of the model at its west, north and bottom edges should go.
+    */
+  BlockPosition origin() const;
+
+ private slots:
+  /**
+    * Shows the size the model will come out at, and only allows sizes the Voxelizer can manage.
+    */
+  void updateSize();
+
+ private:
+  Ui::MeshImportDialog ui;
+  TriangleMesh mesh_;
+};
+
+#endif // MESH_IMPORT_DIALOG_H
@@ -0,0 +1,216 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nbt.h"
+
+#include <QtEndian>
+
+/**
+  * How deeply tags may be nested inside each other before the data is assumed to be corrupt.
+  */
+static const int kMaximumNestingDepth = 512;
+
+/**
+  * The number of bytes handed to zlib at a time when reading large arrays.
+  */
+static const int kIoChunkSize = 1 << 20;
+
+/**
+  * The largest byte array that will be read before the data is assumed to be corrupt.
+  */
+static const int kMaximumByteArraySize = 1 << 26;
+
+NbtReader::NbtReader(gzFile file) : file_(file), position_(0), ok_(true) {
+}
+
+NbtReader::NbtReader(const QByteArray& data) : file_(NULL), data_(data), position_(0), ok_(true) {
+}
+
+void NbtReader::readRaw(char* data, int size) {
+  if (!file_) {
+    if (!ok_ || size > data_.size() - position_) {
+      ok_ = false;
+      return;
+    }
+    memcpy(data, data_.constData() + position_, size);
+    position_ += size;
+    return;
+  }
+  while (ok_ && size > 0) {
+    int read = gzread(file_, data, qMin(size, kIoChunkSize));
+    if (read <= 0) {
+      ok_ = false;
+      return;
+    }
+    data += read;
+    size -= read;
+  }
+}
+
+void NbtReader::skip(qint64 size) {
+  if (!ok_ || size <= 0) {
+    return;
+  }
+  if (!file_) {
+    if (size > data_.size() - position_) {
+      ok_ = false;
+    } else {
+      position_ += size;
+    }
+  } else if (gzseek(file_, size, SEEK_CUR) < 0) {
+    ok_ = false;
+  }
+}
+
+quint8 NbtReader::readByte() {
+  uchar value = 0;
+  readRaw(reinterpret_cast<char*>(&value), 1);
+  return value;
+}
+
+qint16 NbtReader::readShort() {
+  uchar value[2] = {0, 0};
+  readRaw(reinterpret_cast<char*>(value), 2);
+  return qFromBigEndian<qint16>(value);
+}
+
+qint32 NbtReader::readInt() {
+  uchar value[4] = {0, 0, 0, 0};
+  readRaw(reinterpret_cast<char*>(value), 4);
+  return qFromBigEndian<qint32>(value);
+}
+
+QString NbtReader::readString() {
+  quint16 size = static_cast<quint16>(readShort());
+  QByteArray utf8(size, '\0');
+  readRaw(utf8.data(), size);
+  return QString::fromUtf8(utf8.constData(), utf8.size());
+}
+
+QByteArray NbtReader::readByteArray() {
+  qint32 size = readInt();
+  if (size < 0 || size > kMaximumByteArraySize || (!file_ && size > data_.size() - position_)) {
+    ok_ = false;
+    return QByteArray();
+  }
+  if (!file_) {
+    // Share the buffer rather than copying out of it; the array is usually most of what's left anyway.
+    QByteArray bytes = data_.mid(position_, size);
+    position_ += size;
+    return bytes;
+  }
+  // The size can't be checked against what is left of a compressed file, so the array grows only as its data arrives.
+  QByteArray bytes;
+  while (ok_ && bytes.size() < size) {
+    int offset = bytes.size();
+    bytes.resize(offset + qMin(size - offset, kIoChunkSize));
+    readRaw(bytes.data() + offset, bytes.size() - offset);
+  }
+  return ok_ ? bytes : QByteArray();
+}
+
+void NbtReader::skipPayload(int type, int depth) {
+  if (depth > kMaximumNestingDepth) {
+    ok_ = false;
+    return;
+  }
+  switch (type) {
+    case kTagByte:
+      skip(1);
+      break;
+    case kTagShort:
+      skip(2);
+      break;
+    case kTagInt:
+    case kTagFloat:
+      skip(4);
+      break;
+    case kTagLong:
+    case kTagDouble:
+      skip(8);
+      break;
+    case kTagByteArray:
+      skipArray(1);
+      break;
+    case kTagIntArray:
+      skipArray(4);
+      break;
+    case kTagString:
+      skip(static_cast<quint16>(readShort()));
+      break;
+    case kTagList: {
+      int element_type = readByte();
+      qint32 count = readInt();
+      for (qint32 i = 0; ok_ && i < count; ++i) {
+        skipPayload(element_type, depth + 1);
+      }
+      break;
+    }
+    case kTagCompound:
+      for (int child_type = readByte(); ok_ && child_type != kTagEnd; child_type = readByte()) {
+        skip(static_cast<quint16>(readShort()));
+        skipPayload(child_type, depth + 1);
+      }
+      break;
+    default:
+      ok_ = false;
+      break;
+  }
+}
+
+void NbtReader::skipArray(int element_size) {
+  qint32 count = readInt();
+  if (count < 0) {
+    ok_ = false;
+    return;
+  }
+  skip(static_cast<qint64>(count) * element_size);
+}
+
+NbtWriter::NbtWriter(gzFile file) : file_(file), ok_(true) {
+}
+
+void NbtWriter::writeRaw(const char* data, int size) {
+  if (ok_ && size > 0 && gzwrite(file_, data, size) != size) {
+    ok_ = false;
+  }
+}
+
+void NbtWriter::writeByte(quint8 value) {
+  writeRaw(reinterpret_cast<const char*>(&value), 1);
+}
+
+void NbtWriter::writeShort(qint16 value) {
+  uchar bytes[2];
+  qToBigEndian(value, bytes);
+  writeRaw(reinterpret_cast<const char*>(bytes), 2);
+}
+
+void NbtWriter::writeInt(qint32 value) {
+  uchar bytes[4];
+  qToBigEndian(value, bytes);
+  writeRaw(reinterpret_cast<const char*>(bytes), 4);
+}
+
+void NbtWriter::writeString(const QString& string) {
+  QByteArray utf8 = string.toUtf8();
+  writeShort(static_cast<qint16>(utf8.size()));
+  writeRaw(utf8.constData(), utf8.size());
+}
+
+void NbtWriter::writeTagHeader(NbtTagType type, const QString& name) {
+  writeByte(type);
+  writeString(name);
+}
@@ -0,0 +1,134 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NBT_H
+#define NBT_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <zlib.h>
+
+/**
+  * The types of NBT tags, the format Minecraft and the tools around it save everything in.
+  */
+enum NbtTagType {
+  kTagEnd = 0,
+  kTagByte = 1,
+  kTagShort = 2,
+  kTagInt = 3,
+  kTagLong = 4,
+  kTagFloat = 5,
+  kTagDouble = 6,
+  kTagByteArray = 7,
+  kTagString = 8,
+  kTagList = 9,
+  kTagCompound = 10,
+  kTagIntArray = 11
+};
+
+/**
+  * Reads big-endian NBT values, either from a gzipped file or from a buffer that has already been decompressed.
+  * Rather than building a tree of tags, callers walk the tags themselves, reading the ones they want and skipping the
+  * rest with skipPayload(), so large byte arrays are read straight into the QByteArray they end up in.
+  *
+  * Once a read fails, every later read fails too and returns zero or an empty value, so callers only need to check
+  * ok() once they have read everything they were after.
+  */
+class NbtReader {
+ public:
+  /**
+    * Constructs a reader for \p file, which must stay open for as long as the reader is used.
+    */
+  explicit NbtReader(gzFile file);
+
+  /**
+    * Constructs a reader for the decompressed tags in \p data.
+    */
+  explicit NbtReader(const QByteArray& data);
+
+  bool ok() const {
+    return ok_;
+  }
+
+  /**
+    * Reads \p size bytes into \p data.
+    */
+  void readRaw(char* data, int size);
+
+  /**
+    * Skips \p size bytes.
+    */
+  void skip(qint64 size);
+
+  quint8 readByte();
+  qint16 readShort();
+  qint32 readInt();
+  QString readString();
+
+  /**
+    * Reads the payload of a byte array tag in bulk.  Arrays larger than 64 MB are treated as corrupt.
+    */
+  QByteArray readByteArray();
+
+  /**
+    * Skips the payload of a tag of type \p type, which is nested \p depth tags deep.
+    */
+  void skipPayload(int type, int depth);
+
+ private:
+  /**
+    * Skips the payload of an array tag whose elements are \p element_size bytes long.
+    */
+  void skipArray(int element_size);
+
+  gzFile file_;
+  QByteArray data_;
+  int position_;
+  bool ok_;
+};
+
+/**
+  * Writes big-endian NBT values to a gzipped file.  Like NbtReader, once a write fails every later one does nothing, so
+  * callers only need to check ok() at the end.
+  */
+class NbtWriter {
+ public:
+  /**
+    * Constructs a writer for \p file, which must stay open for as long as the writer is used.
+    */
+  explicit NbtWriter(gzFile file);
+
+  bool ok() const {
+    return ok_;
+  }
+
+  void writeRaw(const char* data, int size);
+  void writeByte(quint8 value);
+  void writeShort(qint16 value);
+  void writeInt(qint32 value);
+  void writeString(const QString& string);
+
+  /**
+    * Writes the type and name that start a tag.  The payload should be written next.
+    */
+  void writeTagHeader(NbtTagType type, const QString& name);
+
+ private:
+  gzFile file_;
+  bool ok_;
+};
+
+#endif // NBT_H
@@ -152,48 +152,52 @@ void PaneRenderable::addGeometry(const PaneRenderable::Geometry& geometry,
 bool PaneRenderable::shouldRenderQuad(int index,
                                       const QVector3D& location,
                                       const BlockOrientation* orientation) const {
-  if (orientation == BlockOrientation::get("Running north/south") ||
-      orientation == BlockOrientation::get("Running east/west")) {
+  if (orientation->id() == BlockOrientation::kOrientationRunningNorthSouth ||
+      orientation->id() == BlockOrientation::kOrientationRunningEastWest) {
     return index >= kFullWidthFront && index <= kFullWidthLeft;
-  } else if (orientation == BlockOrientation::get("North half")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationNorthHalf) {
     return index >= kNorthHalfFront && index <= kNorthHalfLeft;
-  } else if (orientation == BlockOrientation::get("South half")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationSouthHalf) {
     return index >= kSouthHalfFront && index <= kSouthHalfLeft;
-  } else if (orientation == BlockOrientation::get("East half")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationEastHalf) {
     return index >= kEastHalfFront && index <= kEastHalfLeft;
-  } else if (orientation == BlockOrientation::get("West half")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationWestHalf) {
     return index >= kWestHalfFront && index <= kWestHalfLeft;
-  } else if (orientation == BlockOrientation::get("Northeast corner")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationNortheastCorner) {
     return (index >= kNorthHalfFront && index <= kNorthHalfLeft) ||
            (index >= kEastHalfFront && index <= kEastHalfLeft);
-  } else if (orientation == BlockOrientation::get("Northwest corner")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationNorthwestCorner) {
     return (index >= kNorthHalfFront && index <= kNorthHalfLeft) ||
            (index >= kWestHalfFront && index <= kWestHalfLeft);
-  } else if (orientation == BlockOrientation::get("Southeast corner")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationSoutheastCorner) {
     return (index >= kSouthHalfFront && index <= kSouthHalfLeft) ||
            (index >= kEastHalfFront && index <= kEastHalfLeft);
-  } else if (orientation == BlockOrientation::get("Southwest corner")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationSouthwestCorner) {
     return (index >= kSouthHalfFront && index <= kSouthHalfLeft) ||
            (index >= kWestHalfFront && index <= kWestHalfLeft);
-  } else if (orientation == BlockOrientation::get("T facing south")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationTFacingSouth) {
     return index > kFullWidthLeft && !(index >= kSouthHalfFront && index <= kSouthHalfLeft);
-  } else if (orientation == BlockOrientation::get("T facing west")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationTFacingWest) {
     return index > kFullWidthLeft && !(index >= kWestHalfFront && index <= kWestHalfLeft);
-  } else if (orientation == BlockOrientation::get("T facing north")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationTFacingNorth) {
     return index > kFullWidthLeft && !(index >= kNorthHalfFront && index <= kNorthHalfLeft);
-  } else if (orientation == BlockOrientation::get("T facing east")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationTFacingEast) {
     return index > kFullWidthLeft && !(index >= kEastHalfFront && index <= kEastHalfLeft);
-  } else if (orientation == BlockOrientation::get("Cross")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationCross) {
     return index > kFullWidthLeft;
   } else {
     return false;
   }
 }
 
-void PaneRenderable::applyOrientationTransform(const BlockOrientation* orientation) const {
-  if (orientation == BlockOrientation::get("Facing east/west")) {
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
+QMatrix4x4 PaneRenderable::orientationTransform(const BlockOrientation* orientation) const {
+  // "Facing east/west" is not in the orientation table, so look it up by name, but only once.
+  static const BlockOrientation* facing_east_west = BlockOrientation::get("Facing east/west");
+  QMatrix4x4 transform;
+  if (orientation == facing_east_west) {
+    transform.rotate(90.0f, 0.0f, 1.0f, 0.0f);
   }
+  return transform;
 }
 
 Texture PaneRenderable::textureForQuad(int index, const BlockOrientation* orientation) const {
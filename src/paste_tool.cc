@@ -0,0 +1,61 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "paste_tool.h"
+
+#include "diagram.h"
+
+PasteTool::PasteTool(Diagram* diagram, const BlockClipboard& clipboard)
+    : diagram_(diagram),
+      clipboard_(clipboard),
+      preview_origin_(0, 0, 0) {}
+
+QString PasteTool::actionName() const {
+  return "Paste";
+}
+
+bool PasteTool::wantsMorePositions() {
+  return countPositions() < 1;
+}
+
+bool PasteTool::isBrush() const {
+  return false;
+}
+
+void PasteTool::draw(BlockPrototype* /* prototype */,
+                     const BlockOrientation* /* orientation */,
+                     BlockTransaction* transaction) {
+  if (wantsMorePositions() || clipboard_.isEmpty()) {
+    return;
+  }
+  diagram_->paste(clipboard_, positionAtIndex(0), transaction);
+}
+
+bool PasteTool::drawPreview(BlockPrototype* prototype,
+                            const BlockOrientation* orientation,
+                            BlockTransaction* /* retracted */,
+                            BlockTransaction* transaction) {
+  // The pasted blocks don't depend on prototype or orientation, but continuePreview() still tells us whether there
+  // is a previous preview to continue.
+  bool is_incremental = continuePreview(prototype, orientation) && !wantsMorePositions() &&
+                        positionAtIndex(0) == preview_origin_;
+  if (!is_incremental) {
+    draw(prototype, orientation, transaction);
+  }
+  if (!wantsMorePositions()) {
+    preview_origin_ = positionAtIndex(0);
+  }
+  return is_incremental;
+}
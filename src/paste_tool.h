@@ -0,0 +1,52 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PASTE_TOOL_H
+#define PASTE_TOOL_H
+
+#include "block_clipboard.h"
+#include "block_position.h"
+#include "tool.h"
+
+class Diagram;
+
+/**
+  * A Tool that pastes the contents of a BlockClipboard with its lowest corner at a single position, replacing
+  * everything inside the box the clipboard covers.
+  *
+  * Moving the paste anywhere else changes almost every cell of the preview, so rather than comparing successive
+  * drawings, drawPreview() redraws the whole paste whenever the position changes, and reports no change otherwise.
+  */
+class PasteTool : public Tool {
+ public:
+  PasteTool(Diagram* diagram, const BlockClipboard& clipboard);
+  virtual QString actionName() const;
+  virtual bool wantsMorePositions();
+  virtual bool isBrush() const;
+  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
+  virtual bool drawPreview(BlockPrototype* prototype,
+                           const BlockOrientation* orientation,
+                           BlockTransaction* retracted,
+                           BlockTransaction* transaction);
+
+ private:
+  Diagram* diagram_;
+  BlockClipboard clipboard_;
+
+  /// The position the previous preview was drawn at.
+  BlockPosition preview_origin_;
+};
+
+#endif // PASTE_TOOL_H
@@ -15,34 +15,17 @@
 
 #include "pencil_tool.h"
 
-#include "block_instance.h"
-#include "block_oracle.h"
-#include "block_prototype.h"
-#include "block_transaction.h"
+#include "diagram.h"
 
-PencilTool::PencilTool(BlockOracle* oracle) : oracle_(oracle) {}
+PencilTool::PencilTool(Diagram* diagram) : BrushTool(diagram) {}
 
 QString PencilTool::actionName() const {
   return "Draw Blocks";
 }
 
-bool PencilTool::wantsMorePositions() {
-  return countPositions() == 0;
-}
-
-bool PencilTool::isBrush() const {
-  return true;
-}
-
-void PencilTool::draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
-  if (wantsMorePositions()) {
-    return;
-  }
-
-  for (int i = 0; i < countPositions(); ++i) {
-    // TODO(phoenix): Should eventually draw lines between these points.
-    const BlockPosition& point = positionAtIndex(i);
-    BlockInstance new_block(prototype, point, orientation);
-    transaction->replaceBlock(oracle_->blockAt(point), new_block);
-  }
+void PencilTool::paint(const SpanMask& mask,
+                       BlockPrototype* prototype,
+                       const BlockOrientation* orientation,
+                       BlockTransaction* segment) {
+  diagram()->fillSpans(mask, prototype, orientation, segment);
 }
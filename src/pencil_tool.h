@@ -16,24 +16,23 @@
 #ifndef PENCIL_TOOL_H
 #define PENCIL_TOOL_H
 
-#include "block_position.h"
-#include "tool.h"
+#include "brush_tool.h"
 
-class BlockOracle;
+class Diagram;
 
 /**
   * A Tool that draws individual blocks.
   */
-class PencilTool : public Tool {
+class PencilTool : public BrushTool {
  public:
-  explicit PencilTool(BlockOracle* oracle);
+  explicit PencilTool(Diagram* diagram);
   virtual QString actionName() const;
-  virtual bool wantsMorePositions();
-  virtual bool isBrush() const;
-  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
 
- private:
-  BlockOracle* oracle_;
+ protected:
+  virtual void paint(const SpanMask& mask,
+                     BlockPrototype* prototype,
+                     const BlockOrientation* orientation,
+                     BlockTransaction* segment);
 };
 
 #endif // PENCIL_TOOL_H
@@ -0,0 +1,234 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefab_file.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include "block_clipboard.h"
+#include "block_manager.h"
+#include "block_orientation.h"
+#include "block_prototype.h"
+#include "chunk.h"
+#include "chunk_position.h"
+
+/**
+  * The string every prefab starts with.
+  */
+static const char kPrefabMagic[] = "mcprefab";
+
+/**
+  * The version of the prefab format written by this version of MCModeler.  Files with a newer version are refused.
+  */
+static const quint32 kPrefabFormatVersion = 1;
+
+/**
+  * The largest palette, air aside, whose indices fit in a byte.
+  */
+static const int kMaximumBytePaletteSize = 0xFF;
+
+// Static.
+bool PrefabFile::read(const QString& filename, BlockManager* block_mgr, BlockClipboard* clipboard, QString* error) {
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    *error = "The file could not be opened.";
+    return false;
+  }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_7);
+  char* magic = NULL;
+  stream >> magic;
+  bool is_prefab = magic && qstrcmp(magic, kPrefabMagic) == 0;
+  delete[] magic;
+  if (!is_prefab) {
+    *error = "The file is not a prefab.";
+    return false;
+  }
+  quint32 version;
+  qint32 width;
+  qint32 height;
+  qint32 depth;
+  qint32 layer_count;
+  stream >> version >> width >> height >> depth >> layer_count;
+  if (stream.status() != QDataStream::Ok) {
+    *error = "The file is truncated.";
+    return false;
+  }
+  if (version > kPrefabFormatVersion) {
+    *error = "The prefab was saved by a newer version of MCModeler.";
+    return false;
+  }
+  if (width <= 0 || height <= 0 || depth <= 0 || layer_count < 0) {
+    *error = "The prefab is corrupt.";
+    return false;
+  }
+
+  BlockClipboard result(width, height, depth);
+  QVector<BlockPrototype*> prototypes;
+  QVector<const BlockOrientation*> orientations;
+  QVector<quint16> cells(kChunkLayerArea);
+  for (int i = 0; i < layer_count; ++i) {
+    qint32 chunk_x;
+    qint32 chunk_y;
+    qint32 chunk_z;
+    quint8 y;
+    quint16 palette_size;
+    stream >> chunk_x >> chunk_y >> chunk_z >> y >> palette_size;
+    if (stream.status() != QDataStream::Ok) {
+      *error = "The file is truncated.";
+      return false;
+    }
+    // Every cell of a layer must lie inside the box, apart from air.
+    if (chunk_x < 0 || chunk_z < 0 || chunk_y < 0 || y >= kChunkSize ||
+        (static_cast<qint64>(chunk_y) << kChunkShift) + y >= height ||
+        static_cast<qint64>(chunk_x) << kChunkShift >= width ||
+        static_cast<qint64>(chunk_z) << kChunkShift >= depth) {
+      *error = "The prefab is corrupt.";
+      return false;
+    }
+
+    // Entry 0 is air, which isn't stored.
+    prototypes.fill(NULL, palette_size + 1);
+    orientations.fill(NULL, palette_size + 1);
+    for (int index = 1; index <= palette_size; ++index) {
+      qint32 type;
+      stream >> type;
+      if (BlockPrototype::isKnownType(type)) {
+        prototypes[index] = block_mgr->getPrototype(type);
+      } else {
+        qWarning() << "Unknown block type" << type << "in prefab; leaving it out.";
+      }
+      orientations[index] = BlockOrientation::deserialize(&stream);
+      if (!orientations.at(index)) {
+        orientations[index] = BlockOrientation::noOrientation();
+      }
+    }
+    if (palette_size <= kMaximumBytePaletteSize) {
+      QByteArray bytes(kChunkLayerArea, '\0');
+      if (stream.readRawData(bytes.data(), kChunkLayerArea) != kChunkLayerArea) {
+        *error = "The file is truncated.";
+        return false;
+      }
+      for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+        cells[cell] = static_cast<quint8>(bytes.at(cell));
+      }
+    } else {
+      for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+        stream >> cells[cell];
+      }
+    }
+    if (stream.status() != QDataStream::Ok) {
+      *error = "The file is truncated.";
+      return false;
+    }
+
+    ChunkLayer layer;
+    int first_x = chunk_x << kChunkShift;
+    int first_z = chunk_z << kChunkShift;
+    for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+      int index = cells.at(cell);
+      if (!index) {
+        continue;
+      }
+      if (index > palette_size || first_x + (cell & kChunkMask) >= width || first_z + (cell >> kChunkShift) >= depth) {
+        *error = "The prefab is corrupt.";
+        return false;
+      }
+      if (prototypes.at(index)) {
+        layer.setBlock(cell, prototypes.at(index), orientations.at(index));
+      }
+    }
+    result.setLayer(ChunkPosition(chunk_x, chunk_y, chunk_z), y, layer);
+  }
+  *clipboard = result;
+  return true;
+}
+
+// Static.
+bool PrefabFile::write(const QString& filename, const BlockClipboard& clipboard, QString* error) {
+  if (clipboard.isEmpty()) {
+    *error = "There is nothing to save.";
+    return false;
+  }
+  QFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    *error = "The file could not be created.";
+    return false;
+  }
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_7);
+
+  qint32 layer_count = 0;
+  for (QHash<ChunkPosition, Chunk>::const_iterator iter = clipboard.chunks().constBegin();
+       iter != clipboard.chunks().constEnd(); ++iter) {
+    for (int y = 0; y < kChunkSize; ++y) {
+      if (!iter.value().layer(y).isEmpty()) {
+        ++layer_count;
+      }
+    }
+  }
+  stream << kPrefabMagic << kPrefabFormatVersion;
+  stream << static_cast<qint32>(clipboard.width()) << static_cast<qint32>(clipboard.height())
+         << static_cast<qint32>(clipboard.depth()) << layer_count;
+
+  // Palettes may have unused entries, which are dropped, so the indices written are remapped.
+  QVector<quint16> remapped;
+  QByteArray bytes(kChunkLayerArea, '\0');
+  for (QHash<ChunkPosition, Chunk>::const_iterator iter = clipboard.chunks().constBegin();
+       iter != clipboard.chunks().constEnd(); ++iter) {
+    for (int y = 0; y < kChunkSize; ++y) {
+      const ChunkLayer& layer = iter.value().layer(y);
+      if (layer.isEmpty()) {
+        continue;
+      }
+      const QVector<ChunkLayer::PaletteEntry>& palette = layer.palette();
+      remapped.fill(0, palette.size());
+      int palette_size = 0;
+      for (int index = 1; index < palette.size(); ++index) {
+        if (palette.at(index).count()) {
+          remapped[index] = ++palette_size;
+        }
+      }
+      stream << static_cast<qint32>(iter.key().x()) << static_cast<qint32>(iter.key().y())
+             << static_cast<qint32>(iter.key().z()) << static_cast<quint8>(y) << static_cast<quint16>(palette_size);
+      for (int index = 1; index < palette.size(); ++index) {
+        if (palette.at(index).count()) {
+          stream << static_cast<qint32>(palette.at(index).prototype()->type());
+          palette.at(index).orientation()->serialize(&stream);
+        }
+      }
+      if (palette_size <= kMaximumBytePaletteSize) {
+        for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+          bytes[cell] = static_cast<char>(remapped.at(layer.paletteIndexAt(cell)));
+        }
+        stream.writeRawData(bytes.constData(), kChunkLayerArea);
+      } else {
+        for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+          stream << remapped.at(layer.paletteIndexAt(cell));
+        }
+      }
+    }
+  }
+  if (stream.status() != QDataStream::Ok || !file.flush()) {
+    *error = "The file could not be written.";
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,50 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFAB_FILE_H
+#define PREFAB_FILE_H
+
+#include <QString>
+
+class BlockClipboard;
+class BlockManager;
+
+/**
+  * Reads and writes prefabs: boxes of blocks saved for stamping into diagrams again and again (see PrefabLibrary).
+  *
+  * Unlike a schematic, a prefab keeps the orientation of every block, and it is stored the way a BlockClipboard holds
+  * it in memory.  After a short header giving the size of the box, each layer of each chunk that holds any blocks is
+  * written as its chunk position and local height, its palette of block types and orientations with air left out,
+  * and then one palette index per cell, a byte each if the palette is small enough and two otherwise.  So reading
+  * a prefab builds its layers directly, with one prototype lookup per palette entry, and never creates a BlockInstance.
+  * Block types this version of MCModeler doesn't know are read as air.
+  */
+class PrefabFile {
+ public:
+  /**
+    * Reads the prefab at \p filename into \p clipboard, using \p block_mgr to look up block prototypes.
+    * @return Whether the file was read successfully.  If not, \p error is set to a description of the problem and
+    *     \p clipboard is left alone.
+    */
+  static bool read(const QString& filename, BlockManager* block_mgr, BlockClipboard* clipboard, QString* error);
+
+  /**
+    * Writes the blocks in \p clipboard to a prefab at \p filename.
+    * @return Whether the file was written successfully.  If not, \p error is set to a description of the problem.
+    */
+  static bool write(const QString& filename, const BlockClipboard& clipboard, QString* error);
+};
+
+#endif // PREFAB_FILE_H
@@ -0,0 +1,89 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prefab_library.h"
+
+#include <QDesktopServices>
+#include <QRegExp>
+
+#include "block_transform.h"
+#include "prefab_file.h"
+
+/**
+  * The file extension of prefabs.
+  */
+static const char kPrefabExtension[] = ".mcprefab";
+
+PrefabLibrary::PrefabLibrary(BlockManager* block_mgr, const QDir& directory)
+    : block_mgr_(block_mgr), directory_(directory) {}
+
+// Static.
+QDir PrefabLibrary::defaultDirectory() {
+  return QDir(QDesktopServices::storageLocation(QDesktopServices::DataLocation) + "/prefabs");
+}
+
+QStringList PrefabLibrary::names() const {
+  QStringList names;
+  QStringList filenames = directory_.entryList(QStringList(QString("*") + kPrefabExtension), QDir::Files,
+                                               QDir::Name | QDir::IgnoreCase);
+  foreach (const QString& filename, filenames) {
+    names.append(filename.left(filename.size() - qstrlen(kPrefabExtension)));
+  }
+  return names;
+}
+
+BlockClipboard PrefabLibrary::prefab(const QString& name, int quarter_turns, QString* error) {
+  Q_ASSERT(quarter_turns >= 0 && quarter_turns < kRotationCount);
+  QHash<QString, QVector<BlockClipboard> >::iterator rotations = rotations_.find(name);
+  if (rotations == rotations_.end()) {
+    BlockClipboard clipboard;
+    if (!PrefabFile::read(filenameFor(name), block_mgr_, &clipboard, error)) {
+      return BlockClipboard();
+    }
+    rotations = rotations_.insert(name, QVector<BlockClipboard>(kRotationCount));
+    rotations.value()[0] = clipboard;
+  }
+  BlockClipboard& rotation = rotations.value()[quarter_turns];
+  if (rotation.isEmpty()) {
+    // The prefab as read is never empty, so this is a real rotation.
+    BlockTransform::Kind kind = quarter_turns == 1 ? BlockTransform::kRotateClockwise :
+                                quarter_turns == 2 ? BlockTransform::kRotateHalfTurn :
+                                                     BlockTransform::kRotateCounterclockwise;
+    rotation = rotations.value().at(0).transformed(kind);
+  }
+  return rotation;
+}
+
+bool PrefabLibrary::save(const QString& name, const BlockClipboard& clipboard, QString* error) {
+  if (name.isEmpty() || name.startsWith(".") || name.contains(QRegExp("[/\\\\:*?\"<>|]"))) {
+    *error = "Prefab names can't start with a period or contain any of / \\ : * ? \" < > |.";
+    return false;
+  }
+  if (!QDir().mkpath(directory_.absolutePath())) {
+    *error = "The prefab library folder could not be created.";
+    return false;
+  }
+  if (!PrefabFile::write(filenameFor(name), clipboard, error)) {
+    return false;
+  }
+  QVector<BlockClipboard> rotations(kRotationCount);
+  rotations[0] = clipboard;
+  rotations_.insert(name, rotations);
+  return true;
+}
+
+QString PrefabLibrary::filenameFor(const QString& name) const {
+  return directory_.filePath(name + kPrefabExtension);
+}
@@ -0,0 +1,90 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PREFAB_LIBRARY_H
+#define PREFAB_LIBRARY_H
+
+#include <QDir>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "block_clipboard.h"
+
+class BlockManager;
+
+/**
+  * A library of prefabs: boxes of blocks, such as windows, doors and lamp posts, saved under a name to be stamped into
+  * diagrams again and again.  Each prefab is a PrefabFile in the library's directory.
+  *
+  * Nothing is read until it is needed.  Constructing the library doesn't touch the disk, listing it only reads the
+  * directory, and each prefab is read the first time it is asked for.  After that it is kept in memory, along with each
+  * rotation of it that has been asked for, so stamping a prefab, or turning it while stamping, costs no more than
+  * pasting a clipboard: the blocks are already in chunk layers, with their orientations already turned.
+  */
+class PrefabLibrary {
+ public:
+  /**
+    * The number of rotations of each prefab: none, and one, two and three quarter turns clockwise.
+    */
+  static const int kRotationCount = 4;
+
+  /**
+    * Constructs a library of the prefabs in \p directory, using \p block_mgr to look up block prototypes when reading
+    * them.  The directory is created when the first prefab is saved.
+    */
+  PrefabLibrary(BlockManager* block_mgr, const QDir& directory);
+
+  /**
+    * Returns the directory prefabs are kept in unless the user says otherwise: "prefabs" in MCModeler's data
+    * directory.
+    */
+  static QDir defaultDirectory();
+
+  /**
+    * Returns the names of the prefabs in the library, sorted alphabetically.
+    */
+  QStringList names() const;
+
+  /**
+    * Returns the prefab called \p name turned \p quarter_turns quarter turns clockwise, which must be less than
+    * kRotationCount.
+    * @return The prefab, or an empty clipboard if it could not be read, in which case \p error is set to a description
+    *     of the problem.
+    */
+  BlockClipboard prefab(const QString& name, int quarter_turns, QString* error);
+
+  /**
+    * Saves \p clipboard as a prefab called \p name, replacing any prefab of that name.
+    * @return Whether the prefab was saved.  If not, \p error is set to a description of the problem.
+    */
+  bool save(const QString& name, const BlockClipboard& clipboard, QString* error);
+
+ private:
+  /**
+    * Returns the path of the file holding the prefab called \p name.
+    */
+  QString filenameFor(const QString& name) const;
+
+  BlockManager* block_mgr_;
+  QDir directory_;
+
+  /// The prefabs read so far, each with the rotations of it made so far, indexed by quarter turns clockwise.  Those
+  /// not made yet are empty.
+  QHash<QString, QVector<BlockClipboard> > rotations_;
+};
+
+#endif // PREFAB_LIBRARY_H
@@ -15,12 +15,9 @@
 
 #include "rectangle_tool.h"
 
-#include "block_instance.h"
-#include "block_oracle.h"
-#include "block_prototype.h"
-#include "block_transaction.h"
+#include "span_mask.h"
 
-RectangleTool::RectangleTool(BlockOracle* oracle) : oracle_(oracle) {}
+RectangleTool::RectangleTool(Diagram* diagram) : ShapeTool(diagram) {}
 
 QString RectangleTool::actionName() const {
   return "Draw Rectangle";
@@ -34,7 +31,7 @@ bool RectangleTool::isBrush() const {
   return false;
 }
 
-void RectangleTool::draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
+void RectangleTool::rasterize(SpanMask* mask) {
   if (wantsMorePositions()) {
     return;
   }
@@ -48,27 +45,10 @@ void RectangleTool::draw(BlockPrototype* prototype, const BlockOrientation* orie
                     positionAtIndex(0).y(),
                     qMax(positionAtIndex(0).z(), positionAtIndex(1).z()));
 
-  for (int x = start.x(); x <= end.x(); ++x) {
-    {
-      BlockPosition pos(x, start.y(), start.z());
-      BlockInstance new_block(prototype, pos, orientation);
-      transaction->replaceBlock(oracle_->blockAt(pos), new_block);
-    }
-
-    BlockPosition pos(x, start.y(), end.z());
-    BlockInstance new_block(prototype, pos, orientation);
-    transaction->replaceBlock(oracle_->blockAt(pos), new_block);
-  }
-
-  for (int z = start.z(); z <= end.z(); ++z) {
-    {
-      BlockPosition pos(start.x(), start.y(), z);
-      BlockInstance new_block(prototype, pos, orientation);
-      transaction->replaceBlock(oracle_->blockAt(pos), new_block);
-    }
-
-    BlockPosition pos(end.x(), start.y(), z);
-    BlockInstance new_block(prototype, pos, orientation);
-    transaction->replaceBlock(oracle_->blockAt(pos), new_block);
+  mask->addSpan(start.x(), end.x(), start.y(), start.z());
+  for (int z = start.z() + 1; z < end.z(); ++z) {
+    mask->addCell(start.x(), start.y(), z);
+    mask->addCell(end.x(), start.y(), z);
   }
+  mask->addSpan(start.x(), end.x(), start.y(), end.z());
 }
@@ -17,23 +17,22 @@
 #define RECTANGLE_TOOL_H
 
 #include "block_position.h"
-#include "tool.h"
+#include "shape_tool.h"
 
-class BlockOracle;
+class Diagram;
 
 /**
   * A Tool that draws hollow rectangles between two corners.
   */
-class RectangleTool : public Tool {
+class RectangleTool : public ShapeTool {
  public:
-  explicit RectangleTool(BlockOracle* oracle);
+  explicit RectangleTool(Diagram* diagram);
   virtual QString actionName() const;
   virtual bool wantsMorePositions();
   virtual bool isBrush() const;
-  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
 
- private:
-  BlockOracle* oracle_;
+ protected:
+  virtual void rasterize(SpanMask* mask);
 };
 
 #endif // RECTANGLE_TOOL_H
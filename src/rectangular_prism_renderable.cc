@@ -162,14 +162,16 @@ RectangularPrismRenderable::TextureCoords RectangularPrismRenderable::createText
   return TextureCoords() << front_tex << back_tex << bottom_tex << right_tex << top_tex << left_tex;
 }
 
-void RectangularPrismRenderable::applyOrientationTransform(const BlockOrientation* orientation) const {
-  if (orientation == BlockOrientation::get("Facing north")) {
-    glRotatef(180.0f, 0.0f, 1.0f, 0.0f);
-  } else if (orientation == BlockOrientation::get("Facing east")) {
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-  } else if (orientation == BlockOrientation::get("Facing west")) {
-    glRotatef(-90.0f, 0.0f, 1.0f, 0.0f);
+QMatrix4x4 RectangularPrismRenderable::orientationTransform(const BlockOrientation* orientation) const {
+  QMatrix4x4 transform;
+  if (orientation->id() == BlockOrientation::kOrientationFacingNorth) {
+    transform.rotate(180.0f, 0.0f, 1.0f, 0.0f);
+  } else if (orientation->id() == BlockOrientation::kOrientationFacingEast) {
+    transform.rotate(90.0f, 0.0f, 1.0f, 0.0f);
+  } else if (orientation->id() == BlockOrientation::kOrientationFacingWest) {
+    transform.rotate(-90.0f, 0.0f, 1.0f, 0.0f);
   }
+  return transform;
 }
 
 bool RectangularPrismRenderable::shouldRenderQuad(int index,
@@ -184,8 +186,19 @@ bool RectangularPrismRenderable::shouldRenderQuad(int index,
   }
 }
 
+bool RectangularPrismRenderable::shouldExportQuad(int index,
+                                                  const QVector3D& location,
+                                                  const BlockOrientation* orientation) const {
+  if (culling_ == kDoNotCullFaces) {
+    return true;
+  } else {
+    Face face = mapToDefaultOrientation(static_cast<Face>(index), orientation);
+    return !(renderDelegate() && !renderDelegate()->shouldExportFace(this, face, location));
+  }
+}
+
 Face RectangularPrismRenderable::mapToDefaultOrientation(Face local_face, const BlockOrientation* orientation) const {
-  if (orientation == BlockOrientation::get("Facing north")) {
+  if (orientation->id() == BlockOrientation::kOrientationFacingNorth) {
     switch (local_face) {
     case kFrontFace:
       return kBackFace;
@@ -198,7 +211,7 @@ Face RectangularPrismRenderable::mapToDefaultOrientation(Face local_face, const
     default:
       break;
     }
-  } else if (orientation == BlockOrientation::get("Facing west")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationFacingWest) {
     switch (local_face) {
     case kFrontFace:
       return kLeftFace;
@@ -211,7 +224,7 @@ Face RectangularPrismRenderable::mapToDefaultOrientation(Face local_face, const
     default:
       break;
     }
-  } else if (orientation == BlockOrientation::get("Facing east")) {
+  } else if (orientation->id() == BlockOrientation::kOrientationFacingEast) {
     switch (local_face) {
     case kFrontFace:
       return kRightFace;
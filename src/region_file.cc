@@ -0,0 +1,435 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "region_file.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QRegExp>
+#include <QVector>
+#include <QtConcurrentMap>
+#include <QtEndian>
+
+#include <string.h>
+#include <zlib.h>
+
+#include "block_clipboard.h"
+#include "block_manager.h"
+#include "block_position.h"
+#include "block_prototype.h"
+#include "chunk.h"
+#include "chunk_position.h"
+#include "nbt.h"
+
+/**
+  * The number of chunk columns along each side of a region.
+  */
+static const int kRegionSize = 32;
+
+/**
+  * The size of the sectors region files are divided into.  The first sector holds the table of chunk offsets.
+  */
+static const int kSectorSize = 4096;
+
+/**
+  * The largest a chunk may be once decompressed before it is assumed to be corrupt.
+  */
+static const int kMaximumChunkSize = 1 << 26;
+
+/**
+  * The number of distinct (block ID, data value) pairs a chunk can hold: 12-bit IDs and 4-bit data values.
+  */
+static const int kMinecraftBlockKeyCount = 1 << 16;
+
+/**
+  * The height of the chunk columns in MCRegion files, which store each column as a single array.
+  */
+static const int kMcRegionHeight = 128;
+
+/**
+  * The number of blocks in an Anvil section.
+  */
+static const int kSectionVolume = kChunkSize * kChunkSize * kChunkSize;
+
+/**
+  * The number of blocks in an MCRegion chunk column.
+  */
+static const int kMcRegionColumnVolume = kChunkSize * kChunkSize * kMcRegionHeight;
+
+/**
+  * What every chunk job needs to know about the import as a whole.
+  */
+class RegionImport {
+ public:
+  RegionImport(const BlockPosition& minimum, const BlockPosition& maximum, const QVector<BlockPrototype*>& prototypes)
+      : minimum_(minimum), maximum_(maximum), prototypes_(prototypes) {}
+
+  /**
+    * Returns the corner of the box being imported with the smallest coordinates, which becomes the corner of the
+    * clipboard.
+    */
+  const BlockPosition& minimum() const {
+    return minimum_;
+  }
+
+  /**
+    * Returns the corner of the box being imported with the largest coordinates.
+    */
+  const BlockPosition& maximum() const {
+    return maximum_;
+  }
+
+  /**
+    * Returns the prototype for the block ID \p id and data value \p data, or NULL if the block should be left out.
+    */
+  BlockPrototype* prototype(int id, int data) const {
+    return prototypes_.at((id << 4) | data);
+  }
+
+ private:
+  BlockPosition minimum_;
+  BlockPosition maximum_;
+  QVector<BlockPrototype*> prototypes_;
+};
+
+/**
+  * One compressed chunk column to be decoded.
+  */
+class RegionChunkJob {
+ public:
+  RegionChunkJob(int chunk_x, int chunk_z, const QByteArray& compressed_data, const RegionImport* import)
+      : chunk_x_(chunk_x), chunk_z_(chunk_z), compressed_data_(compressed_data), import_(import) {}
+
+  /**
+    * Returns the world coordinates of the column, in chunks.
+    */
+  int chunkX() const {
+    return chunk_x_;
+  }
+  int chunkZ() const {
+    return chunk_z_;
+  }
+
+  const QByteArray& compressedData() const {
+    return compressed_data_;
+  }
+
+  const RegionImport& import() const {
+    return *import_;
+  }
+
+ private:
+  int chunk_x_;
+  int chunk_z_;
+  QByteArray compressed_data_;
+  const RegionImport* import_;
+};
+
+/**
+  * Decompresses \p compressed, which may be either a gzip or a zlib stream, into \p inflated.
+  * @return Whether the whole stream was decompressed.
+  */
+static bool inflateChunk(const QByteArray& compressed, QByteArray* inflated) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // Adding 32 to the window size makes zlib detect gzip (compression type 1) and zlib (type 2) streams alike.
+  if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+    return false;
+  }
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.constData()));
+  stream.avail_in = compressed.size();
+  inflated->resize(qMax(compressed.size() * 4, kSectorSize));
+  int status = Z_OK;
+  while (status == Z_OK) {
+    if (static_cast<int>(stream.total_out) == inflated->size()) {
+      if (inflated->size() >= kMaximumChunkSize) {
+        break;
+      }
+      inflated->resize(inflated->size() * 2);
+    }
+    stream.next_out = reinterpret_cast<Bytef*>(inflated->data()) + stream.total_out;
+    stream.avail_out = inflated->size() - stream.total_out;
+    status = inflate(&stream, Z_NO_FLUSH);
+  }
+  inflated->resize(stream.total_out);
+  inflateEnd(&stream);
+  return status == Z_STREAM_END;
+}
+
+/**
+  * Converts the 16 levels starting at world height \p section_y of the chunk column of \p job into layers, appending
+  * those holding any blocks inside the box to \p layers.  The block at (_x_, _y_, _z_) within the section is at
+  * \p base + _x_ * \p x_stride + _y_ * \p y_stride + _z_ * \p z_stride in \p blocks, and in the nibble arrays \p add
+  * (which may be empty) and \p data.  The callers check that the arrays are large enough.
+  */
+static void addSectionLayers(const RegionChunkJob& job, int section_y, const QByteArray& blocks,
+                             const QByteArray& add, const QByteArray& data,
+                             int base, int x_stride, int y_stride, int z_stride, QList<BlockClipboard::Layer>* layers) {
+  const RegionImport& import = job.import();
+  const BlockPosition& minimum = import.minimum();
+  const BlockPosition& maximum = import.maximum();
+  int world_x = job.chunkX() * kChunkSize;
+  int world_z = job.chunkZ() * kChunkSize;
+  int first_x = qMax(minimum.x(), world_x) - world_x;
+  int last_x = qMin(maximum.x(), world_x + kChunkMask) - world_x;
+  int first_z = qMax(minimum.z(), world_z) - world_z;
+  int last_z = qMin(maximum.z(), world_z + kChunkMask) - world_z;
+  if (first_x > last_x || first_z > last_z) {
+    return;
+  }
+  // The box needn't line up with chunks, so the column may straddle two clipboard chunks along each of x and z.
+  int first_chunk_x = (world_x + first_x - minimum.x()) >> kChunkShift;
+  int first_chunk_z = (world_z + first_z - minimum.z()) >> kChunkShift;
+  const uchar* block_bytes = reinterpret_cast<const uchar*>(blocks.constData());
+  const uchar* add_bytes = add.isEmpty() ? NULL : reinterpret_cast<const uchar*>(add.constData());
+  const uchar* data_bytes = reinterpret_cast<const uchar*>(data.constData());
+  for (int y = qMax(minimum.y() - section_y, 0); y <= qMin(maximum.y() - section_y, kChunkMask); ++y) {
+    ChunkLayer destinations[4];
+    for (int z = first_z; z <= last_z; ++z) {
+      int clipboard_z = world_z + z - minimum.z();
+      for (int x = first_x; x <= last_x; ++x) {
+        int index = base + x * x_stride + y * y_stride + z * z_stride;
+        // Minecraft's nibble arrays keep the even cells in the low nibbles.
+        int shift = (index & 1) ? 4 : 0;
+        int id = block_bytes[index];
+        if (add_bytes) {
+          id |= ((add_bytes[index >> 1] >> shift) & 0xF) << 8;
+        }
+        if (!id) {
+          continue;
+        }
+        BlockPrototype* prototype = import.prototype(id, (data_bytes[index >> 1] >> shift) & 0xF);
+        if (!prototype) {
+          continue;
+        }
+        int clipboard_x = world_x + x - minimum.x();
+        int destination = ((clipboard_x >> kChunkShift) - first_chunk_x) +
+                          2 * ((clipboard_z >> kChunkShift) - first_chunk_z);
+        destinations[destination].setBlock(ChunkLayer::cellIndex(clipboard_x & kChunkMask, clipboard_z & kChunkMask),
+                                           prototype, prototype->defaultOrientation());
+      }
+    }
+    int clipboard_y = section_y + y - minimum.y();
+    for (int i = 0; i < 4; ++i) {
+      if (!destinations[i].isEmpty()) {
+        ChunkPosition chunk_position(first_chunk_x + (i & 1), clipboard_y >> kChunkShift, first_chunk_z + (i >> 1));
+        layers->append(BlockClipboard::Layer(chunk_position, clipboard_y & kChunkMask, destinations[i]));
+      }
+    }
+  }
+}
+
+/**
+  * Reads the payload of an Anvil section compound from \p reader and converts it into layers.
+  */
+static void readSection(NbtReader* reader, const RegionChunkJob& job, QList<BlockClipboard::Layer>* layers) {
+  bool has_y = false;
+  int section_y = 0;
+  QByteArray blocks;
+  QByteArray add;
+  QByteArray data;
+  for (int type = reader->readByte(); reader->ok() && type != kTagEnd; type = reader->readByte()) {
+    QString name = reader->readString();
+    if (type == kTagByte && name == "Y") {
+      section_y = static_cast<qint8>(reader->readByte());
+      has_y = true;
+    } else if (type == kTagByteArray && name == "Blocks") {
+      blocks = reader->readByteArray();
+    } else if (type == kTagByteArray && name == "Add") {
+      add = reader->readByteArray();
+    } else if (type == kTagByteArray && name == "Data") {
+      data = reader->readByteArray();
+    } else {
+      reader->skipPayload(type, 3);
+    }
+  }
+  if (!reader->ok() || !has_y || blocks.size() != kSectionVolume || data.size() != kSectionVolume / 2 ||
+      (!add.isEmpty() && add.size() != kSectionVolume / 2)) {
+    return;
+  }
+  addSectionLayers(job, section_y * kChunkSize, blocks, add, data,
+                   0, 1, kChunkSize * kChunkSize, kChunkSize, layers);
+}
+
+/**
+  * Decompresses and parses the chunk column of \p job, and converts the parts of it inside the box into layers.  Anvil
+  * columns are split into sections of 16 levels, which are converted as they are read; MCRegion columns hold one array
+  * for the whole column, which is converted 16 levels at a time once it has been read.
+  */
+static QList<BlockClipboard::Layer> decodeRegionChunk(const RegionChunkJob& job) {
+  QList<BlockClipboard::Layer> layers;
+  QByteArray nbt;
+  if (!inflateChunk(job.compressedData(), &nbt)) {
+    qWarning() << "Skipping chunk" << job.chunkX() << job.chunkZ() << "because it could not be decompressed";
+    return layers;
+  }
+  NbtReader reader(nbt);
+  if (reader.readByte() != kTagCompound) {
+    qWarning() << "Skipping chunk" << job.chunkX() << job.chunkZ() << "because it is not a compound tag";
+    return layers;
+  }
+  reader.readString();
+  QByteArray blocks;
+  QByteArray data;
+  for (int type = reader.readByte(); reader.ok() && type != kTagEnd; type = reader.readByte()) {
+    QString name = reader.readString();
+    if (type != kTagCompound || name != "Level") {
+      reader.skipPayload(type, 1);
+      continue;
+    }
+    for (int level_type = reader.readByte(); reader.ok() && level_type != kTagEnd; level_type = reader.readByte()) {
+      QString level_name = reader.readString();
+      if (level_type == kTagList && level_name == "Sections") {
+        int element_type = reader.readByte();
+        qint32 count = reader.readInt();
+        for (qint32 i = 0; reader.ok() && i < count; ++i) {
+          if (element_type == kTagCompound) {
+            readSection(&reader, job, &layers);
+          } else {
+            reader.skipPayload(element_type, 3);
+          }
+        }
+      } else if (level_type == kTagByteArray && level_name == "Blocks") {
+        blocks = reader.readByteArray();
+      } else if (level_type == kTagByteArray && level_name == "Data") {
+        data = reader.readByteArray();
+      } else {
+        reader.skipPayload(level_type, 2);
+      }
+    }
+  }
+  if (!reader.ok()) {
+    qWarning() << "Skipping chunk" << job.chunkX() << job.chunkZ() << "because it is damaged";
+    layers.clear();
+    return layers;
+  }
+  if (blocks.size() == kMcRegionColumnVolume && data.size() == kMcRegionColumnVolume / 2) {
+    for (int section_y = 0; section_y < kMcRegionHeight; section_y += kChunkSize) {
+      addSectionLayers(job, section_y, blocks, QByteArray(), data,
+                       section_y, kChunkSize * kMcRegionHeight, 1, kMcRegionHeight, &layers);
+    }
+  }
+  return layers;
+}
+
+// Static.
+bool RegionFile::regionCoordinates(const QString& filename, int* region_x, int* region_z) {
+  QRegExp pattern("r\\.(-?\\d+)\\.(-?\\d+)\\.mc[ar]");
+  if (!pattern.exactMatch(QFileInfo(filename).fileName())) {
+    return false;
+  }
+  *region_x = pattern.cap(1).toInt();
+  *region_z = pattern.cap(2).toInt();
+  return true;
+}
+
+// Static.
+bool RegionFile::read(const QString& filename, const BlockPosition& corner, const BlockPosition& opposite_corner,
+                      BlockManager* block_mgr, BlockClipboard* clipboard, QString* error) {
+  int region_x = 0;
+  int region_z = 0;
+  if (!regionCoordinates(filename, &region_x, &region_z)) {
+    *error = "Region files must keep the names Minecraft gave them, like r.0.0.mca, which say where the region is.";
+    return false;
+  }
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    *error = "The file could not be opened.";
+    return false;
+  }
+  QByteArray offsets = file.read(kSectorSize);
+  if (offsets.size() != kSectorSize) {
+    *error = "The file is not a region file.";
+    return false;
+  }
+
+  // The prototypes are all looked up up front, since BlockManager can't be used from the thread pool.
+  QVector<BlockPrototype*> prototypes(kMinecraftBlockKeyCount);
+  for (int key = 0; key < kMinecraftBlockKeyCount; ++key) {
+    prototypes[key] = block_mgr->getPrototypeForMinecraftBlock(key >> 4, key & 0xF);
+  }
+  BlockPosition minimum(qMin(corner.x(), opposite_corner.x()),
+                        qMin(corner.y(), opposite_corner.y()),
+                        qMin(corner.z(), opposite_corner.z()));
+  BlockPosition maximum(qMax(corner.x(), opposite_corner.x()),
+                        qMax(corner.y(), opposite_corner.y()),
+                        qMax(corner.z(), opposite_corner.z()));
+  RegionImport import(minimum, maximum, prototypes);
+
+  // Only the columns overlapping the box are read, each as the sectors the offset table points at.
+  QList<RegionChunkJob> jobs;
+  for (int local_z = 0; local_z < kRegionSize; ++local_z) {
+    for (int local_x = 0; local_x < kRegionSize; ++local_x) {
+      int chunk_x = region_x * kRegionSize + local_x;
+      int chunk_z = region_z * kRegionSize + local_z;
+      if (chunk_x * kChunkSize > maximum.x() || chunk_x * kChunkSize + kChunkMask < minimum.x() ||
+          chunk_z * kChunkSize > maximum.z() || chunk_z * kChunkSize + kChunkMask < minimum.z()) {
+        continue;
+      }
+      const uchar* entry = reinterpret_cast<const uchar*>(offsets.constData()) + 4 * (local_z * kRegionSize + local_x);
+      quint32 location = qFromBigEndian<quint32>(entry);
+      qint64 offset = static_cast<qint64>(location >> 8) * kSectorSize;
+      int sector_count = location & 0xFF;
+      if (!offset || !sector_count || !file.seek(offset)) {
+        continue;
+      }
+      QByteArray header = file.read(5);
+      if (header.size() != 5) {
+        continue;
+      }
+      qint32 length = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(header.constData()));
+      if (length <= 1 || length > sector_count * kSectorSize) {
+        qWarning() << "Skipping chunk" << chunk_x << chunk_z << "because its length is out of range";
+        continue;
+      }
+      // The length includes the byte giving the compression type, which inflateChunk() works out for itself.
+      QByteArray compressed_data = file.read(length - 1);
+      if (compressed_data.size() == length - 1) {
+        jobs.append(RegionChunkJob(chunk_x, chunk_z, compressed_data, &import));
+      }
+    }
+  }
+  file.close();
+  if (jobs.isEmpty()) {
+    *error = "The region file has no chunks inside that box.";
+    return false;
+  }
+
+  QList<QList<BlockClipboard::Layer> > results =
+      QtConcurrent::blockingMapped<QList<QList<BlockClipboard::Layer> > >(jobs, decodeRegionChunk);
+  BlockClipboard result(maximum.x() - minimum.x() + 1, maximum.y() - minimum.y() + 1, maximum.z() - minimum.z() + 1);
+  foreach (const QList<BlockClipboard::Layer>& layers, results) {
+    foreach (const BlockClipboard::Layer& imported, layers) {
+      ChunkLayer existing = result.chunks().value(imported.chunkPosition()).layer(imported.y());
+      if (existing.isEmpty()) {
+        result.setLayer(imported.chunkPosition(), imported.y(), imported.layer());
+        continue;
+      }
+      // Where the box doesn't line up with chunks, neighbouring columns fill in different cells of the same layer.
+      ChunkLayer merged = existing;
+      for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+        BlockPrototype* prototype = imported.layer().prototypeAt(cell);
+        if (prototype) {
+          merged.setBlock(cell, prototype, imported.layer().orientationAt(cell));
+        }
+      }
+      result.setLayer(imported.chunkPosition(), imported.y(), merged);
+    }
+  }
+  *clipboard = result;
+  return true;
+}
@@ -0,0 +1,57 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef REGION_FILE_H
+#define REGION_FILE_H
+
+#include <QString>
+
+class BlockClipboard;
+class BlockManager;
+class BlockPosition;
+
+/**
+  * Reads blocks out of the region files Minecraft saves worlds in, so that builds made in the game can be brought into
+  * a diagram.  Both the Anvil format (.mca) and the older MCRegion format (.mcr) are understood, though not the
+  * block palettes Minecraft switched to later.
+  *
+  * A region file holds up to 32 x 32 chunk columns, each compressed separately and found through a table of sector
+  * offsets at the start of the file.  Only the columns overlapping the box being imported are read from disk, and they
+  * are decompressed and converted into chunk layers in parallel on the global thread pool.  Block IDs and data values
+  * are mapped to block types by BlockManager::getPrototypeForMinecraftBlock(), and blocks MCModeler doesn't know of
+  * are left out.
+  */
+class RegionFile {
+ public:
+  /**
+    * Finds the coordinates of the region held by the file at \p filename from its name, which Minecraft always makes
+    * r.<x>.<z>.mca or r.<x>.<z>.mcr.  The region covers the 512 x 512 column of blocks starting at _x_ * 512,
+    * _z_ * 512.
+    * @return Whether \p filename has the name of a region file.
+    */
+  static bool regionCoordinates(const QString& filename, int* region_x, int* region_z);
+
+  /**
+    * Reads the blocks inside the box between \p corner and \p opposite_corner, in world coordinates, from the region
+    * file at \p filename into \p clipboard, using \p block_mgr to look up block prototypes.
+    * @return Whether the blocks were read successfully.  If not, \p error is set to a description of the problem and
+    *     \p clipboard is left alone.  Chunks that are damaged are skipped with a warning rather than failing the whole
+    *     import.
+    */
+  static bool read(const QString& filename, const BlockPosition& corner, const BlockPosition& opposite_corner,
+                   BlockManager* block_mgr, BlockClipboard* clipboard, QString* error);
+};
+
+#endif // REGION_FILE_H
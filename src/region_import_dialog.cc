@@ -0,0 +1,44 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "region_import_dialog.h"
+
+/**
+  * The number of blocks along each side of a region.
+  */
+static const int kRegionBlockSize = 512;
+
+/**
+  * The highest level Minecraft builds on.
+  */
+static const int kTopLevel = 255;
+
+RegionImportDialog::RegionImportDialog(int region_x, int region_z, QWidget* parent) : QDialog(parent) {
+  ui.setupUi(this);
+  ui.from_x_spin_box_->setValue(region_x * kRegionBlockSize);
+  ui.from_z_spin_box_->setValue(region_z * kRegionBlockSize);
+  ui.from_y_spin_box_->setValue(0);
+  ui.to_x_spin_box_->setValue((region_x + 1) * kRegionBlockSize - 1);
+  ui.to_z_spin_box_->setValue((region_z + 1) * kRegionBlockSize - 1);
+  ui.to_y_spin_box_->setValue(kTopLevel);
+}
+
+BlockPosition RegionImportDialog::corner() const {
+  return BlockPosition(ui.from_x_spin_box_->value(), ui.from_y_spin_box_->value(), ui.from_z_spin_box_->value());
+}
+
+BlockPosition RegionImportDialog::oppositeCorner() const {
+  return BlockPosition(ui.to_x_spin_box_->value(), ui.to_y_spin_box_->value(), ui.to_z_spin_box_->value());
+}
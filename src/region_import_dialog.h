@@ -0,0 +1,50 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef REGION_IMPORT_DIALOG_H
+#define REGION_IMPORT_DIALOG_H
+
+#include "block_position.h"
+#include "ui_region_import_dialog.h"
+
+/**
+  * The dialog that asks which box of blocks to import from a Minecraft region file (see RegionFile).  Only the chunks
+  * overlapping the box are read, so importing a small build out of a big region is quick.
+  */
+class RegionImportDialog : public QDialog {
+  Q_OBJECT
+
+ public:
+  /**
+    * Constructs a dialog for importing from the region at \p region_x, \p region_z (see
+    * RegionFile::regionCoordinates()).  The box starts out covering the whole region.
+    */
+  RegionImportDialog(int region_x, int region_z, QWidget* parent = NULL);
+
+  /**
+    * Returns the corner of the box at its west, north and bottom edges, in world coordinates.
+    */
+  BlockPosition corner() const;
+
+  /**
+    * Returns the corner of the box at its east, south and top edges, in world coordinates.
+    */
+  BlockPosition oppositeCorner() const;
+
+ private:
+  Ui::RegionImportDialog ui;
+};
+
+#endif // REGION_IMPORT_DIALOG_H
@@ -34,6 +34,13 @@ class RenderDelegate {
     */
   virtual bool shouldRenderFace(const Renderable* renderable, Face face, const QVector3D& location) const = 0;
 
+  /**
+    * Returns whether \p renderable should export a \p face at \p location.  Unlike shouldRenderFace(), this only looks
+    * at the physical blocks of the world, in world orientation, so exported meshes do not depend on what the 3D view
+    * is showing at the time.
+    */
+  virtual bool shouldExportFace(const Renderable* renderable, Face face, const QVector3D& location) const = 0;
+
   /**
     * Returns a vector of valid orientations for this block.  The default orientation will be the first element in the
     * vector.
@@ -23,6 +23,10 @@ void Renderable::initialize() {
   // Base class has no special initialization.
 }
 
+void Renderable::addToMesh(const QVector3D& location, const BlockOrientation* orientation, MeshBuilder* mesh) const {
+  // Base class has no geometry to export.
+}
+
 Texture Renderable::texture(int local_id) const {
   if (local_id < textures_.size()) {
     return textures_[local_id];
@@ -25,6 +25,7 @@
 #include "texture.h"
 
 class BlockOrientation;
+class MeshBuilder;
 class RenderDelegate;
 
 /**
@@ -73,6 +74,15 @@ class Renderable {
     */
   virtual void renderAt(const QVector3D& location, const BlockOrientation* orientation) const = 0;
 
+  /**
+    * Adds the geometry renderAt() would draw at \p location with \p orientation to \p mesh, without touching OpenGL,
+    * so that it can be exported to other programs.  Faces hidden by the physical blocks next to them are left out,
+    * whatever the 3D view is showing (see RenderDelegate::shouldExportFace()).  The default implementation adds
+    * nothing.
+    * @warning You must call initialize() before calling this method.
+    */
+  virtual void addToMesh(const QVector3D& location, const BlockOrientation* orientation, MeshBuilder* mesh) const;
+
   /**
     * Returns true if initialize() has been called on this Renderable.
     */
@@ -0,0 +1,305 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "schematic_file.h"
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QFile>
+#include <QVector>
+
+#include <limits.h>
+
+#include "block_clipboard.h"
+#include "block_manager.h"
+#include "block_prototype.h"
+#include "chunk.h"
+#include "chunk_position.h"
+#include "nbt.h"
+
+/**
+  * The largest size of a schematic along any axis, since sizes are stored as shorts.
+  */
+static const int kMaximumSchematicSize = 32767;
+
+/**
+  * The number of distinct (block ID, data value) pairs a schematic can hold: 12-bit IDs (8 bits from Blocks and 4 from
+  * AddBlocks) and 4-bit data values.
+  */
+static const int kSchematicBlockKeyCount = 1 << 16;
+
+/**
+  * The size of the buffers zlib uses for schematic files.
+  */
+static const int kGzipBufferSize = 1 << 20;
+
+/**
+  * Decodes the \p blocks, \p data and (if not empty) \p add_blocks arrays of a schematic of \p width x \p height x
+  * \p length blocks into \p clipboard, one level at a time.  Each level is built up as a row of chunk layers, which are
+  * then handed to the clipboard whole.  Prototypes are looked up once per distinct ID and data value.
+  */
+static void decodeBlocks(int width, int height, int length,
+                         const QByteArray& blocks, const QByteArray& data, const QByteArray& add_blocks,
+                         BlockManager* block_mgr, BlockClipboard* clipboard) {
+  QVector<BlockPrototype*> prototypes(kSchematicBlockKeyCount);
+  QBitArray looked_up(kSchematicBlockKeyCount);
+  int chunks_x = (width + kChunkMask) >> kChunkShift;
+  int chunks_z = (length + kChunkMask) >> kChunkShift;
+  QVector<ChunkLayer> layers(chunks_x * chunks_z);
+  const uchar* block_bytes = reinterpret_cast<const uchar*>(blocks.constData());
+  const uchar* data_bytes = reinterpret_cast<const uchar*>(data.constData());
+  const uchar* add_bytes = reinterpret_cast<const uchar*>(add_blocks.constData());
+  for (int y = 0; y < height; ++y) {
+    layers.fill(ChunkLayer());
+    for (int z = 0; z < length; ++z) {
+      int index = (y * length + z) * width;
+      for (int x = 0; x < width; ++x, ++index) {
+        int id = block_bytes[index];
+        if (add_bytes) {
+          // Unlike Minecraft's own nibble arrays, AddBlocks keeps the even cells in the high nibbles.
+          id |= ((add_bytes[index >> 1] >> ((index & 1) ? 0 : 4)) & 0xF) << 8;
+        }
+        if (!id) {
+          continue;
+        }
+        int key = (id << 4) | (data_bytes[index] & 0xF);
+        if (!looked_up.testBit(key)) {
+          prototypes[key] = block_mgr->getPrototypeForMinecraftBlock(id, data_bytes[index] & 0xF);
+          looked_up.setBit(key);
+        }
+        BlockPrototype* prototype = prototypes.at(key);
+        if (prototype) {
+          layers[(z >> kChunkShift) * chunks_x + (x >> kChunkShift)].setBlock(
+                ChunkLayer::cellIndex(x & kChunkMask, z & kChunkMask), prototype, prototype->defaultOrientation());
+        }
+      }
+    }
+    for (int i = 0; i < layers.size(); ++i) {
+      if (!layers.at(i).isEmpty()) {
+        clipboard->setLayer(ChunkPosition(i % chunks_x, y >> kChunkShift, i / chunks_x), y & kChunkMask, layers.at(i));
+      }
+    }
+  }
+}
+
+/**
+  * Fills \p types with the type of each block on level \p y of \p clipboard, in schematic order (_z_, then _x_), with
+  * air as kBlockTypeAir.
+  */
+static void typesOnLevel(const BlockClipboard& clipboard, int y, QVector<blocktype_t>* types) {
+  types->fill(kBlockTypeAir, clipboard.width() * clipboard.depth());
+  for (int chunk_z = 0; chunk_z <= (clipboard.depth() - 1) >> kChunkShift; ++chunk_z) {
+    for (int chunk_x = 0; chunk_x <= (clipboard.width() - 1) >> kChunkShift; ++chunk_x) {
+      QHash<ChunkPosition, Chunk>::const_iterator chunk =
+          clipboard.chunks().constFind(ChunkPosition(chunk_x, y >> kChunkShift, chunk_z));
+      if (chunk == clipboard.chunks().constEnd() || chunk.value().layer(y & kChunkMask).isEmpty()) {
+        continue;
+      }
+      const ChunkLayer& layer = chunk.value().layer(y & kChunkMask);
+      int last_z = qMin(kChunkSize, clipboard.depth() - (chunk_z << kChunkShift));
+      int last_x = qMin(kChunkSize, clipboard.width() - (chunk_x << kChunkShift));
+      for (int z = 0; z < last_z; ++z) {
+        int index = ((chunk_z << kChunkShift) + z) * clipboard.width() + (chunk_x << kChunkShift);
+        for (int x = 0; x < last_x; ++x) {
+          BlockPrototype* prototype = layer.prototypeAt(ChunkLayer::cellIndex(x, z));
+          if (prototype) {
+            (*types)[index + x] = prototype->type();
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+  * Returns the Minecraft block ID for \p type, including the bits that go in AddBlocks.
+  */
+static int schematicBlockId(blocktype_t type) {
+  return type == kBlockTypeAir ? 0 : (type & 0xFFF);
+}
+
+/**
+  * Returns the Minecraft data value for \p type.
+  */
+static int schematicBlockData(blocktype_t type) {
+  return type == kBlockTypeAir ? 0 : ((type >> 16) & 0xF);
+}
+
+// Static.
+bool SchematicFile::read(const QString& filename, BlockManager* block_mgr, BlockClipboard* clipboard, QString* error) {
+  gzFile file = gzopen(QFile::encodeName(filename).constData(), "rb");
+  if (!file) {
+    *error = "The file could not be opened.";
+    return false;
+  }
+  gzbuffer(file, kGzipBufferSize);
+  NbtReader reader(file);
+  int width = 0;
+  int height = 0;
+  int length = 0;
+  QString materials;
+  QByteArray blocks;
+  QByteArray data;
+  QByteArray add_blocks;
+  if (reader.readByte() != kTagCompound) {
+    gzclose(file);
+    *error = "The file is not a schematic.";
+    return false;
+  }
+  reader.readString();
+  for (int type = reader.readByte(); reader.ok() && type != kTagEnd; type = reader.readByte()) {
+    QString name = reader.readString();
+    if (type == kTagShort && name == "Width") {
+      width = reader.readShort();
+    } else if (type == kTagShort && name == "Height") {
+      height = reader.readShort();
+    } else if (type == kTagShort && name == "Length") {
+      length = reader.readShort();
+    } else if (type == kTagString && name == "Materials") {
+      materials = reader.readString();
+    } else if (type == kTagByteArray && name == "Blocks") {
+      blocks = reader.readByteArray();
+    } else if (type == kTagByteArray && name == "Data") {
+      data = reader.readByteArray();
+    } else if (type == kTagByteArray && name == "AddBlocks") {
+      add_blocks = reader.readByteArray();
+    } else {
+      reader.skipPayload(type, 1);
+    }
+  }
+  bool ok = reader.ok();
+  gzclose(file);
+  if (!ok) {
+    *error = "The file is damaged or is not a schematic.";
+    return false;
+  }
+  qint64 cell_count = static_cast<qint64>(width) * height * length;
+  if (width <= 0 || height <= 0 || length <= 0 || blocks.size() != cell_count || data.size() != cell_count ||
+      (!add_blocks.isEmpty() && add_blocks.size() < (cell_count + 1) / 2)) {
+    *error = "The schematic is damaged: its size doesn't match the amount of block data in it.";
+    return false;
+  }
+  if (!materials.isEmpty() && materials != "Alpha") {
+    qWarning() << "Reading a schematic with" << materials << "materials as if they were Alpha materials";
+  }
+
+  BlockClipboard result(width, height, length);
+  decodeBlocks(width, height, length, blocks, data, add_blocks, block_mgr, &result);
+  *clipboard = result;
+  return true;
+}
+
+// Static.
+bool SchematicFile::write(const QString& filename, const BlockClipboard& clipboard, QString* error) {
+  if (clipboard.isEmpty()) {
+    *error = "There is nothing to export.";
+    return false;
+  }
+  if (clipboard.width() > kMaximumSchematicSize || clipboard.height() > kMaximumSchematicSize ||
+      clipboard.depth() > kMaximumSchematicSize) {
+    *error = QString("Schematics can't be larger than %1 blocks in any direction.").arg(kMaximumSchematicSize);
+    return false;
+  }
+  if (static_cast<qint64>(clipboard.width()) * clipboard.height() * clipboard.depth() > INT_MAX) {
+    *error = "The selection holds too many blocks for a schematic.";
+    return false;
+  }
+
+  // AddBlocks is only written if some block needs it, which the palettes can tell us without looking at any cells.
+  bool needs_add_blocks = false;
+  for (QHash<ChunkPosition, Chunk>::const_iterator iter = clipboard.chunks().constBegin();
+       iter != clipboard.chunks().constEnd() && !needs_add_blocks; ++iter) {
+    for (int y = 0; y < kChunkSize; ++y) {
+      foreach (const ChunkLayer::PaletteEntry& entry, iter.value().layer(y).palette()) {
+        if (entry.count() && schematicBlockId(entry.prototype()->type()) > 0xFF) {
+          needs_add_blocks = true;
+        }
+      }
+    }
+  }
+
+  gzFile file = gzopen(QFile::encodeName(filename).constData(), "wb");
+  if (!file) {
+    *error = "The file could not be created.";
+    return false;
+  }
+  gzbuffer(file, kGzipBufferSize);
+  NbtWriter writer(file);
+  writer.writeTagHeader(kTagCompound, "Schematic");
+  writer.writeTagHeader(kTagShort, "Width");
+  writer.writeShort(clipboard.width());
+  writer.writeTagHeader(kTagShort, "Height");
+  writer.writeShort(clipboard.height());
+  writer.writeTagHeader(kTagShort, "Length");
+  writer.writeShort(clipboard.depth());
+  writer.writeTagHeader(kTagString, "Materials");
+  writer.writeString("Alpha");
+
+  // Each array is written a level at a time.  The arrays are in schematic order, which is also the order of levels.
+  qint32 cell_count = clipboard.width() * clipboard.height() * clipboard.depth();
+  int level_size = clipboard.width() * clipboard.depth();
+  QVector<blocktype_t> types;
+  QByteArray bytes;
+  QStringList array_names = QStringList() << "Blocks" << "Data";
+  if (needs_add_blocks) {
+    array_names << "AddBlocks";
+  }
+  foreach (const QString& array_name, array_names) {
+    bool add_blocks = (array_name == "AddBlocks");
+    writer.writeTagHeader(kTagByteArray, array_name);
+    writer.writeInt(add_blocks ? (cell_count + 1) / 2 : cell_count);
+    // AddBlocks packs two cells into each byte, and a level may hold an odd number of cells, so the high nibble of
+    // the last byte of a level may have to wait for the next level.
+    int pending_nibble = -1;
+    for (int y = 0; y < clipboard.height() && writer.ok(); ++y) {
+      typesOnLevel(clipboard, y, &types);
+      bytes.resize(0);
+      for (int i = 0; i < level_size; ++i) {
+        if (array_name == "Blocks") {
+          bytes.append(static_cast<char>(schematicBlockId(types.at(i)) & 0xFF));
+        } else if (array_name == "Data") {
+          bytes.append(static_cast<char>(schematicBlockData(types.at(i))));
+        } else if (pending_nibble < 0) {
+          pending_nibble = schematicBlockId(types.at(i)) >> 8;
+        } else {
+          bytes.append(static_cast<char>((pending_nibble << 4) | (schematicBlockId(types.at(i)) >> 8)));
+          pending_nibble = -1;
+        }
+      }
+      writer.writeRaw(bytes.constData(), bytes.size());
+    }
+    if (pending_nibble >= 0) {
+      writer.writeByte(pending_nibble << 4);
+    }
+  }
+
+  // Schematics are expected to have entity lists, even though MCModeler has no entities to put in them.
+  writer.writeTagHeader(kTagList, "Entities");
+  writer.writeByte(kTagCompound);
+  writer.writeInt(0);
+  writer.writeTagHeader(kTagList, "TileEntities");
+  writer.writeByte(kTagCompound);
+  writer.writeInt(0);
+  writer.writeByte(kTagEnd);
+
+  bool ok = writer.ok();
+  if (gzclose(file) != Z_OK) {
+    ok = false;
+  }
+  if (!ok) {
+    *error = "The file could not be written.";
+  }
+  return ok;
+}
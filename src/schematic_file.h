@@ -0,0 +1,57 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SCHEMATIC_FILE_H
+#define SCHEMATIC_FILE_H
+
+#include <QString>
+
+class BlockClipboard;
+class BlockManager;
+
+/**
+  * Reads and writes the .schematic files used by MCEdit, WorldEdit and friends, so that designs can be handed back and
+  * forth with in-game tools.
+  *
+  * A schematic is a gzipped NBT compound holding the size of a box of blocks and two byte arrays, Blocks and Data,
+  * with one entry per cell in the order _y_, then _z_, then _x_.  Block IDs above 255 keep their top four bits in an
+  * optional AddBlocks array of nibbles.  Each ID and data value is mapped to the blocktype_t with the ID in its bottom
+  * 16 bits and the data value in the next four if MCModeler knows that type, or else to the type with just the ID,
+  * in its default orientation.  Anything else is left out.  When writing, the reverse mapping is used, and the
+  * MCModeler-specific bits of each type and the orientations of blocks are dropped, since schematics have no room for
+  * them.
+  *
+  * Everything else in the file, such as entities and tile entities, is skipped on reading and written out empty.
+  */
+class SchematicFile {
+ public:
+  /**
+    * Reads the schematic at \p filename into \p clipboard, using \p block_mgr to look up block prototypes.  The byte
+    * arrays are decompressed in bulk, then decoded a level at a time straight into chunk layers, so no per-block
+    * objects are ever created.
+    * @return Whether the file was read successfully.  If not, \p error is set to a description of the problem and
+    *     \p clipboard is left alone.
+    */
+  static bool read(const QString& filename, BlockManager* block_mgr, BlockClipboard* clipboard, QString* error);
+
+  /**
+    * Writes the blocks in \p clipboard to a schematic at \p filename.  The byte arrays are encoded and compressed a
+    * level at a time, so memory use doesn't grow with the size of the box.
+    * @return Whether the file was written successfully.  If not, \p error is set to a description of the problem.
+    */
+  static bool write(const QString& filename, const BlockClipboard& clipboard, QString* error);
+};
+
+#endif // SCHEMATIC_FILE_H
@@ -0,0 +1,47 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "selection_tool.h"
+
+#include "block_position.h"
+
+SelectionTool::SelectionTool() {}
+
+QString SelectionTool::actionName() const {
+  return "Select";
+}
+
+bool SelectionTool::wantsMorePositions() {
+  return countPositions() < 2;
+}
+
+bool SelectionTool::isBrush() const {
+  return false;
+}
+
+void SelectionTool::draw(BlockPrototype* /* prototype */,
+                         const BlockOrientation* /* orientation */,
+                         BlockTransaction* /* transaction */) {
+  // Selecting doesn't change the diagram.
+}
+
+bool SelectionTool::selectedBox(BlockPosition* corner, BlockPosition* opposite_corner) const {
+  if (countPositions() == 0) {
+    return false;
+  }
+  *corner = positionAtIndex(0);
+  *opposite_corner = positionAtIndex(countPositions() - 1);
+  return true;
+}
@@ -0,0 +1,44 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SELECTION_TOOL_H
+#define SELECTION_TOOL_H
+
+#include "tool.h"
+
+/**
+  * A Tool that picks out a box of blocks between two corners rather than drawing anything.  The corners may be chosen
+  * on different levels, so the box can span as many levels as you like.
+  *
+  * draw() leaves the transaction empty.  Instead, views ask for the box with selectedBox() once the tool has all its
+  * positions, and use it for the clipboard (see Diagram::copyRegion()).
+  */
+class SelectionTool : public Tool {
+ public:
+  SelectionTool();
+  virtual QString actionName() const;
+  virtual bool wantsMorePositions();
+  virtual bool isBrush() const;
+  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
+
+  /**
+    * Stores the opposite corners of the box the tool currently describes in \p corner and \p opposite_corner.  While
+    * only the first corner has been chosen, both receive it.
+    * @returns \c false, leaving the corners alone, if the tool has no positions yet.
+    */
+  bool selectedBox(BlockPosition* corner, BlockPosition* opposite_corner) const;
+};
+
+#endif // SELECTION_TOOL_H
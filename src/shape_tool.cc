@@ -0,0 +1,52 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shape_tool.h"
+
+#include "block_transaction.h"
+#include "diagram.h"
+
+ShapeTool::ShapeTool(Diagram* diagram) : diagram_(diagram) {}
+
+ShapeTool::~ShapeTool() {}
+
+void ShapeTool::draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
+  SpanMask mask;
+  rasterize(&mask);
+  diagram_->fillSpans(mask, prototype, orientation, transaction);
+}
+
+bool ShapeTool::drawPreview(BlockPrototype* prototype,
+                            const BlockOrientation* orientation,
+                            BlockTransaction* retracted,
+                            BlockTransaction* transaction) {
+  SpanMask mask;
+  rasterize(&mask);
+  bool is_incremental = continuePreview(prototype, orientation);
+  if (is_incremental) {
+    // Only the cells that left or entered the shape need to be looked at.
+    diagram_->fillSpans(preview_mask_.subtracted(mask), prototype, orientation, retracted);
+    diagram_->fillSpans(mask.subtracted(preview_mask_), prototype, orientation, transaction);
+  } else {
+    diagram_->fillSpans(mask, prototype, orientation, transaction);
+  }
+  preview_mask_ = mask;
+  return is_incremental;
+}
+
+void ShapeTool::resetPreview() {
+  Tool::resetPreview();
+  preview_mask_.clear();
+}
@@ -0,0 +1,58 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SHAPE_TOOL_H
+#define SHAPE_TOOL_H
+
+#include "span_mask.h"
+#include "tool.h"
+
+class Diagram;
+
+/**
+  * A Tool that draws a shape determined entirely by its positions, such as a line or a rectangle.
+  *
+  * Subclasses only need to implement rasterize(), which adds the cells of the shape to a SpanMask.  ShapeTool turns
+  * the mask into a transaction using Diagram::fillSpans(), and implements drawPreview() by subtracting successive masks
+  * from each other, so that previewing a large shape as the mouse moves costs time in proportion to the number of rows
+  * in the shape plus the number of cells that actually changed.
+  */
+class ShapeTool : public Tool {
+ public:
+  explicit ShapeTool(Diagram* diagram);
+  virtual ~ShapeTool();
+
+  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
+  virtual bool drawPreview(BlockPrototype* prototype,
+                           const BlockOrientation* orientation,
+                           BlockTransaction* retracted,
+                           BlockTransaction* transaction);
+  virtual void resetPreview();
+
+ protected:
+  /**
+    * Adds the cells of the shape described by the tool's current positions to \p mask.  Does nothing if the tool
+    * does not have enough positions to draw itself yet.
+    */
+  virtual void rasterize(SpanMask* mask) = 0;
+
+ private:
+  Diagram* diagram_;
+
+  /// The shape drawn by the previous preview.
+  SpanMask preview_mask_;
+};
+
+#endif // SHAPE_TOOL_H
@@ -0,0 +1,136 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "solid_tool.h"
+
+#include "block_position.h"
+#include "span_mask.h"
+
+SolidTool::SolidTool(Diagram* diagram)
+    : ShapeTool(diagram),
+      is_filled_(false),
+      x_(0),
+      y_(0),
+      z_(0),
+      width_(0),
+      depth_(0) {}
+
+SolidTool::~SolidTool() {}
+
+bool SolidTool::wantsMorePositions() {
+  return countPositions() < 2;
+}
+
+bool SolidTool::isBrush() const {
+  return false;
+}
+
+void SolidTool::setFilled(bool filled) {
+  is_filled_ = filled;
+}
+
+void SolidTool::rasterize(SpanMask* mask) {
+  if (wantsMorePositions()) {
+    return;
+  }
+
+  Q_ASSERT(positionAtIndex(0).y() == positionAtIndex(1).y());
+
+  // Past kMaximumFootprintSize, addEllipticRing() could overflow, so the second corner is held back.
+  BlockPosition first = positionAtIndex(0);
+  BlockPosition second = positionAtIndex(1);
+  int second_x = qBound(first.x() - (kMaximumFootprintSize - 1), second.x(), first.x() + (kMaximumFootprintSize - 1));
+  int second_z = qBound(first.z() - (kMaximumFootprintSize - 1), second.z(), first.z() + (kMaximumFootprintSize - 1));
+  x_ = qMin(first.x(), second_x);
+  y_ = first.y();
+  z_ = qMin(first.z(), second_z);
+  width_ = qAbs(second_x - first.x()) + 1;
+  depth_ = qAbs(second_z - first.z()) + 1;
+  int height = qMax(1, heightForFootprint(width_, depth_));
+
+  if (is_filled_) {
+    for (int level = 0; level < height; ++level) {
+      rasterizeLevel(mask, level, height);
+    }
+    return;
+  }
+
+  SpanMask solid;
+  for (int level = 0; level < height; ++level) {
+    rasterizeLevel(&solid, level, height);
+  }
+  SpanMask shell = solid.subtracted(solid.interior());
+  foreach (const BlockSpan& span, shell.spans()) {
+    mask->addSpan(span.firstX(), span.lastX(), span.y(), span.z());
+  }
+}
+
+int SolidTool::heightForFootprint(int width, int depth) const {
+  return qMin(width, depth);
+}
+
+void SolidTool::addRectangle(SpanMask* mask, int level) {
+  for (int row = 0; row < depth_; ++row) {
+    mask->addSpan(x_, x_ + width_ - 1, y_ + level, z_ + row);
+  }
+}
+
+void SolidTool::addEllipticRing(SpanMask* mask, int level, qint64 outer, qint64 inner, qint64 scale) {
+  // Measured in half blocks from the center of the footprint, the cell in column i and row k is offset by
+  // u = 2i + 1 - width along x and v = 2k + 1 - depth along z, and the inscribed ellipse has semi-axes of width and
+  // depth.  So the cell lies inside the ellipse scaled by sqrt(r / scale) when
+  // scale * (u^2 * depth^2 + v^2 * width^2) <= r * width^2 * depth^2.
+  //
+  // Rows are visited from the middle of the footprint outwards, over which the widest u that passes can only shrink,
+  // so it is found by stepping inwards from where the previous row left off, as in the midpoint ellipse algorithm.
+  // The rows on either side of the middle are mirror images of each other.
+  qint64 width_squared = qint64(width_) * width_;
+  qint64 depth_squared = qint64(depth_) * depth_;
+  qint64 area = width_squared * depth_squared;
+  qint64 u_weight = scale * depth_squared;
+  qint64 outer_u = width_ - 1;
+  qint64 inner_u = width_ - 1;
+  for (int row = (depth_ - 1) / 2; row >= 0; --row) {
+    qint64 v = 2 * row + 1 - depth_;
+    qint64 v_term = scale * v * v * width_squared;
+    qint64 outer_limit = outer * area - v_term;
+    while (outer_u >= 0 && outer_u * outer_u * u_weight > outer_limit) {
+      outer_u -= 2;
+    }
+    if (outer_u < 0) {
+      break;
+    }
+    qint64 inner_limit = inner * area - v_term;
+    while (inner_u >= 0 && inner_u * inner_u * u_weight > inner_limit) {
+      inner_u -= 2;
+    }
+    addRingRow(mask, level, row, outer_u, inner_u);
+    if (depth_ - 1 - row != row) {
+      addRingRow(mask, level, depth_ - 1 - row, outer_u, inner_u);
+    }
+  }
+}
+
+void SolidTool::addRingRow(SpanMask* mask, int level, int row, int outer_u, int inner_u) {
+  // outer_u and inner_u have the same parity as width - 1, so these all land on cell boundaries.
+  int first_x = x_ + (width_ - 1 - outer_u) / 2;
+  int last_x = x_ + (width_ - 1 + outer_u) / 2;
+  if (inner_u < 0) {
+    mask->addSpan(first_x, last_x, y_ + level, z_ + row);
+  } else if (inner_u < outer_u) {
+    mask->addSpan(first_x, x_ + (width_ - 1 - inner_u) / 2 - 1, y_ + level, z_ + row);
+    mask->addSpan(x_ + (width_ - 1 + inner_u) / 2 + 1, last_x, y_ + level, z_ + row);
+  }
+}
@@ -0,0 +1,109 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOLID_TOOL_H
+#define SOLID_TOOL_H
+
+#include <QtGlobal>
+
+#include "shape_tool.h"
+
+class Diagram;
+
+/**
+  * A ShapeTool that draws a three-dimensional shape standing on the current level, inside the box whose footprint is
+  * the rectangle between two corners and whose height is chosen by the subclass.
+  *
+  * Subclasses implement rasterizeLevel(), which adds one horizontal slice of the solid shape at a time, usually with
+  * addEllipticRing().  Both of them work a row at a time with integer arithmetic, so drawing a shape costs time in
+  * proportion to the number of rows it covers rather than the number of blocks in its bounding box.  Unless the tool
+  * is set to be filled, only the shell of the shape is drawn: the blocks of the solid that have a face exposed to the
+  * outside (see SpanMask::interior()).
+  */
+class SolidTool : public ShapeTool {
+ public:
+  /**
+    * The largest footprint, in blocks along either side, that the tool draws.  addEllipticRing() compares products
+    * that grow as the sixth power of the footprint's size, and the largest, for the torus, would overflow 64 bits a
+    * little beyond 900 blocks.  Dragging further out leaves the footprint at this size, measured from the first corner.
+    */
+  static const int kMaximumFootprintSize = 768;
+
+  explicit SolidTool(Diagram* diagram);
+  virtual ~SolidTool();
+
+  virtual bool wantsMorePositions();
+  virtual bool isBrush() const;
+
+  /**
+    * Returns whether the tool draws the whole solid rather than just its shell.  Defaults to false.
+    */
+  bool isFilled() const {
+    return is_filled_;
+  }
+
+  /**
+    * Sets whether the tool draws the whole solid rather than just its shell.
+    */
+  void setFilled(bool filled);
+
+ protected:
+  virtual void rasterize(SpanMask* mask);
+
+  /**
+    * Returns the height in blocks of the shape whose footprint is \p width by \p depth blocks.  The default is the
+    * smaller of the two, so that a square footprint gives a shape as tall as it is wide.
+    */
+  virtual int heightForFootprint(int width, int depth) const;
+
+  /**
+    * Adds to \p mask the cells of the solid shape that lie \p level blocks above its base, where \p height is the
+    * height of the whole shape.
+    */
+  virtual void rasterizeLevel(SpanMask* mask, int level, int height) = 0;
+
+  /**
+    * Adds to \p mask every cell of the footprint at \p level blocks above the base.
+    */
+  void addRectangle(SpanMask* mask, int level);
+
+  /**
+    * Adds to \p mask the cells of the footprint at \p level blocks above the base that lie inside the ellipse
+    * inscribed in the footprint scaled by the square root of \p outer / \p scale, but outside the one scaled by the
+    * square root of \p inner / \p scale.  Pass a negative \p inner to fill the whole ellipse.  Every cell is judged by
+    * its center, using only integer arithmetic.  \p outer, \p inner and \p scale must be no more than about 16
+    * times the square of the footprint's size, as the torus's are, for the products not to overflow (see
+    * kMaximumFootprintSize).
+    */
+  void addEllipticRing(SpanMask* mask, int level, qint64 outer, qint64 inner, qint64 scale);
+
+ private:
+  /**
+    * Adds to \p mask the cells in row \p row of the footprint at \p level blocks above the base that are at most
+    * \p outer_u but more than \p inner_u half blocks from the center of the footprint along x.
+    */
+  void addRingRow(SpanMask* mask, int level, int row, int outer_u, int inner_u);
+
+  bool is_filled_;
+
+  /// The footprint being rasterized, as its corner with the lowest coordinates and its size.
+  int x_;
+  int y_;
+  int z_;
+  int width_;
+  int depth_;
+};
+
+#endif // SOLID_TOOL_H
@@ -0,0 +1,284 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "span_mask.h"
+
+#include <QtAlgorithms>
+
+#include "block_position.h"
+
+/**
+  * Returns whether \p a lies entirely before \p b in the order spans are sorted in: that is, in an earlier row, or
+  * ending before \p b starts in the same row.
+  */
+static inline bool isEntirelyBefore(const BlockSpan& a, const BlockSpan& b) {
+  if (a.y() != b.y()) {
+    return a.y() < b.y();
+  }
+  if (a.z() != b.z()) {
+    return a.z() < b.z();
+  }
+  return a.lastX() < b.firstX();
+}
+
+/**
+  * Returns the index of the first of \p spans that lies in the row at \p y and \p z, or if there are none, the index
+  * at which such a span would be inserted.  \p spans must be sorted.
+  */
+static int rowStart(const QVector<BlockSpan>& spans, int y, int z) {
+  int low = 0;
+  int high = spans.size();
+  while (low < high) {
+    int middle = (low + high) / 2;
+    const BlockSpan& span = spans.at(middle);
+    if (span.y() < y || (span.y() == y && span.z() < z)) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+/**
+  * Replaces \p row with the cells it has in common with the row of \p spans at \p y and \p z.  \p row must lie in
+  * that row, and both it and \p spans must be sorted.
+  */
+static void intersectRow(const QVector<BlockSpan>& spans, int y, int z, QVector<BlockSpan>* row) {
+  if (row->isEmpty()) {
+    return;
+  }
+  QVector<BlockSpan> result;
+  int i = rowStart(spans, y, z);
+  foreach (const BlockSpan& span, *row) {
+    while (i < spans.size() && spans.at(i).y() == y && spans.at(i).z() == z && spans.at(i).lastX() < span.firstX()) {
+      ++i;
+    }
+    for (int j = i; j < spans.size() && spans.at(j).y() == y && spans.at(j).z() == z; ++j) {
+      const BlockSpan& other = spans.at(j);
+      if (other.firstX() > span.lastX()) {
+        break;
+      }
+      int first_x = qMax(span.firstX(), other.firstX());
+      int last_x = qMin(span.lastX(), other.lastX());
+      if (first_x <= last_x) {
+        result.append(BlockSpan(first_x, last_x, span.y(), span.z()));
+      }
+    }
+  }
+  *row = result;
+}
+
+SpanMask::SpanMask() : is_normalized_(true) {}
+
+void SpanMask::addSpan(int first_x, int last_x, int y, int z) {
+  if (first_x > last_x) {
+    qSwap(first_x, last_x);
+  }
+  // Most shapes are rasterized a row at a time, so a span usually either extends the last one or starts a new row
+  // after it.  Catching those cases here keeps the mask small and often saves sorting it at all.
+  if (!spans_.isEmpty()) {
+    BlockSpan& last = spans_.last();
+    if (last.y_ == y && last.z_ == z && first_x <= last.last_x_ + 1 && last_x >= last.first_x_ - 1) {
+      if (first_x < last.first_x_) {
+        // Growing backwards may run into an earlier span in the same row.
+        is_normalized_ = false;
+        last.first_x_ = first_x;
+      }
+      last.last_x_ = qMax(last.last_x_, last_x);
+      return;
+    }
+    if (!(last < BlockSpan(first_x, last_x, y, z))) {
+      is_normalized_ = false;
+    }
+  }
+  spans_.append(BlockSpan(first_x, last_x, y, z));
+}
+
+void SpanMask::addLine(const BlockPosition& start, const BlockPosition& end) {
+  Q_ASSERT(start.y() == end.y());
+
+  // What follows is an implementation of Bresenham's line algorithm.  See
+  // http://en.wikipedia.org/wiki/Bresenham's_line_algorithm.
+
+  int x1 = start.x();
+  int y1 = start.z();
+
+  int x2 = end.x();
+  int y2 = end.z();
+
+  // Flip start and end if line extends to the left.
+  if (start.x() > end.x()) {
+    x1 = end.x();
+    y1 = end.z();
+
+    x2 = start.x();
+    y2 = start.z();
+  }
+
+  int dx = qAbs(x2 - x1);
+  int dy = qAbs(y2 - y1);
+
+  // Increment if line extends downwards, otherwise decrement.
+  int inc_dec = (y2 >= y1 ? 1 : -1);
+
+  // Different algorithm depending on whether slope is less or greater than 1.
+  if (dx > dy) {
+    // Multiply everything by two to avoid non-integral values.
+    int two_dy = 2 * dy;
+    int two_dy_dx = 2 * (dy - dx);
+    int diff = (2 * dy) - dx;
+
+    int x = x1;
+    int y = y1;
+
+    addCell(x, start.y(), y);
+
+    while (x < x2) {
+      ++x;
+
+      if (diff < 0) {
+        // Midpoint is above line.
+        diff += two_dy;
+      } else {
+        // Midpoint is below line.
+        y += inc_dec;
+        diff += two_dy_dx;
+      }
+
+      addCell(x, start.y(), y);
+    }
+  } else {
+    // Multiply everything by two to avoid non-integral values.
+    int two_dx = 2 * dx;
+    int two_dx_dy = 2 * (dx - dy);
+    int diff = (2 * dx) - dy;
+
+    int x = x1;
+    int y = y1;
+
+    addCell(x, start.y(), y);
+
+    while (y != y2) {  // This is safe since y will never change by more than one block per iteration.
+      y += inc_dec;
+
+      if (diff < 0) {
+        // Midpoint is above line.
+        diff += two_dx;
+      } else {
+        // Midpoint is below line.
+        ++x;
+        diff += two_dx_dy;
+      }
+
+      addCell(x, start.y(), y);
+    }
+  }
+}
+
+int SpanMask::cellCount() const {
+  int count = 0;
+  foreach (const BlockSpan& span, spans()) {
+    count += span.length();
+  }
+  return count;
+}
+
+const QVector<BlockSpan>& SpanMask::spans() const {
+  normalize();
+  return spans_;
+}
+
+SpanMask SpanMask::subtracted(const SpanMask& other) const {
+  const QVector<BlockSpan>& spans = this->spans();
+  const QVector<BlockSpan>& other_spans = other.spans();
+  SpanMask result;
+  int other_index = 0;
+  foreach (const BlockSpan& span, spans) {
+    while (other_index < other_spans.size() && isEntirelyBefore(other_spans.at(other_index), span)) {
+      ++other_index;
+    }
+    // Walk the spans of other that overlap this one, keeping the gaps between them.
+    int first_x = span.firstX();
+    for (int i = other_index; i < other_spans.size() && first_x <= span.lastX(); ++i) {
+      const BlockSpan& other_span = other_spans.at(i);
+      if (other_span.y() != span.y() || other_span.z() != span.z() || other_span.firstX() > span.lastX()) {
+        break;
+      }
+      if (other_span.firstX() > first_x) {
+        result.addSpan(first_x, other_span.firstX() - 1, span.y(), span.z());
+      }
+      first_x = qMax(first_x, other_span.lastX() + 1);
+    }
+    if (first_x <= span.lastX()) {
+      result.addSpan(first_x, span.lastX(), span.y(), span.z());
+    }
+  }
+  return result;
+}
+
+SpanMask SpanMask::interior() const {
+  const QVector<BlockSpan>& spans = this->spans();
+  SpanMask result;
+  QVector<BlockSpan> row;
+  int row_start = 0;
+  while (row_start < spans.size()) {
+    int y = spans.at(row_start).y();
+    int z = spans.at(row_start).z();
+    // A cell at either end of a span has a neighbour along x that is not in the mask.
+    row.clear();
+    int i = row_start;
+    for (; i < spans.size() && spans.at(i).y() == y && spans.at(i).z() == z; ++i) {
+      if (spans.at(i).length() > 2) {
+        row.append(BlockSpan(spans.at(i).firstX() + 1, spans.at(i).lastX() - 1, y, z));
+      }
+    }
+    row_start = i;
+    intersectRow(spans, y - 1, z, &row);
+    intersectRow(spans, y + 1, z, &row);
+    intersectRow(spans, y, z - 1, &row);
+    intersectRow(spans, y, z + 1, &row);
+    foreach (const BlockSpan& span, row) {
+      result.addSpan(span.firstX(), span.lastX(), y, z);
+    }
+  }
+  return result;
+}
+
+void SpanMask::clear() {
+  spans_.clear();
+  is_normalized_ = true;
+}
+
+void SpanMask::normalize() const {
+  if (is_normalized_) {
+    return;
+  }
+  qSort(spans_);
+  int merged_count = 0;
+  for (int i = 0; i < spans_.size(); ++i) {
+    BlockSpan span = spans_.at(i);
+    if (merged_count > 0) {
+      BlockSpan& last = spans_[merged_count - 1];
+      if (last.y_ == span.y_ && last.z_ == span.z_ && span.first_x_ <= last.last_x_ + 1) {
+        last.last_x_ = qMax(last.last_x_, span.last_x_);
+        continue;
+      }
+    }
+    spans_[merged_count++] = span;
+  }
+  spans_.resize(merged_count);
+  is_normalized_ = true;
+}
@@ -0,0 +1,155 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SPAN_MASK_H
+#define SPAN_MASK_H
+
+#include <QVector>
+
+class BlockPosition;
+
+/**
+  * A run of adjacent cells along the x axis, from firstX() to lastX() inclusive, in the row at y() and z().
+  */
+class BlockSpan {
+ public:
+  BlockSpan() : first_x_(0), last_x_(-1), y_(0), z_(0) {}
+  BlockSpan(int first_x, int last_x, int y, int z) : first_x_(first_x), last_x_(last_x), y_(y), z_(z) {}
+
+  inline int firstX() const {
+    return first_x_;
+  }
+
+  inline int lastX() const {
+    return last_x_;
+  }
+
+  inline int y() const {
+    return y_;
+  }
+
+  inline int z() const {
+    return z_;
+  }
+
+  /**
+    * Returns the number of cells in the span.
+    */
+  inline int length() const {
+    return last_x_ - first_x_ + 1;
+  }
+
+  /**
+    * Orders spans by row (first y, then z) and then by where they start within the row.
+    */
+  bool operator<(const BlockSpan& other) const {
+    if (y_ != other.y_) {
+      return y_ < other.y_;
+    }
+    if (z_ != other.z_) {
+      return z_ < other.z_;
+    }
+    return first_x_ < other.first_x_;
+  }
+
+ private:
+  friend class SpanMask;
+
+  int first_x_;
+  int last_x_;
+  int y_;
+  int z_;
+};
+
+/**
+  * A set of cells described as runs along the x axis.
+  *
+  * Shape tools rasterize into a SpanMask rather than recording one block at a time in a BlockTransaction.  The mask is
+  * then handed to Diagram::fillSpans(), which reads the old contents of each run straight out of the chunk it lies in
+  * and records the whole replacement in one go.  Since the diagram stores each chunk layer as rows along the x axis,
+  * this keeps the cost of a large filled shape proportional to the number of rows rather than the number of cells.
+  *
+  * Spans may be added in any order and may overlap; spans() always returns them sorted and with overlapping or touching
+  * spans in the same row merged, so every cell is covered exactly once.
+  */
+class SpanMask {
+ public:
+  SpanMask();
+
+  /**
+    * Adds the cells from \p first_x to \p last_x inclusive in the row at \p y and \p z.  The endpoints may be given in
+    * either order.
+    */
+  void addSpan(int first_x, int last_x, int y, int z);
+
+  /**
+    * Adds the single cell at \p x, \p y, \p z.
+    */
+  inline void addCell(int x, int y, int z) {
+    addSpan(x, x, y, z);
+  }
+
+  /**
+    * Adds the cells of a straight line from \p start to \p end, both of which must be on the same level.
+    */
+  void addLine(const BlockPosition& start, const BlockPosition& end);
+
+  /**
+    * Returns whether the mask covers no cells.
+    */
+  bool isEmpty() const {
+    return spans_.isEmpty();
+  }
+
+  /**
+    * Returns the number of cells covered by the mask.
+    */
+  int cellCount() const;
+
+  /**
+    * Returns the spans in the mask, sorted by row and with no two of them covering the same cell.
+    */
+  const QVector<BlockSpan>& spans() const;
+
+  /**
+    * Returns the cells that are in this mask but not in \p other.  This takes time proportional to the number of spans
+    * in the two masks, not the number of cells they cover.
+    */
+  SpanMask subtracted(const SpanMask& other) const;
+
+  /**
+    * Returns the cells of this mask whose six face neighbours are all in the mask as well.  Subtracting the interior
+    * of a solid shape from the shape leaves its shell one block thick.  Each row is only compared with the four rows
+    * next to it, so this also takes time proportional to the number of spans rather than cells.
+    */
+  SpanMask interior() const;
+
+  /**
+    * Removes all spans from the mask.
+    */
+  void clear();
+
+ private:
+  /**
+    * Sorts spans_ and merges overlapping or adjacent spans within each row, if that has not been done since the last
+    * span was added.
+    */
+  void normalize() const;
+
+  mutable QVector<BlockSpan> spans_;
+  mutable bool is_normalized_;
+};
+
+#endif // SPAN_MASK_H
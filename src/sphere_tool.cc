@@ -11,60 +11,22 @@
  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
  * See the License for the specific language governing permissions and
  * limitations under the License.
- *
- * Portions Copyright Alois Zingl, Vienna, Austria
  */
 
 #include "sphere_tool.h"
 
-#include "block_instance.h"
-#include "block_oracle.h"
-#include "block_prototype.h"
-#include "block_transaction.h"
+#include "span_mask.h"
 
-SphereTool::SphereTool(BlockOracle* oracle) : oracle_(oracle) {}
+SphereTool::SphereTool(Diagram* diagram) : SolidTool(diagram) {}
 
 QString SphereTool::actionName() const {
   return "Draw Sphere";
 }
 
-bool SphereTool::wantsMorePositions() {
-  return countPositions() < 2;
-}
-
-bool SphereTool::isBrush() const {
-  return false;
-}
-
-void SphereTool::setPixel(int x, int y, int z, BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
-  BlockPosition pos(x, y, z);
-  BlockInstance new_block(prototype, pos, orientation);
-  transaction->replaceBlock(oracle_->blockAt(pos), new_block);
-}
-
-void SphereTool::draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) {
-  if (wantsMorePositions()) {
-    return;
-  }
-
-  Q_ASSERT(positionAtIndex(0).y() == positionAtIndex(1).y());
-
-  BlockPosition start = positionAtIndex(0);
-  BlockPosition end = positionAtIndex(1);
-  double size = qMax(qAbs(end.x() - start.x()), qAbs(end.z() - start.z()));
-  double radius = size / 2.0;
-  double x_increment = (end.x() < start.x() ? -1 : 1);
-  double z_increment = (end.z() < start.z() ? -1 : 1);
-  QVector3D center = start.centerVector() + QVector3D(radius * x_increment, radius, radius * z_increment);
-  for (int z = 0; z <= size; ++z) {
-    for (int y = 0; y <= size; ++y) {
-      for (int x = 0; x <= size; ++x) {
-        BlockPosition pos(start.x() + x * x_increment, start.y() + y, start.z() + z * z_increment);
-        QVector3D distance = pos.centerVector() - center;
-        if (qAbs(radius - distance.length()) < 0.5) {
-          transaction->replaceBlock(oracle_->blockAt(pos), BlockInstance(prototype, pos, orientation));
-        }
-      }
-    }
-  }
+void SphereTool::rasterizeLevel(SpanMask* mask, int level, int height) {
+  // At w half blocks above or below the middle of the sphere, the slice is the footprint ellipse scaled by
+  // sqrt(1 - w^2 / height^2).
+  qint64 w = 2 * level + 1 - height;
+  qint64 scale = qint64(height) * height;
+  addEllipticRing(mask, level, scale - w * w, -1, scale);
 }
@@ -16,25 +16,20 @@
 #ifndef SPHERE_TOOL_H
 #define SPHERE_TOOL_H
 
-#include "block_position.h"
-#include "tool.h"
+#include "solid_tool.h"
 
-class BlockOracle;
+class Diagram;
 
 /**
-  * A Tool that draws hollow spheres between two corners.
+  * A Tool that draws spheres between two corners, or ellipsoids if the footprint between them is not square.
   */
-class SphereTool : public Tool {
+class SphereTool : public SolidTool {
  public:
-  explicit SphereTool(BlockOracle* oracle);
+  explicit SphereTool(Diagram* diagram);
   virtual QString actionName() const;
-  virtual bool wantsMorePositions();
-  virtual bool isBrush() const;
-  virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction);
 
- private:
-  void setPixel(int x, int y, int z, BlockPrototype *prototype, const BlockOrientation *orientation, BlockTransaction *transaction);
-  BlockOracle* oracle_;
+ protected:
+  virtual void rasterizeLevel(SpanMask* mask, int level, int height);
 };
 
 #endif // SPHERE_TOOL_H
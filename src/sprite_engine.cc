@@ -15,60 +15,67 @@
 
 #include "sprite_engine.h"
 
+#include <QDebug>
+#include <QFontDatabase>
+#include <QPainter>
+#include <QtConcurrentMap>
+
 #include "application.h"
 #include "block_geometry.h"
-#include "block_properties.h"
 #include "texture.h"
 
-SpriteEngine::SpriteEngine() {
-}
-
-QPixmap SpriteEngine::createSprite(const Texture& texture,
-                                   const BlockProperties& properties,
-                                   const BlockOrientation* orientation) {
-  CacheKey key = qMakePair(&properties, orientation);
-  QPixmap cached_pixmap = pixmap_cache_.value(key);
-  if (!cached_pixmap.isNull()) {
-    return cached_pixmap;
-  }
+/**
+  * The size in pixels of a single sprite.
+  */
+static const int kSpriteSize = 16;
 
-  QPixmap pixmap = texture.texturePixmap();
-  QPainter painter(&pixmap);
+/**
+  * Paints the sprite for a block in a particular orientation.  Painting is done on a QImage rather than a QPixmap so
+  * that it can safely take place on a worker thread.
+  * @param texture The texture upon which the sprite should be based.
+  * @param properties The properties of the block.
+  * @param orientation The orientation in which the block should be shown.
+  * @param colorize_flows Whether flowing blocks should have their labels colored by flow distance.
+  */
+static QImage paintSprite(const QImage& texture, const BlockProperties& properties,
+                          const BlockOrientation* orientation, bool colorize_flows) {
+  QImage image = texture.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+  QPainter painter(&image);
   painter.save();
   switch (properties.geometry()) {
     case BlockGeometry::kGeometryStairs:
-      if (orientation == BlockOrientation::get("Facing south")) {
-        painter.fillRect(0, pixmap.height() / 2, pixmap.width(), pixmap.height(), QColor(0, 0, 0, 96));
-      } else if (orientation == BlockOrientation::get("Facing north")) {
-        painter.fillRect(0, 0, pixmap.width(), pixmap.height() / 2, QColor(0, 0, 0, 96));
-      } else if (orientation == BlockOrientation::get("Facing east")) {
-        painter.fillRect(pixmap.width() / 2, 0, pixmap.width() / 2, pixmap.height(), QColor(0, 0, 0, 96));
-      } else if (orientation == BlockOrientation::get("Facing west")) {
-        painter.fillRect(0, 0, pixmap.width() / 2, pixmap.height(), QColor(0, 0, 0, 96));
+      if (orientation->id() == BlockOrientation::kOrientationFacingSouth) {
+        painter.fillRect(0, image.height() / 2, image.width(), image.height(), QColor(0, 0, 0, 96));
+      } else if (orientation->id() == BlockOrientation::kOrientationFacingNorth) {
+        painter.fillRect(0, 0, image.width(), image.height() / 2, QColor(0, 0, 0, 96));
+      } else if (orientation->id() == BlockOrientation::kOrientationFacingEast) {
+        painter.fillRect(image.width() / 2, 0, image.width() / 2, image.height(), QColor(0, 0, 0, 96));
+      } else if (orientation->id() == BlockOrientation::kOrientationFacingWest) {
+        painter.fillRect(0, 0, image.width() / 2, image.height(), QColor(0, 0, 0, 96));
       } else {  // Palette orientation
         painter.setCompositionMode(QPainter::CompositionMode_Clear);
-        painter.fillRect(0, 0, pixmap.width() / 2, pixmap.height() / 2, Qt::black);
+        painter.fillRect(0, 0, image.width() / 2, image.height() / 2, Qt::black);
       }
       break;
     case BlockGeometry::kGeometrySlab:
       if (orientation == BlockOrientation::paletteOrientation()) {
         painter.setCompositionMode(QPainter::CompositionMode_Clear);
-        painter.fillRect(0, 0, pixmap.width(), pixmap.height() / 2, Qt::black);
+        painter.fillRect(0, 0, image.width(), image.height() / 2, Qt::black);
       } else {
-        painter.fillRect(0, 0, pixmap.width(), pixmap.height(), QColor(0, 0, 0, 96));
+        painter.fillRect(0, 0, image.width(), image.height(), QColor(0, 0, 0, 96));
       }
       break;
     case BlockGeometry::kGeometrySnow:
       if (orientation == BlockOrientation::paletteOrientation()) {
         painter.setCompositionMode(QPainter::CompositionMode_Clear);
-        painter.fillRect(0, 0, pixmap.width(), 3 * pixmap.height() / 4, Qt::black);
+        painter.fillRect(0, 0, image.width(), 3 * image.height() / 4, Qt::black);
       }
       break;
     case BlockGeometry::kGeometryFlow:
     {
       QHash<int, QColor> colors;
 
-      if (Application::instance()->settings()->value("ColorizeFlows", true).toBool()) {
+      if (colorize_flows) {
         colors.insert(1, QColor(0x990000));
         colors.insert(2, QColor(0x996600));
         colors.insert(3, QColor(0x999900));
@@ -88,8 +95,8 @@ QPixmap SpriteEngine::createSprite(const Texture& texture,
       painter.setPen(QPen(painter.brush(), 2.0));
       QPainterPath text_path;
       QSize text_size = painter.fontMetrics().size(Qt::TextSingleLine, label);
-      QPoint baseline(pixmap.width() / 2 - text_size.width() / 2,
-                      pixmap.height() / 2 + painter.fontMetrics().ascent() / 2 - 1);
+      QPoint baseline(image.width() / 2 - text_size.width() / 2,
+                      image.height() / 2 + painter.fontMetrics().ascent() / 2 - 1);
       QFont font = painter.font();
       font.setBold(true);
       text_path.addText(baseline, font, label);
@@ -103,20 +110,173 @@ QPixmap SpriteEngine::createSprite(const Texture& texture,
     default:
       if (properties.validOrientations().count() > 1) {
         painter.setPen(QPen(QColor(0, 255, 0, 128), 2.0));
-        if (orientation == BlockOrientation::get("Facing south")) {
-          painter.drawLine(0, pixmap.height() - 1, pixmap.width(), pixmap.height() - 1);
-        } else if (orientation == BlockOrientation::get("Facing east")) {
-          painter.drawLine(pixmap.width() - 1, 0, pixmap.width() - 1, pixmap.height());
-        } else if (orientation == BlockOrientation::get("Facing north")) {
-          painter.drawLine(0, 1, pixmap.width(), 1);
-        } else if (orientation == BlockOrientation::get("Facing west")) {
-          painter.drawLine(1, 0, 1, pixmap.height());
+        if (orientation->id() == BlockOrientation::kOrientationFacingSouth) {
+          painter.drawLine(0, image.height() - 1, image.width(), image.height() - 1);
+        } else if (orientation->id() == BlockOrientation::kOrientationFacingEast) {
+          painter.drawLine(image.width() - 1, 0, image.width() - 1, image.height());
+        } else if (orientation->id() == BlockOrientation::kOrientationFacingNorth) {
+          painter.drawLine(0, 1, image.width(), 1);
+        } else if (orientation->id() == BlockOrientation::kOrientationFacingWest) {
+          painter.drawLine(1, 0, 1, image.height());
         }
       }
       break;
   }
   painter.restore();
+  return image;
+}
+
+/**
+  * The source data for one row of the sprite atlas: everything needed to paint the sprites for a single block type
+  * without touching any state shared with other threads.
+  */
+class SpriteRow {
+ public:
+  SpriteRow(const QImage& texture, const BlockProperties& properties)
+      : texture_(texture),
+        properties_(properties),
+        colorize_flows_(true) {
+    orientations_.append(BlockOrientation::paletteOrientation());
+    orientations_.append(BlockOrientation::noOrientation());
+    foreach (const BlockOrientation* orientation, properties.validOrientations()) {
+      if (!orientations_.contains(orientation)) {
+        orientations_.append(orientation);
+      }
+    }
+  }
+
+  /**
+    * Returns the orientation of the sprite in column \p column of the atlas.
+    */
+  const BlockOrientation* orientation(int column) const {
+    return orientations_.at(column);
+  }
+
+  /**
+    * Returns the number of sprites in this row.
+    */
+  int size() const {
+    return orientations_.size();
+  }
+
+  void setColorizeFlows(bool colorize_flows) {
+    colorize_flows_ = colorize_flows;
+  }
+
+  /**
+    * Paints the sprite for \p orientation.
+    */
+  QImage paint(const BlockOrientation* orientation) const {
+    return paintSprite(texture_, properties_, orientation, colorize_flows_);
+  }
+
+  /**
+    * Paints every sprite in the row, from left to right, into a single image.
+    */
+  QImage paintRow() const {
+    QImage row(kSpriteSize * orientations_.size(), kSpriteSize, QImage::Format_ARGB32_Premultiplied);
+    row.fill(Qt::transparent);
+    QPainter painter(&row);
+    for (int i = 0; i < orientations_.size(); ++i) {
+      painter.drawImage(QRect(i * kSpriteSize, 0, kSpriteSize, kSpriteSize), paint(orientations_.at(i)));
+    }
+    return row;
+  }
+
+ private:
+  QImage texture_;
+  BlockProperties properties_;
+  QVector<const BlockOrientation*> orientations_;
+  bool colorize_flows_;
+};
+
+/**
+  * Paints every sprite in \p row.  Used as the map function when generating the atlas.
+  */
+static QImage paintSpriteRow(const SpriteRow* row) {
+  return row->paintRow();
+}
+
+SpriteEngine::SpriteEngine() {
+}
+
+SpriteEngine::~SpriteEngine() {
+  qDeleteAll(rows_);
+}
+
+void SpriteEngine::addBlock(blocktype_t type, const Texture& texture, const BlockProperties& properties) {
+  if (block_ids_.contains(type)) {
+    return;
+  }
+  block_ids_.insert(type, rows_.size());
+  rows_.append(new SpriteRow(texture.texturePixmap().toImage(), properties));
+}
+
+void SpriteEngine::generateSprites() {
+  // Read everything the painting code needs from shared state up front, so that the worker threads only ever read.
+  bool colorize_flows = Application::instance()->settings()->value("ColorizeFlows", true).toBool();
+  int columns = 0;
+  foreach (SpriteRow* row, rows_) {
+    row->setColorizeFlows(colorize_flows);
+    columns = qMax(columns, row->size());
+  }
+
+  // Flow sprites are labelled with text, which some platforms can only render on the GUI thread.
+  QList<QImage> row_images;
+  if (QFontDatabase::supportsThreadedFontRendering()) {
+    row_images = QtConcurrent::blockingMapped<QList<QImage> >(rows_, paintSpriteRow);
+  } else {
+    foreach (const SpriteRow* row, rows_) {
+      row_images.append(row->paintRow());
+    }
+  }
+
+  QImage atlas(kSpriteSize * columns, kSpriteSize * row_images.size(), QImage::Format_ARGB32_Premultiplied);
+  atlas.fill(Qt::transparent);
+  QPainter painter(&atlas);
+  for (int i = 0; i < row_images.size(); ++i) {
+    painter.drawImage(0, i * kSpriteSize, row_images.at(i));
+  }
+  painter.end();
 
-  pixmap_cache_.insert(key, pixmap);
+  atlas_ = QPixmap::fromImage(atlas);
+  atlas_rects_.clear();
+  for (int block_id = 0; block_id < rows_.size(); ++block_id) {
+    for (int column = 0; column < rows_.at(block_id)->size(); ++column) {
+      atlas_rects_.insert(qMakePair(block_id, rows_.at(block_id)->orientation(column)->id()),
+                          QRect(column * kSpriteSize, block_id * kSpriteSize, kSpriteSize, kSpriteSize));
+    }
+  }
+  sprite_cache_.clear();
+}
+
+int SpriteEngine::blockId(blocktype_t type) const {
+  return block_ids_.value(type, -1);
+}
+
+QRect SpriteEngine::spriteRect(int block_id, int orientation_id) const {
+  return atlas_rects_.value(qMakePair(block_id, orientation_id));
+}
+
+QPixmap SpriteEngine::createSprite(blocktype_t type, const BlockOrientation* orientation) {
+  int block_id = blockId(type);
+  QPair<int, int> key = qMakePair(block_id, orientation->id());
+  QPixmap cached_pixmap = sprite_cache_.value(key);
+  if (!cached_pixmap.isNull()) {
+    return cached_pixmap;
+  }
+
+  QPixmap pixmap;
+  QRect rect = spriteRect(block_id, orientation->id());
+  if (rect.isValid()) {
+    pixmap = atlas_.copy(rect);
+  } else if (block_id >= 0) {
+    // The block was added after the atlas was generated, or is being shown in an orientation it doesn't support.
+    pixmap = QPixmap::fromImage(rows_.at(block_id)->paint(orientation));
+  } else {
+    qWarning() << "No sprite source has been added for block type" << type;
+    return QPixmap();
+  }
+  sprite_cache_.insert(key, pixmap);
   return pixmap;
 }
@@ -16,39 +16,92 @@
 #ifndef SPRITE_ENGINE_H
 #define SPRITE_ENGINE_H
 
-#include <QMap>
+#include <QHash>
+#include <QList>
 #include <QPair>
 #include <QPixmap>
+#include <QRect>
+#include <QVector>
 
 #include "block_orientation.h"
+#include "block_properties.h"
 #include "block_type.h"
 
-class BlockProperties;
+class SpriteRow;
 class Texture;
 
 /**
-  * Constructs and returns sprite images for blocks to represent the block in a 2D context.  The sprite images returned
-  * by the engine can take into account the block's geometry, orientation, and whether it is being drawn in the
-  * BlockPicker or in the LevelWidget.
+  * Constructs sprite images for blocks to represent the block in a 2D context.  The sprite images returned by the
+  * engine can take into account the block's geometry, orientation, and whether it is being drawn in the BlockPicker or
+  * in the LevelWidget.
+  *
+  * There is a single SpriteEngine for the whole application, owned by the BlockManager.  Each BlockPrototype registers
+  * itself with addBlock() when it is created, and once every prototype exists, generateSprites() paints all the
+  * sprites for every registered block in every valid orientation in one go, spreading the work across worker threads.
+  * The results are packed into a single atlas pixmap with one row per block (numbered densely in the order the blocks
+  * were added) and one column per orientation.  Widgets that draw many sprites, like the BlockPicker and the
+  * LevelWidget, draw them straight from atlas() using spriteRect(); createSprite() cuts single sprites out of it for
+  * everything else.
   */
 class SpriteEngine {
  public:
   SpriteEngine();
+  ~SpriteEngine();
 
   /**
-    * Creates and returns a sprite pixmap that can be drawn to represent a block in 2D.  \p texture will be used as
-    * the basis for the sprite, with modifications made based on \p properties and \p orientation, if given.  To obtain
-    * a sprite suitable for the BlockPicker widget, pass BlockOrientation::paletteOrientation() as \p orientation.
-    * @note SpriteEngine caches pixmaps when possible, so this method is fairly inexpensive after the first time a
-    * particular block is seen in a particular orientation.
-    * @note The caching assumes that a particular \p properties parameter implies the same \p texture each time.
+    * Registers a block of type \p type, whose sprites will be based on \p texture and modified according to
+    * \p properties.  Blocks added after generateSprites() has been called are painted on demand instead.
     */
-  QPixmap createSprite(const Texture& texture, const BlockProperties& properties,
-                       const BlockOrientation* orientation = BlockOrientation::noOrientation());
+  void addBlock(blocktype_t type, const Texture& texture, const BlockProperties& properties);
+
+  /**
+    * Paints the sprites for every block registered with addBlock() in each of its orientations, and packs them into
+    * the atlas.  This blocks until all the sprites are painted.
+    */
+  void generateSprites();
+
+  /**
+    * Returns a sprite pixmap that can be drawn to represent a block of type \p type in 2D, modified based on
+    * \p orientation.  To obtain a sprite suitable for the BlockPicker widget, pass
+    * BlockOrientation::paletteOrientation() as \p orientation.
+    * @note The returned pixmap is cached, so every block of the same type and orientation shares the same pixmap data.
+    */
+  QPixmap createSprite(blocktype_t type, const BlockOrientation* orientation = BlockOrientation::noOrientation());
+
+  /**
+    * Returns the pixmap holding every sprite painted by generateSprites().
+    */
+  const QPixmap& atlas() const {
+    return atlas_;
+  }
+
+  /**
+    * Returns the dense id of blocks of type \p type, which is their row in the atlas, or -1 if there isn't one.
+    */
+  int blockId(blocktype_t type) const;
+
+  /**
+    * Returns the rectangle within atlas() holding the sprite for the block with id \p block_id in the orientation
+    * whose id is \p orientation_id, or a null rectangle if the sprite is not in the atlas.  Sprites for blocks added
+    * after generateSprites(), or for orientations a block doesn't support, are only available from createSprite().
+    */
+  QRect spriteRect(int block_id, int orientation_id) const;
 
  private:
-  typedef QPair<const BlockProperties*, const BlockOrientation*> CacheKey;
-  QMap<CacheKey, QPixmap> pixmap_cache_;
+  /// The source data for each block added using addBlock(), in the order in which they were added.
+  QList<SpriteRow*> rows_;
+
+  /// A map from block type to index in rows_.
+  QHash<blocktype_t, int> block_ids_;
+
+  /// Every sprite painted by generateSprites().
+  QPixmap atlas_;
+
+  /// The rectangle within atlas_ of each sprite in it, keyed on block id and orientation id.
+  QHash<QPair<int, int>, QRect> atlas_rects_;
+
+  /// The sprites that have been handed out by createSprite(), keyed on block id and orientation id.
+  QHash<QPair<int, int>, QPixmap> sprite_cache_;
 };
 
 #endif // SPRITE_ENGINE_H
@@ -44,7 +44,7 @@ class StairsRenderable : public BasicRenderable {
   virtual Geometry moveToOrigin(const Geometry& geometry);
   virtual void addGeometry(const Geometry& geometry, const TextureCoords& texture_coords);
 
-  virtual void applyOrientationTransform(const BlockOrientation* orientation) const;
+  virtual QMatrix4x4 orientationTransform(const BlockOrientation* orientation) const;
   virtual Texture textureForQuad(int index, const BlockOrientation* orientation) const;
 
   virtual TextureCoords createTextureCoordsForBlock(QVector<QVector3D> front, QVector<QVector3D> back);
@@ -0,0 +1,56 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "terrain_dialog.h"
+
+#include <QFileDialog>
+
+TerrainDialog::TerrainDialog(const QSize& size, int level, QWidget* parent) : QDialog(parent) {
+  ui.setupUi(this);
+  ui.x_spin_box_->setValue(-size.width() / 2);
+  ui.z_spin_box_->setValue(-size.height() / 2);
+  ui.level_spin_box_->setValue(level);
+  connect(ui.splat_map_button_, SIGNAL(clicked()), SLOT(browseForSplatMap()));
+  connect(ui.splat_map_line_edit_, SIGNAL(textChanged(QString)), SLOT(updateSurfaceDepth()));
+  updateSurfaceDepth();
+}
+
+BlockPosition TerrainDialog::origin() const {
+  return BlockPosition(ui.x_spin_box_->value(), ui.level_spin_box_->value(), ui.z_spin_box_->value());
+}
+
+int TerrainDialog::maximumHeight() const {
+  return ui.height_spin_box_->value();
+}
+
+QString TerrainDialog::splatMapFilename() const {
+  return ui.splat_map_line_edit_->text();
+}
+
+int TerrainDialog::surfaceDepth() const {
+  return ui.surface_depth_spin_box_->value();
+}
+
+void TerrainDialog::browseForSplatMap() {
+  QString filename = QFileDialog::getOpenFileName(this, "Choose Splat Map", ui.splat_map_line_edit_->text(),
+                                                  "Images (*.png *.gif *.bmp *.jpg *.jpeg)");
+  if (!filename.isEmpty()) {
+    ui.splat_map_line_edit_->setText(filename);
+  }
+}
+
+void TerrainDialog::updateSurfaceDepth() {
+  ui.surface_depth_spin_box_->setEnabled(!ui.splat_map_line_edit_->text().isEmpty());
+}
@@ -0,0 +1,71 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TERRAIN_DIALOG_H
+#define TERRAIN_DIALOG_H
+
+#include "block_position.h"
+#include "ui_terrain_dialog.h"
+
+/**
+  * The dialog that asks where to build terrain from a heightmap, how high to make it, and optionally which splat map
+  * to take its surface blocks from (see LevelWidget::generateTerrain()).
+  */
+class TerrainDialog : public QDialog {
+  Q_OBJECT
+
+ public:
+  /**
+    * Constructs a dialog for building terrain from a heightmap of \p size pixels, placing it on \p level by default.
+    * The terrain starts out centered on the origin.
+    */
+  TerrainDialog(const QSize& size, int level, QWidget* parent = NULL);
+
+  /**
+    * Returns where the corner of the terrain at its west, north and bottom edges should go.
+    */
+  BlockPosition origin() const;
+
+  /**
+    * Returns how tall the columns for white pixels should be.
+    */
+  int maximumHeight() const;
+
+  /**
+    * Returns the path of the splat map to choose surface blocks from, or an empty string if there isn't one.
+    */
+  QString splatMapFilename() const;
+
+  /**
+    * Returns how many blocks at the top of each column should be taken from the splat map.
+    */
+  int surfaceDepth() const;
+
+ private slots:
+  /**
+    * Asks for the splat map.
+    */
+  void browseForSplatMap();
+
+  /**
+    * Only enables the surface depth when there is a splat map to take the surface from.
+    */
+  void updateSurfaceDepth();
+
+ private:
+  Ui::TerrainDialog ui;
+};
+
+#endif // TERRAIN_DIALOG_H
@@ -0,0 +1,175 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "terrain_generator.h"
+
+#include <QList>
+#include <QtConcurrentMap>
+
+#include "block_prototype.h"
+#include "chunk.h"
+#include "chunk_position.h"
+#include "image_converter.h"
+
+/**
+  * One chunk column of the terrain to be filled in.
+  */
+class TerrainColumnJob {
+ public:
+  TerrainColumnJob(int chunk_x, int chunk_z, int width, int depth, const QVector<qint16>* heights,
+                   const QVector<BlockPrototype*>* surfaces, BlockPrototype* ground, int surface_depth)
+      : chunk_x_(chunk_x), chunk_z_(chunk_z), width_(width), depth_(depth), heights_(heights), surfaces_(surfaces),
+        ground_(ground), surface_depth_(surface_depth) {}
+
+  /**
+    * Returns the position of the column in the terrain, in chunks.
+    */
+  int chunkX() const {
+    return chunk_x_;
+  }
+  int chunkZ() const {
+    return chunk_z_;
+  }
+
+  /**
+    * Returns the size of the whole terrain along x and z.
+    */
+  int width() const {
+    return width_;
+  }
+  int depth() const {
+    return depth_;
+  }
+
+  /**
+    * Returns the height of the column of blocks at \p x, \p z.
+    */
+  int height(int x, int z) const {
+    return heights_->at(z * width_ + x);
+  }
+
+  /**
+    * Returns the block at \p level of the column of blocks at \p x, \p z, which must be below the column's height.
+    */
+  BlockPrototype* block(int x, int z, int level) const {
+    if (surfaces_->isEmpty() || level < height(x, z) - surface_depth_) {
+      return ground_;
+    }
+    BlockPrototype* surface = surfaces_->at(z * width_ + x);
+    return surface ? surface : ground_;
+  }
+
+ private:
+  int chunk_x_;
+  int chunk_z_;
+  int width_;
+  int depth_;
+  const QVector<qint16>* heights_;
+  const QVector<BlockPrototype*>* surfaces_;
+  BlockPrototype* ground_;
+  int surface_depth_;
+};
+
+/**
+  * Returns the layers holding the terrain in the chunk column of \p job.
+  */
+static QList<BlockClipboard::Layer> fillTerrainColumn(const TerrainColumnJob& job) {
+  int first_x = job.chunkX() * kChunkSize;
+  int first_z = job.chunkZ() * kChunkSize;
+  int last_x = qMin(first_x + kChunkMask, job.width() - 1);
+  int last_z = qMin(first_z + kChunkMask, job.depth() - 1);
+  int column_height = 0;
+  for (int z = first_z; z <= last_z; ++z) {
+    for (int x = first_x; x <= last_x; ++x) {
+      column_height = qMax(column_height, job.height(x, z));
+    }
+  }
+
+  // Each column is one run of ground from the bottom level up, capped by a run of its surface block.
+  QVector<ChunkLayer> layers(column_height);
+  for (int z = first_z; z <= last_z; ++z) {
+    for (int x = first_x; x <= last_x; ++x) {
+      int cell = ChunkLayer::cellIndex(x & kChunkMask, z & kChunkMask);
+      for (int level = 0; level < job.height(x, z); ++level) {
+        BlockPrototype* prototype = job.block(x, z, level);
+        layers[level].setBlock(cell, prototype, prototype->defaultOrientation());
+      }
+    }
+  }
+
+  QList<BlockClipboard::Layer> result;
+  for (int level = 0; level < column_height; ++level) {
+    ChunkPosition chunk_position(job.chunkX(), ChunkPosition::chunkCoordinate(level), job.chunkZ());
+    result.append(BlockClipboard::Layer(chunk_position, ChunkPosition::localCoordinate(level), layers.at(level)));
+  }
+  return result;
+}
+
+TerrainGenerator::TerrainGenerator(const QImage& heightmap, int maximum_height, BlockPrototype* ground)
+    : width_(heightmap.width()), depth_(heightmap.height()), height_(0), ground_(ground), surface_depth_(0) {
+  Q_ASSERT(maximum_height > 0);
+  QImage argb_heightmap = heightmap.convertToFormat(QImage::Format_ARGB32);
+  heights_.reserve(width_ * depth_);
+  for (int y = 0; y < depth_; ++y) {
+    const QRgb* line = reinterpret_cast<const QRgb*>(argb_heightmap.constScanLine(y));
+    for (int x = 0; x < width_; ++x) {
+      int height = 0;
+      if (qAlpha(line[x]) >= ImageConverter::kOpaqueAlpha) {
+        height = 1 + (qGray(line[x]) * (maximum_height - 1) + 127) / 255;
+      }
+      heights_.append(height);
+      height_ = qMax(height_, height);
+    }
+  }
+}
+
+void TerrainGenerator::setSplatMap(const QImage& splat_map, const ImageConverter& palette, int surface_depth) {
+  surface_depth_ = surface_depth;
+  surfaces_.clear();
+  if (!palette.paletteSize()) {
+    return;
+  }
+  QImage argb_splat_map = splat_map.scaled(width_, depth_).convertToFormat(QImage::Format_ARGB32);
+  surfaces_.reserve(width_ * depth_);
+  for (int y = 0; y < depth_; ++y) {
+    const QRgb* line = reinterpret_cast<const QRgb*>(argb_splat_map.constScanLine(y));
+    for (int x = 0; x < width_; ++x) {
+      BlockPrototype* surface = NULL;
+      if (qAlpha(line[x]) >= ImageConverter::kOpaqueAlpha) {
+        float l, a, b;
+        palette.toLab(line[x], &l, &a, &b);
+        surface = palette.block(palette.nearestBlock(l, a, b));
+      }
+      surfaces_.append(surface);
+    }
+  }
+}
+
+BlockClipboard TerrainGenerator::generate() const {
+  if (!height_) {
+    return BlockClipboard();
+  }
+  QList<TerrainColumnJob> jobs;
+  for (int chunk_z = 0; chunk_z * kChunkSize < depth_; ++chunk_z) {
+    for (int chunk_x = 0; chunk_x * kChunkSize < width_; ++chunk_x) {
+      jobs.append(TerrainColumnJob(chunk_x, chunk_z, width_, depth_, &heights_, &surfaces_, ground_, surface_depth_));
+    }
+  }
+  QList<QList<BlockClipboard::Layer> > results =
+      QtConcurrent::blockingMapped<QList<QList<BlockClipboard::Layer> > >(jobs, fillTerrainColumn);
+  BlockClipboard clipboard(width_, height_, depth_);
+  clipboard.setLayers(results);
+  return clipboard;
+}
@@ -0,0 +1,100 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TERRAIN_GENERATOR_H
+#define TERRAIN_GENERATOR_H
+
+#include <QImage>
+#include <QVector>
+
+#include "block_clipboard.h"
+
+class BlockPrototype;
+class ImageConverter;
+
+/**
+  * Builds terrain from a grayscale heightmap, so that the ground under a build doesn't have to be laid out by hand a
+  * level at a time.
+  *
+  * Each pixel of the heightmap becomes a column of blocks standing on the bottom level, from one block tall where the
+  * pixel is black to a chosen maximum height where it is white.  Pixels that are more than half transparent leave
+  * their column empty.  The columns are made of a single ground block, except that a splat map may be given to choose
+  * the blocks for the top few levels of each column by color, the same way ImageConverter turns pixels into blocks.
+  *
+  * The heights and surface blocks are worked out for every column first.  Then each chunk column of the result is
+  * filled in parallel on the global thread pool, one run of blocks per column, straight into chunk layers.
+  */
+class TerrainGenerator {
+ public:
+  /**
+    * Prepares to build the terrain described by \p heightmap, with columns up to \p maximum_height blocks tall made
+    * of \p ground.
+    */
+  TerrainGenerator(const QImage& heightmap, int maximum_height, BlockPrototype* ground);
+
+  /**
+    * Makes the top \p surface_depth blocks of each column the block in \p palette closest in color to the column's
+    * pixel in \p splat_map.  If the splat map isn't the same size as the heightmap, it is stretched to fit.
+    */
+  void setSplatMap(const QImage& splat_map, const ImageConverter& palette, int surface_depth);
+
+  /**
+    * Returns the number of blocks the terrain spans along x, which is the width of the heightmap.
+    */
+  int width() const {
+    return width_;
+  }
+
+  /**
+    * Returns the number of blocks the terrain spans along z, which is the height of the heightmap.
+    */
+  int depth() const {
+    return depth_;
+  }
+
+  /**
+    * Returns the number of levels the terrain spans, which is the height of its tallest column.
+    */
+  int height() const {
+    return height_;
+  }
+
+  /**
+    * Returns a clipboard holding the terrain, with the column for pixel (_x_, _y_) of the heightmap at block
+    * (_x_, 0, _y_), so that the top of the heightmap is to the north.  The clipboard is as tall as the tallest column,
+    * and holds air above the ground.
+    */
+  BlockClipboard generate() const;
+
+ private:
+  int width_;
+  int depth_;
+  int height_;
+  BlockPrototype* ground_;
+  int surface_depth_;
+
+  /**
+    * The height of each column, a row of the heightmap at a time.
+    */
+  QVector<qint16> heights_;
+
+  /**
+    * The block for the top surface_depth_ levels of each column, or NULL where the column is all ground.  Empty if
+    * there is no splat map.
+    */
+  QVector<BlockPrototype*> surfaces_;
+};
+
+#endif // TERRAIN_GENERATOR_H
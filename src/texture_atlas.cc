@@ -0,0 +1,65 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "texture_atlas.h"
+
+#include <QDebug>
+#include <QPainter>
+
+/**
+  * The size of the cells if no texture has been added to size them by.
+  */
+static const int kDefaultCellSize = 16;
+
+TextureAtlas::TextureAtlas() {
+}
+
+int TextureAtlas::cellFor(const Texture& texture) {
+  QHash<GLuint, int>::const_iterator iter = cells_.constFind(texture.textureId());
+  if (iter != cells_.constEnd()) {
+    return iter.value();
+  }
+  if (pixmaps_.size() == kAtlasColumns * kAtlasColumns) {
+    qWarning() << "Texture atlas is full; reusing its last cell";
+    return pixmaps_.size() - 1;
+  }
+  int cell = pixmaps_.size();
+  pixmaps_.append(texture.texturePixmap());
+  cells_.insert(texture.textureId(), cell);
+  return cell;
+}
+
+// static
+QVector2D TextureAtlas::mapTextureCoord(int cell, const QVector2D& tex_coord) {
+  // Cells are laid out in rows from the top of the image down, but v counts up from the bottom.
+  qreal u = qBound(0.0, static_cast<qreal>(tex_coord.x()), 1.0);
+  qreal v = qBound(0.0, static_cast<qreal>(tex_coord.y()), 1.0);
+  int column = cell % kAtlasColumns;
+  int row = cell / kAtlasColumns;
+  return QVector2D((column + u) / kAtlasColumns, 1.0 - (row + 1.0 - v) / kAtlasColumns);
+}
+
+QImage TextureAtlas::image() const {
+  int cell_size = pixmaps_.isEmpty() ? kDefaultCellSize : pixmaps_.first().width();
+  QImage atlas(cell_size * kAtlasColumns, cell_size * kAtlasColumns, QImage::Format_ARGB32);
+  atlas.fill(Qt::transparent);
+  QPainter painter(&atlas);
+  for (int cell = 0; cell < pixmaps_.size(); ++cell) {
+    QRect target((cell % kAtlasColumns) * cell_size, (cell / kAtlasColumns) * cell_size, cell_size, cell_size);
+    painter.drawPixmap(target, pixmaps_.at(cell));
+  }
+  painter.end();
+  return atlas;
+}
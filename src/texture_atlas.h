@@ -0,0 +1,72 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QPixmap>
+#include <QVector2D>
+
+#include "texture.h"
+
+/**
+  * Packs the textures of exported geometry into a single image, so that a whole mesh can be drawn with one material.
+  *
+  * The atlas is a fixed grid of kAtlasColumns x kAtlasColumns cells, which is far more than the distinct textures any
+  * texture pack has, and which lets texture coordinates be mapped into the atlas as soon as a texture is first seen,
+  * before it is known how many textures there will be.  Every cell is as large as the first texture added.
+  */
+class TextureAtlas {
+ public:
+  /**
+    * The number of cells along each side of the atlas.
+    */
+  static const int kAtlasColumns = 32;
+
+  TextureAtlas();
+
+  /**
+    * Returns the cell holding \p texture, adding it to the atlas if this is the first time it has been seen.  If the
+    * atlas is full, warns and returns the last cell.
+    */
+  int cellFor(const Texture& texture);
+
+  /**
+    * Maps \p tex_coord, a texture coordinate within the texture in \p cell, to a coordinate within the whole atlas.
+    * As in OpenGL, _v_ runs from 0 at the bottom of the image to 1 at the top.
+    */
+  static QVector2D mapTextureCoord(int cell, const QVector2D& tex_coord);
+
+  /**
+    * Returns whether no textures have been added.
+    */
+  bool isEmpty() const {
+    return pixmaps_.isEmpty();
+  }
+
+  /**
+    * Returns the atlas image, with every texture that has been added drawn into its cell.
+    */
+  QImage image() const;
+
+ private:
+  QHash<GLuint, int> cells_;
+  QList<QPixmap> pixmaps_;
+};
+
+#endif // TEXTURE_ATLAS_H
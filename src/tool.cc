@@ -13,10 +13,16 @@
  * limitations under the License.
  */
 
+#include "block_instance.h"
 #include "block_position.h"
 #include "tool.h"
 
-Tool::Tool() : state_(kInitial) {}
+Tool::Tool()
+    : state_(kInitial),
+      preview_prototype_(NULL),
+      preview_orientation_(NULL),
+      has_preview_(false) {
+}
 Tool::~Tool() {}
 
 void Tool::setStateFrom(Tool* other) {
@@ -25,6 +31,7 @@ void Tool::setStateFrom(Tool* other) {
     positions_.replace(i, other->positionAtIndex(i));
   }
   setState(kInitial);
+  resetPreview();
 }
 
 void Tool::proposePosition(const BlockPosition& position) {
@@ -64,6 +71,36 @@ void Tool::setPositionAtIndex(int index, const BlockPosition& position) {
 void Tool::clear() {
   positions_.clear();
   setState(kInitial);
+  resetPreview();
+}
+
+bool Tool::drawPreview(BlockPrototype* prototype,
+                       const BlockOrientation* orientation,
+                       BlockTransaction* retracted,
+                       BlockTransaction* transaction) {
+  BlockTransaction drawing;
+  draw(prototype, orientation, &drawing);
+  bool is_incremental = continuePreview(prototype, orientation);
+  if (is_incremental) {
+    preview_.difference(drawing, retracted, transaction);
+  } else {
+    *transaction = drawing;
+  }
+  preview_ = drawing;
+  return is_incremental;
+}
+
+void Tool::resetPreview() {
+  preview_ = BlockTransaction();
+  has_preview_ = false;
+}
+
+bool Tool::continuePreview(BlockPrototype* prototype, const BlockOrientation* orientation) {
+  bool continues = has_preview_ && prototype == preview_prototype_ && orientation == preview_orientation_;
+  preview_prototype_ = prototype;
+  preview_orientation_ = orientation;
+  has_preview_ = true;
+  return continues;
 }
 
 BlockPosition Tool::positionAtIndex(int index) const {
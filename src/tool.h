@@ -20,10 +20,11 @@
 #include <QObject>
 #include <QVector>
 
+#include "block_transaction.h"
+
 class BlockOrientation;
 class BlockPosition;
 class BlockPrototype;
-class BlockTransaction;
 
 /**
   * An abstract class representing a particular method of drawing blocks given one or more positions.
@@ -52,6 +53,10 @@ class BlockTransaction;
   * (including proposed positions) by calling draw().  Whether you should actually commit the transaction depends on
   * whether the tool wants more positions and, more generally, whether the user has signaled their intent to finish the
   * interaction.
+  *
+  * While the user is still choosing positions, views show what the tool would do by calling drawPreview() instead.
+  * Rather than the whole drawing, it describes how the drawing has changed since the previous preview, so that
+  * dragging out a large shape only costs as much as the part of it that actually moved.
   */
 class Tool : public QObject {
  public:
@@ -110,6 +115,35 @@ class Tool : public QObject {
     */
   virtual void draw(BlockPrototype* prototype, const BlockOrientation* orientation, BlockTransaction* transaction) = 0;
 
+  /**
+    * Describes how the result of draw() has changed since the last call to drawPreview(), so that a view showing the
+    * tool's proposal only has to touch the cells that changed.  Taking back the changes in \p retracted and then
+    * making those in \p transaction turns the previous preview into the current one (see Diagram::patchEphemeral()).
+    *
+    * The default implementation calls draw() and compares the result with the previous one using
+    * BlockTransaction::difference().  ShapeTool compares the shapes' span masks instead, so that cells which stay
+    * inside or outside the shape are never visited at all.
+    *
+    * @param prototype The prototype for the block the tool should use when drawing.
+    * @param orientation The orientation that added blocks should have.
+    * @param[out] retracted Receives the changes from the previous preview that are no longer part of this one.
+    * @param[out] transaction Receives the changes in this preview that were not part of the previous one.
+    * @returns \c true if the result is relative to the previous preview.  If there was no previous preview, or it was
+    *     drawn with a different \p prototype or \p orientation, returns \c false, leaves \p retracted empty, and
+    *     fills \p transaction with the whole drawing just as draw() would.
+    */
+  virtual bool drawPreview(BlockPrototype* prototype,
+                           const BlockOrientation* orientation,
+                           BlockTransaction* retracted,
+                           BlockTransaction* transaction);
+
+  /**
+    * Forgets the previous preview, so that the next call to drawPreview() describes the whole drawing.  This happens
+    * automatically in clear() and setStateFrom(); views should also call it whenever they throw away what they were
+    * showing as the preview.
+    */
+  virtual void resetPreview();
+
  protected:
   /**
     * Describes the state of this tool.  The state of the tool determines what happens when proposePosition() is called:
@@ -177,9 +211,22 @@ class Tool : public QObject {
     */
   virtual BlockPosition positionAtIndex(int index) const;
 
+  /**
+    * Notes that a preview is being drawn with \p prototype and \p orientation, and returns whether it continues the
+    * previous one; that is, whether there is a previous preview and it was drawn with the same prototype and
+    * orientation.  For use by implementations of drawPreview().
+    */
+  bool continuePreview(BlockPrototype* prototype, const BlockOrientation* orientation);
+
  private:
   QVector<BlockPosition> positions_;
   State state_;
+
+  /// The result of draw() for the previous preview, as used by the default implementation of drawPreview().
+  BlockTransaction preview_;
+  BlockPrototype* preview_prototype_;
+  const BlockOrientation* preview_orientation_;
+  bool has_preview_;
 };
 
 #endif // TOOL_H
@@ -145,19 +145,21 @@ void TorchRenderable::addGeometry(const Geometry& geometry, const TextureCoords&
           slanted_geometry[0][kBottomLeftCorner], slanted_geometry[0][kTopLeftCorner], texture_coords.at(4));   // Left
 }
 
-void TorchRenderable::applyOrientationTransform(const BlockOrientation* orientation) const {
-  if (orientation == BlockOrientation::get("On north wall")) {
-    glRotatef(-90.0f, 0.0f, 1.0f, 0.0f);
-  } else if (orientation == BlockOrientation::get("On east wall")) {
-    glRotatef(180.0f, 0.0f, 1.0f, 0.0f);
-  } else if (orientation == BlockOrientation::get("On south wall")) {
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
+QMatrix4x4 TorchRenderable::orientationTransform(const BlockOrientation* orientation) const {
+  QMatrix4x4 transform;
+  if (orientation->id() == BlockOrientation::kOrientationOnNorthWall) {
+    transform.rotate(-90.0f, 0.0f, 1.0f, 0.0f);
+  } else if (orientation->id() == BlockOrientation::kOrientationOnEastWall) {
+    transform.rotate(180.0f, 0.0f, 1.0f, 0.0f);
+  } else if (orientation->id() == BlockOrientation::kOrientationOnSouthWall) {
+    transform.rotate(90.0f, 0.0f, 1.0f, 0.0f);
   }
+  return transform;
 }
 
 bool TorchRenderable::shouldRenderQuad(int index, const QVector3D& location,
                                        const BlockOrientation* orientation) const {
-  if (orientation == BlockOrientation::get("On floor")) {
+  if (orientation->id() == BlockOrientation::kOrientationOnFloor) {
     return index < 5;
   } else {
     return index >= 5;
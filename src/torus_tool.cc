@@ -0,0 +1,58 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "torus_tool.h"
+
+#include "span_mask.h"
+
+/**
+  * Returns the largest integer whose square is at most \p n, which must not be negative.
+  */
+static qint64 integerSquareRoot(qint64 n) {
+  Q_ASSERT(n >= 0);
+  if (n < 2) {
+    return n;
+  }
+  // Newton's method, started above the root so that it descends onto it.
+  qint64 root = n;
+  qint64 next = (root + 1) / 2;
+  while (next < root) {
+    root = next;
+    next = (root + n / root) / 2;
+  }
+  return root;
+}
+
+TorusTool::TorusTool(Diagram* diagram) : SolidTool(diagram) {}
+
+QString TorusTool::actionName() const {
+  return "Draw Torus";
+}
+
+int TorusTool::heightForFootprint(int width, int depth) const {
+  // The tube is a quarter as thick as the torus is wide, leaving a hole half as wide as the torus.
+  return (qMin(width, depth) + 2) / 4;
+}
+
+void TorusTool::rasterizeLevel(SpanMask* mask, int level, int height) {
+  // Measured in units of the footprint ellipse, the tube has a radius of 1/4 around a circle of radius 3/4.  At w half
+  // blocks above or below the middle of the tube, it therefore spans radii of 3/4 +/- sqrt(1 - w^2 / height^2) / 4,
+  // which is (12 * height +/- q) / (16 * height) for q = sqrt(16 * (height^2 - w^2)).  Rounding q down to an integer
+  // is the only inexact step.
+  qint64 w = 2 * level + 1 - height;
+  qint64 q = integerSquareRoot(16 * (qint64(height) * height - w * w));
+  qint64 middle = 12 * qint64(height);
+  addEllipticRing(mask, level, (middle + q) * (middle + q), (middle - q) * (middle - q), 256 * qint64(height) * height);
+}
@@ -0,0 +1,36 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TORUS_TOOL_H
+#define TORUS_TOOL_H
+
+#include "solid_tool.h"
+
+class Diagram;
+
+/**
+  * A Tool that draws flat tori whose outer edge is the circle or ellipse filling the footprint between two corners.
+  */
+class TorusTool : public SolidTool {
+ public:
+  explicit TorusTool(Diagram* diagram);
+  virtual QString actionName() const;
+
+ protected:
+  virtual int heightForFootprint(int width, int depth) const;
+  virtual void rasterizeLevel(SpanMask* mask, int level, int height);
+};
+
+#endif // TORUS_TOOL_H
@@ -113,19 +113,21 @@ void TrackRenderable::addGeometry(const Geometry& geometry, const TextureCoords&
           geometry[0][kTopRightCorner], geometry[0][kTopLeftCorner], texture_coords[2]);
 }
 
-void TrackRenderable::applyOrientationTransform(const BlockOrientation* orientation) const {
-  if (orientation == BlockOrientation::get("Running east/west")) {
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-  } else if (orientation == BlockOrientation::get("Ascending east")) {
-    glRotatef(-90.0f, 0.0f, 1.0f, 0.0f);
-  } else if (orientation == BlockOrientation::get("Ascending south")) {
-    glRotatef(180.0f, 0.0f, 1.0f, 0.0f);
-  } else if (orientation == BlockOrientation::get("Ascending west")) {
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f);
-  } else if (orientation == BlockOrientation::get("Southeast corner") ||
-             orientation == BlockOrientation::get("Southwest corner")) {
-    glRotatef(180.0f, 0.0f, 1.0f, 0.0f);
+QMatrix4x4 TrackRenderable::orientationTransform(const BlockOrientation* orientation) const {
+  QMatrix4x4 transform;
+  if (orientation->id() == BlockOrientation::kOrientationRunningEastWest) {
+    transform.rotate(90.0f, 0.0f, 1.0f, 0.0f);
+  } else if (orientation->id() == BlockOrientation::kOrientationAscendingEast) {
+    transform.rotate(-90.0f, 0.0f, 1.0f, 0.0f);
+  } else if (orientation->id() == BlockOrientation::kOrientationAscendingSouth) {
+    transform.rotate(180.0f, 0.0f, 1.0f, 0.0f);
+  } else if (orientation->id() == BlockOrientation::kOrientationAscendingWest) {
+    transform.rotate(90.0f, 0.0f, 1.0f, 0.0f);
+  } else if (orientation->id() == BlockOrientation::kOrientationSoutheastCorner ||
+             orientation->id() == BlockOrientation::kOrientationSouthwestCorner) {
+    transform.rotate(180.0f, 0.0f, 1.0f, 0.0f);
   }
+  return transform;
 }
 
 bool TrackRenderable::shouldRenderQuad(int index,
@@ -135,15 +137,15 @@ bool TrackRenderable::shouldRenderQuad(int index,
     case 0:  // Normal flat quad.
     case 1:
       return !orientation->name().contains("Ascending") &&
-             !(orientation == BlockOrientation::get("Southwest corner") ||
-               orientation == BlockOrientation::get("Northeast corner"));
+             !(orientation->id() == BlockOrientation::kOrientationSouthwestCorner ||
+               orientation->id() == BlockOrientation::kOrientationNortheastCorner);
     case 2:  // Ascending quad, top.
     case 3:  // Ascending quad, bottom.
       return orientation->name().contains("Ascending");
     case 4:  // Reversed flat quad.
     case 5:
-      return orientation == BlockOrientation::get("Southwest corner") ||
-             orientation == BlockOrientation::get("Northeast corner");
+      return orientation->id() == BlockOrientation::kOrientationSouthwestCorner ||
+             orientation->id() == BlockOrientation::kOrientationNortheastCorner;
     default:
       return false;
   }
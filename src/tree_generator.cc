@@ -0,0 +1,109 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tree_generator.h"
+
+#include <math.h>
+
+/**
+  * A small, fast random number generator (SplitMix32) whose whole state is one integer, so that every tree can have its
+  * own.
+  */
+class TreeRandom {
+ public:
+  explicit TreeRandom(quint32 seed) : state_(seed) {}
+
+  quint32 next() {
+    state_ += 0x9E3779B9u;
+    quint32 z = state_;
+    z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+    return z ^ (z >> 16);
+  }
+
+  /**
+    * Returns a number uniformly distributed in [-1, 1].
+    */
+  double uniform() {
+    return next() / 2147483647.5 - 1.0;
+  }
+
+  /**
+    * Returns a number drawn from the standard normal distribution, using the Marsaglia polar method.
+    */
+  double normal() {
+    double u, v, r;
+    do {
+      u = uniform();
+      v = uniform();
+      r = u * u + v * v;
+    } while (r == 0.0 || r > 1.0);
+    return u * sqrt(-2.0 * log(r) / r);
+  }
+
+  /**
+    * Returns an integer in [\p min, \p max], normally distributed around the middle of the range with the ends of the
+    * range one standard deviation away.
+    */
+  int normalRange(int min, int max) {
+    return qBound(min, qRound(normal() * (max - min) / 2.0 + (min + max) / 2.0), max);
+  }
+
+ private:
+  quint32 state_;
+};
+
+TreeGenerator::TreeGenerator(quint32 seed) : seed_(seed) {
+  TreeRandom random(seed);
+  trunk_height_ = random.normalRange(3, 5);
+  canopy_radius_ = random.normalRange(2, 4) + (trunk_height_ - 3);
+  clip_radius_ = canopy_radius_ - 1;
+  canopy_offset_ = random.normalRange(1, 2);
+}
+
+void TreeGenerator::grow(const BlockPosition& base, QList<BlockPosition>* trunk, QList<BlockPosition>* leaves) const {
+  for (int i = 0; i < trunk_height_; ++i) {
+    trunk->append(base + BlockPosition(0, i, 0));
+  }
+
+  // The leaves draw from their own generator, so the shape chosen in the constructor doesn't decide which of them are
+  // left out.
+  TreeRandom random(seed_ ^ 0x5BD1E995u);
+  BlockPosition canopy_center = base + BlockPosition(0, trunk_height_ - canopy_offset_, 0);
+  int squared_radius = canopy_radius_ * canopy_radius_;
+  for (int x = -clip_radius_; x <= clip_radius_; ++x) {
+    for (int y = 0; y <= canopy_radius_; ++y) {
+      for (int z = -clip_radius_; z <= clip_radius_; ++z) {
+        int squared_distance = x * x + y * y + z * z;
+        bool in_trunk = (x == 0 && z == 0 && canopy_center.y() + y < base.y() + trunk_height_);
+        if (squared_distance > squared_radius || in_trunk) {
+          continue;
+        }
+        // Leaves on the edge of the canopy are only there half the time.
+        if (squared_distance < squared_radius || (random.next() & 1)) {
+          leaves->append(canopy_center + BlockPosition(x, y, z));
+        }
+      }
+    }
+  }
+}
+
+// Static.
+blocktype_t TreeGenerator::leafType(blocktype_t wood_type) {
+  if ((wood_type & 0xFFFF) == 0x11 || (wood_type & 0xFFFF) == 0x05) {  // This tree is made of wood.
+    return (wood_type & 0xFF0000) + 0x12;  // Select the leaves for that type of wood.
+  }
+  return 0x12;  // Oak leaves by default.
+}
@@ -0,0 +1,64 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TREE_GENERATOR_H
+#define TREE_GENERATOR_H
+
+#include <QList>
+
+#include "block_position.h"
+#include "block_type.h"
+
+/**
+  * Works out the shape of a tree: a trunk a few blocks tall topped by a rough dome of leaves, with a ragged edge.
+  *
+  * The shape is a pure function of the seed, drawn from a random number generator belonging to the tree rather than
+  * from qrand(), so the same seed always grows the same tree, and trees can be grown on any thread at once.
+  */
+class TreeGenerator {
+ public:
+  /**
+    * Picks the size and proportions of the tree grown from \p seed.
+    */
+  explicit TreeGenerator(quint32 seed);
+
+  /**
+    * Returns how many blocks tall the trunk is.
+    */
+  int trunkHeight() const {
+    return trunk_height_;
+  }
+
+  /**
+    * Appends to \p trunk the positions of the trunk of the tree standing at \p base, from the bottom up, and to
+    * \p leaves the positions of its leaves.  No position is in both lists.
+    */
+  void grow(const BlockPosition& base, QList<BlockPosition>* trunk, QList<BlockPosition>* leaves) const;
+
+  /**
+    * Returns the type of leaves that go with a trunk of \p wood_type: the matching leaves for logs and planks of any
+    * kind of wood, or oak leaves for anything else.
+    */
+  static blocktype_t leafType(blocktype_t wood_type);
+
+ private:
+  quint32 seed_;
+  int trunk_height_;
+  int canopy_radius_;
+  int clip_radius_;
+  int canopy_offset_;
+};
+
+#endif // TREE_GENERATOR_H
@@ -36,11 +36,11 @@ class TreeTool : public Tool {
   BlockOracle* oracle_;
   BlockManager* block_manager_;
 
-  int trunk_height_;
-  int canopy_radius_;
-  int clip_radius_;
-  int canopy_offset_;
-  int foliage_seed_;
+  /**
+    * The seed of the tree being planted (see TreeGenerator).  It only changes once a tree has been planted, so the
+    * preview shows the tree that will actually be planted.
+    */
+  quint32 tree_seed_;
 };
 
 #endif // TREE_TOOL_H
@@ -0,0 +1,197 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "triangle_mesh.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QtEndian>
+
+#include <string.h>
+
+/**
+  * The size of the header that starts a binary STL file, before the triangle count.
+  */
+static const int kStlHeaderSize = 80;
+
+/**
+  * The size of each triangle in a binary STL file: a normal, three corners, and two bytes of attributes.
+  */
+static const int kStlTriangleSize = 50;
+
+/**
+  * Parses the first three numbers of \p fields, starting at \p first, as a point.
+  * @return Whether there were three numbers to parse.
+  */
+static bool parsePoint(const QList<QByteArray>& fields, int first, QVector3D* point) {
+  if (fields.size() < first + 3) {
+    return false;
+  }
+  bool ok_x = false;
+  bool ok_y = false;
+  bool ok_z = false;
+  *point = QVector3D(fields.at(first).toFloat(&ok_x),
+                     fields.at(first + 1).toFloat(&ok_y),
+                     fields.at(first + 2).toFloat(&ok_z));
+  return ok_x && ok_y && ok_z;
+}
+
+/**
+  * Reads the vertices and faces of the Wavefront OBJ file \p file into \p mesh.  Faces refer to vertices by their
+  * one-based index, or by a negative index counting back from the last vertex read.
+  */
+static bool readObj(QFile* file, TriangleMesh* mesh, QString* error) {
+  QVector<QVector3D> vertices;
+  int line_number = 0;
+  while (!file->atEnd()) {
+    QByteArray line = file->readLine().simplified();
+    ++line_number;
+    if (line.startsWith("v ")) {
+      QVector3D vertex;
+      if (!parsePoint(line.split(' '), 1, &vertex)) {
+        *error = QString("Line %1 has a vertex without three coordinates.").arg(line_number);
+        return false;
+      }
+      vertices.append(vertex);
+    } else if (line.startsWith("f ")) {
+      QList<QByteArray> fields = line.split(' ');
+      QVector<int> indices;
+      for (int i = 1; i < fields.size(); ++i) {
+        // Each corner is vertex/texture/normal, of which only the vertex matters.
+        bool ok = false;
+        int index = fields.at(i).split('/').first().toInt(&ok);
+        index = index < 0 ? vertices.size() + index : index - 1;
+        if (!ok || index < 0 || index >= vertices.size()) {
+          *error = QString("Line %1 has a face with a corner that isn't a vertex.").arg(line_number);
+          return false;
+        }
+        indices.append(index);
+      }
+      for (int i = 2; i < indices.size(); ++i) {
+        mesh->addTriangle(vertices.at(indices.at(0)), vertices.at(indices.at(i - 1)), vertices.at(indices.at(i)));
+      }
+    }
+  }
+  return true;
+}
+
+/**
+  * Reads the triangles of the binary STL file \p data into \p mesh.  The caller has already checked that \p data is
+  * exactly as long as the triangle count in its header says.
+  */
+static void readBinaryStl(const QByteArray& data, TriangleMesh* mesh) {
+  const uchar* bytes = reinterpret_cast<const uchar*>(data.constData());
+  quint32 count = qFromLittleEndian<quint32>(bytes + kStlHeaderSize);
+  const uchar* triangle = bytes + kStlHeaderSize + 4;
+  for (quint32 i = 0; i < count; ++i, triangle += kStlTriangleSize) {
+    QVector3D corners[3];
+    for (int corner = 0; corner < 3; ++corner) {
+      float coordinates[3];
+      for (int axis = 0; axis < 3; ++axis) {
+        // Skip the facet normal, which the corners' winding already gives.
+        quint32 bits = qFromLittleEndian<quint32>(triangle + 12 + corner * 12 + axis * 4);
+        memcpy(&coordinates[axis], &bits, sizeof(bits));
+      }
+      corners[corner] = QVector3D(coordinates[0], coordinates[1], coordinates[2]);
+    }
+    mesh->addTriangle(corners[0], corners[1], corners[2]);
+  }
+}
+
+/**
+  * Reads the triangles of the ASCII STL file \p data into \p mesh, taking every three vertex lines as a triangle and
+  * ignoring the facet and loop lines around them.
+  */
+static bool readAsciiStl(const QByteArray& data, TriangleMesh* mesh, QString* error) {
+  QVector3D corners[3];
+  int corner_count = 0;
+  int line_number = 0;
+  foreach (const QByteArray& raw_line, data.split('\n')) {
+    QByteArray line = raw_line.simplified();
+    ++line_number;
+    if (!line.startsWith("vertex ")) {
+      continue;
+    }
+    if (!parsePoint(line.split(' '), 1, &corners[corner_count])) {
+      *error = QString("Line %1 has a vertex without three coordinates.").arg(line_number);
+      return false;
+    }
+    if (++corner_count == 3) {
+      mesh->addTriangle(corners[0], corners[1], corners[2]);
+      corner_count = 0;
+    }
+  }
+  return true;
+}
+
+TriangleMesh::TriangleMesh() {}
+
+// Static.
+bool TriangleMesh::read(const QString& filename, TriangleMesh* mesh, QString* error) {
+  QString suffix = QFileInfo(filename).suffix().toLower();
+  if (suffix != "obj" && suffix != "stl") {
+    *error = "Only Wavefront OBJ and STL files can be imported.";
+    return false;
+  }
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    *error = file.errorString();
+    return false;
+  }
+  TriangleMesh result;
+  if (suffix == "obj") {
+    if (!readObj(&file, &result, error)) {
+      return false;
+    }
+  } else {
+    // Binary STL files may begin with "solid" just like ASCII ones, so they're told apart by their length instead.
+    QByteArray data = file.readAll();
+    qint64 count = 0;
+    if (data.size() >= kStlHeaderSize + 4) {
+      count = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data.constData()) + kStlHeaderSize);
+    }
+    if (data.size() >= kStlHeaderSize + 4 && data.size() == kStlHeaderSize + 4 + count * kStlTriangleSize) {
+      readBinaryStl(data, &result);
+    } else if (!data.startsWith("solid") || !readAsciiStl(data, &result, error)) {
+      if (error->isEmpty()) {
+        *error = "The file is neither a binary nor an ASCII STL file.";
+      }
+      return false;
+    }
+  }
+  if (result.triangleCount() == 0) {
+    *error = "The file has no triangles in it.";
+    return false;
+  }
+  *mesh = result;
+  return true;
+}
+
+void TriangleMesh::addTriangle(const QVector3D& a, const QVector3D& b, const QVector3D& c) {
+  if (corners_.isEmpty()) {
+    minimum_ = a;
+    maximum_ = a;
+  }
+  const QVector3D* corners[3] = {&a, &b, &c};
+  for (int i = 0; i < 3; ++i) {
+    const QVector3D& corner = *corners[i];
+    minimum_ = QVector3D(qMin(minimum_.x(), corner.x()), qMin(minimum_.y(), corner.y()),
+                         qMin(minimum_.z(), corner.z()));
+    maximum_ = QVector3D(qMax(maximum_.x(), corner.x()), qMax(maximum_.y(), corner.y()),
+                         qMax(maximum_.z(), corner.z()));
+    corners_.append(corner);
+  }
+}
@@ -0,0 +1,82 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRIANGLE_MESH_H
+#define TRIANGLE_MESH_H
+
+#include <QString>
+#include <QVector>
+#include <QVector3D>
+
+/**
+  * A soup of triangles read from a Wavefront OBJ or STL file, to be turned into blocks by a Voxelizer.
+  *
+  * Only the geometry is kept; normals, texture coordinates and materials are ignored, and polygons with more than three
+  * corners are split into fans of triangles.  The corners are stored three to a triangle, so triangles never share
+  * vertices, which is all an STL file gives us anyway.
+  */
+class TriangleMesh {
+ public:
+  TriangleMesh();
+
+  /**
+    * Reads the mesh in the OBJ or STL file at \p filename into \p mesh, telling the formats apart by the file's
+    * extension.  STL files may be either binary or ASCII.
+    * @return Whether the file was read successfully.  If not, \p error is set to a description of the problem and
+    *     \p mesh is left alone.
+    */
+  static bool read(const QString& filename, TriangleMesh* mesh, QString* error);
+
+  /**
+    * Appends the triangle with corners \p a, \p b and \p c.
+    */
+  void addTriangle(const QVector3D& a, const QVector3D& b, const QVector3D& c);
+
+  /**
+    * Returns the number of triangles in the mesh.
+    */
+  int triangleCount() const {
+    return corners_.size() / 3;
+  }
+
+  /**
+    * Returns corner \p corner, from 0 to 2, of triangle \p triangle.
+    */
+  const QVector3D& corner(int triangle, int corner) const {
+    return corners_.at(triangle * 3 + corner);
+  }
+
+  /**
+    * Returns the corner of the mesh's bounding box with the smallest coordinates.  This is only meaningful if the mesh
+    * has at least one triangle.
+    */
+  const QVector3D& minimum() const {
+    return minimum_;
+  }
+
+  /**
+    * Returns the corner of the mesh's bounding box with the largest coordinates.
+    */
+  const QVector3D& maximum() const {
+    return maximum_;
+  }
+
+ private:
+  QVector<QVector3D> corners_;
+  QVector3D minimum_;
+  QVector3D maximum_;
+};
+
+#endif // TRIANGLE_MESH_H
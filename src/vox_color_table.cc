@@ -0,0 +1,72 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vox_color_table.h"
+
+#include <QSettings>
+#include <QVariantMap>
+
+#include "application.h"
+#include "block_manager.h"
+#include "block_prototype.h"
+
+/**
+  * The settings key the table is saved under, as a map from color names like "#336699" to block types.
+  */
+static const char kSettingsKey[] = "VoxColorTable";
+
+VoxColorTable::VoxColorTable(BlockManager* block_mgr) : block_mgr_(block_mgr), palette_(block_mgr) {
+  QVariantMap saved = Application::instance()->settings()->value(kSettingsKey).toMap();
+  for (QVariantMap::const_iterator iter = saved.constBegin(); iter != saved.constEnd(); ++iter) {
+    QColor color(iter.key());
+    if (color.isValid()) {
+      blocks_.insert(color.rgb() & RGB_MASK, iter.value().toInt());
+    }
+  }
+}
+
+blocktype_t VoxColorTable::blockFor(QRgb color) const {
+  QHash<QRgb, blocktype_t>::const_iterator saved = blocks_.find(color & RGB_MASK);
+  if (saved != blocks_.constEnd()) {
+    return saved.value();
+  }
+  if (!palette_.paletteSize()) {
+    return kBlockTypeAir;
+  }
+  float l, a, b;
+  palette_.toLab(color, &l, &a, &b);
+  return palette_.block(palette_.nearestBlock(l, a, b))->type();
+}
+
+QRgb VoxColorTable::colorFor(BlockPrototype* prototype) const {
+  for (QHash<QRgb, blocktype_t>::const_iterator iter = blocks_.constBegin(); iter != blocks_.constEnd(); ++iter) {
+    if (iter.value() == prototype->type()) {
+      return iter.key() | ~RGB_MASK;
+    }
+  }
+  return palette_.averageColor(prototype);
+}
+
+void VoxColorTable::setBlockFor(QRgb color, blocktype_t type) {
+  blocks_.insert(color & RGB_MASK, type);
+}
+
+void VoxColorTable::save() const {
+  QVariantMap saved;
+  for (QHash<QRgb, blocktype_t>::const_iterator iter = blocks_.constBegin(); iter != blocks_.constEnd(); ++iter) {
+    saved.insert(QColor(iter.key()).name(), iter.value());
+  }
+  Application::instance()->settings()->setValue(kSettingsKey, saved);
+}
@@ -0,0 +1,75 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VOX_COLOR_TABLE_H
+#define VOX_COLOR_TABLE_H
+
+#include <QColor>
+#include <QHash>
+
+#include "block_type.h"
+#include "image_converter.h"
+
+class BlockManager;
+class BlockPrototype;
+
+/**
+  * Says which block each color of a MagicaVoxel palette stands for, and which color each block becomes when exported
+  * (see VoxFile).
+  *
+  * The choices made when importing are saved in the application settings, so a modeller who always paints stone in
+  * the same gray only has to say so once.  Colors that have never been chosen for are matched to the opaque cube
+  * whose texture is closest in color on average, and blocks that no color has been chosen for are exported as the
+  * average color of their sprite.
+  */
+class VoxColorTable {
+ public:
+  /**
+    * Loads the saved choices, using \p block_mgr to look up blocks that have none.
+    */
+  explicit VoxColorTable(BlockManager* block_mgr);
+
+  /**
+    * Returns the block type \p color stands for, or kBlockTypeAir if voxels of that color should be left out.
+    */
+  blocktype_t blockFor(QRgb color) const;
+
+  /**
+    * Returns the color blocks of type \p prototype should be exported as.  If several colors have been chosen to
+    * stand for the block, one of them is used.
+    */
+  QRgb colorFor(BlockPrototype* prototype) const;
+
+  /**
+    * Makes \p color stand for blocks of type \p type from now on.
+    */
+  void setBlockFor(QRgb color, blocktype_t type);
+
+  /**
+    * Saves the choices made with setBlockFor() in the application settings.
+    */
+  void save() const;
+
+ private:
+  BlockManager* block_mgr_;
+  ImageConverter palette_;
+
+  /**
+    * The saved choices, keyed by color with the alpha channel ignored.
+    */
+  QHash<QRgb, blocktype_t> blocks_;
+};
+
+#endif // VOX_COLOR_TABLE_H
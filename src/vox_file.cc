@@ -0,0 +1,713 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vox_file.h"
+
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QStringList>
+#include <QtEndian>
+
+#include <limits.h>
+
+#include "block_manager.h"
+#include "block_position.h"
+#include "block_prototype.h"
+#include "chunk.h"
+#include "chunk_position.h"
+#include "diagram.h"
+#include "vox_color_table.h"
+
+/**
+  * The version of the format written, which is the one MagicaVoxel has written since 0.98.
+  */
+static const qint32 kVoxVersion = 150;
+
+/**
+  * The base-2 logarithm of the largest size of a model along any axis, since voxel coordinates are stored as bytes.
+  * Models are larger than chunks, so every chunk lies in a single model when writing.
+  */
+static const int kModelShift = 8;
+
+/**
+  * The number of colors in a palette.  Palette index 0 means no voxel, so only kPaletteSize - 1 colors can be used.
+  */
+static const int kPaletteSize = 256;
+
+/**
+  * How deeply scene graph nodes may nest before the graph is assumed to loop back on itself.
+  */
+static const int kMaximumSceneDepth = 64;
+
+/**
+  * Reads little-endian values out of part of a .vox file that has been read into memory.  Like NbtReader, once a read
+  * runs past the end every later read fails too, so callers only need to check ok() once they are done.
+  */
+class VoxReader {
+ public:
+  /**
+    * Constructs a reader for the bytes of \p data from \p begin up to but not including \p end.  \p data must outlive
+    * the reader.
+    */
+  VoxReader(const QByteArray& data, int begin, int end) : data_(data), position_(begin), end_(end), ok_(true) {}
+
+  bool ok() const {
+    return ok_;
+  }
+
+  int position() const {
+    return position_;
+  }
+
+  qint32 readInt() {
+    if (end_ - position_ < 4) {
+      fail();
+      return 0;
+    }
+    qint32 value = qFromLittleEndian<qint32>(reinterpret_cast<const uchar*>(data_.constData() + position_));
+    position_ += 4;
+    return value;
+  }
+
+  QByteArray readBytes(int size) {
+    if (size < 0 || size > end_ - position_) {
+      fail();
+      return QByteArray();
+    }
+    QByteArray bytes = data_.mid(position_, size);
+    position_ += size;
+    return bytes;
+  }
+
+  QByteArray readString() {
+    return readBytes(readInt());
+  }
+
+  /**
+    * Reads a dictionary, which is a count followed by that many pairs of strings.
+    */
+  QHash<QByteArray, QByteArray> readDictionary() {
+    QHash<QByteArray, QByteArray> dictionary;
+    int count = readInt();
+    for (int i = 0; i < count && ok_; ++i) {
+      QByteArray key = readString();
+      dictionary.insert(key, readString());
+    }
+    return dictionary;
+  }
+
+ private:
+  void fail() {
+    ok_ = false;
+    position_ = end_;
+  }
+
+  const QByteArray& data_;
+  int position_;
+  int end_;
+  bool ok_;
+};
+
+/**
+  * A node of the scene graph in a .vox file.  Transform nodes move their single child by their translation, group
+  * nodes gather any number of children, and shape nodes place models, whose ids are kept as their children.
+  */
+class VoxNode {
+ public:
+  enum Kind {
+    kTransform,
+    kGroup,
+    kShape
+  };
+
+  VoxNode() : kind_(kGroup), x_(0), y_(0), z_(0) {}
+  VoxNode(Kind kind, const QList<int>& children) : kind_(kind), children_(children), x_(0), y_(0), z_(0) {}
+
+  Kind kind() const {
+    return kind_;
+  }
+
+  const QList<int>& children() const {
+    return children_;
+  }
+
+  /**
+    * Sets the translation of a transform node from \p value, the "_t" entry of its first frame, which holds three
+    * integers separated by spaces.
+    */
+  void setTranslation(const QByteArray& value) {
+    QList<QByteArray> parts = value.simplified().split(' ');
+    if (parts.size() == 3) {
+      x_ = parts.at(0).toInt();
+      y_ = parts.at(1).toInt();
+      z_ = parts.at(2).toInt();
+    }
+  }
+
+  int x() const {
+    return x_;
+  }
+  int y() const {
+    return y_;
+  }
+  int z() const {
+    return z_;
+  }
+
+ private:
+  Kind kind_;
+  QList<int> children_;
+  int x_;
+  int y_;
+  int z_;
+};
+
+/**
+  * The part of a diagram that goes into one model when writing: a cube of 1 << kModelShift blocks on a side, of which
+  * only the chunks holding blocks are listed.  The bounds are those of the blocks, in diagram coordinates.
+  */
+class VoxTile {
+ public:
+  VoxTile() : voxel_count_(0), min_x_(INT_MAX), min_y_(INT_MAX), min_z_(INT_MAX),
+              max_x_(INT_MIN), max_y_(INT_MIN), max_z_(INT_MIN) {}
+
+  void addChunk(const ChunkPosition& position) {
+    chunks_.append(position);
+  }
+
+  void addVoxel(int x, int y, int z) {
+    ++voxel_count_;
+    min_x_ = qMin(min_x_, x);
+    min_y_ = qMin(min_y_, y);
+    min_z_ = qMin(min_z_, z);
+    max_x_ = qMax(max_x_, x);
+    max_y_ = qMax(max_y_, y);
+    max_z_ = qMax(max_z_, z);
+  }
+
+  const QList<ChunkPosition>& chunks() const {
+    return chunks_;
+  }
+
+  int voxelCount() const {
+    return voxel_count_;
+  }
+
+  int minX() const {
+    return min_x_;
+  }
+  int minY() const {
+    return min_y_;
+  }
+  int minZ() const {
+    return min_z_;
+  }
+  int maxX() const {
+    return max_x_;
+  }
+  int maxY() const {
+    return max_y_;
+  }
+  int maxZ() const {
+    return max_z_;
+  }
+
+ private:
+  QList<ChunkPosition> chunks_;
+  int voxel_count_;
+  int min_x_;
+  int min_y_;
+  int min_z_;
+  int max_x_;
+  int max_y_;
+  int max_z_;
+};
+
+/**
+  * Returns the palette MagicaVoxel uses for files without an RGBA chunk: a 6 x 6 x 6 color cube without black,
+  * followed by ten-step ramps of red, green, blue and gray, all running from light to dark.
+  */
+static QVector<QRgb> defaultPalette() {
+  static const int kRampValues[] = { 0xEE, 0xDD, 0xBB, 0xAA, 0x88, 0x77, 0x55, 0x44, 0x22, 0x11 };
+  QVector<QRgb> palette(kPaletteSize, 0);
+  int index = 1;
+  for (int r = 0xFF; r >= 0; r -= 0x33) {
+    for (int g = 0xFF; g >= 0; g -= 0x33) {
+      for (int b = 0xFF; b >= 0; b -= 0x33) {
+        if (r || g || b) {
+          palette[index++] = qRgb(r, g, b);
+        }
+      }
+    }
+  }
+  for (int channel = 0; channel < 4; ++channel) {
+    for (int i = 0; i < 10; ++i) {
+      int value = kRampValues[i];
+      palette[index++] = qRgb(channel == 0 || channel == 3 ? value : 0, channel == 1 || channel == 3 ? value : 0,
+                              channel == 2 || channel == 3 ? value : 0);
+    }
+  }
+  Q_ASSERT(index == kPaletteSize);
+  return palette;
+}
+
+/**
+  * Returns the index in \p colors of the color closest to \p color.
+  */
+static int nearestColor(const QVector<QRgb>& colors, QRgb color) {
+  int nearest = 0;
+  int nearest_distance = INT_MAX;
+  for (int i = 0; i < colors.size(); ++i) {
+    int dr = qRed(colors.at(i)) - qRed(color);
+    int dg = qGreen(colors.at(i)) - qGreen(color);
+    int db = qBlue(colors.at(i)) - qBlue(color);
+    int distance = dr * dr + dg * dg + db * db;
+    if (distance < nearest_distance) {
+      nearest = i;
+      nearest_distance = distance;
+    }
+  }
+  return nearest;
+}
+
+// Static.
+void VoxFile::placeNode(const QHash<int, VoxNode>& nodes, int id, int x, int y, int z, int depth,
+                        const QList<QByteArray>& models, const QVector<int>& sizes, QList<Model>* placed) {
+  QHash<int, VoxNode>::const_iterator node = nodes.find(id);
+  if (node == nodes.constEnd() || depth > kMaximumSceneDepth) {
+    return;
+  }
+  if (node.value().kind() == VoxNode::kShape) {
+    foreach (int model, node.value().children()) {
+      if (model >= 0 && model < models.size()) {
+        // Translations are of the center of the model, rounded down.
+        placed->append(Model(models.at(model), x - sizes.at(model * 3) / 2, y - sizes.at(model * 3 + 1) / 2,
+                             z - sizes.at(model * 3 + 2) / 2));
+      }
+    }
+    return;
+  }
+  if (node.value().kind() == VoxNode::kTransform) {
+    x += node.value().x();
+    y += node.value().y();
+    z += node.value().z();
+  }
+  foreach (int child, node.value().children()) {
+    placeNode(nodes, child, x, y, z, depth + 1, models, sizes, placed);
+  }
+}
+
+static void appendInt(QByteArray* bytes, qint32 value) {
+  uchar little_endian[4];
+  qToLittleEndian(value, little_endian);
+  bytes->append(reinterpret_cast<const char*>(little_endian), 4);
+}
+
+static void appendString(QByteArray* bytes, const QByteArray& string) {
+  appendInt(bytes, string.size());
+  bytes->append(string);
+}
+
+static void appendDictionary(QByteArray* bytes, const QMap<QByteArray, QByteArray>& dictionary) {
+  appendInt(bytes, dictionary.size());
+  for (QMap<QByteArray, QByteArray>::const_iterator iter = dictionary.constBegin(); iter != dictionary.constEnd();
+       ++iter) {
+    appendString(bytes, iter.key());
+    appendString(bytes, iter.value());
+  }
+}
+
+/**
+  * Appends the header of a chunk with the four-letter id \p id, \p content_size bytes of content and
+  * \p children_size bytes of children.
+  */
+static void appendChunkHeader(QByteArray* bytes, const char* id, qint32 content_size, qint32 children_size) {
+  bytes->append(id, 4);
+  appendInt(bytes, content_size);
+  appendInt(bytes, children_size);
+}
+
+static void appendChunk(QByteArray* bytes, const char* id, const QByteArray& content) {
+  appendChunkHeader(bytes, id, content.size(), 0);
+  bytes->append(content);
+}
+
+VoxFile::VoxFile() {}
+
+// Static.
+bool VoxFile::read(const QString& filename, VoxFile* vox, QString* error) {
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    *error = "The file could not be opened.";
+    return false;
+  }
+  QByteArray data = file.readAll();
+  file.close();
+
+  VoxReader header(data, 0, data.size());
+  if (header.readBytes(4) != "VOX " || !header.ok()) {
+    *error = "The file is not a MagicaVoxel model.";
+    return false;
+  }
+  header.readInt();  // The version, which doesn't change anything we read.
+  QByteArray main_id = header.readBytes(4);
+  qint32 main_content_size = header.readInt();
+  qint32 main_children_size = header.readInt();
+  if (!header.ok() || main_id != "MAIN" || main_content_size < 0 || main_children_size < 0 ||
+      main_content_size > data.size() - header.position() ||
+      main_children_size > data.size() - header.position() - main_content_size) {
+    *error = "The file is damaged.";
+    return false;
+  }
+
+  // The children of MAIN are read in order.  Each XYZI chunk holds the voxels of the model whose size was given by
+  // the SIZE chunk before it.
+  QList<QByteArray> models;
+  QVector<int> sizes;
+  QVector<QRgb> palette = defaultPalette();
+  QHash<int, VoxNode> nodes;
+  int size_x = 0;
+  int size_y = 0;
+  int size_z = 0;
+  int position = header.position() + main_content_size;
+  int end = position + main_children_size;
+  while (end - position >= 12) {
+    VoxReader chunk_header(data, position, end);
+    QByteArray id = chunk_header.readBytes(4);
+    qint32 content_size = chunk_header.readInt();
+    qint32 children_size = chunk_header.readInt();
+    if (content_size < 0 || children_size < 0 || content_size > end - chunk_header.position() ||
+        children_size > end - chunk_header.position() - content_size) {
+      *error = "The file is damaged.";
+      return false;
+    }
+    VoxReader reader(data, chunk_header.position(), chunk_header.position() + content_size);
+    position = chunk_header.position() + content_size + children_size;
+
+    if (id == "SIZE") {
+      size_x = reader.readInt();
+      size_y = reader.readInt();
+      size_z = reader.readInt();
+    } else if (id == "XYZI") {
+      qint32 voxel_count = reader.readInt();
+      if (voxel_count < 0 || voxel_count > content_size / 4) {
+        reader.readBytes(-1);
+      }
+      models.append(reader.readBytes(voxel_count * 4));
+      sizes << size_x << size_y << size_z;
+    } else if (id == "RGBA") {
+      QByteArray colors = reader.readBytes((kPaletteSize - 1) * 4);
+      for (int i = 0; i + 1 < kPaletteSize && reader.ok(); ++i) {
+        const uchar* rgba = reinterpret_cast<const uchar*>(colors.constData()) + i * 4;
+        palette[i + 1] = qRgb(rgba[0], rgba[1], rgba[2]);
+      }
+    } else if (id == "nTRN") {
+      qint32 node_id = reader.readInt();
+      reader.readDictionary();
+      qint32 child = reader.readInt();
+      reader.readInt();  // Reserved.
+      reader.readInt();  // The layer.
+      qint32 frame_count = reader.readInt();
+      VoxNode node(VoxNode::kTransform, QList<int>() << child);
+      if (frame_count > 0) {
+        node.setTranslation(reader.readDictionary().value("_t"));
+      }
+      nodes.insert(node_id, node);
+    } else if (id == "nGRP") {
+      qint32 node_id = reader.readInt();
+      reader.readDictionary();
+      qint32 child_count = reader.readInt();
+      QList<int> children;
+      for (int i = 0; i < child_count && reader.ok(); ++i) {
+        children.append(reader.readInt());
+      }
+      nodes.insert(node_id, VoxNode(VoxNode::kGroup, children));
+    } else if (id == "nSHP") {
+      qint32 node_id = reader.readInt();
+      reader.readDictionary();
+      qint32 model_count = reader.readInt();
+      QList<int> shape_models;
+      for (int i = 0; i < model_count && reader.ok(); ++i) {
+        shape_models.append(reader.readInt());
+        reader.readDictionary();
+      }
+      nodes.insert(node_id, VoxNode(VoxNode::kShape, shape_models));
+    }
+    // Anything else, such as materials, layers and cameras, is skipped.
+
+    if (!reader.ok()) {
+      *error = QString("The %1 chunk is damaged.").arg(QString::fromLatin1(id));
+      return false;
+    }
+  }
+  if (models.isEmpty()) {
+    *error = "The file holds no models.";
+    return false;
+  }
+
+  VoxFile result;
+  result.palette_ = palette;
+  if (nodes.contains(0)) {
+    placeNode(nodes, 0, 0, 0, 0, 0, models, sizes, &result.models_);
+  } else {
+    // Without a scene graph, the models are laid out side by side with a voxel of space between them.
+    int x = 0;
+    for (int i = 0; i < models.size(); ++i) {
+      result.models_.append(Model(models.at(i), x, 0, 0));
+      x += sizes.at(i * 3) + 1;
+    }
+  }
+  *vox = result;
+  return true;
+}
+
+QList<QRgb> VoxFile::usedColors() const {
+  QVector<bool> used(kPaletteSize, false);
+  foreach (const Model& model, models_) {
+    const uchar* voxel = reinterpret_cast<const uchar*>(model.voxels().constData());
+    for (int i = 0; i < model.voxels().size(); i += 4) {
+      used[voxel[i + 3]] = true;
+    }
+  }
+  QList<QRgb> colors;
+  for (int i = 1; i < kPaletteSize; ++i) {
+    if (used.at(i) && !colors.contains(palette_.at(i))) {
+      colors.append(palette_.at(i));
+    }
+  }
+  return colors;
+}
+
+BlockClipboard VoxFile::toClipboard(BlockManager* block_mgr, const VoxColorTable& table) const {
+  // Each palette entry is turned into a block once, up front.
+  QVector<BlockPrototype*> prototypes(kPaletteSize, NULL);
+  QHash<QRgb, BlockPrototype*> prototypes_by_color;
+  foreach (QRgb color, usedColors()) {
+    blocktype_t type = table.blockFor(color);
+    prototypes_by_color.insert(color, type == kBlockTypeAir ? NULL : block_mgr->getPrototype(type));
+  }
+  for (int i = 1; i < kPaletteSize; ++i) {
+    prototypes[i] = prototypes_by_color.value(palette_.at(i));
+  }
+
+  // MagicaVoxel's (x, y, z) is the diagram's (x, z, -y).
+  int min_x = INT_MAX, min_y = INT_MAX, min_z = INT_MAX;
+  int max_x = INT_MIN, max_y = INT_MIN, max_z = INT_MIN;
+  foreach (const Model& model, models_) {
+    const uchar* voxel = reinterpret_cast<const uchar*>(model.voxels().constData());
+    for (int i = 0; i < model.voxels().size(); i += 4) {
+      if (prototypes.at(voxel[i + 3])) {
+        min_x = qMin(min_x, model.x() + voxel[i]);
+        max_x = qMax(max_x, model.x() + voxel[i]);
+        min_y = qMin(min_y, model.z() + voxel[i + 2]);
+        max_y = qMax(max_y, model.z() + voxel[i + 2]);
+        min_z = qMin(min_z, -(model.y() + voxel[i + 1]));
+        max_z = qMax(max_z, -(model.y() + voxel[i + 1]));
+      }
+    }
+  }
+  if (min_x > max_x) {
+    return BlockClipboard();
+  }
+
+  BlockClipboard clipboard(max_x - min_x + 1, max_y - min_y + 1, max_z - min_z + 1);
+  foreach (const Model& model, models_) {
+    const uchar* voxel = reinterpret_cast<const uchar*>(model.voxels().constData());
+    for (int i = 0; i < model.voxels().size(); i += 4) {
+      BlockPrototype* prototype = prototypes.at(voxel[i + 3]);
+      if (prototype) {
+        BlockPosition position(model.x() + voxel[i] - min_x, model.z() + voxel[i + 2] - min_y,
+                               -(model.y() + voxel[i + 1]) - min_z);
+        clipboard.setBlock(position, prototype, prototype->defaultOrientation());
+      }
+    }
+  }
+  return clipboard;
+}
+
+// Static.
+bool VoxFile::write(const QString& filename, const Diagram& diagram, const VoxColorTable& table, QString* error) {
+  // The first pass gives every kind of block a palette index, and finds which chunks go into which model and the
+  // bounds of the blocks in each model.  Layer palettes are small, so blocks are looked up once per palette entry.
+  QHash<ChunkPosition, Chunk> chunks = diagram.chunks();
+  QHash<BlockPrototype*, int> indices;
+  QVector<QRgb> colors;
+  QHash<ChunkPosition, VoxTile> tiles;
+  for (QHash<ChunkPosition, Chunk>::const_iterator iter = chunks.constBegin(); iter != chunks.constEnd(); ++iter) {
+    if (iter.value().isEmpty()) {
+      continue;
+    }
+    ChunkPosition chunk_position = iter.key();
+    int shift = kModelShift - kChunkShift;
+    ChunkPosition tile_position(chunk_position.x() >> shift, chunk_position.y() >> shift, chunk_position.z() >> shift);
+    VoxTile& tile = tiles[tile_position];
+    tile.addChunk(chunk_position);
+    BlockPosition origin = chunk_position.minimumBlock();
+    for (int y = 0; y < kChunkSize; ++y) {
+      const ChunkLayer& layer = iter.value().layer(y);
+      if (layer.isEmpty()) {
+        continue;
+      }
+      foreach (const ChunkLayer::PaletteEntry& entry, layer.palette()) {
+        if (entry.count() && !indices.contains(entry.prototype())) {
+          QRgb color = table.colorFor(entry.prototype());
+          if (colors.size() < kPaletteSize - 1) {
+            colors.append(color);
+            indices.insert(entry.prototype(), colors.size());
+          } else {
+            indices.insert(entry.prototype(), nearestColor(colors, color) + 1);
+          }
+        }
+      }
+      for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+        if (layer.paletteIndexAt(cell)) {
+          tile.addVoxel(origin.x() + (cell & kChunkMask), origin.y() + y, origin.z() + (cell >> kChunkShift));
+        }
+      }
+    }
+  }
+  if (tiles.isEmpty()) {
+    *error = "There is nothing to export.";
+    return false;
+  }
+
+  // The scene graph is a root transform holding a group, which holds a transform and a shape for each model.
+  // Translations are of the center of each model, in MagicaVoxel's axes.
+  QList<VoxTile> models = tiles.values();
+  QByteArray scene;
+  QByteArray content;
+  QMap<QByteArray, QByteArray> no_attributes;
+  appendInt(&content, 0);
+  appendDictionary(&content, no_attributes);
+  appendInt(&content, 1);
+  appendInt(&content, -1);
+  appendInt(&content, -1);
+  appendInt(&content, 1);
+  appendDictionary(&content, no_attributes);
+  appendChunk(&scene, "nTRN", content);
+  content.clear();
+  appendInt(&content, 1);
+  appendDictionary(&content, no_attributes);
+  appendInt(&content, models.size());
+  for (int i = 0; i < models.size(); ++i) {
+    appendInt(&content, 2 + i * 2);
+  }
+  appendChunk(&scene, "nGRP", content);
+  qint64 models_size = 0;
+  for (int i = 0; i < models.size(); ++i) {
+    const VoxTile& model = models.at(i);
+    QMap<QByteArray, QByteArray> frame;
+    frame.insert("_t", QString("%1 %2 %3")
+                           .arg(model.minX() + (model.maxX() - model.minX() + 1) / 2)
+                           .arg(-model.maxZ() + (model.maxZ() - model.minZ() + 1) / 2)
+                           .arg(model.minY() + (model.maxY() - model.minY() + 1) / 2).toLatin1());
+    content.clear();
+    appendInt(&content, 2 + i * 2);
+    appendDictionary(&content, no_attributes);
+    appendInt(&content, 3 + i * 2);
+    appendInt(&content, -1);
+    appendInt(&content, 0);
+    appendInt(&content, 1);
+    appendDictionary(&content, frame);
+    appendChunk(&scene, "nTRN", content);
+    content.clear();
+    appendInt(&content, 3 + i * 2);
+    appendDictionary(&content, no_attributes);
+    appendInt(&content, 1);
+    appendInt(&content, i);
+    appendDictionary(&content, no_attributes);
+    appendChunk(&scene, "nSHP", content);
+    models_size += 12 + 12 + 12 + 4 + static_cast<qint64>(model.voxelCount()) * 4;
+  }
+  qint64 children_size = models_size + scene.size() + 12 + kPaletteSize * 4;
+  if (children_size > INT_MAX) {
+    *error = "The diagram holds too many blocks for a MagicaVoxel model.";
+    return false;
+  }
+
+  QFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    *error = "The file could not be created.";
+    return false;
+  }
+  QByteArray bytes("VOX ");
+  appendInt(&bytes, kVoxVersion);
+  appendChunkHeader(&bytes, "MAIN", 0, children_size);
+  bool ok = (file.write(bytes) == bytes.size());
+
+  // The second pass streams each model's voxels out of its chunks, a chunk at a time.
+  QVector<int> layer_indices;
+  for (int i = 0; i < models.size() && ok; ++i) {
+    const VoxTile& model = models.at(i);
+    bytes.clear();
+    content.clear();
+    appendInt(&content, model.maxX() - model.minX() + 1);
+    appendInt(&content, model.maxZ() - model.minZ() + 1);
+    appendInt(&content, model.maxY() - model.minY() + 1);
+    appendChunk(&bytes, "SIZE", content);
+    appendChunkHeader(&bytes, "XYZI", 4 + model.voxelCount() * 4, 0);
+    appendInt(&bytes, model.voxelCount());
+    ok = (file.write(bytes) == bytes.size());
+    foreach (const ChunkPosition& chunk_position, model.chunks()) {
+      Chunk chunk = chunks.value(chunk_position);
+      BlockPosition origin = chunk_position.minimumBlock();
+      bytes.clear();
+      for (int y = 0; y < kChunkSize; ++y) {
+        const ChunkLayer& layer = chunk.layer(y);
+        if (layer.isEmpty()) {
+          continue;
+        }
+        layer_indices.resize(layer.palette().size());
+        for (int entry = 0; entry < layer.palette().size(); ++entry) {
+          layer_indices[entry] = indices.value(layer.paletteEntry(entry).prototype());
+        }
+        char voxel_z = static_cast<char>(origin.y() + y - model.minY());
+        for (int cell = 0; cell < kChunkLayerArea; ++cell) {
+          int entry = layer.paletteIndexAt(cell);
+          if (entry) {
+            bytes.append(static_cast<char>(origin.x() + (cell & kChunkMask) - model.minX()));
+            bytes.append(static_cast<char>(model.maxZ() - origin.z() - (cell >> kChunkShift)));
+            bytes.append(voxel_z);
+            bytes.append(static_cast<char>(layer_indices.at(entry)));
+          }
+        }
+      }
+      if (ok) {
+        ok = (file.write(bytes) == bytes.size());
+      }
+    }
+  }
+
+  // The remaining entries of the palette are left black.
+  bytes = scene;
+  content.clear();
+  for (int i = 0; i < kPaletteSize; ++i) {
+    QRgb color = (i < colors.size() ? colors.at(i) : qRgb(0, 0, 0));
+    content.append(static_cast<char>(qRed(color)));
+    content.append(static_cast<char>(qGreen(color)));
+    content.append(static_cast<char>(qBlue(color)));
+    content.append(static_cast<char>(0xFF));
+  }
+  appendChunk(&bytes, "RGBA", content);
+  if (ok) {
+    ok = (file.write(bytes) == bytes.size());
+  }
+  file.close();
+  if (!ok) {
+    *error = "The file could not be written.";
+  }
+  return ok;
+}
@@ -0,0 +1,137 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VOX_FILE_H
+#define VOX_FILE_H
+
+#include <QByteArray>
+#include <QColor>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include "block_clipboard.h"
+
+class BlockManager;
+class Diagram;
+class VoxColorTable;
+class VoxNode;
+
+/**
+  * Reads and writes the .vox files saved by MagicaVoxel, so that models painted there can be brought into a diagram
+  * and diagrams can be touched up there.
+  *
+  * A .vox file holds one or more models, each a box of at most 256 voxels on a side with a list of the occupied
+  * voxels and the palette index of each, a palette of 255 colors shared by all the models, and a scene graph placing
+  * the models in the world.  MagicaVoxel's _z_ axis points up, so its (_x_, _y_, _z_) is the diagram's (_x_, _z_,
+  * -_y_).  Palette colors are turned into blocks and back by a VoxColorTable.
+  *
+  * Rotations in the scene graph are ignored, as are materials, layers and cameras.  Files with no scene graph have
+  * their models laid out side by side along _x_.
+  */
+class VoxFile {
+ public:
+  VoxFile();
+
+  /**
+    * Reads the file at \p filename into \p vox.  The voxel lists are kept packed as they are in the file until
+    * toClipboard() is called.
+    * @return Whether the file was read successfully.  If not, \p error is set to a description of the problem and
+    *     \p vox is left alone.
+    */
+  static bool read(const QString& filename, VoxFile* vox, QString* error);
+
+  /**
+    * Writes the blocks in \p diagram to a .vox file at \p filename, using \p table to pick each block's color.  If the
+    * diagram uses more than 255 kinds of block, the later ones share the palette entry with the closest color.  The
+    * diagram is cut into models of at most 256 voxels on a side, and each model's voxels are streamed straight out of
+    * the diagram's chunks.
+    * @return Whether the file was written successfully.  If not, \p error is set to a description of the problem.
+    */
+  static bool write(const QString& filename, const Diagram& diagram, const VoxColorTable& table, QString* error);
+
+  /**
+    * Returns the number of models placed in the scene.  A model placed twice is counted twice.
+    */
+  int modelCount() const {
+    return models_.size();
+  }
+
+  /**
+    * Returns the distinct colors used by at least one voxel, in palette order.
+    */
+  QList<QRgb> usedColors() const;
+
+  /**
+    * Returns a clipboard holding every model where the scene places it, with each voxel replaced by the block
+    * \p table picks for its color, as looked up in \p block_mgr.  Each palette entry is looked up once, and the
+    * voxels are written straight into the clipboard's chunks.  Voxels whose color stands for air are left out, and
+    * the box is trimmed to the voxels that remain.
+    */
+  BlockClipboard toClipboard(BlockManager* block_mgr, const VoxColorTable& table) const;
+
+ private:
+  /**
+    * One placement of a model in the scene.
+    */
+  class Model {
+   public:
+    Model() : x_(0), y_(0), z_(0) {}
+    Model(const QByteArray& voxels, int x, int y, int z) : voxels_(voxels), x_(x), y_(y), z_(z) {}
+
+    /**
+      * Returns the voxels, four bytes each: _x_, _y_, _z_ and palette index, exactly as stored in the XYZI chunk.
+      */
+    const QByteArray& voxels() const {
+      return voxels_;
+    }
+
+    /**
+      * Returns where the corner of the model's box is placed, in MagicaVoxel's axes.
+      */
+    int x() const {
+      return x_;
+    }
+    int y() const {
+      return y_;
+    }
+    int z() const {
+      return z_;
+    }
+
+   private:
+    QByteArray voxels_;
+    int x_;
+    int y_;
+    int z_;
+  };
+
+  /**
+    * Places the models under the scene graph node \p id, which is \p depth nodes below the root, in \p placed.  The
+    * node's parents have moved it by (\p x, \p y, \p z).  \p models and \p sizes hold the voxels and sizes of the
+    * models in the file, with three sizes per model.
+    */
+  static void placeNode(const QHash<int, VoxNode>& nodes, int id, int x, int y, int z, int depth,
+                        const QList<QByteArray>& models, const QVector<int>& sizes, QList<Model>* placed);
+
+  /**
+    * The colors of the palette, indexed by palette index.  Entry 0 is never used by voxels.
+    */
+  QVector<QRgb> palette_;
+  QList<Model> models_;
+};
+
+#endif // VOX_FILE_H
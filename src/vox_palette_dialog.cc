@@ -0,0 +1,74 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vox_palette_dialog.h"
+
+#include <QComboBox>
+#include <QPixmap>
+#include <QTableWidgetItem>
+
+#include "block_manager.h"
+#include "block_orientation.h"
+#include "block_prototype.h"
+#include "vox_color_table.h"
+
+/**
+  * The size of the color swatches shown beside each color.
+  */
+static const int kSwatchSize = 16;
+
+VoxPaletteDialog::VoxPaletteDialog(const QList<QRgb>& colors, BlockManager* block_mgr, const VoxColorTable& table,
+                                   QWidget* parent)
+    : QDialog(parent),
+      colors_(colors) {
+  Q_ASSERT(block_mgr);
+  ui.setupUi(this);
+
+  // The icons are made once and shared by every row's combo box.
+  QList<BlockPrototype*> blocks;
+  QList<QIcon> icons;
+  BlockTypeIterator iter = BlockPrototype::blockIterator();
+  while (iter.hasNext()) {
+    BlockPrototype* block = block_mgr->getPrototype(iter.next());
+    if (block->type() == kBlockTypeAir) {
+      continue;
+    }
+    blocks.append(block);
+    icons.append(QIcon(block->sprite(BlockOrientation::paletteOrientation())));
+  }
+
+  ui.color_table_->setRowCount(colors_.size());
+  for (int row = 0; row < colors_.size(); ++row) {
+    QPixmap swatch(kSwatchSize, kSwatchSize);
+    swatch.fill(QColor(colors_.at(row)));
+    ui.color_table_->setItem(row, 0, new QTableWidgetItem(QIcon(swatch), QColor(colors_.at(row)).name()));
+
+    QComboBox* combo_box = new QComboBox;
+    combo_box->addItem("Leave out", kBlockTypeAir);
+    for (int i = 0; i < blocks.size(); ++i) {
+      combo_box->addItem(icons.at(i), blocks.at(i)->name(), blocks.at(i)->type());
+    }
+    combo_box->setCurrentIndex(qMax(0, combo_box->findData(table.blockFor(colors_.at(row)))));
+    ui.color_table_->setCellWidget(row, 1, combo_box);
+  }
+  ui.color_table_->resizeColumnsToContents();
+}
+
+void VoxPaletteDialog::applyTo(VoxColorTable* table) const {
+  for (int row = 0; row < colors_.size(); ++row) {
+    const QComboBox* combo_box = qobject_cast<const QComboBox*>(ui.color_table_->cellWidget(row, 1));
+    table->setBlockFor(colors_.at(row), combo_box->itemData(combo_box->currentIndex()).toInt());
+  }
+}
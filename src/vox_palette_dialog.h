@@ -0,0 +1,52 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VOX_PALETTE_DIALOG_H
+#define VOX_PALETTE_DIALOG_H
+
+#include <QColor>
+#include <QList>
+
+#include "ui_vox_palette_dialog.h"
+
+class BlockManager;
+class VoxColorTable;
+
+/**
+  * The dialog that asks which block each color of a MagicaVoxel model stands for when importing it (see VoxFile).
+  * Each color starts out as the block \p table picks for it, and the choices are written back to the table when the
+  * dialog is accepted.
+  */
+class VoxPaletteDialog : public QDialog {
+  Q_OBJECT
+
+ public:
+  /**
+    * Constructs a dialog listing \p colors, using \p block_mgr to look up the blocks they can stand for.
+    */
+  VoxPaletteDialog(const QList<QRgb>& colors, BlockManager* block_mgr, const VoxColorTable& table,
+                   QWidget* parent = NULL);
+
+  /**
+    * Makes each color stand for the block chosen for it in \p table.
+    */
+  void applyTo(VoxColorTable* table) const;
+
+ private:
+  Ui::VoxPaletteDialog ui;
+  QList<QRgb> colors_;
+};
+
+#endif // VOX_PALETTE_DIALOG_H
@@ -0,0 +1,479 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "voxelizer.h"
+
+#include <QBitArray>
+#include <QList>
+#include <QVarLengthArray>
+#include <QtConcurrentMap>
+
+#include <math.h>
+
+#include "block_position.h"
+#include "chunk.h"
+#include "triangle_mesh.h"
+
+/**
+  * How far the mesh is moved along each axis past the corner of the grid, in cells.  Meshes modelled on a grid often
+  * have faces lying exactly on the planes between cells, which would otherwise touch the cells on both sides and make
+  * the shell two blocks thick there.
+  */
+static const double kGridNudge = 1.0 / 1024.0;
+
+/**
+  * How far from the center of each column the rays for solid fills are cast, in cells.  The odd offsets keep the rays
+  * from passing exactly through the edges and corners that triangles share, where a crossing would be counted twice
+  * or not at all.
+  */
+static const double kRayOffsetX = 0.000137;
+static const double kRayOffsetZ = 0.000291;
+
+/**
+  * The most triangles the bounding volume hierarchy keeps in a leaf.
+  */
+static const int kBvhLeafSize = 4;
+
+/**
+  * Returns whether the triangle with corners \p corners, relative to the center of a cell, overlaps the cell when both
+  * are projected onto \p axis.
+  */
+static bool overlapsOnAxis(const QVector3D& axis, const QVector3D* corners) {
+  qreal p0 = QVector3D::dotProduct(axis, corners[0]);
+  qreal p1 = QVector3D::dotProduct(axis, corners[1]);
+  qreal p2 = QVector3D::dotProduct(axis, corners[2]);
+  qreal radius = 0.5 * (qAbs(axis.x()) + qAbs(axis.y()) + qAbs(axis.z()));
+  return qMin(p0, qMin(p1, p2)) <= radius && qMax(p0, qMax(p1, p2)) >= -radius;
+}
+
+/**
+  * Returns whether the triangle \p a, \p b, \p c overlaps the unit cell centered on \p center.  This is the separating
+  * axis test of Akenine-Moller: the two overlap unless they can be told apart along one of the cell's three axes, the
+  * triangle's normal, or one of the nine cross products of a cell axis with a triangle edge.
+  */
+static bool triangleOverlapsCell(const QVector3D& center, const QVector3D& a, const QVector3D& b,
+                                 const QVector3D& c) {
+  const QVector3D corners[3] = {a - center, b - center, c - center};
+  const QVector3D edges[3] = {corners[1] - corners[0], corners[2] - corners[1], corners[0] - corners[2]};
+  const QVector3D cell_axes[3] = {QVector3D(1, 0, 0), QVector3D(0, 1, 0), QVector3D(0, 0, 1)};
+  for (int i = 0; i < 3; ++i) {
+    if (!overlapsOnAxis(cell_axes[i], corners)) {
+      return false;
+    }
+  }
+  if (!overlapsOnAxis(QVector3D::crossProduct(edges[0], edges[1]), corners)) {
+    return false;
+  }
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      if (!overlapsOnAxis(QVector3D::crossProduct(cell_axes[i], edges[j]), corners)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/**
+  * Finds where the vertical line through \p x, \p z crosses the triangle \p a, \p b, \p c.
+  * @return Whether the line crosses the triangle.  If so, \p y is set to the height at which it does.
+  */
+static bool verticalLineCrossesTriangle(double x, double z, const QVector3D& a, const QVector3D& b,
+                                        const QVector3D& c, double* y) {
+  double area = (b.x() - a.x()) * (c.z() - a.z()) - (c.x() - a.x()) * (b.z() - a.z());
+  if (qAbs(area) < 1e-12) {
+    // The triangle is edge-on to the line.
+    return false;
+  }
+  double weight_a = ((b.x() - x) * (c.z() - z) - (c.x() - x) * (b.z() - z)) / area;
+  double weight_b = ((c.x() - x) * (a.z() - z) - (a.x() - x) * (c.z() - z)) / area;
+  double weight_c = 1.0 - weight_a - weight_b;
+  if (weight_a < 0 || weight_b < 0 || weight_c < 0) {
+    return false;
+  }
+  *y = weight_a * a.y() + weight_b * b.y() + weight_c * c.y();
+  return true;
+}
+
+/**
+  * A bounding volume hierarchy over the triangles of a mesh, for finding the triangles near a box quickly.
+  *
+  * The nodes are stored depth first, so the first child of a node always follows it directly and only the second
+  * child's index needs to be kept.  Each leaf holds a run of up to kBvhLeafSize triangles from triangles_.
+  */
+class TriangleBvh {
+ public:
+  /**
+    * Builds the hierarchy over the triangles with corners \p corners, three to a triangle.
+    */
+  explicit TriangleBvh(const QVector<QVector3D>& corners);
+
+  /**
+    * Appends to \p triangles the index of every triangle whose bounding box overlaps the box between \p minimum and
+    * \p maximum.
+    */
+  void query(const QVector3D& minimum, const QVector3D& maximum, QVector<int>* triangles) const;
+
+ private:
+  /**
+    * Orders triangles by the centers of their bounding boxes along one axis.
+    */
+  class CenterLessThan {
+   public:
+    CenterLessThan(const TriangleBvh* bvh, int axis) : bvh_(bvh), axis_(axis) {}
+
+    bool operator()(int a, int b) const {
+      return component(bvh_->triangle_minimum_.at(a) + bvh_->triangle_maximum_.at(a), axis_) <
+          component(bvh_->triangle_minimum_.at(b) + bvh_->triangle_maximum_.at(b), axis_);
+    }
+
+   private:
+    const TriangleBvh* bvh_;
+    int axis_;
+  };
+
+  static qreal component(const QVector3D& vector, int axis) {
+    return axis == 0 ? vector.x() : (axis == 1 ? vector.y() : vector.z());
+  }
+
+  /**
+    * Appends the node holding the \p count triangles of triangles_ starting at \p first, and its descendants.
+    */
+  void build(int first, int count);
+
+  QVector<QVector3D> triangle_minimum_;
+  QVector<QVector3D> triangle_maximum_;
+  QVector<int> triangles_;
+  QVector<QVector3D> node_minimum_;
+  QVector<QVector3D> node_maximum_;
+  /**
+    * For leaves, the index in triangles_ of the first triangle.  For other nodes, the index of the second child.
+    */
+  QVector<int> node_index_;
+  /**
+    * For leaves, the number of triangles.  For other nodes, 0.
+    */
+  QVector<int> node_count_;
+};
+
+TriangleBvh::TriangleBvh(const QVector<QVector3D>& corners) {
+  int triangle_count = corners.size() / 3;
+  triangle_minimum_.reserve(triangle_count);
+  triangle_maximum_.reserve(triangle_count);
+  triangles_.reserve(triangle_count);
+  for (int i = 0; i < triangle_count; ++i) {
+    const QVector3D& a = corners.at(i * 3);
+    const QVector3D& b = corners.at(i * 3 + 1);
+    const QVector3D& c = corners.at(i * 3 + 2);
+    triangle_minimum_.append(QVector3D(qMin(a.x(), qMin(b.x(), c.x())), qMin(a.y(), qMin(b.y(), c.y())),
+                                       qMin(a.z(), qMin(b.z(), c.z()))));
+    triangle_maximum_.append(QVector3D(qMax(a.x(), qMax(b.x(), c.x())), qMax(a.y(), qMax(b.y(), c.y())),
+                                       qMax(a.z(), qMax(b.z(), c.z()))));
+    triangles_.append(i);
+  }
+  if (triangle_count) {
+    build(0, triangle_count);
+  }
+}
+
+void TriangleBvh::build(int first, int count) {
+  QVector3D minimum = triangle_minimum_.at(triangles_.at(first));
+  QVector3D maximum = triangle_maximum_.at(triangles_.at(first));
+  for (int i = first + 1; i < first + count; ++i) {
+    const QVector3D& triangle_minimum = triangle_minimum_.at(triangles_.at(i));
+    const QVector3D& triangle_maximum = triangle_maximum_.at(triangles_.at(i));
+    minimum = QVector3D(qMin(minimum.x(), triangle_minimum.x()), qMin(minimum.y(), triangle_minimum.y()),
+                        qMin(minimum.z(), triangle_minimum.z()));
+    maximum = QVector3D(qMax(maximum.x(), triangle_maximum.x()), qMax(maximum.y(), triangle_maximum.y()),
+                        qMax(maximum.z(), triangle_maximum.z()));
+  }
+  int node = node_minimum_.size();
+  node_minimum_.append(minimum);
+  node_maximum_.append(maximum);
+  if (count <= kBvhLeafSize) {
+    node_index_.append(first);
+    node_count_.append(count);
+    return;
+  }
+  node_index_.append(0);
+  node_count_.append(0);
+
+  // Split at the median along the longest side of the box.
+  QVector3D extent = maximum - minimum;
+  int axis = 0;
+  if (extent.y() > component(extent, axis)) {
+    axis = 1;
+  }
+  if (extent.z() > component(extent, axis)) {
+    axis = 2;
+  }
+  qSort(triangles_.begin() + first, triangles_.begin() + first + count, CenterLessThan(this, axis));
+  int half = count / 2;
+  build(first, half);
+  node_index_[node] = node_minimum_.size();
+  build(first + half, count - half);
+}
+
+void TriangleBvh::query(const QVector3D& minimum, const QVector3D& maximum, QVector<int>* triangles) const {
+  if (node_minimum_.isEmpty()) {
+    return;
+  }
+  QVarLengthArray<int, 64> stack;
+  stack.append(0);
+  while (stack.size()) {
+    int node = stack[stack.size() - 1];
+    stack.resize(stack.size() - 1);
+    const QVector3D& node_minimum = node_minimum_.at(node);
+    const QVector3D& node_maximum = node_maximum_.at(node);
+    if (node_minimum.x() > maximum.x() || node_maximum.x() < minimum.x() ||
+        node_minimum.y() > maximum.y() || node_maximum.y() < minimum.y() ||
+        node_minimum.z() > maximum.z() || node_maximum.z() < minimum.z()) {
+      continue;
+    }
+    int count = node_count_.at(node);
+    if (!count) {
+      stack.append(node_index_.at(node));
+      stack.append(node + 1);
+      continue;
+    }
+    for (int i = node_index_.at(node); i < node_index_.at(node) + count; ++i) {
+      int triangle = triangles_.at(i);
+      const QVector3D& triangle_minimum = triangle_minimum_.at(triangle);
+      const QVector3D& triangle_maximum = triangle_maximum_.at(triangle);
+      if (triangle_minimum.x() <= maximum.x() && triangle_maximum.x() >= minimum.x() &&
+          triangle_minimum.y() <= maximum.y() && triangle_maximum.y() >= minimum.y() &&
+          triangle_minimum.z() <= maximum.z() && triangle_maximum.z() >= minimum.z()) {
+        triangles->append(triangle);
+      }
+    }
+  }
+}
+
+/**
+  * What every column job needs to know about the voxelization as a whole.
+  */
+class Voxelization {
+ public:
+  Voxelization(const QVector<QVector3D>& corners, const TriangleBvh* bvh, Voxelizer::Fill fill,
+               int width, int height, int depth, const BlockPosition& origin)
+      : corners_(corners), bvh_(bvh), fill_(fill), width_(width), height_(height), depth_(depth), origin_(origin) {}
+
+  const QVector3D& corner(int triangle, int corner) const {
+    return corners_.at(triangle * 3 + corner);
+  }
+
+  const TriangleBvh& bvh() const {
+    return *bvh_;
+  }
+
+  Voxelizer::Fill fill() const {
+    return fill_;
+  }
+
+  int width() const {
+    return width_;
+  }
+
+  int height() const {
+    return height_;
+  }
+
+  int depth() const {
+    return depth_;
+  }
+
+  const BlockPosition& origin() const {
+    return origin_;
+  }
+
+ private:
+  QVector<QVector3D> corners_;
+  const TriangleBvh* bvh_;
+  Voxelizer::Fill fill_;
+  int width_;
+  int height_;
+  int depth_;
+  BlockPosition origin_;
+};
+
+/**
+  * One column of the grid, a chunk wide and deep and as tall as the whole grid, to be voxelized.
+  */
+class VoxelColumnJob {
+ public:
+  VoxelColumnJob(int column_x, int column_z, const Voxelization* voxelization)
+      : column_x_(column_x), column_z_(column_z), voxelization_(voxelization) {}
+
+  /**
+    * Returns the position of the column in the grid, in chunks.
+    */
+  int columnX() const {
+    return column_x_;
+  }
+  int columnZ() const {
+    return column_z_;
+  }
+
+  const Voxelization& voxelization() const {
+    return *voxelization_;
+  }
+
+ private:
+  int column_x_;
+  int column_z_;
+  const Voxelization* voxelization_;
+};
+
+/**
+  * Returns the spans of cells in the column \p job that the mesh covers, in diagram coordinates.
+  */
+static QVector<BlockSpan> voxelizeColumn(const VoxelColumnJob& job) {
+  const Voxelization& voxelization = job.voxelization();
+  int first_x = job.columnX() * kChunkSize;
+  int first_z = job.columnZ() * kChunkSize;
+  int last_x = qMin(first_x + kChunkMask, voxelization.width() - 1);
+  int last_z = qMin(first_z + kChunkMask, voxelization.depth() - 1);
+  int height = voxelization.height();
+  // Cell x, y, z of the column is bit ((y * kChunkSize) + z) * kChunkSize + x.
+  QBitArray cells(kChunkLayerArea * height);
+
+  // The shell: every cell near one of the triangles near the column that the triangle actually touches.
+  QVector<int> triangles;
+  voxelization.bvh().query(QVector3D(first_x, 0, first_z), QVector3D(last_x + 1, height, last_z + 1), &triangles);
+  foreach (int triangle, triangles) {
+    const QVector3D& a = voxelization.corner(triangle, 0);
+    const QVector3D& b = voxelization.corner(triangle, 1);
+    const QVector3D& c = voxelization.corner(triangle, 2);
+    int min_x = qMax(first_x, static_cast<int>(floor(qMin(a.x(), qMin(b.x(), c.x())))));
+    int max_x = qMin(last_x, static_cast<int>(floor(qMax(a.x(), qMax(b.x(), c.x())))));
+    int min_y = qMax(0, static_cast<int>(floor(qMin(a.y(), qMin(b.y(), c.y())))));
+    int max_y = qMin(height - 1, static_cast<int>(floor(qMax(a.y(), qMax(b.y(), c.y())))));
+    int min_z = qMax(first_z, static_cast<int>(floor(qMin(a.z(), qMin(b.z(), c.z())))));
+    int max_z = qMin(last_z, static_cast<int>(floor(qMax(a.z(), qMax(b.z(), c.z())))));
+    for (int y = min_y; y <= max_y; ++y) {
+      for (int z = min_z; z <= max_z; ++z) {
+        for (int x = min_x; x <= max_x; ++x) {
+          int bit = ((y * kChunkSize) + (z - first_z)) * kChunkSize + (x - first_x);
+          if (!cells.testBit(bit) && triangleOverlapsCell(QVector3D(x + 0.5, y + 0.5, z + 0.5), a, b, c)) {
+            cells.setBit(bit);
+          }
+        }
+      }
+    }
+  }
+
+  // The inside: every cell whose center lies between an odd-numbered crossing of the surface and the next one up.
+  if (voxelization.fill() == Voxelizer::kFillSolid) {
+    QVector<double> crossings;
+    for (int z = first_z; z <= last_z; ++z) {
+      for (int x = first_x; x <= last_x; ++x) {
+        double ray_x = x + 0.5 + kRayOffsetX;
+        double ray_z = z + 0.5 + kRayOffsetZ;
+        triangles.clear();
+        voxelization.bvh().query(QVector3D(ray_x, 0, ray_z), QVector3D(ray_x, height, ray_z), &triangles);
+        crossings.clear();
+        foreach (int triangle, triangles) {
+          double crossing = 0;
+          if (verticalLineCrossesTriangle(ray_x, ray_z, voxelization.corner(triangle, 0),
+                                          voxelization.corner(triangle, 1), voxelization.corner(triangle, 2),
+                                          &crossing)) {
+            crossings.append(crossing);
+          }
+        }
+        qSort(crossings);
+        // If the mesh isn't closed there may be an odd number of crossings, and the last one is ignored.
+        for (int i = 0; i + 1 < crossings.size(); i += 2) {
+          int bottom = qMax(0, static_cast<int>(ceil(crossings.at(i) - 0.5)));
+          int top = qMin(height - 1, static_cast<int>(floor(crossings.at(i + 1) - 0.5)));
+          for (int y = bottom; y <= top; ++y) {
+            cells.setBit(((y * kChunkSize) + (z - first_z)) * kChunkSize + (x - first_x));
+          }
+        }
+      }
+    }
+  }
+
+  QVector<BlockSpan> spans;
+  const BlockPosition& origin = voxelization.origin();
+  for (int y = 0; y < height; ++y) {
+    for (int z = first_z; z <= last_z; ++z) {
+      int row = ((y * kChunkSize) + (z - first_z)) * kChunkSize;
+      int run_start = -1;
+      for (int x = first_x; x <= last_x + 1; ++x) {
+        bool covered = x <= last_x && cells.testBit(row + x - first_x);
+        if (covered && run_start < 0) {
+          run_start = x;
+        } else if (!covered && run_start >= 0) {
+          spans.append(BlockSpan(origin.x() + run_start, origin.x() + x - 1, origin.y() + y, origin.z() + z));
+          run_start = -1;
+        }
+      }
+    }
+  }
+  return spans;
+}
+
+Voxelizer::Voxelizer(const TriangleMesh& mesh, double scale, UpAxis up_axis)
+    : mesh_(mesh), scale_(scale), up_axis_(up_axis), width_(0), height_(0), depth_(0) {
+  if (!mesh.triangleCount()) {
+    return;
+  }
+  minimum_ = mesh.minimum();
+  QVector3D maximum = mesh.maximum();
+  if (up_axis == kUpAxisZ) {
+    minimum_ = QVector3D(mesh.minimum().x(), mesh.minimum().z(), -mesh.maximum().y());
+    maximum = QVector3D(mesh.maximum().x(), mesh.maximum().z(), -mesh.minimum().y());
+  }
+  // Sizes too large to voxelize are capped just past the limit, so that isValid() catches them without overflowing.
+  QVector3D extent = (maximum - minimum_) * scale;
+  width_ = static_cast<int>(qMin<double>(floor(extent.x() + kGridNudge), kMaximumSize)) + 1;
+  height_ = static_cast<int>(qMin<double>(floor(extent.y() + kGridNudge), kMaximumSize)) + 1;
+  depth_ = static_cast<int>(qMin<double>(floor(extent.z() + kGridNudge), kMaximumSize)) + 1;
+}
+
+SpanMask Voxelizer::voxelize(Fill fill, const BlockPosition& origin) const {
+  Q_ASSERT(isValid());
+  SpanMask mask;
+  if (!mesh_.triangleCount()) {
+    return mask;
+  }
+  // Turning z up into y up is a quarter turn about x, which keeps the handedness of the mesh.
+  QVector<QVector3D> corners;
+  corners.reserve(mesh_.triangleCount() * 3);
+  for (int triangle = 0; triangle < mesh_.triangleCount(); ++triangle) {
+    for (int i = 0; i < 3; ++i) {
+      QVector3D corner = mesh_.corner(triangle, i);
+      if (up_axis_ == kUpAxisZ) {
+        corner = QVector3D(corner.x(), corner.z(), -corner.y());
+      }
+      corners.append((corner - minimum_) * scale_ + QVector3D(kGridNudge, kGridNudge, kGridNudge));
+    }
+  }
+  TriangleBvh bvh(corners);
+  Voxelization voxelization(corners, &bvh, fill, width_, height_, depth_, origin);
+  QList<VoxelColumnJob> jobs;
+  for (int column_z = 0; column_z * kChunkSize < depth_; ++column_z) {
+    for (int column_x = 0; column_x * kChunkSize < width_; ++column_x) {
+      jobs.append(VoxelColumnJob(column_x, column_z, &voxelization));
+    }
+  }
+  QList<QVector<BlockSpan> > results = QtConcurrent::blockingMapped<QList<QVector<BlockSpan> > >(jobs, voxelizeColumn);
+  foreach (const QVector<BlockSpan>& spans, results) {
+    foreach (const BlockSpan& span, spans) {
+      mask.addSpan(span.firstX(), span.lastX(), span.y(), span.z());
+    }
+  }
+  return mask;
+}
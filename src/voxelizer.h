@@ -0,0 +1,112 @@
+/* Copyright 2012 Brian Ellis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VOXELIZER_H
+#define VOXELIZER_H
+
+#include <QVector3D>
+
+#include "span_mask.h"
+#include "triangle_mesh.h"
+
+class BlockPosition;
+
+/**
+  * Turns a TriangleMesh into the cells of blocks it covers, so that a model made in a CAD program can be rebuilt in a
+  * diagram.
+  *
+  * The mesh is scaled so that one unit of it is scale() blocks long and moved so that the corner of its bounding box
+  * with the smallest coordinates lies at the corner of the first cell.  A cell is part of the shell of the mesh if
+  * any triangle touches it, which is decided exactly with a separating axis test between the triangle and the cell.
+  * Solid fills add every cell whose center is inside the mesh, found by casting a ray up through each column of cells
+  * and filling between alternate crossings of the surface, so the mesh should be closed for them to make sense.
+  *
+  * The grid is split into columns one chunk wide and deep, which are voxelized in parallel on the global thread pool.
+  * Each column finds the triangles it needs through a bounding volume hierarchy built over the whole mesh, so the
+  * work for a column is proportional to the triangles near it rather than to the size of the mesh.
+  */
+class Voxelizer {
+ public:
+  enum Fill {
+    kFillSolid,
+    kFillShell
+  };
+
+  enum UpAxis {
+    kUpAxisY,
+    kUpAxisZ
+  };
+
+  /**
+    * The most blocks the voxelized mesh may span along any axis.
+    */
+  static const int kMaximumSize = 4096;
+
+  /**
+    * Prepares to voxelize \p mesh at \p scale blocks per unit.  \p up_axis says which of the mesh's axes points up;
+    * modelling programs mostly use _y_ like the diagram does, but CAD programs often use _z_.  This only works out
+    * the size of the result, so it is cheap enough to do every time the scale changes.
+    */
+  Voxelizer(const TriangleMesh& mesh, double scale, UpAxis up_axis);
+
+  /**
+    * Returns the number of blocks the voxelized mesh spans along x.
+    */
+  int width() const {
+    return width_;
+  }
+
+  /**
+    * Returns the number of levels the voxelized mesh spans.
+    */
+  int height() const {
+    return height_;
+  }
+
+  /**
+    * Returns the number of blocks the voxelized mesh spans along z.
+    */
+  int depth() const {
+    return depth_;
+  }
+
+  /**
+    * Returns whether the voxelized mesh would be small enough to voxelize, no more than kMaximumSize blocks along any
+    * axis.
+    */
+  bool isValid() const {
+    return width_ <= kMaximumSize && height_ <= kMaximumSize && depth_ <= kMaximumSize;
+  }
+
+  /**
+    * Returns the cells covered by the mesh, filled according to \p fill, with the corner of the first cell at
+    * \p origin.  The voxelizer must be valid.
+    */
+  SpanMask voxelize(Fill fill, const BlockPosition& origin) const;
+
+ private:
+  TriangleMesh mesh_;
+  double scale_;
+  UpAxis up_axis_;
+  /**
+    * The corner of the mesh's bounding box with the smallest coordinates, once it has been turned so that y is up.
+    */
+  QVector3D minimum_;
+  int width_;
+  int height_;
+  int depth_;
+};
+
+#endif // VOXELIZER_H
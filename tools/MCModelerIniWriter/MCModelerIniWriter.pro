@@ -23,7 +23,8 @@ HEADERS += \
     ../../src/block_geometry.h \
     ../../src/enumeration_impl.h \
     ../../src/enumeration.h \
-    ../../src/block_property_keys.h
+    ../../src/block_property_keys.h \
+    ../../src/block_orientation_table.h
 
 INCLUDEPATH += ../../third_party/qjson/include
 
@@ -12,6 +12,7 @@
 #include <QJson/Serializer>
 
 #include "../../src/block_geometry.h"
+#include "../../src/block_orientation_table.h"
 #include "../../src/block_property_keys.h"
 #include "../../src/enumeration.h"
 
@@ -24,46 +25,9 @@ const char kCategoryMining[] = "mining";
 const char kCategoryVegetation[] = "vegetation";
 const char kCategoryNether[] = "nether";
 
-const char kOrientationNone[] = "";
-const char kOrientationFacingSouth[] = "Facing south";
-const char kOrientationFacingWest[] = "Facing west";
-const char kOrientationFacingNorth[] = "Facing north";
-const char kOrientationFacingEast[] = "Facing east";
-const char kOrientationFacingSouthInverted[] = "Facing south, inverted";
-const char kOrientationFacingWestInverted[] = "Facing west, inverted";
-const char kOrientationFacingNorthInverted[] = "Facing north, inverted";
-const char kOrientationFacingEastInverted[] = "Facing east, inverted";
-const char kOrientationRunningNorthSouth[] = "Running north/south";
-const char kOrientationRunningEastWest[] = "Running east/west";
-const char kOrientationNorthwestCorner[] = "Northwest corner";
-const char kOrientationSouthwestCorner[] = "Southwest corner";
-const char kOrientationNortheastCorner[] = "Northeast corner";
-const char kOrientationSoutheastCorner[] = "Southeast corner";
-const char kOrientationAscendingSouth[] = "Ascending south";
-const char kOrientationAscendingWest[] = "Ascending west";
-const char kOrientationAscendingNorth[] = "Ascending north";
-const char kOrientationAscendingEast[] = "Ascending east";
-const char kOrientationNorthHalf[] = "North half";
-const char kOrientationSouthHalf[] = "South half";
-const char kOrientationEastHalf[] = "East half";
-const char kOrientationWestHalf[] = "West half";
-const char kOrientationTFacingSouth[] = "T facing south";
-const char kOrientationTFacingWest[] = "T facing west";
-const char kOrientationTFacingNorth[] = "T facing north";
-const char kOrientationTFacingEast[] = "T facing east";
-const char kOrientationCross[] = "Cross";
-const char kOrientationOnFloor[] = "On floor";
-const char kOrientationOnNorthWall[] = "On north wall";
-const char kOrientationOnEastWall[] = "On east wall";
-const char kOrientationOnSouthWall[] = "On south wall";
-const char kOrientationOnWestWall[] = "On west wall";
-const char kOrientationOneBlockFromSource[] = "One block from source";
-const char kOrientationTwoBlocksFromSource[] = "Two blocks from source";
-const char kOrientationThreeBlocksFromSource[] = "Three blocks from source";
-const char kOrientationFourBlocksFromSource[] = "Four blocks from source";
-const char kOrientationFiveBlocksFromSource[] = "Five blocks from source";
-const char kOrientationSixBlocksFromSource[] = "Six blocks from source";
-const char kOrientationSevenBlocksFromSource[] = "Seven blocks from source";
+#define DECLARE_ORIENTATION_NAME(identifier, name) const char kOrientation##identifier[] = name;
+BLOCK_ORIENTATION_TABLE(DECLARE_ORIENTATION_NAME)
+#undef DECLARE_ORIENTATION_NAME
 
 
 // Anatomy of a 32-bit MCModeler block ID: